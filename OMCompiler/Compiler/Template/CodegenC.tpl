@@ -1076,7 +1076,7 @@ template simulationFile(SimCode simCode, String guid, String isModelExchangeFMU)
 
     <%functionSetC(modelInfo, modelNamePrefixStr)%>
 
-    <%functionDAE(allEquations, modelNamePrefixStr)%>
+    <%functionDAE(allEquations, fileNamePrefix, simCode.fullPathPrefix, modelNamePrefixStr)%>
 
     <%functionLocalKnownVars(localKnownVars, modelNamePrefixStr)%>
 
@@ -3097,10 +3097,14 @@ end functionUpdateBoundParameters;
 
 template functionEquationsMultiFiles(list<SimEqSystem> inEqs, Integer numEqs, Integer equationsPerFile, String fileNamePrefix, String fullPathPrefix, String modelNamePrefix, String funcName, String partName, Text &eqFuncs, Boolean static, Boolean noOpt, Boolean init)
 ::=
+  match System.tmpTickIndexReserve(0, 0) /* Remember the old tmpTick, the equations of the parts start at 0 */
+  case oldTick then
+  match SimCodeUtil.balancedPartitionBySize(inEqs, equationsPerFile)
+  case parts then
   let () = System.tmpTickReset(0)
   let &file = buffer ""
-  let multiFile = if intGt(numEqs, equationsPerFile) then "x"
-  let fncalls = (List.balancedPartition(inEqs, equationsPerFile) |> eqs hasindex i0 =>
+  let multiFile = if intGt(listLength(parts), 1) then "x"
+  let fncalls = (parts |> eqs hasindex i0 =>
                   let name = symbolName(modelNamePrefix,'<%funcName%>_<%i0%>')
                   let &eqFuncs += 'void <%name%>(DATA *data, threadData_t *threadData);<%\n%>'
 
@@ -3141,6 +3145,7 @@ template functionEquationsMultiFiles(list<SimEqSystem> inEqs, Integer numEqs, In
                   )
 
   let &eqFuncs += file
+  let () = System.tmpTickSetIndex(oldTick, 0)
   fncalls
 end functionEquationsMultiFiles;
 
@@ -4250,9 +4255,12 @@ template initializeDAEmodeData(Integer nResVars, list<SimVar> algVars, Integer n
   >>
 end initializeDAEmodeData;
 
-template functionDAE(list<SimEqSystem> allEquationsPlusWhen, String modelNamePrefix)
+template functionDAE(list<SimEqSystem> allEquationsPlusWhen, String fileNamePrefix, String fullPathPrefix, String modelNamePrefix)
   "Generates function in simulation file.
-  This is a helper of template simulationFile."
+  This is a helper of template simulationFile.
+  The equations are split into separate files with at most --equationsPerFile
+  equations each, so the C compiler can process them in parallel. The Jacobians
+  (_12jac.c) and the functions (_functions.c) are still generated as single files."
 ::=
   let &auxFunction = buffer ""
   let nrfuncs = listLength(allEquationsPlusWhen)
@@ -4263,10 +4271,8 @@ template functionDAE(list<SimEqSystem> allEquationsPlusWhen, String modelNamePre
               equation_arrayFormat(eq, "DAE", contextSimulationDiscrete, i0, &eqArray, &eqfuncs, modelNamePrefix, false)
                     ;separator="\n")
               else
-                (allEquationsPlusWhen |> eq hasindex i0 =>
-                    let &eqfuncs += equation_impl(-1, eq, contextSimulationDiscrete, modelNamePrefix, false)
-                    equation_call(eq, modelNamePrefix)
-                    ;separator="\n")
+                functionEquationsMultiFiles(allEquationsPlusWhen, listLength(allEquationsPlusWhen), Flags.getConfigInt(Flags.EQUATIONS_PER_FILE), fileNamePrefix, fullPathPrefix, modelNamePrefix,
+                  "functionDAE", "eqs", &eqfuncs, /* not static */ false, /* do optimize */ false, /* initial */ false)
 
   let eqArrayDecl = if Flags.isSet(Flags.PARMODAUTO) then
                 <<
@@ -5490,8 +5496,19 @@ match eq
 case SES_SIMPLE_ASSIGN(exp=CALL(path=IDENT(name="fail")))
 case SES_SIMPLE_ASSIGN_CONSTRAINTS(exp=CALL(path=IDENT(name="fail"))) then
   '<%generateThrow()%><%\n%>'
-case SES_SIMPLE_ASSIGN(__)
+case SES_SIMPLE_ASSIGN(__) then
+  if isArrayType(crefTypeFull(cref)) then
+    equationSimpleArrayAssign(eq, cref, exp, context, &varDecls, &auxFunction)
+  else
+    equationSimpleAssignScalar(eq, cref, exp, context, &varDecls, &auxFunction)
 case SES_SIMPLE_ASSIGN_CONSTRAINTS(__) then
+  equationSimpleAssignScalar(eq, cref, exp, context, &varDecls, &auxFunction)
+end equationSimpleAssign;
+
+template equationSimpleAssignScalar(SimEqSystem eq, ComponentRef cref, Exp exp, Context context,
+                                    Text &varDecls, Text &auxFunction)
+ "Generates the assignment of a scalar variable."
+::=
   let &preExp = buffer ""
   let expPart = daeExp(exp, context, &preExp, &varDecls, &auxFunction)
   let postExp = if isStartCref(cref) then
@@ -5506,7 +5523,24 @@ case SES_SIMPLE_ASSIGN_CONSTRAINTS(__) then
     <%postExp%>
   <%endModelicaLine()%>
   >>
-end equationSimpleAssign;
+end equationSimpleAssignScalar;
+
+template equationSimpleArrayAssign(SimEqSystem eq, ComponentRef cref, Exp exp, Context context,
+                                   Text &varDecls, Text &auxFunction)
+ "Generates the assignment of a whole array variable, as resulting from array
+  equations that are kept with -d=-nfScalarize. The data is copied in a loop
+  over the contiguous array instead of one statement per element."
+::=
+  let &preExp = buffer ""
+  let expPart = daeExp(exp, context, &preExp, &varDecls, &auxFunction)
+  let lhsstr = daeExpCrefLhs(crefExp(cref), context, &preExp, &varDecls, &auxFunction, false)
+  <<
+  <%modelicaLine(eqInfo(eq))%>
+  <%preExp%>
+  copy_<%expTypeShort(crefTypeFull(cref))%>_array_data(<%expPart%>, &<%lhsstr%>);
+  <%endModelicaLine()%>
+  >>
+end equationSimpleArrayAssign;
 
 template equationForLoop(SimEqSystem eq, Context context, Text &varDecls, Text &auxFunction)
  "Generates an equation that is a for-loop."
@@ -5515,18 +5549,20 @@ match eq
 case SES_FOR_LOOP(__) then
   let &preExp = buffer ""
   let expPart = daeExp(exp, context, &preExp, &varDecls, &auxFunction)
-  let crefPart = daeExp(crefExp(cref), context, &preExp, &varDecls, &auxFunction)
-  //let bodyStr = daeExpIteratedCref(body)
+  let crefPart = daeExpCrefLhs(crefExp(cref), context, &preExp, &varDecls, &auxFunction, false)
   let start = dumpExp(startIt,"\"")
   let stop = dumpExp(endIt,"\"")
-  let iterVar = daeExp(iter, context, &preExp, &varDecls, &auxFunction)
+  let iterVar = '$P<%dumpExp(iter,"\"")%>'
   <<
   <%modelicaLine(eqInfo(eq))%>
-  modelica_integer  $P<%dumpExp(iter,"\"")%> = 0; // the iterator
-  // the for-equation
-  for($P<%dumpExp(iter,"\"")%> = <%start%>; $P<%dumpExp(iter,"\"")%> != <%stop%>+1; $P<%dumpExp(iter,"\"")%>++)
   {
-    <%crefPart%> += <%expPart%>;
+    modelica_integer <%iterVar%>; /* the iterator */
+    /* the for-equation, the body is evaluated once per iteration */
+    for(<%iterVar%> = <%start%>; <%iterVar%> <= <%stop%>; <%iterVar%>++)
+    {
+      <%preExp%>
+      <%crefPart%> = <%expPart%>;
+    }
   }
   <%endModelicaLine()%>
   >>
@@ -6208,6 +6244,7 @@ case SIMCODE(modelInfo=MODELINFO(varInfo=varInfo as VARINFO(__)), delayedExps=DE
   <<
   # Makefile generated by OpenModelica
   # Platform: <%makefileParams.platform%>
+  # Version: <%getVersionNr()%>
 
   # Simulations use -O3 by default
   CC=<%if boolOr(Flags.isSet(Flags.PARMODAUTO),acceptParModelicaGrammar()) then 'g++' else '<%makefileParams.ccompiler%>'%>
@@ -6235,18 +6272,28 @@ case SIMCODE(modelInfo=MODELINFO(varInfo=varInfo as VARINFO(__)), delayedExps=DE
   OFILES=$(CFILES:.c=.o)
   GENERATEDFILES=$(MAINFILE) <%fileNamePrefix%>.makefile <%fileNamePrefix%>_literals.h <%fileNamePrefix%>_functions.h $(CFILES)
 
-  .PHONY: omc_main_target clean bundle
+  .PHONY: omc_main_target clean bundle FORCE
 
-  # This is to make sure that <%fileNamePrefix%>_*.c are always compiled.
-  .PHONY: $(CFILES)
+  # The executable is only linked again if one of the objects was recompiled
+  omc_main_target: <%fileNamePrefix%>$(EXEEXT)
 
-  omc_main_target: $(MAINOBJ) <%fileNamePrefix%>_functions.h <%fileNamePrefix%>_literals.h $(OFILES)
+  <%fileNamePrefix%>$(EXEEXT): $(MAINOBJ) <%fileNamePrefix%>_functions.h <%fileNamePrefix%>_literals.h $(OFILES)
   <%\t%>$(CC) -I. -o <%fileNamePrefix%>$(EXEEXT) $(MAINOBJ) $(OFILES) $(CPPFLAGS) $(DIREXTRA) <%libsPos1%> <%libsPos2%> $(CFLAGS) $(CPPFLAGS) $(LDFLAGS)
   <% if stringEq(Config.simCodeTarget(),"JavaScript") then '<%\t%>rm -f <%fileNamePrefix%>'%>
   <% if stringEq(Config.simCodeTarget(),"JavaScript") then '<%\t%>ln -s <%fileNamePrefix%>_node.js <%fileNamePrefix%>'%>
   <% if stringEq(Config.simCodeTarget(),"JavaScript") then '<%\t%>chmod +x <%fileNamePrefix%>_node.js'%>
+
+  # An object is only recompiled if the contents of its source, the generated headers
+  # or this makefile (compiler flags and omc version) changed since it was compiled.
+  # Contents are compared instead of modification times, which do not tell a file
+  # regenerated within the same second apart.
+  OBJECTDEPS=$(wildcard <%fileNamePrefix%>*.h) <%fileNamePrefix%>.makefile
+  $(MAINOBJ) $(OFILES): %.o: %.c FORCE
+  <%\t%>@cat $< $(OBJECTDEPS) | cksum > $@.key.tmp
+  <%\t%>@if test -f $@ && cmp -s $@.key.tmp $@.key; then rm -f $@.key.tmp; else echo "$(COMPILE.c) $(OUTPUT_OPTION) $<"; $(COMPILE.c) $(OUTPUT_OPTION) $< && mv $@.key.tmp $@.key; fi
+
   clean:
-  <%\t%>@rm -f <%fileNamePrefix%>_records.o $(MAINOBJ)
+  <%\t%>@rm -f <%fileNamePrefix%>_records.o $(MAINOBJ) $(MAINOBJ).key $(OFILES:.o=.o.key)
 
   bundle:
   <%\t%>@tar -cvf <%fileNamePrefix%>_Files.tar $(GENERATEDFILES)
@@ -127,6 +127,7 @@ template additionalHpcomIncludesForParallelCode(SimCode simCode, Text& extraFunc
     case ("openmp") then
       <<
       #include <omp.h>
+      <%if intGt(getConfigInt(HPCOM_ADAPTIVE_STEPS), 0) then '#include <Core/Utils/extension/adaptive_level_schedule.hpp>'%>
       >>
     case ("pthreads")
     case ("pthreads_spin") then
@@ -350,6 +351,13 @@ template generateAdditionalHpcomVarHeaders(Option<tuple<Schedule,Schedule,Schedu
           >>
         else ""
       end match
+    case SOME((odeSchedule as LEVELSCHEDULE(useFixedAssignments=false),_,_)) then
+      if boolAnd(stringEq(type, "openmp"), intGt(getConfigInt(HPCOM_ADAPTIVE_STEPS), 0)) then
+        <<
+        AdaptiveLevelSchedule _adaptiveScheduleOde;
+        AdaptiveLevelSchedule _adaptiveScheduleAll;
+        AdaptiveLevelSchedule _adaptiveScheduleZeroFuncs;
+        >>
     case SOME((odeSchedule as THREADSCHEDULE(__),daeSchedule as THREADSCHEDULE(__),zeroFuncSchedule as THREADSCHEDULE(__))) then
       let odeLocks = createLockArrayByName(listLength(odeSchedule.outgoingDepTasks),"_lockOde",type)//odeSchedule.outgoingDepTasks |> task => createLockByDepTask(task, "_lockOde", type); separator="\n"
       let daeLocks = createLockArrayByName(listLength(daeSchedule.outgoingDepTasks),"_lockDae",type)//daeSchedule.outgoingDepTasks |> task => createLockByDepTask(task, "_lockDae", type); separator="\n"
@@ -504,6 +512,13 @@ template additionalHpcomConstructorBodyStatements(Option<tuple<Schedule,Schedule
           >>
         else ""
       end match
+    case SOME((odeSchedule as LEVELSCHEDULE(useFixedAssignments=false),daeSchedule as LEVELSCHEDULE(useFixedAssignments=false),zeroFuncSchedule as LEVELSCHEDULE(useFixedAssignments=false))) then
+      if boolAnd(stringEq(type, "openmp"), intGt(getConfigInt(HPCOM_ADAPTIVE_STEPS), 0)) then
+        <<
+        <%generateAdaptiveLevelScheduleInit(odeSchedule.tasksOfLevels, "_adaptiveScheduleOde")%>
+        <%generateAdaptiveLevelScheduleInit(daeSchedule.tasksOfLevels, "_adaptiveScheduleAll")%>
+        <%generateAdaptiveLevelScheduleInit(zeroFuncSchedule.tasksOfLevels, "_adaptiveScheduleZeroFuncs")%>
+        >>
     case SOME((odeSchedule as THREADSCHEDULE(__),daeSchedule as THREADSCHEDULE(__),zeroFuncSchedule as THREADSCHEDULE(__))) then
       let initLocksOde = initializeArrayLocks(listLength(odeSchedule.outgoingDepTasks),"_lockOde",type)//odeSchedule.outgoingDepTasks |> task => initializeLockByDepTask(task, "_lockOde", type); separator="\n"
       let assignLocksOde = assignArrayLocks(listLength(odeSchedule.outgoingDepTasks),"_lockOde",type)//odeSchedule.outgoingDepTasks |> task => assignLockByDepTask(task, "_lockOde", type); separator="\n"
@@ -567,6 +582,25 @@ template additionalHpcomConstructorBodyStatements(Option<tuple<Schedule,Schedule
   >>
 end additionalHpcomConstructorBodyStatements;
 
+template generateAdaptiveLevelScheduleInit(list<TaskList> tasksOfLevels, String scheduleName)
+"Registers the levels of a level schedule at the runtime scheduler, serial task lists are a single task."
+::=
+  let levels = tasksOfLevels |> tasksOfLevel => '<%scheduleName%>.addLevel(<%numberOfAdaptiveLevelTasks(tasksOfLevel)%>);'; separator="\n"
+  <<
+  <%levels%>
+  <%scheduleName%>.init(<%getConfigInt(NUM_PROC)%>, <%getConfigInt(HPCOM_ADAPTIVE_STEPS)%>);
+  >>
+end generateAdaptiveLevelScheduleInit;
+
+template numberOfAdaptiveLevelTasks(TaskList tasksOfLevel)
+::=
+  match(tasksOfLevel)
+    case(PARALLELTASKLIST(__)) then '<%listLength(tasks)%>'
+    case(SERIALTASKLIST(__)) then '1'
+    else '0'
+  end match
+end numberOfAdaptiveLevelTasks;
+
 template generateThreadMeasureTimeDeclaration(String fullModelName, Integer numberOfThreads)
 ::=
   <<
@@ -844,10 +878,6 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
         }
         >>
     case SOME((odeSchedule as LEVELSCHEDULE(useFixedAssignments=false, tasksOfLevels=tasksOfLevelsOde), daeSchedule as LEVELSCHEDULE(useFixedAssignments=false, tasksOfLevels=tasksOfLevelsDae), zeroFuncSchedule as LEVELSCHEDULE(useFixedAssignments=false, tasksOfLevels=tasksOfLevelsZeroFunc))) then
-      let odeEqs = tasksOfLevelsOde |> tasks => generateLevelCodeForLevel(allEquationsPlusWhen, tasks, type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation); separator="\n"
-      let daeEqs = tasksOfLevelsDae |> tasks => generateLevelCodeForLevel(allEquationsPlusWhen, tasks, type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation); separator="\n"
-      let zeroFuncEqs = tasksOfLevelsZeroFunc |> tasks => generateLevelCodeForLevel(allEquationsPlusWhen, tasks, type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation); separator="\n"
-
       match type
         case ("openmp") then
           let &extraFuncsDecl +=
@@ -856,31 +886,19 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
           void evaluateAll_Parallel();
           void evaluateZeroFuncs_Parallel();
           >>
+          let parallelFunctions = if intGt(getConfigInt(HPCOM_ADAPTIVE_STEPS), 0) then
+            <<
+            <%generateAdaptiveLevelFunctions(allEquationsPlusWhen, tasksOfLevelsOde, "evaluateODE", "_adaptiveScheduleOde", type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation)%>
 
-          <<
-          void <%lastIdentOfPath(name)%>::evaluateODE_Parallel()
-          {
-            #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
-            {
-              <%odeEqs%>
-            }
-          }
+            <%generateAdaptiveLevelFunctions(allEquationsPlusWhen, tasksOfLevelsDae, "evaluateAll", "_adaptiveScheduleAll", type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation)%>
 
-          void <%lastIdentOfPath(name)%>::evaluateAll_Parallel()
-          {
-            #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
-            {
-              <%daeEqs%>
-            }
-          }
+            <%generateAdaptiveLevelFunctions(allEquationsPlusWhen, tasksOfLevelsZeroFunc, "evaluateZeroFuncs", "_adaptiveScheduleZeroFuncs", type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation)%>
+            >>
+          else
+            generateLevelFunctions(allEquationsPlusWhen, tasksOfLevelsOde, tasksOfLevelsDae, tasksOfLevelsZeroFunc, type, &varDecls, simCode, extraFuncs, extraFuncsDecl, lastIdentOfPath(name), useFlatArrayNotation)
 
-          void <%lastIdentOfPath(name)%>::evaluateZeroFuncs_Parallel()
-          {
-            #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
-            {
-              <%zeroFuncEqs%>
-            }
-          }
+          <<
+          <%parallelFunctions%>
 
           <%functionHead%>
           {
@@ -1233,6 +1251,163 @@ template generateLevelCodeForTask(list<SimEqSystem> allEquationsPlusWhen, Task i
   >>
 end generateLevelCodeForTask;
 
+template generateLevelFunctions(list<SimEqSystem> allEquationsPlusWhen, list<TaskList> tasksOfLevelsOde, list<TaskList> tasksOfLevelsDae, list<TaskList> tasksOfLevelsZeroFunc,
+                                String iType, Text &varDecls, SimCode simCode, Text& extraFuncs, Text& extraFuncsDecl, Text extraFuncsNamespace, Boolean useFlatArrayNotation)
+::=
+  let odeEqs = tasksOfLevelsOde |> tasks => generateLevelCodeForLevel(allEquationsPlusWhen, tasks, iType, &varDecls, simCode, extraFuncs, extraFuncsDecl, extraFuncsNamespace, useFlatArrayNotation); separator="\n"
+  let daeEqs = tasksOfLevelsDae |> tasks => generateLevelCodeForLevel(allEquationsPlusWhen, tasks, iType, &varDecls, simCode, extraFuncs, extraFuncsDecl, extraFuncsNamespace, useFlatArrayNotation); separator="\n"
+  let zeroFuncEqs = tasksOfLevelsZeroFunc |> tasks => generateLevelCodeForLevel(allEquationsPlusWhen, tasks, iType, &varDecls, simCode, extraFuncs, extraFuncsDecl, extraFuncsNamespace, useFlatArrayNotation); separator="\n"
+  <<
+  void <%extraFuncsNamespace%>::evaluateODE_Parallel()
+  {
+    #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
+    {
+      <%odeEqs%>
+    }
+  }
+
+  void <%extraFuncsNamespace%>::evaluateAll_Parallel()
+  {
+    #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
+    {
+      <%daeEqs%>
+    }
+  }
+
+  void <%extraFuncsNamespace%>::evaluateZeroFuncs_Parallel()
+  {
+    #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
+    {
+      <%zeroFuncEqs%>
+    }
+  }
+  >>
+end generateLevelFunctions;
+
+template generateAdaptiveLevelFunctions(list<SimEqSystem> allEquationsPlusWhen, list<TaskList> tasksOfLevels, String functionName, String scheduleName,
+                                        String iType, Text &varDecls, SimCode simCode, Text& extraFuncs, Text& extraFuncsDecl, Text extraFuncsNamespace, Boolean useFlatArrayNotation)
+"Generates the level schedule evaluation that measures the task times during the first calls and is re-balanced afterwards."
+::=
+  let levelCases = tasksOfLevels |> tasksOfLevel hasindex levelIdx fromindex 0 => generateAdaptiveLevelTaskCases(allEquationsPlusWhen, tasksOfLevel, levelIdx, iType, &varDecls, simCode, extraFuncs, extraFuncsDecl, extraFuncsNamespace, useFlatArrayNotation); separator="\n"
+  let &extraFuncsDecl += 'void <%functionName%>_Task(int level, int task);<%\n%>'
+  <<
+  void <%extraFuncsNamespace%>::<%functionName%>_Task(int level, int task)
+  {
+    switch(level)
+    {
+      <%levelCases%>
+      default:
+        break;
+    }
+  }
+
+  void <%extraFuncsNamespace%>::<%functionName%>_Parallel()
+  {
+    AdaptiveLevelSchedule& schedule = <%scheduleName%>;
+    if(schedule.isSerial())
+    {
+      for(int level = 0; level < schedule.getNumberOfLevels(); level++)
+      {
+        const std::vector<int>& tasks = schedule.getTasksOfLevel(level);
+        for(size_t i = 0; i < tasks.size(); i++)
+          <%functionName%>_Task(level, tasks[i]);
+      }
+      return;
+    }
+
+    #pragma omp parallel num_threads(<%getConfigInt(NUM_PROC)%>)
+    {
+      int threadNum = omp_get_thread_num();
+      int teamSize = omp_get_num_threads();
+      for(int level = 0; level < schedule.getNumberOfLevels(); level++)
+      {
+        const std::vector<int>& tasks = schedule.getTasksOfLevel(level);
+        int numTasks = (int)tasks.size();
+        AdaptiveLevelSchedule::LevelMode mode = schedule.getLevelMode(level);
+        if(mode == AdaptiveLevelSchedule::MEASURE)
+        {
+          #pragma omp for schedule(dynamic,1)
+          for(int i = 0; i < numTasks; i++)
+          {
+            double startTime = omp_get_wtime();
+            <%functionName%>_Task(level, tasks[i]);
+            schedule.addTaskTime(level, tasks[i], omp_get_wtime() - startTime);
+          }
+        }
+        else if(mode == AdaptiveLevelSchedule::DYNAMIC)
+        {
+          #pragma omp for schedule(dynamic,1)
+          for(int i = 0; i < numTasks; i++)
+            <%functionName%>_Task(level, tasks[i]);
+        }
+        else
+        {
+          if(mode == AdaptiveLevelSchedule::SERIAL)
+          {
+            #pragma omp master
+            {
+              for(int i = 0; i < numTasks; i++)
+                <%functionName%>_Task(level, tasks[i]);
+            }
+          }
+          else
+          {
+            // the runtime may start fewer threads than the schedule has slots, run the remaining slots round-robin
+            for(int slot = threadNum; slot < schedule.getNumberOfThreads(); slot += teamSize)
+            {
+              const std::vector<int>& threadTasks = schedule.getTasksOfThread(level, slot);
+              for(size_t i = 0; i < threadTasks.size(); i++)
+                <%functionName%>_Task(level, threadTasks[i]);
+            }
+          }
+          #pragma omp barrier
+        }
+      }
+    }
+    schedule.finishCall();
+  }
+  >>
+end generateAdaptiveLevelFunctions;
+
+template generateAdaptiveLevelTaskCases(list<SimEqSystem> allEquationsPlusWhen, TaskList tasksOfLevel, Integer levelIdx, String iType, Text &varDecls,
+                                        SimCode simCode, Text& extraFuncs, Text& extraFuncsDecl, Text extraFuncsNamespace, Boolean useFlatArrayNotation)
+::=
+  match(tasksOfLevel)
+    case(PARALLELTASKLIST(__)) then
+      let taskCases = (tasks |> task hasindex taskIdx fromindex 0 =>
+        <<
+        case <%taskIdx%>:
+        {
+          <%taskCode(allEquationsPlusWhen, task, iType, "", &varDecls, simCode, extraFuncs, extraFuncsDecl, extraFuncsNamespace, useFlatArrayNotation)%>
+          break;
+        }
+        >>
+        ;separator="\n")
+      <<
+      case <%levelIdx%>:
+        switch(task)
+        {
+          <%taskCases%>
+          default:
+            break;
+        }
+        break;
+      >>
+    case(SERIALTASKLIST(__)) then
+      let odeEqs = tasks |> task => taskCode(allEquationsPlusWhen, task, iType, "", &varDecls, simCode, extraFuncs, extraFuncsDecl, extraFuncsNamespace, useFlatArrayNotation); separator="\n"
+      <<
+      case <%levelIdx%>:
+      {
+        <%odeEqs%>
+        break;
+      }
+      >>
+    else
+      <<
+      >>
+  end match
+end generateAdaptiveLevelTaskCases;
+
 template generateLevelFixedCodeForLevel(list<SimEqSystem> allEquationsPlusWhen, array<list<HpcOmSimCode.Task>> tasksOfLevel, String iType, Text &varDecls, Absyn.Path name, SimCode simCode, Text& extraFuncs, Text& extraFuncsDecl, Text extraFuncsNamespace, Boolean useFlatArrayNotation)
 ::=
   let eqs = (arrayList(tasksOfLevel) |> threadTasks hasindex i0 =>
@@ -287,6 +287,11 @@ case SIMCODE(modelInfo=MODELINFO(__)) then
     /*testmaessig aus der Cruntime*/
     void initializeColoredJacobianA();
 
+    /*sparsity pattern of A in compressed sparse column format*/
+    int* _ASparsePatternLeadindex;
+    int* _ASparsePatternIndex;
+    int  _ANonZeros;
+
   };
   >>
 end simulationJacobianHeaderFile;
@@ -420,6 +425,8 @@ case SIMCODE(modelInfo=MODELINFO(vars = vars as SIMVARS(__))) then
     /*colored jacobians*/
     virtual void getAColorOfColumn(int* aSparsePatternColorCols, int size);
     virtual int  getAMaxColors();
+    virtual int  getANonZeros();
+    virtual void getASparsePattern(int* aSparsePatternLeadindex, int* aSparsePatternIndex);
 
     virtual string getModelName();
     virtual bool isJacobianSparse();//true if getSparseJacobian is implemented and getJacobian is not, false if getJacobian is implemented and getSparseJacobian is not.
@@ -644,6 +651,9 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
        : <%lastIdentOfPath(modelInfo.name)%>(globalSettings,simObjects)
        , _AColorOfColumn(NULL)
        , _AMaxColors(0)
+       , _ASparsePatternLeadindex(NULL)
+       , _ASparsePatternIndex(NULL)
+       , _ANonZeros(0)
        <%initialjacMats%>
        <%jacobianVarsInit%>
    {
@@ -653,6 +663,9 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
        : <%lastIdentOfPath(modelInfo.name)%>(instance)
        , _AColorOfColumn(NULL)
        , _AMaxColors(0)
+       , _ASparsePatternLeadindex(NULL)
+       , _ASparsePatternIndex(NULL)
+       , _ANonZeros(0)
        <%initialjacMats%>
        <%jacobianVarsInit%>
    {
@@ -662,6 +675,10 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
    {
    if(_AColorOfColumn)
      delete []  _AColorOfColumn;
+   if(_ASparsePatternLeadindex)
+     delete []  _ASparsePatternLeadindex;
+   if(_ASparsePatternIndex)
+     delete []  _ASparsePatternIndex;
    }
 
    <%functionAnalyticJacobians(modelInfo,jacobianMatrixes, simCode , &extraFuncs , &extraFuncsDecl,  extraFuncsNamespace, stateDerVectorName, useFlatArrayNotation)%>
@@ -1145,6 +1162,20 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
     return _AMaxColors;
    }
 
+   int <%classname%>Mixed::getANonZeros()
+   {
+    return _ANonZeros;
+   }
+
+   void <%classname%>Mixed::getASparsePattern(int* aSparsePatternLeadindex, int* aSparsePatternIndex)
+   {
+    if(_ASparsePatternLeadindex)
+    {
+      memcpy(aSparsePatternLeadindex, _ASparsePatternLeadindex, (_dimContinuousStates + 1) * sizeof(int));
+      memcpy(aSparsePatternIndex, _ASparsePatternIndex, _ANonZeros * sizeof(int));
+    }
+   }
+
    string <%classname%>Mixed::getModelName()
    {
     return "<%fileNamePrefix%>";
@@ -12869,6 +12900,9 @@ case _ then
       '<%colorCol%>'
       ;separator="\n")
       let index_ = listLength(seedVars)
+      let sp_size_index = lengthListElements(unzipSecond(sparsepattern))
+      let colPtrIndex = (sparsepattern |> (i, indexes) => '<%listLength(indexes)%>' ;separator=",")
+      let rowIndex = (sparsepattern |> (i, indexes) => (indexes |> indexrow => '<%indexrow%>' ;separator=",") ;separator=",")
       <<
         if(_AColorOfColumn)
           delete [] _AColorOfColumn;
@@ -12877,6 +12911,21 @@ case _ then
 
         /* write color array */
         <%colorArray%>
+
+        /* write sparsity pattern in compressed sparse column format */
+        static const int colPtrIndex[1+<%listLength(sparsepattern)%>] = {0<%if colPtrIndex then ',<%colPtrIndex%>'%>};
+        static const int rowIndex[<%sp_size_index%>+1] = {<%rowIndex%>};
+        if(_ASparsePatternLeadindex)
+          delete [] _ASparsePatternLeadindex;
+        if(_ASparsePatternIndex)
+          delete [] _ASparsePatternIndex;
+        _ASparsePatternLeadindex = new int[<%listLength(sparsepattern)%>+1];
+        _ASparsePatternIndex = new int[<%sp_size_index%>+1];
+        _ANonZeros = <%sp_size_index%>;
+        memcpy(_ASparsePatternLeadindex, colPtrIndex, (<%listLength(sparsepattern)%>+1) * sizeof(int));
+        for(int i = 2; i < <%listLength(sparsepattern)%>+1; ++i)
+          _ASparsePatternLeadindex[i] += _ASparsePatternLeadindex[i-1];
+        memcpy(_ASparsePatternIndex, rowIndex, _ANonZeros * sizeof(int));
       >>
    end match
    end match
@@ -265,14 +265,19 @@ case SIMCODE(__) then
   <<
   void eventUpdate(ModelInstance* comp, fmi2EventInfo* eventInfo);
   fmi2Real getReal(ModelInstance* comp, const fmi2ValueReference vr);
+  UpdateLevel getRealUpdateLevel(const fmi2ValueReference vr);
   fmi2Status setReal(ModelInstance* comp, const fmi2ValueReference vr, const fmi2Real value);
   fmi2Integer getInteger(ModelInstance* comp, const fmi2ValueReference vr);
+  UpdateLevel getIntegerUpdateLevel(const fmi2ValueReference vr);
   fmi2Status setInteger(ModelInstance* comp, const fmi2ValueReference vr, const fmi2Integer value);
   fmi2Boolean getBoolean(ModelInstance* comp, const fmi2ValueReference vr);
+  UpdateLevel getBooleanUpdateLevel(const fmi2ValueReference vr);
   fmi2Status setBoolean(ModelInstance* comp, const fmi2ValueReference vr, const fmi2Boolean value);
   fmi2String getString(ModelInstance* comp, const fmi2ValueReference vr);
+  UpdateLevel getStringUpdateLevel(const fmi2ValueReference vr);
   fmi2Status setString(ModelInstance* comp, const fmi2ValueReference vr, fmi2String value);
   fmi2Status setExternalFunction(ModelInstance* c, const fmi2ValueReference vr, const void* value);
+  void evaluateOutputEquations(ModelInstance* comp);
   fmi2ValueReference mapInputReference2InputNumber(const fmi2ValueReference vr);
   fmi2ValueReference mapOutputReference2OutputNumber(const fmi2ValueReference vr);
   >>
@@ -315,14 +320,19 @@ case SIMCODE(__) then
   <<
   <%eventUpdateFunction2(simCode)%>
   <%getRealFunction2(simCode, modelInfo)%>
+  <%getRealUpdateLevelFunction2(simCode, modelInfo)%>
   <%setRealFunction2(simCode, modelInfo)%>
   <%getIntegerFunction2(simCode, modelInfo)%>
+  <%getIntegerUpdateLevelFunction2(simCode, modelInfo)%>
   <%setIntegerFunction2(simCode, modelInfo)%>
   <%getBooleanFunction2(simCode, modelInfo)%>
+  <%getBooleanUpdateLevelFunction2(simCode, modelInfo)%>
   <%setBooleanFunction2(simCode, modelInfo)%>
   <%getStringFunction2(simCode, modelInfo)%>
+  <%getStringUpdateLevelFunction2(simCode, modelInfo)%>
   <%setStringFunction2(simCode, modelInfo)%>
   <%setExternalFunction2(modelInfo)%>
+  <%evaluateOutputEquationsFunction2(simCode)%>
   <%mapInputAndOutputs(simCode)%>
   >>
   else
@@ -776,6 +786,96 @@ case MODELINFO(vars=SIMVARS(__),varInfo=VARINFO(numAlgAliasVars=numAlgAliasVars,
   >>
 end getRealFunction2;
 
+template getRealUpdateLevelFunction2(SimCode simCode, ModelInfo modelInfo)
+ "Generates getRealUpdateLevel function for c file. It tells fmi2GetReal which
+  equation blocks a value reference depends on."
+::=
+match modelInfo
+case MODELINFO(vars=SIMVARS(__),varInfo=VARINFO(numAlgAliasVars=numAlgAliasVars, numParams=numParams, numStateVars=numStateVars, numAlgVars= numAlgVars, numDiscreteReal=numDiscreteReal)) then
+  let ixFirstAlg = intMul(2,numStateVars)
+  let ixFirstParam = intAdd(intMul(2,numStateVars),intAdd(numAlgVars,numDiscreteReal))
+  let ixFirstAlias = intAdd(numParams, intAdd(intMul(2,numStateVars),intAdd(numAlgVars,numDiscreteReal)))
+  let ixEnd = intAdd(numAlgAliasVars,intAdd(numParams, intAdd(intMul(2,numStateVars),intAdd(numAlgVars,numDiscreteReal))))
+  <<
+  UpdateLevel getRealUpdateLevel(const fmi2ValueReference vr) {
+    if (vr < <%numStateVars%>) {
+      return updateLevelNone;
+    }
+    if (vr < <%ixFirstAlg%>) {
+      return updateLevelODE;
+    }
+    if (vr < <%ixFirstParam%>) {
+      switch (vr) {
+        <%updateLevelCases(simCode, "Real")%>
+        default:
+          return updateLevelAll;
+      }
+    }
+    if (vr < <%ixFirstAlias%>) {
+      return updateLevelNone;
+    }
+    <%if numAlgAliasVars then
+    <<
+    if (vr < <%ixEnd%>) {
+      int ix = realAliasIndexes[vr-<%ixFirstAlias%>];
+      return getRealUpdateLevel(ix>=0 ? ix : -(ix+1));
+    }
+    >>
+    %>
+    return updateLevelAll;
+  }
+
+  >>
+end getRealUpdateLevelFunction2;
+
+template updateLevelCases(SimCode simCode, String typeName)
+ "Generates the switch cases of the variables that are assigned in functionODE
+  or by evaluateOutputEquations."
+::=
+  let odeCases = (getOdeValueReferences(simCode, typeName) |> vr => 'case <%vr%>:' ; separator="\n")
+  let outputCases = (getOutputValueReferences(simCode, typeName) |> vr => 'case <%vr%>:' ; separator="\n")
+  <<
+  <%if odeCases then
+  <<
+  /* assigned in functionODE */
+  <%odeCases%>
+    return updateLevelODE;
+  >>
+  %>
+  <%if outputCases then
+  <<
+  /* assigned in evaluateOutputEquations */
+  <%outputCases%>
+    return updateLevelOutputs;
+  >>
+  %>
+  >>
+end updateLevelCases;
+
+template evaluateOutputEquationsFunction2(SimCode simCode)
+ "Generates evaluateOutputEquations function for c file. It evaluates the
+  algebraic equations the outputs depend on, in the order of functionAlgebraics."
+::=
+  let eqs = getFmiOutputEquations(simCode)
+  let forwardEqs = (eqs |> eq => equationForward_(eq, contextSimulationNonDiscrete, modelNamePrefix(simCode)) ; separator="\n")
+  let callEqs = (eqs |> eq => equationNames_(eq, contextSimulationNonDiscrete, modelNamePrefix(simCode)) ; separator="\n")
+  <<
+  <%forwardEqs%>
+
+  void evaluateOutputEquations(ModelInstance* comp) {
+    <%if callEqs then
+    <<
+    DATA* data = comp->fmuData;
+    threadData_t* threadData = comp->threadData;
+
+    <%callEqs%>
+    >>
+    %>
+  }
+
+  >>
+end evaluateOutputEquationsFunction2;
+
 template setRealFunction2(SimCode simCode, ModelInfo modelInfo)
  "Generates setReal function for c file."
 ::=
@@ -854,6 +954,40 @@ case MODELINFO(vars=SIMVARS(__),varInfo=VARINFO(numIntAliasVars=numAliasVars, nu
   >>
 end getIntegerFunction2;
 
+template getIntegerUpdateLevelFunction2(SimCode simCode, ModelInfo modelInfo)
+ "Generates getIntegerUpdateLevel function for c file."
+::=
+match modelInfo
+case MODELINFO(varInfo=VARINFO(numIntAliasVars=numAliasVars, numIntParams=numParams, numIntAlgVars=numAlgVars)) then
+  let ixFirstParam = numAlgVars
+  let ixFirstAlias = intAdd(numParams, numAlgVars)
+  let ixEnd = intAdd(numAliasVars,intAdd(numParams, numAlgVars))
+  <<
+  UpdateLevel getIntegerUpdateLevel(const fmi2ValueReference vr) {
+    if (vr < <%ixFirstParam%>) {
+      switch (vr) {
+        <%updateLevelCases(simCode, "Integer")%>
+        default:
+          return updateLevelAll;
+      }
+    }
+    if (vr < <%ixFirstAlias%>) {
+      return updateLevelNone;
+    }
+    <% if numAliasVars then
+    <<
+    if (vr < <%ixEnd%>) {
+      int ix = intAliasIndexes[vr-<%ixFirstAlias%>];
+      return getIntegerUpdateLevel(ix>=0 ? ix : -(ix+1));
+    }
+    >>
+    %>
+    return updateLevelAll;
+  }
+
+  >>
+end getIntegerUpdateLevelFunction2;
+
 template setIntegerFunction2(SimCode simCode, ModelInfo modelInfo)
  "Generates getInteger function for c file."
 ::=
@@ -904,6 +1038,28 @@ case MODELINFO(vars=SIMVARS(__)) then
   >>
 end getBooleanFunction2;
 
+template getBooleanUpdateLevelFunction2(SimCode simCode, ModelInfo modelInfo)
+ "Generates getBooleanUpdateLevel function for c file."
+::=
+match modelInfo
+case MODELINFO(vars=SIMVARS(__)) then
+  <<
+  UpdateLevel getBooleanUpdateLevel(const fmi2ValueReference vr) {
+    switch (vr) {
+      <%updateLevelCases(simCode, "Boolean")%>
+      <%vars.boolParamVars |> var as SIMVAR(__) => 'case <%lookupVR(name, simCode)%>:' ;separator="\n"%>
+        return updateLevelNone;
+      <%vars.boolAliasVars |> var as SIMVAR(__) => (match aliasvar
+        case ALIAS(__)
+        case NEGATEDALIAS(__) then 'case <%lookupVR(name, simCode)%>: return getBooleanUpdateLevel(<%lookupVR(varName, simCode)%>);') ;separator="\n"%>
+      default:
+        return updateLevelAll;
+    }
+  }
+
+  >>
+end getBooleanUpdateLevelFunction2;
+
 template setBooleanFunction2(SimCode simCode, ModelInfo modelInfo)
  "Generates getBoolean function for c file."
 ::=
@@ -943,6 +1099,24 @@ case MODELINFO(vars=SIMVARS(__)) then
   >>
 end getStringFunction2;
 
+template getStringUpdateLevelFunction2(SimCode simCode, ModelInfo modelInfo)
+ "Generates getStringUpdateLevel function for c file."
+::=
+match modelInfo
+case MODELINFO(vars=SIMVARS(__)) then
+  <<
+  UpdateLevel getStringUpdateLevel(const fmi2ValueReference vr) {
+    switch (vr) {
+      <%vars.stringParamVars |> var as SIMVAR(__) => 'case <%lookupVR(name, simCode)%>:' ;separator="\n"%>
+        return updateLevelNone;
+      default:
+        return updateLevelAll;
+    }
+  }
+
+  >>
+end getStringUpdateLevelFunction2;
+
 template setStringFunction2(SimCode simCode, ModelInfo modelInfo)
  "Generates setString function for c file."
 ::=
@@ -61,7 +61,9 @@ case SIMCODE(__) then
   let pdd = if providesDirectionalDerivative(simCode) then ' providesDirectionalDerivative="true"' else ''
   <<
   <ModelExchange
-    modelIdentifier="<%modelIdentifier%>"<%pdd%>>
+    modelIdentifier="<%modelIdentifier%>"
+    canGetAndSetFMUstate="true"
+    canSerializeFMUstate="true"<%pdd%>>
     <%SourceFiles(sourceFiles)%>
   </ModelExchange>
   >>
@@ -35,12 +35,14 @@
 #include <stdio.h>
 #include <gc.h>
 #include <errno.h>
+#include <string.h>
 #include "ModelicaUtilities.h"
 
 typedef struct {
   FILE* file /* the file */;
   mmc_sint_t cnt /* reference count */;
   const char* name /* the file name */;
+  char* tmpName /* the temporary file written in mode WriteIfChanged */;
 } __OMC_FILE;
 
 enum escape_t {
@@ -64,6 +66,7 @@ static inline void* om_file_new(void *fromID)
     res->file = NULL;
     res->cnt = 0;
     res->name = "[no open file]";
+    res->tmpName = NULL;
 #if defined(__OMC_FILE_DEBUG)
     fprintf(stderr,"File.constructor: new %s\n", res->name); fflush(NULL);
 #endif
@@ -77,6 +80,30 @@ static inline void* om_file_new(void *fromID)
   }
 }
 
+extern int SystemImpl__fileContentsEqual(const char *file1, const char *file2);
+
+/* Closes the file. In mode WriteIfChanged the temporary file only replaces
+ * the target if the contents differ, so the modification time of unchanged
+ * generated files is kept and make does not rebuild them. */
+static inline void om_file_close(__OMC_FILE *file)
+{
+  if (file->file) {
+    fclose(file->file);
+    file->file = 0;
+  }
+  if (file->tmpName) {
+    if (SystemImpl__fileContentsEqual(file->tmpName, file->name)) {
+      remove(file->tmpName);
+    } else {
+      remove(file->name);
+      if (rename(file->tmpName, file->name)) {
+        ModelicaFormatError("File.close: Failed to rename %s to %s: %s\n", file->tmpName, file->name, strerror(errno));
+      }
+    }
+    file->tmpName = NULL;
+  }
+}
+
 static inline void om_file_free(__OMC_FILE *file)
 {
   if (file->cnt /* reference count */) {
@@ -86,8 +113,7 @@ static inline void om_file_free(__OMC_FILE *file)
 #if defined(__OMC_FILE_DEBUG)
   fprintf(stderr,"File.destructor: close:%s,%p,%p\n",file->name, file->file, file); fflush(NULL);
 #endif
-  fclose(file->file);
-  file->file = 0;
+  om_file_close(file);
   file->name = "[closed]";
   GC_free(file);
 }
@@ -98,7 +124,15 @@ static inline void om_file_open(__OMC_FILE *file, const char *filename, int mode
 #if defined(__OMC_FILE_DEBUG)
     fprintf(stderr,"File.open: close :%s,%p,%p\n",file->name, file->file, file); fflush(NULL);
 #endif
-    fclose(file->file);
+    om_file_close(file);
+  }
+  file->name = filename;
+  if (mode == 3) {
+    /* WriteIfChanged: write to filename.tmp and compare on close */
+    file->tmpName = (char*) GC_malloc_atomic(strlen(filename) + 5);
+    strcpy(file->tmpName, filename);
+    strcat(file->tmpName, ".tmp");
+    filename = file->tmpName;
   }
 #if defined(__APPLE_CC__)||defined(__MINGW32__)||defined(__MINGW64__)
   if (mode == 1) {
@@ -110,7 +144,6 @@ static inline void om_file_open(__OMC_FILE *file, const char *filename, int mode
 #else
   file->file = fopen(filename, mode == 1 ? "rb" : "wb");
 #endif
-  file->name = filename;
 #if defined(__OMC_FILE_DEBUG)
   fprintf(stderr,"File.open: f:%s,%p,%p\n",file->name,file->file,file); fflush(NULL);
 #endif
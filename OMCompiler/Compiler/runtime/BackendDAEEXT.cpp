@@ -46,6 +46,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 
@@ -60,6 +61,161 @@ static std::vector<int> f;
 
 using namespace std;
 
+/* Compressed sparse row storage of an adjacency matrix with 0-based column indices.
+ * Single rows can be replaced without rebuilding the whole matrix, the replaced rows are
+ * kept in the overflow map until the next compact(). */
+struct AdjacencyCSR
+{
+  std::vector<int> ptr;
+  std::vector<int> ids;
+  std::map<int, std::vector<int> > patched;
+
+  int rows() const
+  {
+    return ptr.empty() ? 0 : (int)ptr.size()-1;
+  }
+
+  void clear(int nrows, int nz)
+  {
+    ptr.clear();
+    ptr.reserve(nrows+1);
+    ptr.push_back(0);
+    ids.clear();
+    ids.reserve(nz);
+    patched.clear();
+  }
+
+  /* closes the row of the ids pushed since the last call */
+  void endRow()
+  {
+    ptr.push_back((int)ids.size());
+  }
+
+  /* replaces or appends row i */
+  void setRow(int i, const std::vector<int> &row)
+  {
+    while (rows() <= i) {
+      endRow();
+    }
+    patched[i] = row;
+  }
+
+  /* moves the replaced rows back into the compressed storage */
+  void compact()
+  {
+    std::vector<int> newPtr, newIds;
+    int i, nrows = rows();
+
+    if (patched.empty()) {
+      return;
+    }
+    newPtr.reserve(nrows+1);
+    newIds.reserve(ids.size());
+    newPtr.push_back(0);
+    for (i = 0; i < nrows; i++) {
+      std::map<int, std::vector<int> >::const_iterator it = patched.find(i);
+      if (it != patched.end()) {
+        newIds.insert(newIds.end(), it->second.begin(), it->second.end());
+      } else {
+        newIds.insert(newIds.end(), ids.begin()+ptr[i], ids.begin()+ptr[i+1]);
+      }
+      newPtr.push_back((int)newIds.size());
+    }
+    ptr.swap(newPtr);
+    ids.swap(newIds);
+    patched.clear();
+  }
+};
+
+/* Iterative version of Tarjan's algorithm on the equation graph given by a compressed adjacency
+ * matrix and a matching; it does not need the system stack for deep graphs.
+ * transposed = false: rows are equations, ass is eqn := ass[var] and the successors of eqn are
+ *                     ass[var] for all var in row eqn (Sorting.Tarjan).
+ * transposed = true:  rows are variables, ass is var := ass[eqn] and the successors of eqn are
+ *                     the equations in row ass[eqn] (Sorting.TarjanTransposed).
+ * All indices are 0-based, unassigned entries are negative. The components are returned in
+ * discovery order in comps/compPtr, each one starting with the top of the stack.
+ * Returns false if an index is out of range. */
+static bool tarjanCSR(const AdjacencyCSR &adj, const std::vector<int> &ass, bool transposed,
+                      std::vector<int> &comps, std::vector<int> &compPtr)
+{
+  const int N = (int)ass.size();
+  std::vector<int> number(N, -1), lowlink(N, -1), stack, callStack, edgePos;
+  std::vector<bool> onStack(N, false);
+  int index = 0, root, i;
+
+  comps.clear();
+  compPtr.assign(1, 0);
+  for (i = 0; i < N; i++) {
+    root = transposed ? (ass[i] >= 0 ? i : -1) : ass[i];
+    if (root < 0 || root >= N || number[root] != -1) {
+      if (root >= N) return false;
+      continue;
+    }
+    callStack.push_back(root);
+    edgePos.push_back(-1);
+    while (!callStack.empty()) {
+      int eqn = callStack.back(), row, pos, end, next = -1;
+      if (edgePos.back() < 0) {
+        /* first visit of eqn */
+        number[eqn] = lowlink[eqn] = index++;
+        stack.push_back(eqn);
+        onStack[eqn] = true;
+        edgePos.back() = 0;
+      }
+      row = transposed ? ass[eqn] : eqn;
+      if (row >= 0 && row < adj.rows()) {
+        end = adj.ptr[row+1] - adj.ptr[row];
+        for (pos = edgePos.back(); pos < end; pos++) {
+          int eqn2 = adj.ids[adj.ptr[row] + pos];
+          if (!transposed) {
+            if (eqn2 >= N) return false;
+            eqn2 = ass[eqn2];
+          }
+          if (eqn2 < 0 || eqn2 == eqn) {
+            continue;
+          }
+          if (eqn2 >= N) return false;
+          if (number[eqn2] == -1) {
+            next = eqn2;
+            pos++;
+            break;
+          } else if (onStack[eqn2]) {
+            lowlink[eqn] = std::min(lowlink[eqn], number[eqn2]);
+          }
+        }
+        edgePos.back() = pos;
+      } else if (row >= 0) {
+        return false;
+      }
+      if (next >= 0) {
+        /* recurse on the unvisited successor */
+        callStack.push_back(next);
+        edgePos.push_back(-1);
+        continue;
+      }
+      /* all successors are done: pop the component if eqn is a root node */
+      if (lowlink[eqn] == number[eqn]) {
+        int eqn2;
+        do {
+          eqn2 = stack.back();
+          stack.pop_back();
+          onStack[eqn2] = false;
+          comps.push_back(eqn2);
+        } while (eqn2 != eqn);
+        compPtr.push_back((int)comps.size());
+      }
+      callStack.pop_back();
+      edgePos.pop_back();
+      if (!callStack.empty()) {
+        int parent = callStack.back();
+        lowlink[parent] = std::min(lowlink[parent], lowlink[eqn]);
+      }
+    }
+  }
+  return true;
+}
+
 extern "C" {
 #include "matchmaker.h"
 
@@ -69,6 +225,14 @@ static int* match=NULL;
 static int* row_match=NULL;
 static int* col_ptrs=NULL;
 static int* col_ids=NULL;
+static AdjacencyCSR adjacency; /* col_ptrs and col_ids point into it */
+
+static void BackendDAEExtImpl__updateColPtrs()
+{
+  adjacency.compact();
+  col_ptrs = adjacency.ptr.empty() ? NULL : &adjacency.ptr[0];
+  col_ids = adjacency.ids.empty() ? NULL : &adjacency.ids[0];
+}
 
 void BackendDAEEXTImpl__initMarks(int nvars, int neqns)
 {
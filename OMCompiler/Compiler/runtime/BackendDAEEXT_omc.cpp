@@ -108,30 +108,88 @@ extern void BackendDAEEXT_vMark(int _inInteger)
   BackendDAEEXTImpl__vMark(_inInteger);
 }
 
+/* appends the positive entries of the list as 0-based indices */
+static void BackendDAEEXT_listToIndices(modelica_metatype lst, std::vector<int> &ids)
+{
+  mmc_sint_t i1;
+  while(MMC_GETHDR(lst) == MMC_CONSHDR) {
+    i1 = MMC_UNTAGFIXNUM(MMC_CAR(lst));
+    if (i1>0) {
+      ids.push_back((int)i1-1);
+    }
+    lst = MMC_CDR(lst);
+  }
+}
+
+/* builds the compressed form of the first nrows rows of an array<list<Integer>> */
+static void BackendDAEEXT_toCSR(modelica_metatype mat, int nrows, int nz, AdjacencyCSR &csr)
+{
+  int i;
+  csr.clear(nrows, nz);
+  for(i=0; i<nrows; ++i) {
+    BackendDAEEXT_listToIndices(MMC_STRUCTDATA(mat)[i], csr.ids);
+    csr.endRow();
+  }
+}
+
 extern void BackendDAEEXT_setAdjacencyMatrix(modelica_integer nvars, modelica_integer neqns, modelica_integer nz, modelica_metatype adjacencymatrix)
 {
-  int i=0;
+  /* the buffers of the previous matrix are reused */
+  BackendDAEEXT_toCSR(adjacencymatrix, neqns, nz, adjacency);
+  BackendDAEExtImpl__updateColPtrs();
+}
+
+extern void BackendDAEEXT_updateAdjacencyMatrixRows(modelica_integer neqns, modelica_metatype adjacencymatrix, modelica_metatype rows)
+{
+  std::vector<int> row;
   mmc_sint_t i1;
-  int j=0;
-  modelica_integer nelts = MMC_HDRSLOTS(MMC_GETHDR(adjacencymatrix));
-
-  if (col_ptrs) free(col_ptrs);
-  col_ptrs = (int*) malloc((neqns+1) * sizeof(int));
-  col_ptrs[neqns]=nz;
-  if (col_ids) free(col_ids);
-  col_ids = (int*) malloc(nz * sizeof(int));
-
-  for(i=0; i<neqns; ++i) {
-    modelica_metatype ie = MMC_STRUCTDATA(adjacencymatrix)[i];
-    col_ptrs[i] = j;
-    while(MMC_GETHDR(ie) == MMC_CONSHDR) {
-      i1 = MMC_UNTAGFIXNUM(MMC_CAR(ie));
-      if (i1>0) {
-        col_ids[j++] = (int)i1-1;
-      }
-      ie = MMC_CDR(ie);
+  int i;
+
+  /* new equations are appended, all other rows stay as they are */
+  for(i=adjacency.rows(); i<neqns; ++i) {
+    row.clear();
+    BackendDAEEXT_listToIndices(MMC_STRUCTDATA(adjacencymatrix)[i], row);
+    adjacency.setRow(i, row);
+  }
+  while(MMC_GETHDR(rows) == MMC_CONSHDR) {
+    i1 = MMC_UNTAGFIXNUM(MMC_CAR(rows));
+    if (i1>0 && i1<=neqns) {
+      row.clear();
+      BackendDAEEXT_listToIndices(MMC_STRUCTDATA(adjacencymatrix)[i1-1], row);
+      adjacency.setRow((int)i1-1, row);
+    }
+    rows = MMC_CDR(rows);
+  }
+  BackendDAEExtImpl__updateColPtrs();
+}
+
+extern modelica_metatype BackendDAEEXT_tarjan(modelica_metatype mat, modelica_metatype ass, modelica_boolean transposed)
+{
+  AdjacencyCSR csr;
+  std::vector<int> assignment, comps, compPtr;
+  modelica_metatype res = mmc_mk_nil(), comp;
+  int i, j, nass = MMC_HDRSLOTS(MMC_GETHDR(ass));
+
+  BackendDAEEXT_toCSR(mat, MMC_HDRSLOTS(MMC_GETHDR(mat)), 0, csr);
+  assignment.resize(nass);
+  for(i=0; i<nass; ++i) {
+    assignment[i] = MMC_UNTAGFIXNUM(MMC_STRUCTDATA(ass)[i])-1;
+    if (assignment[i]<0) assignment[i] = -1;
+  }
+  if (!tarjanCSR(csr, assignment, transposed, comps, compPtr)) {
+    /* fails silently like an out of bounds array access */
+    MMC_THROW();
+  }
+  /* same order as Sorting.Tarjan and Sorting.TarjanTransposed */
+  for(j=0; j<(int)compPtr.size()-1; ++j) {
+    int k = transposed ? j : (int)compPtr.size()-2-j;
+    comp = mmc_mk_nil();
+    for(i=compPtr[k+1]-1; i>=compPtr[k]; --i) {
+      comp = mmc_mk_cons(mmc_mk_icon(comps[i]+1), comp);
     }
+    res = mmc_mk_cons(comp, res);
   }
+  return res;
 }
 
 extern void BackendDAEEXT_matching(modelica_integer nv, modelica_integer ne, modelica_integer matchingID, modelica_integer cheapID, modelica_real relabel_period, modelica_integer clear_match)
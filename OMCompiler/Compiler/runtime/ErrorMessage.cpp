@@ -32,11 +32,48 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <pthread.h>
+
+#include <map>
 
 #include "ErrorMessage.hpp"
 
   /* Implementation of ErrorMessage class. */
 
+/* The template of a message id is a constant of Error.mo, so it is only kept once per id and
+ * shared by all messages with that id. A message whose template differs from the one of its id
+ * was built at runtime and keeps its own copy, so the table does not grow with such messages.
+ * The shared templates are never freed; the messages can move between threads. */
+static std::map<long, const std::string*> internedTemplates;
+static pthread_mutex_t internedTemplatesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Returns the shared template, or NULL if the message has to keep its own copy */
+static const std::string* internTemplate(long errorID, const std::string &message)
+{
+  const std::string *res = NULL;
+  std::map<long, const std::string*>::iterator it;
+  if (errorID <= 0) {
+    return NULL;
+  }
+  pthread_mutex_lock(&internedTemplatesMutex);
+  it = internedTemplates.find(errorID);
+  if (it == internedTemplates.end()) {
+    res = new std::string(message);
+    internedTemplates[errorID] = res;
+  } else if (*it->second == message) {
+    res = it->second;
+  }
+  pthread_mutex_unlock(&internedTemplatesMutex);
+  return res;
+}
+
+static unsigned long hash_string(unsigned long hash, const std::string &str)
+{
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+    hash = ((hash << 5) + hash) + (unsigned char) *it;
+  }
+  return hash;
+}
 
   ErrorMessage::ErrorMessage(long errorID,
            ErrorType type,
@@ -46,8 +83,9 @@
     : errorID_(errorID),
       messageType_(type),
       severity_(severity),
-      message_(message),
-      tokens_(tokens)
+      message_(internTemplate(errorID, message)),
+      tokens_(tokens),
+      formatted_(false)
 
 {
   startLineNo_ = 0;
@@ -55,9 +93,11 @@
   endLineNo_ = 0;
   endColumnNo_ = 0;
   isReadOnly_ = false;
-  filename_ = std::string("");
-  shortMessage = getMessage_(0);
-  fullMessage = getFullMessage_();
+  if (!message_) {
+    ownMessage_ = message;
+    message_ = &ownMessage_;
+  }
+  computeHash();
 }
 
 ErrorMessage::ErrorMessage(long errorID,
@@ -70,7 +110,8 @@ ErrorMessage::ErrorMessage(long errorID,
          long endLineNo,
          long endColumnNo,
          bool isReadOnly,
-         const std::string &filename)
+         const std::string &filename,
+         const std::string &prefix)
     :
     errorID_(errorID),
     messageType_(type),
@@ -81,70 +122,118 @@ ErrorMessage::ErrorMessage(long errorID,
     endColumnNo_(endColumnNo),
     isReadOnly_(isReadOnly),
     filename_(filename),
-    message_(message),
-    tokens_(tokens)
+    message_(internTemplate(errorID, message)),
+    prefix_(prefix),
+    tokens_(tokens),
+    formatted_(false)
 {
-  shortMessage = getMessage_(0);
-  fullMessage = getFullMessage_();
+  if (!message_) {
+    ownMessage_ = message;
+    message_ = &ownMessage_;
+  }
+  computeHash();
 }
 
-std::string ErrorMessage::getMessage_(int warningsAsErrors)
+void ErrorMessage::computeHash()
+{
+  unsigned long hash = 5381;
+  hash = hash * 33 + (unsigned long) errorID_;
+  hash = hash * 33 + (unsigned long) severity_;
+  hash = message_ == &ownMessage_ ? hash_string(hash, ownMessage_) : hash * 33 + (unsigned long) (size_t) message_;
+  hash = hash_string(hash, filename_);
+  hash = hash * 33 + (unsigned long) startLineNo_;
+  hash = hash * 33 + (unsigned long) startColumnNo_;
+  hash = hash_string(hash, prefix_);
+  for (TokenList::const_iterator tok = tokens_.begin(); tok != tokens_.end(); ++tok) {
+    hash = hash_string(hash * 33, *tok);
+  }
+  hash_ = hash;
+}
+
+bool ErrorMessage::isEqual(const ErrorMessage &other) const
+{
+  return hash_ == other.hash_ &&
+    errorID_ == other.errorID_ &&
+    messageType_ == other.messageType_ &&
+    severity_ == other.severity_ &&
+    (message_ == other.message_ || *message_ == *other.message_) &&
+    filename_ == other.filename_ &&
+    startLineNo_ == other.startLineNo_ &&
+    startColumnNo_ == other.startColumnNo_ &&
+    endLineNo_ == other.endLineNo_ &&
+    endColumnNo_ == other.endColumnNo_ &&
+    isReadOnly_ == other.isReadOnly_ &&
+    prefix_ == other.prefix_ &&
+    tokens_ == other.tokens_;
+}
+
+void ErrorMessage::format() const
 {
   std::string::size_type str_pos = 0;
-  TokenList::iterator tok = tokens_.begin();
+  TokenList::const_iterator tok = tokens_.begin();
   char index_symbol;
   int index;
 
-  while((str_pos = message_.find('%', str_pos)) != std::string::npos) {
-    index_symbol = message_[str_pos + 1];
+  if (formatted_) {
+    return;
+  }
+  formatted_ = true;
+  std::string message = *message_;
+
+  while((str_pos = message.find('%', str_pos)) != std::string::npos) {
+    index_symbol = message[str_pos + 1];
 
     if(index_symbol == 's') {
       if(tok == tokens_.end()) {
         std::cerr << "Internal error: no tokens left to replace %s with.\n";
-        std::cerr << "Given message was: " << message_ << "\n";
-        return "";
+        std::cerr << "Given message was: " << *message_ << "\n";
+        return;
       }
-      message_.replace(str_pos, 2, *tok);
+      message.replace(str_pos, 2, *tok);
       str_pos += tok->size();
-      *tok++;
+      tok++;
     } else if(index_symbol >= '0' && index_symbol <= '9') {
       index = index_symbol - '0' - 1;
 
       if(index >= tokens_.size() || index < 0) {
         std::cerr << "Internal error: Invalid positional index %" << index + 1
           << " in error message.\n";
-        std::cerr << "Given message was: " << message_ << "\n";
-        return "";
+        std::cerr << "Given message was: " << *message_ << "\n";
+        return;
       }
 
-      message_.replace(str_pos, 2, tokens_[index]);
+      message.replace(str_pos, 2, tokens_[index]);
       str_pos += tokens_[index].size();
     } else {
       ++str_pos;
     }
   }
-  veryshort_msg = message_;
+  veryshort_msg = prefix_ + message;
+  shortMessage = getMessage_(0);
+}
 
+std::string ErrorMessage::getMessage_(int warningsAsErrors) const
+{
   std::string ret_msg;
   const char* severityStr = ErrorLevel_toStr(warningsAsErrors && severity_ == ErrorLevel_warning ? ErrorLevel_error : severity_);
 
-  if(filename_ == "" && startLineNo_ == 0 && startColumnNo_ == 0 &&
+  if(filename_.empty() && startLineNo_ == 0 && startColumnNo_ == 0 &&
       endLineNo_ == 0 && endColumnNo_ == 0) {
-    ret_msg = severityStr + (": " + message_);
+    ret_msg = severityStr + (": " + veryshort_msg);
   } else {
     std::stringstream str;
     str << "[" << filename_ << ":" << startLineNo_ << ":" << startColumnNo_ <<
       "-" << endLineNo_ << ":" << endColumnNo_ << ":" <<
       (isReadOnly_ ? "readonly" : "writable") << "] " << severityStr << ": ";
     std::string positionInfo = str.str();
-    ret_msg = positionInfo + message_;
+    ret_msg = positionInfo + veryshort_msg;
   }
   // trim trailing whitespace
   ret_msg.erase(ret_msg.find_last_not_of(" \n\r\t")+1);
   return ret_msg;
 }
 
-std::string ErrorMessage::getFullMessage_()
+std::string ErrorMessage::getFullMessage_() const
 {
   std::stringstream strbuf;
 
@@ -56,7 +56,8 @@ public:
          long endLineNo,
          long endColumnNo,
          bool isReadOnly,
-         const std::string &filename);
+         const std::string &filename,
+         const std::string &prefix = "");
 
   long getID() const { return errorID_; };
 
@@ -65,13 +66,13 @@ public:
   ErrorLevel getSeverity() const { return severity_; };
 
   // Returns the expanded message with inserted tokens.
-  std::string getShortMessage() const {return veryshort_msg;};
+  std::string getShortMessage() const {format(); return veryshort_msg;};
 
   // Returns the expanded message with inserted tokens.
-  std::string getMessage(int warningsAsErrors) {if (!warningsAsErrors) {return shortMessage;} else {return getMessage_(warningsAsErrors);}};
+  std::string getMessage(int warningsAsErrors) const {format(); if (!warningsAsErrors) {return shortMessage;} else {return getMessage_(warningsAsErrors);}};
 
   // Returns the complete message in string format corresponding to a Modeica vector.
-  std::string getFullMessage() const {return fullMessage;};
+  std::string getFullMessage() const {format(); return getFullMessage_();};
 
   long getLineNo() const { return startLineNo_; };
   long getColumnNo() const { return startColumnNo_; };
@@ -83,15 +84,24 @@ public:
   bool getIsFileReadOnly() const { return isReadOnly_; };
   std::string getFileName() const { return filename_; };
   TokenList getTokens() const { return tokens_; };
+
+  // Hash of the unformatted message, equal messages have equal hashes.
+  unsigned long getHash() const { return hash_; };
+  // Compares the unformatted messages; templates of the same id are usually shared.
+  bool isEqual(const ErrorMessage &other) const;
 private:
   long errorID_;
   ErrorType messageType_;
   ErrorLevel severity_;
-  std::string message_;
+  const std::string *message_;
+  /* the template if it is not shared, see internTemplate */
+  std::string ownMessage_;
+  std::string prefix_;
   TokenList tokens_;
-  std::string shortMessage;
-  std::string veryshort_msg;
-  std::string fullMessage;
+  /* formatted lazily, most messages are never printed */
+  mutable bool formatted_;
+  mutable std::string shortMessage;
+  mutable std::string veryshort_msg;
 
   /* adrpo 2006-02-05 changed the ones below */
   long startLineNo_;
@@ -100,11 +110,15 @@ private:
   long endColumnNo_;
   bool isReadOnly_;
   std::string filename_;
-
-  std::string getShortMessage_();
-  std::string getMessage_(int warningsAsErrors);
-  std::string getFullMessage_();
-
+  unsigned long hash_;
+
+  void format() const;
+  std::string getMessage_(int warningsAsErrors) const;
+  std::string getFullMessage_() const;
+  void computeHash();
+  /* not copyable, message_ may point to ownMessage_ */
+  ErrorMessage(const ErrorMessage&);
+  ErrorMessage& operator=(const ErrorMessage&);
 };
 
 
@@ -126,6 +126,14 @@ void Error_setShowErrorMessages(threadData_t *threadData,int show)
   getMembers(threadData)->showErrorMessages = show ? 1 : 0;
 }
 
+void Error_setMessageLimit(threadData_t *threadData, int limit, int suppressedID, const char *suppressedMessage)
+{
+  errorext_members *members = getMembers(threadData);
+  members->messageLimit = limit > 0 ? limit : 0;
+  members->suppressedMessageID = suppressedID;
+  *members->suppressedMessage = suppressedMessage;
+}
+
 static void omc_assert_compiler_common(threadData_t *threadData,ErrorLevel severity, FILE_INFO info, const char *msg, va_list args)
 {
   ErrorMessage::TokenList tokens;
@@ -129,3 +129,20 @@ extern void Print_writeBufConvertLines(threadData_t *threadData,const char* file
   if (PrintImpl__writeBufConvertLines(threadData,filename))
     MMC_THROW();
 }
+
+extern void Print_beginBufStream(threadData_t *threadData,const char* filename,int convertLines)
+{
+  if (PrintImpl__beginBufStream(threadData,filename,convertLines))
+    MMC_THROW();
+}
+
+extern void Print_endBufStream(threadData_t *threadData)
+{
+  if (PrintImpl__endBufStream(threadData))
+    MMC_THROW();
+}
+
+extern void Print_abortBufStream(threadData_t *threadData)
+{
+  PrintImpl__abortBufStream(threadData);
+}
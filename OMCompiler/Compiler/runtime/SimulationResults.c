@@ -83,6 +83,7 @@ static PlotFormat SimulationResultsImpl__openFile(const char *filename, Simulati
   else if (0 == strcmp(filename+len-4, ".mat")) format = MATLAB4;
   else if (0 == strcmp(filename+len-4, ".plt")) format = PLT;
   else if (0 == strcmp(filename+len-4, ".csv")) format = CSV;
+  else if (0 == strcmp(filename+len-4, ".col")) format = MATLAB4; /* columnar files are read by the MATLAB v4 reader */
   else {
     msg[0] = filename;
     c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Unknown result-file suffix of file '%s'"), msg, 1);
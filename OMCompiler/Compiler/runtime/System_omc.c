@@ -911,7 +911,7 @@ static void* System_launchParallelTasksSerial(threadData_t *threadData, void *da
     result = mmc_mk_cons(fn(threadData, MMC_CAR(dataLst)),result);
     dataLst = MMC_CDR(dataLst);
   }
-  return listReverse(dataLst);
+  return listReverse(result);
 }
 
 extern void* System_launchParallelTasks(threadData_t *threadData, int numThreads, void *dataLst, modelica_metatype (*fn)(threadData_t *,modelica_metatype))
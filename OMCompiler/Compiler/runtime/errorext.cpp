@@ -33,9 +33,13 @@
 #include <queue>
 #include <deque>
 #include <list>
+#include <sstream>
+#include <algorithm>
 #include <string.h>
 #include <stdlib.h>
 #include <utility>
+#include <map>
+
 #include "errorext.h"
 #include "openmodelica.h"
 #include "meta_modelica.h"
@@ -63,7 +67,14 @@ typedef struct errorext_struct {
   int numErrorMessages;
   int numWarningMessages;
   deque<ErrorMessage*> *errorMessageQueue; // Global variable of all error messages.
+  multimap<unsigned long,ErrorMessage*> *messageIndex; // the messages in the queue by hash
+  map<long,int> *numMessagesOfID; // number of distinct queued messages of each id, for the message limit
+  int messageLimit; // set by --messageLimit, inherited by the threads started by this one
+  long suppressedMessageID; // Error.MESSAGES_SUPPRESSED, passed with the limit
+  string *suppressedMessage;
+  int numSuppressedMessages; // warnings and notifications dropped because of the message limit
   vector<pair<int,string> > *checkPoints; // a checkpoint has a message index no, and a unique identifier
+  vector<int> *checkPointSuppressed; // numSuppressedMessages when each checkpoint was set
   string *lastDeletedCheckpoint;
   int showErrorMessages;
 } errorext_members;
@@ -78,7 +89,11 @@ static void free_error(void *data)
   errorext_members *members = (errorext_members *) data;
   if (data == NULL) return;
   delete members->errorMessageQueue;
+  delete members->messageIndex;
+  delete members->numMessagesOfID;
+  delete members->suppressedMessage;
   delete members->checkPoints;
+  delete members->checkPointSuppressed;
   delete members->lastDeletedCheckpoint;
   free(members);
 }
@@ -102,7 +117,21 @@ static errorext_members* getMembers(threadData_t *threadData)
   res->numErrorMessages = 0;
   res->numWarningMessages = 0;
   res->errorMessageQueue = new deque<ErrorMessage*>;
+  res->messageIndex = new multimap<unsigned long,ErrorMessage*>;
+  res->numMessagesOfID = new map<long,int>;
+  res->messageLimit = 0;
+  res->suppressedMessageID = 0;
+  res->suppressedMessage = new string;
+  res->numSuppressedMessages = 0;
+  if (threadData && threadData->parent && threadData->parent->localRoots[LOCAL_ROOT_ERROR_MO]) {
+    /* the limit was set before the thread was started */
+    errorext_members *parent = (errorext_members*) threadData->parent->localRoots[LOCAL_ROOT_ERROR_MO];
+    res->messageLimit = parent->messageLimit;
+    res->suppressedMessageID = parent->suppressedMessageID;
+    *res->suppressedMessage = *parent->suppressedMessage;
+  }
   res->checkPoints = new vector<pair<int,string> >;
+  res->checkPointSuppressed = new vector<int>;
   res->lastDeletedCheckpoint = new string;
   res->showErrorMessages = 0;
   pthread_setspecific(errorExtKey,res);
@@ -115,44 +144,149 @@ static errorext_members* getMembers(threadData_t *threadData)
   return res;
 }
 
-static void push_message(threadData_t *threadData,ErrorMessage *msg)
+/* Returns a queued message identical to msg, or NULL */
+static ErrorMessage* find_equal_message(errorext_members *members, ErrorMessage *msg)
 {
-  errorext_members *members = getMembers(threadData);
-  if (members->showErrorMessages)
-  {
-    std::cerr << msg->getFullMessage() << std::endl;
+  pair<multimap<unsigned long,ErrorMessage*>::iterator,multimap<unsigned long,ErrorMessage*>::iterator> range = members->messageIndex->equal_range(msg->getHash());
+  for (multimap<unsigned long,ErrorMessage*>::iterator it = range.first; it != range.second; ++it) {
+    if (it->second != msg && it->second->isEqual(*msg)) {
+      return it->second;
+    }
   }
-  // adrpo: ALWAYS PUSH THE ERROR MESSAGE IN THE QUEUE, even if we have showErrorMessages because otherwise the numErrorMessages is completely wrong!
-  members->errorMessageQueue->push_back(msg);
-  if (msg->getSeverity() == ErrorLevel_error || msg->getSeverity() == ErrorLevel_internal) members->numErrorMessages++;
-  if (msg->getSeverity() == ErrorLevel_warning) members->numWarningMessages++;
+  return NULL;
 }
 
-/* pop the top of the message stack (and any duplicate messages that have also been added) */
-static void pop_message(threadData_t *threadData, bool rollback)
+/* Appends the message to the queue unless the message limit for its id is reached.
+ * Identical messages are queued and counted, but do not count towards the limit and
+ * are printed only once. Returns false if the message was not queued. */
+static bool enqueue_message(errorext_members *members, ErrorMessage *msg, bool limit)
 {
-  errorext_members *members = getMembers(threadData);
-  bool pop_more;
-  do {
-    ErrorMessage *msg = members->errorMessageQueue->back();
-    if (msg->getSeverity() == ErrorLevel_error || msg->getSeverity() == ErrorLevel_internal) members->numErrorMessages--;
-    if (msg->getSeverity() == ErrorLevel_warning) members->numWarningMessages--;
-    members->errorMessageQueue->pop_back();
-    pop_more = (!(members->errorMessageQueue->empty()) && !(rollback && members->errorMessageQueue->size() <= members->checkPoints->back().first) && msg->getFullMessage() == members->errorMessageQueue->back()->getFullMessage());
-    delete msg;
-  } while (pop_more);
+  if (!find_equal_message(members, msg)) {
+    int &numOfID = (*members->numMessagesOfID)[msg->getID()];
+    if (limit && members->messageLimit > 0 && numOfID >= members->messageLimit &&
+        (msg->getSeverity() == ErrorLevel_warning || msg->getSeverity() == ErrorLevel_notification)) {
+      members->numSuppressedMessages++;
+      return false;
+    }
+    numOfID++;
+  }
+  members->messageIndex->insert(make_pair(msg->getHash(), msg));
+  members->errorMessageQueue->push_back(msg);
+  if (msg->getSeverity() == ErrorLevel_error || msg->getSeverity() == ErrorLevel_internal) members->numErrorMessages++;
+  if (msg->getSeverity() == ErrorLevel_warning) members->numWarningMessages++;
+  return true;
 }
 
-static void* pop_message_and_return(threadData_t *threadData, bool rollback)
+/* Removes the last message from the queue and returns it */
+static ErrorMessage* dequeue_message(errorext_members *members)
 {
-  errorext_members *members = getMembers(threadData);
   ErrorMessage *msg = members->errorMessageQueue->back();
+  pair<multimap<unsigned long,ErrorMessage*>::iterator,multimap<unsigned long,ErrorMessage*>::iterator> range = members->messageIndex->equal_range(msg->getHash());
+  for (multimap<unsigned long,ErrorMessage*>::iterator it = range.first; it != range.second; ++it) {
+    if (it->second == msg) {
+      members->messageIndex->erase(it);
+      break;
+    }
+  }
+  /* an identical message that is still queued was queued earlier, so this one was a duplicate */
+  if (!find_equal_message(members, msg)) {
+    (*members->numMessagesOfID)[msg->getID()]--;
+  }
   if (msg->getSeverity() == ErrorLevel_error || msg->getSeverity() == ErrorLevel_internal) members->numErrorMessages--;
   if (msg->getSeverity() == ErrorLevel_warning) members->numWarningMessages--;
   members->errorMessageQueue->pop_back();
   return msg;
 }
 
+/* Marks the queued messages from index first on that are identical to an earlier one from
+ * index first on; they are kept in the queue so the message counts stay right, but are
+ * only printed once */
+static vector<bool> find_duplicates(errorext_members *members, size_t first)
+{
+  multimap<unsigned long,ErrorMessage*> seen;
+  vector<bool> duplicates(members->errorMessageQueue->size(), false);
+  for (size_t i = first; i < members->errorMessageQueue->size(); i++) {
+    ErrorMessage *msg = (*members->errorMessageQueue)[i];
+    pair<multimap<unsigned long,ErrorMessage*>::iterator,multimap<unsigned long,ErrorMessage*>::iterator> range = seen.equal_range(msg->getHash());
+    for (multimap<unsigned long,ErrorMessage*>::iterator it = range.first; it != range.second && !duplicates[i]; ++it) {
+      duplicates[i] = it->second->isEqual(*msg);
+    }
+    if (!duplicates[i]) {
+      seen.insert(make_pair(msg->getHash(), msg));
+    }
+  }
+  return duplicates;
+}
+
+static void push_message(threadData_t *threadData,ErrorMessage *msg)
+{
+  errorext_members *members = getMembers(threadData);
+  // adrpo: ALWAYS PUSH THE ERROR MESSAGE IN THE QUEUE, even if we have showErrorMessages because otherwise the numErrorMessages is completely wrong!
+  if (!enqueue_message(members, msg, true)) {
+    delete msg;
+    return;
+  }
+  if (members->showErrorMessages && !find_equal_message(members, msg))
+  {
+    std::cerr << msg->getFullMessage() << std::endl;
+  }
+}
+
+/* pop the top of the message stack */
+static void pop_message(threadData_t *threadData)
+{
+  delete dequeue_message(getMembers(threadData));
+}
+
+static void* pop_message_and_return(threadData_t *threadData)
+{
+  return dequeue_message(getMembers(threadData));
+}
+
+/* Pops the top checkpoint. On rollback the messages suppressed after the checkpoint are forgotten. */
+static void pop_checkpoint(errorext_members *members, bool rollback)
+{
+  if (rollback) {
+    members->numSuppressedMessages = std::min(members->numSuppressedMessages, members->checkPointSuppressed->back());
+  }
+  members->checkPoints->pop_back();
+  members->checkPointSuppressed->pop_back();
+}
+
+/* Adds a notification about the messages suppressed by the message limit, called when the
+ * messages are retrieved so the summary is at the end */
+static void push_suppressed_message(errorext_members *members)
+{
+  if (members->numSuppressedMessages == 0) {
+    return;
+  }
+  ErrorMessage::TokenList tokens;
+  std::stringstream num, limit;
+  num << members->numSuppressedMessages;
+  limit << members->messageLimit;
+  tokens.push_back(num.str());
+  tokens.push_back(limit.str());
+  members->numSuppressedMessages = 0;
+  ErrorMessage *msg = new ErrorMessage(members->suppressedMessageID, ErrorType_scripting, ErrorLevel_notification, *members->suppressedMessage, tokens);
+  if (!enqueue_message(members, msg, false)) {
+    delete msg;
+  }
+}
+
+/* Appends the messages from index first to the end of the queue to res, one per line */
+static void append_messages(errorext_members *members, std::string &res, size_t first, int warningsAsErrors, bool onlyErrors)
+{
+  vector<bool> duplicates = find_duplicates(members, first);
+  for (size_t i = first; i < members->errorMessageQueue->size(); i++) {
+    ErrorMessage *msg = (*members->errorMessageQueue)[i];
+    if (duplicates[i] || (onlyErrors && msg->getSeverity() != ErrorLevel_error && msg->getSeverity() != ErrorLevel_internal)) {
+      continue;
+    }
+    res += msg->getMessage(warningsAsErrors);
+    res += '\n';
+  }
+}
+
 /* Adds a message with file information */
 void add_source_message(threadData_t *threadData,
       int errorID,
@@ -202,7 +336,7 @@ static void printCheckpointStack(threadData_t *threadData)
     printf("%5d %s   message:", i, cp.second.c_str());
     while(members->errorMessageQueue->size() > cp.first && !members->errorMessageQueue->empty()){
       res = members->errorMessageQueue->back()->getMessage(0)+string(" ")+res;
-      pop_message(threadData,false);
+      pop_message(threadData);
     }
     printf("%s\n", res.c_str());
   }
@@ -212,6 +346,7 @@ extern void ErrorImpl__setCheckpoint(threadData_t *threadData,const char* id)
 {
   errorext_members *members = getMembers(threadData);
   members->checkPoints->push_back(make_pair(members->errorMessageQueue->size(),string(id)));
+  members->checkPointSuppressed->push_back(members->numSuppressedMessages);
   // fprintf(stderr, "setCheckpoint(%s)\n",id); fflush(stderr);
   //printf(" ERROREXT: setting checkpoint: (%d,%s)\n",(int)errorMessageQueue->size(),id);
 }
@@ -235,7 +370,7 @@ extern void ErrorImpl__delCheckpoint(threadData_t *threadData,const char* id)
     }
     // remember the last deleted checkpoint
     *members->lastDeletedCheckpoint = cp.second;
-    members->checkPoints->pop_back();
+    pop_checkpoint(members,false);
   }
   else{
     fprintf(stderr, " ERROREXT: nothing to delete when calling delCheckPoint(%s)\n",id);
@@ -256,7 +391,7 @@ extern void ErrorImpl__deleteNumCheckpoints(threadData_t *threadData, int n)
     cp = (*members->checkPoints)[members->checkPoints->size()-1];
     // remember the last deleted checkpoint
     *members->lastDeletedCheckpoint = cp.second;
-    members->checkPoints->pop_back();
+    pop_checkpoint(members,false);
   }
 }
 
@@ -280,7 +415,7 @@ extern void ErrorImpl__rollBack(threadData_t *threadData,const char* id)
         res = res+errorMessageQueue->back()->getMessage()+string("\n");
         printf( (string("Deleted: ") + res).c_str());
       }*/
-      pop_message(threadData,true);
+      pop_message(threadData);
     }
     /*if(!errorMessageQueue->empty()){
       res = res+errorMessageQueue->back()->getMessage()+string("\n");
@@ -295,7 +430,7 @@ extern void ErrorImpl__rollBack(threadData_t *threadData,const char* id)
       printCheckpointStack(threadData);
       abort();
     }
-    members->checkPoints->pop_back();
+    pop_checkpoint(members,true);
   } else {
     fprintf(stderr, "ERROREXT: caling rollback with id: %s on empty checkpoint stack\n",id);
     abort();
@@ -308,7 +443,7 @@ extern void* ErrorImpl__pop(threadData_t *threadData,const char* id)
   errorext_members *members = getMembers(threadData);
   if (members->checkPoints->size() > 0){
     while(members->errorMessageQueue->size() > members->checkPoints->back().first && !members->errorMessageQueue->empty()){
-      lst = mmc_mk_cons(pop_message_and_return(threadData,true), lst);
+      lst = mmc_mk_cons(pop_message_and_return(threadData), lst);
     }
     pair<int,string> cp;
     cp = (*members->checkPoints)[members->checkPoints->size()-1];
@@ -319,7 +454,7 @@ extern void* ErrorImpl__pop(threadData_t *threadData,const char* id)
       printCheckpointStack(threadData);
       abort();
     }
-    members->checkPoints->pop_back();
+    pop_checkpoint(members,true);
   } else {
     fprintf(stderr, "ERROREXT: caling rollback with id: %s on empty checkpoint stack\n",id);
     abort();
@@ -343,7 +478,7 @@ extern void ErrorImpl__freeMessages(threadData_t *threadData, void *handles)
   while (!listEmpty(handles)) {
     char *handle = (char*) MMC_CAR(handles);
     handles = MMC_CDR(handles);
-    free((ErrorMessage*) handle);
+    delete (ErrorMessage*) handle;
   }
 }
 
@@ -356,9 +491,9 @@ extern void ErrorImpl__rollbackNumCheckpoints(threadData_t *threadData, int n)
   }
   while (--n >= 0) {
     while(members->errorMessageQueue->size() > members->checkPoints->back().first && !members->errorMessageQueue->empty()){
-      pop_message(threadData,true);
+      pop_message(threadData);
     }
-    members->checkPoints->pop_back();
+    pop_checkpoint(members,true);
   }
 }
 
@@ -368,9 +503,9 @@ extern char* ErrorImpl__rollBackAndPrint(threadData_t *threadData,const char* id
   std::string res("");
   // fprintf(stderr, "rollBackAndPrint(%s)\n",id); fflush(stderr);
   if (members->checkPoints->size() > 0){
+    append_messages(members, res, members->checkPoints->back().first, 0, false);
     while(members->errorMessageQueue->size() > members->checkPoints->back().first && !members->errorMessageQueue->empty()){
-      res = members->errorMessageQueue->back()->getMessage(0)+string("\n")+res;
-      pop_message(threadData,true);
+      pop_message(threadData);
     }
     pair<int,string> cp;
     cp = (*members->checkPoints)[members->checkPoints->size()-1];
@@ -381,7 +516,7 @@ extern char* ErrorImpl__rollBackAndPrint(threadData_t *threadData,const char* id
       printCheckpointStack(threadData);
       abort();
     }
-    members->checkPoints->pop_back();
+    pop_checkpoint(members,true);
   } else {
     fprintf(stderr, "ERROREXT: caling rollback with id: %s on empty checkpoint stack\n",id);
     abort();
@@ -457,7 +592,7 @@ extern void c_add_message(threadData_t *threadData,int errorID, ErrorType type,
   filename="";
 #endif
   ErrorMessage *msg = *(const char*)MMC_STRINGDATA(str) ?
-    new ErrorMessage((long)errorID, type, severity, std::string((const char*)MMC_STRINGDATA(str)) + std::string(message), tokens, sline , scol, eline, ecol, read_only, MMC_STRINGDATA(filename)) :
+    new ErrorMessage((long)errorID, type, severity, message, tokens, sline , scol, eline, ecol, read_only, MMC_STRINGDATA(filename), (const char*)MMC_STRINGDATA(str)) :
     new ErrorMessage((long)errorID, type, severity, message, tokens);
   push_message(threadData,msg);
 }
@@ -483,7 +618,7 @@ extern void ErrorImpl__clearMessages(threadData_t *threadData)
 {
   // fprintf(stderr, "-> ErrorImpl__clearMessages error messages: %d queue size: %d\n", numErrorMessages, (int)errorMessageQueue->size()); fflush(NULL);
   while(!getMembers(threadData)->errorMessageQueue->empty()) {
-    pop_message(threadData,false);
+    pop_message(threadData);
   }
 }
 
@@ -520,15 +655,17 @@ static void* get_message_alloc(errorext_members *members)
   return Error__TOTALMESSAGE(msg, info);
 }
 
-// TODO: Use a string builder instead of creating intermediate results all the time?
 extern void* ErrorImpl__getMessages(threadData_t *threadData)
 {
   errorext_members *members = getMembers(threadData);
   void *res = mmc_mk_nil();
+  push_suppressed_message(members);
+  vector<bool> duplicates = find_duplicates(members, 0);
   while(!members->errorMessageQueue->empty()) {
-    void *msg = get_message_alloc(members);
-    res = mmc_mk_cons(msg, res);
-    pop_message(threadData, false);
+    if (!duplicates[members->errorMessageQueue->size()-1]) {
+      res = mmc_mk_cons(get_message_alloc(members), res);
+    }
+    pop_message(threadData);
   }
   return res;
 }
@@ -541,10 +678,12 @@ extern void* ErrorImpl__getCheckpointMessages(threadData_t *threadData)
   if (members->checkPoints->size() == 0) return res;
 
   int id = members->checkPoints->back().first;
+  vector<bool> duplicates = find_duplicates(members, id);
   while (members->errorMessageQueue->size() > id) {
-    void *msg = get_message_alloc(members);
-    res = mmc_mk_cons(msg, res);
-    pop_message(threadData, false);
+    if (!duplicates[members->errorMessageQueue->size()-1]) {
+      res = mmc_mk_cons(get_message_alloc(members), res);
+    }
+    pop_message(threadData);
   }
 
   return res;
@@ -552,33 +691,26 @@ extern void* ErrorImpl__getCheckpointMessages(threadData_t *threadData)
 
 } // extern "C"
 
-// TODO: Use a string builder instead of creating intermediate results all the time?
 extern std::string ErrorImpl__printErrorsNoWarning(threadData_t *threadData)
 {
   errorext_members *members = getMembers(threadData);
   std::string res("");
+  append_messages(members, res, 0, 0, true);
   while(!members->errorMessageQueue->empty()) {
-    //if(strncmp(errorMessageQueue->back()->getSeverity(),"Error")==0){
-    if(members->errorMessageQueue->back()->getSeverity() == ErrorLevel_error
-        || members->errorMessageQueue->back()->getSeverity() == ErrorLevel_internal) {
-      res = members->errorMessageQueue->back()->getMessage(0)+string("\n")+res;
-      members->numErrorMessages--;
-    }
-    delete members->errorMessageQueue->back();
-    members->errorMessageQueue->pop_back();
+    pop_message(threadData);
   }
   return res;
 }
 
-// TODO: Use a string builder instead of creating intermediate results all the time?
 extern std::string ErrorImpl__printMessagesStr(threadData_t *threadData, int warningsAsErrors)
 {
   errorext_members *members = getMembers(threadData);
   // fprintf(stderr, "-> ErrorImpl__printMessagesStr error messages: %d queue size: %d\n", numErrorMessages, (int)errorMessageQueue->size()); fflush(NULL);
   std::string res("");
+  push_suppressed_message(members);
+  append_messages(members, res, 0, warningsAsErrors, false);
   while(!members->errorMessageQueue->empty()) {
-    res = members->errorMessageQueue->back()->getMessage(warningsAsErrors)+string("\n")+res;
-    pop_message(threadData,false);
+    pop_message(threadData);
   }
   return res;
 }
@@ -615,10 +747,19 @@ void Error_moveMessagesToParentThread(threadData_t *threadData)
   pthread_mutex_lock(&threadData->parent->parentMutex);
   parent = getMembers(threadData->parent);
   while(!thread->errorMessageQueue->empty()) {
-    parent->errorMessageQueue->push_back(thread->errorMessageQueue->front());
+    ErrorMessage *msg = thread->errorMessageQueue->front();
     thread->errorMessageQueue->pop_front();
+    if (!enqueue_message(parent, msg, true)) {
+      delete msg;
+    }
   }
+  parent->numSuppressedMessages += thread->numSuppressedMessages;
   pthread_mutex_unlock(&threadData->parent->parentMutex);
+  thread->messageIndex->clear();
+  thread->numMessagesOfID->clear();
+  thread->numErrorMessages = 0;
+  thread->numWarningMessages = 0;
+  thread->numSuppressedMessages = 0;
 }
 
 }
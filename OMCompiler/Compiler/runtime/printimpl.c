@@ -44,6 +44,13 @@ extern char* _replace(const char* source_str, const char* search_str, const char
 #define GROWTH_FACTOR 1.4  /* According to some rumors of buffer growth */
 #define INITIAL_BUFSIZE 4000 /* Seems reasonable */
 #define MAXSAVEDBUFFERS 10   /* adrpo: added this so it compiles again! MathCore can change it later */
+#define STREAM_CHUNKSIZE (4*1024*1024) /* complete lines are written to the stream file once the buffer is this full */
+
+typedef struct convert_lines_state_s {
+  mmc_uint_t nlines;
+  mmc_uint_t modelicaLine;
+  char *modelicaFileName;
+} convert_lines_state;
 
 typedef struct print_members_s {
   char *buf;
@@ -55,6 +62,13 @@ typedef struct print_members_s {
   char** savedBuffers;
   long* savedCurSize;
   long* savedNfilled;
+  FILE *streamFile;
+  const char *streamFileName;
+  char *streamTmpFileName;
+  int streamConvertLines;
+  long streamFlushed;
+  int streamAtNewLine;
+  convert_lines_state streamState;
 } print_members;
 
 static void free_printimpl(void *data)
@@ -75,6 +89,10 @@ static void free_printimpl(void *data)
   if (members->errorBuf != NULL) free(members->errorBuf);
   if (members->savedCurSize != NULL) free(members->savedCurSize);
   if (members->savedNfilled != NULL) free(members->savedNfilled);
+  if (members->streamFile != NULL) fclose(members->streamFile);
+  if (members->streamFileName != NULL) free((char*)members->streamFileName);
+  if (members->streamTmpFileName != NULL) free(members->streamTmpFileName);
+  if (members->streamState.modelicaFileName != NULL) free(members->streamState.modelicaFileName);
   free(members);
 }
 
@@ -126,6 +144,8 @@ static print_members* getMembers(threadData_t *threadData)
 #define savedCurSize members->savedCurSize
 #define savedNfilled members->savedNfilled
 
+static int stream_flush(print_members *members, int final);
+
 static int increase_buffer(threadData_t *threadData)
 {
   print_members* members = getMembers(threadData);
@@ -281,6 +301,10 @@ static int PrintImpl__printBuf(threadData_t *threadData,const char* str)
   long len = strlen(str);
   /* printf("cursize: %d, nfilled %d, strlen: %d\n",cursize,nfilled,strlen(str)); */
 
+  if (members->streamFile && nfilled > STREAM_CHUNKSIZE && stream_flush(members, 0)) {
+    return 1;
+  }
+
   while (nfilled + len + 1 > cursize) {
     if(increase_buffer(threadData)!= 0) {
       return 1;
@@ -382,53 +406,164 @@ static int PrintImpl__writeBuf(threadData_t *threadData,const char* filename)
   return 0;
 }
 
-#include <regex.h>
+static char* skip_digits(char *str, const char *end)
+{
+  while (str < end && *str >= '0' && *str <= '9') {
+    str++;
+  }
+  return str;
+}
 
-/* returns 0 on success */
-static int PrintImpl__writeBufConvertLines(threadData_t *threadData,const char *filename)
+/* Matches the line [str,end) against
+ *   ^ *\/[*]#modelicaLine .([^:]*):([0-9]*):[0-9]*-[0-9]*:[0-9]*.[*]\/$
+ * which on Windows starts the file name with the drive letter: .(.:/[^:]*):
+ * Returns 1 and sets the file name and line on success.
+ */
+static int match_modelica_line(char *str, const char *end, char **fileName, long *fileNameLength, mmc_uint_t *line)
 {
-  print_members* members = getMembers(threadData);
+  static const char marker[] = "/*#modelicaLine ";
+  char *name, *number;
+
+  while (str < end && *str == ' ') {
+    str++;
+  }
+  if (end - str < (long) sizeof(marker) || strncmp(str, marker, sizeof(marker)-1)) {
+    return 0;
+  }
+  str += sizeof(marker); /* skip the marker and the opening bracket */
+  name = str;
 #if defined(__MINGW32__) || defined(_MSC_VER)
-  const char *fileOpenMode = "wt"; /* on Windows do translation so that \n becomes \r\n */
-#else
-  const char *fileOpenMode = "wb";  /* on Unixes don't bother, do it binary mode */
+  if (end - str < 3 || str[1] != ':' || str[2] != '/') {
+    return 0;
+  }
+  str += 3;
 #endif
-  char *str = buf, *next;
-  FILE * file = NULL;
-  regex_t re_begin,re_end;
-  regmatch_t matches[3];
-  mmc_uint_t nlines = 6 /* We start at 6 because we write 6 lines before the first line */, modelicaLine = 0;
-  /* What we try to match: */
-  /*#modelicaLine [/path/to/a.mo:4:3-4:12]*/
-  /*#endModelicaLine*/
-  /* which on Windows is (N is the drive letter): */
-  /*#modelicaLine [N:/path/to/a.mo:4:3-4:12]*/
-  /*#endModelicaLine*/
+  while (str < end && *str != ':') {
+    str++;
+  }
+  if (str == end) {
+    return 0;
+  }
+  *fileNameLength = str - name;
+  number = ++str;
+  str = skip_digits(str, end);
+  if (str == end || *str != ':') return 0;
+  str = skip_digits(str+1, end);
+  if (str == end || *str != '-') return 0;
+  str = skip_digits(str+1, end);
+  if (str == end || *str != ':') return 0;
+  str = skip_digits(str+1, end);
+  /* the closing bracket and the end of the comment */
+  if (end - str != 3 || str[1] != '*' || str[2] != '/') {
+    return 0;
+  }
+  *fileName = name;
+  *line = strtol(number, NULL, 10);
+  return 1;
+}
+
+/* Matches the line [str,end) against ^ *\/[*]#endModelicaLine[*]\/$ */
+static int match_end_modelica_line(const char *str, const char *end)
+{
+  static const char marker[] = "/*#endModelicaLine*/";
+  while (str < end && *str == ' ') {
+    str++;
+  }
+  return (end - str == (long) sizeof(marker)-1) && 0 == strncmp(str, marker, sizeof(marker)-1);
+}
+
+static void write_convert_lines_header(FILE *file, const char *filename)
+{
+  char* strtmp = NULL;
 #if defined(__MINGW32__) || defined(_MSC_VER)
-  const char *re_str[2] = {"^ */[*]#modelicaLine .(.:/[^:]*):([0-9]*):[0-9]*-[0-9]*:[0-9]*.[*]/$", "^ */[*]#endModelicaLine[*]/$"};
-#else /* real OSes */
-  const char *re_str[2] = {"^ */[*]#modelicaLine .([^:]*):([0-9]*):[0-9]*-[0-9]*:[0-9]*.[*]/$", "^ */[*]#endModelicaLine[*]/$"};
+  /* on Windows change the backslashes to forward slashes */
+  strtmp = _replace(filename, "\\", "/");
 #endif
-  char *modelicaFileName = NULL;
-  char* strtmp = NULL;
-
-  if (str!=NULL && nfilled!=0) {
-    str[nfilled] = '\0';
+  fprintf(file,"#ifdef OMC_BASE_FILE\n"
+               "  #define OMC_FILE OMC_BASE_FILE\n"
+               "#else\n"
+               "  #define OMC_FILE \"%s\"\n"
+               "#endif\n",
+               strtmp ? strtmp : filename);
+#if defined(__MINGW32__) || defined(_MSC_VER)
+  GC_free(strtmp);
+#endif
+}
 
-    /* First, compile the regular expressions */
-    if (regcomp(&re_begin, re_str[0], REG_EXTENDED) || regcomp(&re_end, re_str[1], 0)) {
-      c_add_message(NULL,21, /* WRITING_FILE_ERROR */
-        ErrorType_scripting,
-        ErrorLevel_error,
-        gettext("Error compiling regular expression: %s or %s."),
-        re_str,
-        2);
-      return 1;
+/* Writes the complete lines in [str,str+len) to the file, replacing /\*#modelicaLine ...*\/ and
+ * /\*#endModelicaLine*\/ markers by #line directives. The scanner state is kept in state so the
+ * buffer can be converted in chunks that end on a line boundary. */
+static void write_convert_lines(FILE *file, char *str, long len, convert_lines_state *state)
+{
+  char *end = str + len, *run = str, *next, *fileName;
+  long fileNameLength;
+  mmc_uint_t line;
+
+  while (str < end) {
+    next = memchr(str, '\n', end - str);
+    if (next == NULL) {
+      next = end;
+    }
+    /* only lines starting with a comment can be markers */
+    if (state->modelicaFileName == NULL) {
+      const char *c = str;
+      while (c < next && *c == ' ') c++;
+      if (next - c < 3 || c[0] != '/' || c[1] != '*' || c[2] != '#') {
+        state->nlines++;
+        str = next + 1;
+        continue;
+      }
     }
+    /* write the pending lines that need no conversion */
+    if (run < str) {
+      fwrite(run, str - run, 1, file);
+    }
+    if (match_modelica_line(str, next, &fileName, &fileNameLength, &line)) {
+      if (state->modelicaFileName) {
+        free(state->modelicaFileName);
+      }
+      state->modelicaFileName = (char*) malloc(fileNameLength + 1);
+      memcpy(state->modelicaFileName, fileName, fileNameLength);
+      state->modelicaFileName[fileNameLength] = '\0';
+#if defined(__MINGW32__) || defined(_MSC_VER)
+      /* on Windows change the backslashes to forward slashes */
+      for (fileName = state->modelicaFileName; *fileName; fileName++) {
+        if (*fileName == '\\') *fileName = '/';
+      }
+#endif
+      state->modelicaLine = line;
+    } else if (match_end_modelica_line(str, next)) {
+      if (state->modelicaFileName) { /* There is sometimes #endModlicaLine without a matching #modelicaLine */
+        free(state->modelicaFileName);
+        state->modelicaFileName = NULL;
+        fprintf(file,"#line %ld OMC_FILE\n", (long) state->nlines++);
+      }
+    } else if (state->modelicaFileName) {
+      fprintf(file,"#line %ld \"%s\"\n", (long) state->modelicaLine, state->modelicaFileName);
+      fwrite(str, next - str, 1, file);
+      fputc('\n', file);
+      state->nlines+=2;
+    } else {
+      fwrite(str, next - str, 1, file);
+      fputc('\n', file);
+      state->nlines++;
+    }
+    str = next + 1;
+    run = str;
   }
+  if (run < end) {
+    fwrite(run, end - run, 1, file);
+  }
+}
 
-  /* check if we have something to write */
-  /* open the file */
+static FILE* open_buf_file(const char *filename)
+{
+#if defined(__MINGW32__) || defined(_MSC_VER)
+  const char *fileOpenMode = "wt"; /* on Windows do translation so that \n becomes \r\n */
+#else
+  const char *fileOpenMode = "wb";  /* on Unixes don't bother, do it binary mode */
+#endif
+  FILE *file;
   /* adrpo: 2010-09-22 open the file in BINARY mode as otherwise \r\n becomes \r\r\n! */
 #if defined(__APPLE_CC__)||defined(__MINGW32__)||defined(__MINGW64__)
   unlink(filename);
@@ -442,88 +577,215 @@ static int PrintImpl__writeBufConvertLines(threadData_t *threadData,const char *
       gettext("Error writing to file %s."),
       c_tokens,
       1);
-    regfree(&re_begin);
-    regfree(&re_end);
+  }
+  return file;
+}
+
+/* returns 0 on success */
+static int PrintImpl__writeBufConvertLines(threadData_t *threadData,const char *filename)
+{
+  print_members* members = getMembers(threadData);
+  convert_lines_state state = {6 /* We start at 6 because we write 6 lines before the first line */, 0, NULL};
+  char *next;
+  FILE * file = open_buf_file(filename);
+
+  if (file == NULL) {
     return 1;
   }
-  if (str == NULL || str[0]=='\0') {
+  if (buf == NULL || nfilled == 0) {
     /* nothing to write to file, just close it and return ! */
     fclose(file);
     return 1;
   }
-#if defined(__MINGW32__) || defined(_MSC_VER)
-  /* on Windows change the backslashes to forward slashes */
-  strtmp = _replace(filename, "\\", "/");
-#endif
-  fprintf(file,"#ifdef OMC_BASE_FILE\n"
-               "  #define OMC_FILE OMC_BASE_FILE\n"
-               "#else\n"
-               "  #define OMC_FILE \"%s\"\n"
-               "#endif\n",
-#if defined(__MINGW32__) || defined(_MSC_VER)
-               strtmp);
-  GC_free(strtmp);
-#else
-               filename);
-#endif
-  do {
-    next = strchr(str,'\n');
-    if (!next) {
-      fprintf(file,"%s",str);
-      break;
+  buf[nfilled] = '\0';
+  write_convert_lines_header(file, filename);
+  /* the last line is written as it is, even if it looks like a marker */
+  next = strrchr(buf, '\n');
+  next = next ? next + 1 : buf;
+  write_convert_lines(file, buf, next - buf, &state);
+  fputs(next, file);
+  if (state.modelicaFileName) {
+    free(state.modelicaFileName);
+  }
+  *buf = 0;
+  nfilled = 0;
+  fclose(file);
+  return 0;
+}
+
+/* Writes the complete lines of the buffer to the stream file and keeps the last, unfinished line.
+ * If final is set, everything is written. Returns 0 on success. */
+static int stream_flush(print_members *members, int final)
+{
+  char *end = buf + nfilled;
+  long len;
+
+  if (nfilled == 0) {
+    return 0;
+  }
+  if (final) {
+    len = nfilled;
+  } else {
+    while (end > buf && end[-1] != '\n') {
+      end--;
     }
-    *next++ = '\0';
-    if (0==regexec(&re_begin, str, 3, matches, 0)) {
-      str[matches[1].rm_eo] = '\0';
-      str[matches[2].rm_eo] = '\0';
-      modelicaFileName = str + matches[1].rm_so;
-      modelicaLine = strtol(str + matches[2].rm_so, NULL, 10);
-#if defined(__MINGW32__) || defined(_MSC_VER)
-      /* on Windows change the backslashes to forward slashes */
-      modelicaFileName = _replace(modelicaFileName, "\\", "/");
-#endif
-    } else if (0==regexec(&re_end, str, 3, matches, 0)) {
-      if (modelicaFileName) { /* There is sometimes #endModlicaLine without a matching #modelicaLine */
-#if defined(__MINGW32__) || defined(_MSC_VER)
-        GC_free(modelicaFileName);
-#endif
-        modelicaFileName = NULL;
-        fprintf(file,"#line %ld OMC_FILE\n", nlines++);
+    len = end - buf;
+    /* a single huge line; converted output needs complete lines, so just let the buffer grow */
+    if (len == 0 && members->streamConvertLines) {
+      return 0;
+    }
+    if (len == 0) {
+      len = nfilled;
+    }
+  }
+  if (members->streamConvertLines) {
+    char *last = buf + len;
+    if (final) {
+      /* the last line is written as it is, like in writeBufConvertLines */
+      while (last > buf && last[-1] != '\n') {
+        last--;
       }
-    } else if (modelicaFileName) {
-      fprintf(file,"#line %ld \"%s\"\n", modelicaLine, modelicaFileName);
-      fprintf(file,"%s\n", str);
-      nlines+=2;
-    } else {
-      fprintf(file,"%s\n", str);
-      nlines++;
     }
-    str = next;
-  } while (1);
-#if defined(__MINGW32__) || defined(_MSC_VER)
-  if (modelicaFileName) {
-    GC_free(modelicaFileName);
+    write_convert_lines(members->streamFile, buf, last - buf, &members->streamState);
+    if (last < buf + len) {
+      fwrite(last, buf + len - last, 1, members->streamFile);
+    }
+  } else {
+    fwrite(buf, len, 1, members->streamFile);
+  }
+  members->streamAtNewLine = buf[len-1] == '\n';
+  memmove(buf, buf + len, nfilled - len);
+  nfilled -= len;
+  buf[nfilled] = '\0';
+  members->streamFlushed += len;
+  return ferror(members->streamFile) ? 1 : 0;
+}
+
+/* Frees the stream state after the stream file was closed and empties the print buffer */
+static void stream_reset(print_members *members)
+{
+  free((char*)members->streamFileName);
+  free(members->streamTmpFileName);
+  if (members->streamState.modelicaFileName) {
+    free(members->streamState.modelicaFileName);
+    members->streamState.modelicaFileName = NULL;
+  }
+  members->streamFile = NULL;
+  members->streamFileName = NULL;
+  members->streamTmpFileName = NULL;
+  members->streamFlushed = 0;
+  if (buf) {
+    *buf = 0;
   }
-#endif
-  /* We do destructive updates on the print buffer; hide our tracks */
-  *buf = 0;
   nfilled = 0;
-  regfree(&re_begin);
-  regfree(&re_end);
-  fclose(file);
+}
+
+/* Starts writing the print buffer to filename while it is filled, see endBufStream.
+ * Returns 0 on success. */
+static int PrintImpl__beginBufStream(threadData_t *threadData, const char *filename, int convertLines)
+{
+  print_members* members = getMembers(threadData);
+  FILE *file;
+
+  if (members->streamFile) {
+    fprintf(stderr, "Print.beginBufStream: already streaming to file %s!\n", members->streamFileName);
+    return 1;
+  }
+  /* the file is streamed to filename.tmp which only replaces filename if the contents differ,
+   * so the modification time of unchanged generated files is kept and make does not rebuild them */
+  members->streamTmpFileName = (char*) malloc(strlen(filename) + 5);
+  strcpy(members->streamTmpFileName, filename);
+  strcat(members->streamTmpFileName, ".tmp");
+  file = open_buf_file(members->streamTmpFileName);
+  if (file == NULL) {
+    free(members->streamTmpFileName);
+    members->streamTmpFileName = NULL;
+    return 1;
+  }
+  if (convertLines) {
+    write_convert_lines_header(file, filename);
+  }
+  members->streamFile = file;
+  members->streamFileName = strdup(filename);
+  members->streamConvertLines = convertLines;
+  members->streamFlushed = 0;
+  members->streamAtNewLine = 0;
+  members->streamState.nlines = 6; /* We start at 6 because we write 6 lines before the first line */
+  members->streamState.modelicaLine = 0;
+  members->streamState.modelicaFileName = NULL;
   return 0;
 }
 
+/* Writes the rest of the print buffer to the stream file and closes it. Returns 0 on success. */
+static int PrintImpl__endBufStream(threadData_t *threadData)
+{
+  print_members* members = getMembers(threadData);
+  int res;
+
+  if (members->streamFile == NULL) {
+    return 0;
+  }
+  res = stream_flush(members, 1);
+  if (fflush(members->streamFile) != 0) {
+    res = 1;
+  }
+  if (res) {
+    const char *c_tokens[1]={members->streamFileName};
+    c_add_message(NULL,21, /* WRITING_FILE_ERROR */
+      ErrorType_scripting,
+      ErrorLevel_error,
+      gettext("Error writing to file %s."),
+      c_tokens,
+      1);
+  }
+  fclose(members->streamFile);
+  if (res || SystemImpl__fileContentsEqual(members->streamTmpFileName, members->streamFileName)) {
+    remove(members->streamTmpFileName);
+  } else {
+    remove(members->streamFileName);
+    if (rename(members->streamTmpFileName, members->streamFileName)) {
+      const char *c_tokens[1]={members->streamFileName};
+      c_add_message(NULL,21, /* WRITING_FILE_ERROR */
+        ErrorType_scripting,
+        ErrorLevel_error,
+        gettext("Error writing to file %s."),
+        c_tokens,
+        1);
+      res = 1;
+    }
+  }
+  stream_reset(members);
+  return res;
+}
+
+/* Closes the stream file without publishing it: the temporary file is removed and filename keeps
+ * its previous contents. Used when generating the text failed. */
+static void PrintImpl__abortBufStream(threadData_t *threadData)
+{
+  print_members* members = getMembers(threadData);
+
+  if (members->streamFile == NULL) {
+    return;
+  }
+  fclose(members->streamFile);
+  remove(members->streamTmpFileName);
+  stream_reset(members);
+}
+
 static long PrintImpl__getBufLength(threadData_t *threadData)
 {
   print_members* members = getMembers(threadData);
-  return nfilled;
+  /* include what was already written to the stream file, the length is used for differences */
+  return members->streamFlushed + nfilled;
 }
 
 /* returns 0 on success */
 static int PrintImpl__printBufSpace(threadData_t *threadData,long nSpaces)
 {
   print_members* members = getMembers(threadData);
+  if (members->streamFile && nfilled > STREAM_CHUNKSIZE && stream_flush(members, 0)) {
+    return 1;
+  }
   if (nSpaces > 0) {
    while (nfilled + nSpaces + 1 > cursize) {
      if(increase_buffer(threadData)!= 0) {
@@ -541,6 +803,9 @@ static int PrintImpl__printBufSpace(threadData_t *threadData,long nSpaces)
 static int PrintImpl__printBufNewLine(threadData_t *threadData)
 {
   print_members* members = getMembers(threadData);
+  if (members->streamFile && nfilled > STREAM_CHUNKSIZE && stream_flush(members, 0)) {
+    return 1;
+  }
   while (nfilled + 1+1 > cursize) {
     if(increase_buffer(threadData)!= 0) {
       return 1;
@@ -555,6 +820,9 @@ static int PrintImpl__printBufNewLine(threadData_t *threadData)
 static int PrintImpl__hasBufNewLineAtEnd(threadData_t *threadData)
 {
   print_members* members = getMembers(threadData);
+  if (nfilled == 0 && members->streamFlushed > 0) {
+    return members->streamAtNewLine;
+  }
   return (nfilled > 0 && buf[nfilled-1] == '\n') ? 1 : 0;
 }
 
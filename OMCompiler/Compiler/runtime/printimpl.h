@@ -44,3 +44,6 @@ extern void Print_printBufSpace(threadData_t *threadData,int numSpace);
 extern void Print_printBufNewLine(threadData_t *threadData);
 extern void Print_writeBuf(threadData_t *threadData,const char* filename);
 extern void Print_writeBufConvertLines(threadData_t *threadData,const char* filename);
+extern void Print_beginBufStream(threadData_t *threadData,const char* filename,int convertLines);
+extern void Print_endBufStream(threadData_t *threadData);
+extern void Print_abortBufStream(threadData_t *threadData);
@@ -39,6 +39,7 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <map>
 #include <algorithm>
 #include <iomanip>
 #include <stdlib.h>
@@ -50,13 +51,13 @@
 
 extern "C"
 {
-int dgesv_(int *n, int *nrhs, double *a, int *lda, int *ipiv, double *b, int *ldb, int *info);
-int dgemm_(char *transa, char *transb, int *m, int *n, int *k, double *alpha, double *a, int *lda,
-		double *b, int *ldb, double *beta, double *c, int *ldc);
-int dgetrf_(int *m, int *n, double *a, int *lda, int *ipiv, int *info);
-int dgetri_(int *n, double *a, int *lda, int *ipiv, double *work, int *lwork, int *info);
+int dgemv_(char *trans, int *m, int *n, double *alpha, double *a, int *lda, double *x, int *incx,
+		double *beta, double *y, int *incy);
+int dpotrf_(char *uplo, int *n, double *a, int *lda, int *info);
+int dpotrs_(char *uplo, int *n, int *nrhs, double *a, int *lda, double *b, int *ldb, int *info);
+int dtrsm_(char *side, char *uplo, char *transa, char *diag, int *m, int *n, double *alpha, double *a, int *lda,
+		double *b, int *ldb);
 int dscal_(int *n, double *da, double *dx, int *incx);
-int dcopy_(int *n, double *dx, int *incx, double *dy, int *incy);
 }
 
 
@@ -90,6 +91,32 @@ struct inputData {
 	vector<int> index;
 };
 
+/*
+ * sparse matrix in compressed column format
+ */
+struct sparseMatrixData {
+	int rows;
+	int column;
+	vector<int> colptr;
+	vector<int> rowind;
+	vector<double> data;
+};
+
+/*
+ * buffers of the reconciliation, allocated once and
+ * reused by all iterations and measurement sets
+ */
+struct reconcileWorkspace {
+	int r;                 // number of setc equations
+	int n;                 // number of variables to be reconciled
+	vector<double> B;      // F*Sx (r x n)
+	vector<double> A;      // F*Sx*Ft (r x r), cholesky factor after the step
+	vector<double> c;      // c(x,y)
+	vector<double> fstar;  // f*
+	vector<double> d;      // recon_x - x
+	vector<double> Fd;     // F*(recon_x - x)
+};
+
 /*
  * Function which reads the csv file
  * and stores the covariance matrix Sx for DataReconciliation
@@ -272,21 +299,6 @@ csvData readcsvInputs(const char * filename, ofstream & logfile)
 	return data;
 }
 
-/*
- * Function which arranges the elements in column major
- */
-void initColumnMatrix(vector<double> data, int rows, int cols, double * tempSx)
-{
-	for (int i=0; i<rows; i++)
-	{
-		for (int j=0; j<cols;j++)
-		{
-			// store the matrix in column order
-			tempSx[j+i*rows]=data[i+j*rows];
-		}
-	}
-}
-
 /*
  * Function to print and debug whether the matrices are stored in column major
  */
@@ -364,290 +376,137 @@ void printVectorMatrixWithHeaders(vector<double> matrix, int rows, int cols, vec
 }
 
 /*
- *
- Function Which gets the diagonal elements of the matrix
+ * Function to print the nonzero elements of a sparse matrix with headers
  */
-void getDiagonalElements(double *matrix, int rows, int cols, double* result)
+void printSparseMatrixWithHeaders(sparseMatrixData & matrix, vector<string> & headers, string name, ofstream& logfile)
 {
-	int k=0;
-	for (int i=0;i<rows; i++)
+	logfile << "\n" << "************ "<< name << " **********" <<"\n";
+	for (int j=0; j < matrix.column; j++)
 	{
-		for (int j=0;j<cols;j++)
+		for (int k=matrix.colptr[j]; k < matrix.colptr[j+1]; k++)
 		{
-			if(i==j)
-			{
-				result[k++] = matrix[i+j*rows];
-			}
+			logfile << std::right << setw(10) << headers[matrix.rowind[k]] << std::right << setw(10) << headers[j];
+			logfile << std::right << setw(15) << matrix.data[k] << "\n";
 		}
 	}
+	logfile << "\n";
+	logfile.flush();
 }
 
 /*
- * Function to transpose the Matrix
+ * Function Which gets the diagonal elements of the sparse matrix
  */
-void transposeMatrix(double * jacF, double * jacFT, int rows, int cols)
+void getSparseDiagonalElements(sparseMatrixData & matrix, double* result)
 {
-	for (int i=0;i<rows; i++)
+	for (int j=0; j < matrix.column; j++)
 	{
-		for (int j=0;j<cols;j++)
+		result[j] = 0.0;
+		for (int k=matrix.colptr[j]; k < matrix.colptr[j+1]; k++)
 		{
-			// Perform matrix transpose store the elements in column major
-			jacFT[i*cols+j]= jacF[i+j*rows] ;
+			if(matrix.rowind[k] == j)
+			{
+				result[j] = matrix.data[k];
+				break;
+			}
 		}
 	}
 }
 
-
 /*
- * Matrix Multiplication using dgemm LaPack routine
+ * Sparse matrix vector multiplication y = A*x
  */
-void solveMatrixMultiplication(double *matrixA, double *matrixB, int rowsa, int colsa, int rowsb, int colsb , double *matrixC, ofstream & logfile)
+void solveSparseMatrixVector(sparseMatrixData & A, double * x, double * y)
 {
-	char trans = 'N';
-	double one = 1.0, zero = 0.0;
-	int rowsA = rowsa;
-	int colsA = colsa;
-	int rowsB = rowsb;
-	int colsB = colsb;
-	int common = colsa;
-
-	if(colsA!=rowsB)
+	for (int i=0; i < A.rows; i++)
 	{
-		//cout << "\n Error: Column of First Matrix not equal to Rows  of Second Matrix \n ";
-		//errorStreamPrint(LOG_STDOUT, 0, "solveMatrixMultiplication() Failed!, Column of First Matrix not equal to Rows of Second Matrix %i != %i.",colsA,rowsB);
-		logfile << "|  error   |   " << "solveMatrixMultiplication() Failed!, Column of First Matrix not equal to Rows of Second Matrix " << colsA << " != "<< rowsB <<  "\n";
-		logfile.close();
-		exit(1);
+		y[i] = 0.0;
 	}
-	// solve matrix multiplication using dgemm_ LAPACK routine
-	dgemm_(&trans, &trans, &rowsA, &colsB, &common, &one, matrixA, &rowsA, matrixB, &common, &zero, matrixC, &rowsA);
-}
-
-/*
- * Solve the Linear System A*x=b using LAPACK Solver routine dgesv_
- */
-void solveSystemFstar(int n, int nhrs, double * tmpMatrixD, double * tmpMatrixC, ofstream & logfile)
-{
-	int N=n; // number of rows of Matrix A
-	int NRHS=nhrs;  // number of columns of Matrix B
-	int LDA=N;
-	int LDB=N;
-	int ipiv[N];
-	int info;
-	// call the external function
-	dgesv_( &N, &NRHS, tmpMatrixD, &LDA, ipiv, tmpMatrixC, &LDB, &info);
-	if( info > 0 ) {
-		//cout << "The solution could not be computed, The info satus is : " << info;
-		//errorStreamPrint(LOG_STDOUT, 0, "solveSystemFstar() Failed !, The solution could not be computed, The info satus is %i.", info);
-		logfile << "|  error   |   " << "solveSystemFstar() Failed !, The solution could not be computed, The info satus is" << info << "\n";
-		logfile.close();
-		exit(1);
-	}
-}
-
-/*
- * Solve the matrix Subtraction of two matrices
- */
-void solveMatrixSubtraction(matrixData A, matrixData B, double * result, ofstream & logfile)
-{
-	if(A.rows!=B.rows && A.column!=B.column)
-	{
-		//cout << "The Matrix Dimensions are not equal to Compute ! \n";
-		//errorStreamPrint(LOG_STDOUT, 0, "solveMatrixSubtraction() Failed !, The Matrix Dimensions are not equal to Compute ! %i != %i.", A.rows,B.rows);
-		logfile << "|  error   |   " << "solveMatrixSubtraction() Failed !, The Matrix Dimensions are not equal to Compute" << A.rows << " != " << B.rows << "\n";
-		logfile.close();
-		exit(1);
-	}
-	//printColumnAlginment(A.data,A.rows,A.column,"A-Matrix");
-	//printColumnAlginment(B.data,B.rows,B.column,"B-Matrix");
-
-	// subtract elements in cloumn major
-	for(int i=0; i < A.rows*A.column; i++)
-	{
-		result[i]=A.data[i]-B.data[i];
-	}
-}
-
-/*
- * Solve the matrix addition of two matrices
- */
-matrixData solveMatrixAddition(matrixData A, matrixData B, ofstream & logfile)
-{
-	double* result = (double*)calloc(A.rows*A.column,sizeof(double));
-	if(A.rows!=B.rows && A.column!=B.column)
-	{
-		//cout << "The Matrix Dimensions are not equal to Compute ! \n";
-		//errorStreamPrint(LOG_STDOUT, 0, "solveMatrixAddition() Failed !, The Matrix Dimensions are not equal to Compute ! %i != %i.", A.rows,B.rows);
-		logfile << "|  error   |   " << "solveMatrixAddition() Failed !, The Matrix Dimensions are not equal to Compute" << A.rows << " != " << B.rows << "\n";
-		logfile.close();
-		exit(1);
-	}
-	//printColumnAlginment(A.data,A.rows,A.column,"A-Matrix");
-	//printColumnAlginment(B.data,B.rows,B.column,"B-Matrix");
-	// Add the elements in cloumn major
-	for(int i=0; i < A.rows*A.column; i++)
-	{
-		result[i]=A.data[i]+B.data[i];
-	}
-	matrixData tmpadd_a_b = {A.rows,A.column,result};
-	return tmpadd_a_b;
-}
-
-/*
- * Function which Calculates the Matrix Multiplication
- * of (Sx*Ft)*Fstar
- */
-matrixData Calculate_Sx_Ft_Fstar(matrixData Sx, matrixData Ft, matrixData Fstar, ofstream & logfile)
-{
-	// Sx*Ft
-	double* tmpMatrixA = (double*)calloc(Sx.rows*Ft.column,sizeof(double));
-	solveMatrixMultiplication(Sx.data,Ft.data,Sx.rows,Sx.column,Ft.rows,Ft.column,tmpMatrixA,logfile);
-	//printMatrix1(tmpMatrixA,Sx.rows,Ft.column,"Reconciled-(Sx*Ft)");
-	//printMatrix1(Fstar.data,Fstar.rows,Fstar.column,"REconciled-FStar");
-
-	//(Sx*Ft)*Fstar
-	double* tmpMatrixB = (double*)calloc(Sx.rows*Fstar.column,sizeof(double));
-	solveMatrixMultiplication(tmpMatrixA,Fstar.data,Sx.rows,Ft.column,Fstar.rows,Fstar.column,tmpMatrixB,logfile);
-	matrixData rhsdata= {Sx.rows,Fstar.column,tmpMatrixB};
-
-	free(tmpMatrixA);
-	free(tmpMatrixB);
-	return rhsdata;
-}
-
-/*
- * Solves the system
- * recon_x = x - (Sx*Ft*fstar)
- */
-matrixData solveReconciledX(matrixData x, matrixData Sx, matrixData Ft, matrixData Fstar, ofstream& logfile)
-{
-	// Sx*Ft
-	double* tmpMatrixAf = (double*)calloc(Sx.rows*Ft.column,sizeof(double));
-	solveMatrixMultiplication(Sx.data,Ft.data,Sx.rows,Sx.column,Ft.rows,Ft.column,tmpMatrixAf,logfile);
-	//printMatrix(tmpMatrixAf,Sx.rows,Ft.column,"Sx*Ft");
-	//(Sx*Ft)*fstar
-	double* tmpMatrixBf = (double*)calloc(Sx.rows*Fstar.column,sizeof(double));
-	solveMatrixMultiplication(tmpMatrixAf,Fstar.data,Sx.rows,Ft.column,Fstar.rows,Fstar.column,tmpMatrixBf,logfile);
-	//printMatrix(tmpMatrixBf,Sx.rows,Fstar.column,"(Sx*Ft*fstar)");
-
-	matrixData rhs= {Sx.rows,Fstar.column,tmpMatrixBf};
-	//matrixData rhs = Calculate_Sx_Ft_Fstar(Sx,Ft,Fstar);
-
-	double* reconciledX = (double*)calloc(x.rows*x.column,sizeof(double));
-	solveMatrixSubtraction(x,rhs,reconciledX,logfile);
-	//printMatrix(reconciledX,x.rows,x.column,"reconciled X^cap ===> (x - (Sx*Ft*fstar))");
-	if(ACTIVE_STREAM(LOG_JAC))
-	{
-		logfile << "Calculations of Reconciled_x ==> (x - (Sx*Ft*f*))" << "\n";
-		logfile << "====================================================";
-		printMatrix(tmpMatrixAf,Sx.rows,Ft.column,"Sx*Ft",logfile);
-		printMatrix(tmpMatrixBf,Sx.rows,Fstar.column,"(Sx*Ft*f*)",logfile);
-		printMatrix(reconciledX,x.rows,x.column,"x - (Sx*Ft*f*))",logfile);
-		logfile << "***** Completed ****** \n\n";
-	}
-	matrixData recon_x = {x.rows,x.column,reconciledX};
-	//free(reconciledX);
-	free(tmpMatrixAf);
-	free(tmpMatrixBf);
-	return recon_x;
-}
-
-/*
- * Solves the system
- * recon_Sx = Sx - (Sx*Ft*Fstar)
- */
-matrixData solveReconciledSx(matrixData Sx, matrixData Ft, matrixData Fstar, ofstream& logfile)
-{
-	// Sx*Ft
-	double* tmpMatrixA = (double*)calloc(Sx.rows*Ft.column,sizeof(double));
-	solveMatrixMultiplication(Sx.data,Ft.data,Sx.rows,Sx.column,Ft.rows,Ft.column,tmpMatrixA, logfile);
-	//printMatrix(tmpMatrixA,Sx.rows,Ft.column,"Reconciled-(Sx*Ft)");
-	//printMatrix(Fstar.data,Fstar.rows,Fstar.column,"REconciled-FStar");
-
-	//(Sx*Ft)*Fstar
-	double* tmpMatrixB = (double*)calloc(Sx.rows*Fstar.column,sizeof(double));
-	solveMatrixMultiplication(tmpMatrixA,Fstar.data,Sx.rows,Ft.column,Fstar.rows,Fstar.column,tmpMatrixB, logfile);
-	//printMatrix(tmpMatrixB,Sx.rows,Fstar.column,"Reconciled-(Sx*Ft*Fstar)");
-
-	matrixData rhs= {Sx.rows,Fstar.column,tmpMatrixB};
-
-	//matrixData rhs = Calculate_Sx_Ft_Fstar(Sx,Ft,Fstar);
-	double* reconciledSx = (double*)calloc(Sx.rows*Sx.column,sizeof(double));
-	solveMatrixSubtraction(Sx,rhs,reconciledSx, logfile);
-	//printMatrix(reconciledSx,Sx.rows,Sx.column,"reconciled Sx ===> (Sx - (Sx*Ft*Fstar))");
-	if(ACTIVE_STREAM(LOG_JAC))
+	for (int j=0; j < A.column; j++)
 	{
-		logfile << "Calculations of Reconciled_Sx ===> (Sx - (Sx*Ft*F*))" << "\n";
-		logfile << "============================================";
-		printMatrix(tmpMatrixA,Sx.rows,Ft.column,"(Sx*Ft)",logfile);
-		printMatrix(tmpMatrixB,Sx.rows,Fstar.column,"(Sx*Ft*F*)",logfile);
-		printMatrix(reconciledSx,Sx.rows,Sx.column,"Sx - (Sx*Ft*F*))",logfile);
-		logfile << "***** Completed ****** \n\n";
+		for (int k=A.colptr[j]; k < A.colptr[j+1]; k++)
+		{
+			y[A.rowind[k]] += A.data[k]*x[j];
+		}
 	}
-	matrixData recon_sx ={Sx.rows,Sx.column,reconciledSx};
-	//free(reconciledSx);
-	free(tmpMatrixA);
-	free(tmpMatrixB);
-	return recon_sx;
 }
 
 /*
- * Function Which Computes the
- * Jacobian Matrix F
+ * Function Which Computes the sparse
+ * Jacobian Matrix F, the structure is set up at the first call,
+ * later calls only update the values. Columns of the same color
+ * are evaluated with one call of the jacobian.
  */
-matrixData getJacobianMatrixF(DATA* data, threadData_t *threadData, ofstream & logfile)
+void getSparseJacobianMatrixF(DATA* data, threadData_t *threadData, sparseMatrixData & F, ofstream & logfile)
 {
-	// initialize the jacobian call
 	const int index = data->callback->INDEX_JAC_F;
 	ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-	data->callback->initialAnalyticJacobianF(data, threadData, jacobian);
-	int cols = jacobian->sizeCols;
-	int rows = jacobian->sizeRows;
-	if(cols == 0) {
-		//errorStreamPrint(LOG_STDOUT, 0, "Cannot Compute Jacobian Matrix F");
-		logfile << "|  error   |   " << "Cannot Compute Jacobian Matrix F" << "\n";
-		logfile.close();
-		exit(1);
-	}
-	double* jacF = (double*)calloc(rows*cols,sizeof(double)); // allocate for Matrix F
-	int k=0;
-	for (int x=0; x < cols ; x++)
+	SPARSE_PATTERN* sp;
+	bool colored;
+
+	if(F.colptr.empty())
 	{
-		jacobian->seedVars[x] = 1.0;
-		data->callback->functionJacF_column(data, threadData, jacobian, NULL);
-		//cout << "Calculate one column\n:";
-		for (int y=0; y < rows ; y++)
+		// initialize the jacobian call
+		data->callback->initialAnalyticJacobianF(data, threadData, jacobian);
+		int cols = jacobian->sizeCols;
+		int rows = jacobian->sizeRows;
+		if(cols == 0) {
+			logfile << "|  error   |   " << "Cannot Compute Jacobian Matrix F" << "\n";
+			logfile.close();
+			exit(1);
+		}
+		sp = jacobian->sparsePattern;
+		F.rows = rows;
+		F.column = cols;
+		F.colptr.assign(cols+1, 0);
+		if(sp != NULL && sp->leadindex != NULL && sp->numberOfNoneZeros > 0)
 		{
-			jacF[k++]=jacobian->resultVars[y];
+			for (int j=0; j < cols; j++)
+			{
+				F.colptr[j+1] = sp->leadindex[j+1];
+			}
+			F.rowind.assign(sp->index, sp->index + sp->leadindex[cols]);
 		}
-		jacobian->seedVars[x] = 0.0;
+		else
+		{
+			// no sparsity information, store all elements
+			for (int j=0; j < cols; j++)
+			{
+				F.colptr[j+1] = F.colptr[j] + rows;
+				for (int i=0; i < rows; i++)
+				{
+					F.rowind.push_back(i);
+				}
+			}
+		}
+		F.data.assign(F.rowind.size(), 0.0);
 	}
-	matrixData Fdata ={rows,cols,jacF};
-	return Fdata;
-}
 
-/*
- * Function Which Computes the
- * Transpose of Jacobian Matrix FT
- */
-matrixData getTransposeMatrix(matrixData jacF)
-{
-	int rows=jacF.column;
-	int cols=jacF.rows;
-	double* jacFT = (double*)calloc(rows*cols,sizeof(double)); // allocate for Matrix F-transpose
-	int k=0;
-	for (int i=0;i<jacF.rows; i++)
+	sp = jacobian->sparsePattern;
+	colored = (sp != NULL && sp->leadindex != NULL && sp->numberOfNoneZeros > 0);
+	int ncolors = colored ? sp->maxColors : F.column;
+
+	for (int color=1; color <= ncolors; color++)
 	{
-		for (int j=0;j<jacF.column;j++)
+		for (int j=0; j < F.column; j++)
 		{
-			// Perform matrix transpose store the elements in column major
-			//cout << (i1*jacF.rows+j1) << " index :" << (i1+j1*jacF.rows) << " value is: " << jacF.data[i1+j1*jacF.rows] << "\n";
-			jacFT[k++]= jacF.data[i+j*jacF.rows];
-
+			if((colored && sp->colorCols[j] == (unsigned int)color) || (!colored && j == color-1))
+			{
+				jacobian->seedVars[j] = 1.0;
+			}
+		}
+		data->callback->functionJacF_column(data, threadData, jacobian, NULL);
+		for (int j=0; j < F.column; j++)
+		{
+			if((colored && sp->colorCols[j] == (unsigned int)color) || (!colored && j == color-1))
+			{
+				for (int k=F.colptr[j]; k < F.colptr[j+1]; k++)
+				{
+					F.data[k] = jacobian->resultVars[F.rowind[k]];
+				}
+				jacobian->seedVars[j] = 0.0;
+			}
 		}
 	}
-	matrixData Ft_data ={rows,cols,jacFT};
-	return Ft_data;
 }
 
 /*
@@ -672,91 +531,51 @@ csvData readCovarianceMatrixSx(DATA* data, threadData_t *threadData, ofstream &
 }
 
 /*
- * Function which reads the vector
- * and assign to c pointer arrays
- */
-matrixData getCovarianceMatrixSx(csvData Sx_result, DATA* data, threadData_t *threadData)
-{
-	double* tempSx = (double*)calloc(Sx_result.rowcount*Sx_result.columncount,sizeof(double));
-	initColumnMatrix(Sx_result.sxdata , Sx_result.rowcount, Sx_result.columncount, tempSx);
-	matrixData Sx_data = {Sx_result.rowcount,Sx_result.columncount,tempSx};
-	return Sx_data;
-}
-
-/*
- * Function which Computes
+ * Function which Computes the sparse
  * covariance matrix Sx based on
  * Half width confidence interval provided by user
  * Sx=(Wxi/1.96)^2
+ * and the correlation coefficients Sx_ik=rx_ik*sqrt(Sx_ii)*sqrt(Sx_kk)
  */
-
-matrixData computeCovarianceMatrixSx(csvData Sx_result, DATA* data, threadData_t *threadData, ofstream & logfile)
+sparseMatrixData computeCovarianceMatrixSx(csvData & Sx_result, ofstream & logfile)
 {
-	double* tempSx = (double*)calloc(Sx_result.sxdata.size()*Sx_result.sxdata.size(),sizeof(double));
-	vector<double> tmpdata;
-	int k=0;
-	for (unsigned int i=0;i<Sx_result.sxdata.size(); i++)
+	int n = Sx_result.sxdata.size();
+	vector< map<int,double> > cols(n);
+	sparseMatrixData Sx;
+
+	for (int i=0; i < n; i++)
 	{
-		double data = pow(Sx_result.sxdata[k]/1.96,2);
-		for (unsigned int j=0;j<Sx_result.sxdata.size();j++)
-		{
-			if(i==j)
-			{
-				//tmpdata.push_back(pow(Sx_result.sxdata[k]/1.96,2));
-				//k++;
-				tmpdata.push_back(data);
-			}
-			else
-			{
-				tmpdata.push_back(0);
-			}
-			// logfile << " data " << count << "=="<< tmpdata[count++] << "\n";
-		}
-		k++;
+		cols[i][i] = pow(Sx_result.sxdata[i]/1.96,2);
 	}
-	//logfile << "tmpdatasize" << tmpdata.size() << "\n";
-	//logfile << "Size of vector :" << Sx_result.rx.size() << "\n";
 
 	/* check for corelation coefficient matrix and insert the elements in correct position*/
-	for (unsigned int l=0; l < Sx_result.rx.size();l++)
+	for (unsigned int l=0; l < Sx_result.rx.size(); l++)
 	{
-		int pos1;
-		int pos2;
-		double xi;
-		double xk ;
-		for(unsigned int m=0; m<Sx_result.rx[l].size();m++)
+		if(Sx_result.rx[l].size() < 3)
 		{
-			if(m==0)
-			{
-				pos1 = getVariableIndex(Sx_result.headers,Sx_result.rx[l][m],logfile);
-				xi   =  tmpdata[(Sx_result.rowcount*pos1)+pos1];
-				//logfile << "xi =>"<< pos1 << "= "<< xi << "\n";
-			}
+			continue;
+		}
+		int pos1 = getVariableIndex(Sx_result.headers,Sx_result.rx[l][0],logfile);
+		int pos2 = getVariableIndex(Sx_result.headers,Sx_result.rx[l][1],logfile);
+		double tmprx = atof((Sx_result.rx[l][2]).c_str())*sqrt(cols[pos1][pos1])*sqrt(cols[pos2][pos2]);
+		// find the symmetric position and insert the elements
+		cols[pos2][pos1]=tmprx;
+		cols[pos1][pos2]=tmprx;
+	}
 
-			if(m==1)
-			{
-				pos2 = getVariableIndex(Sx_result.headers,Sx_result.rx[l][m],logfile);
-				xk   = tmpdata[(Sx_result.rowcount*pos2)+pos2];
-				//logfile << "xk =>"<< pos2 << "= "<< xk << "\n";
-			}
-			if(m==2)
-			{
-				//logfile << "position:" << pos1 << ": " << pos2 << "\n";
-				//logfile << "rx_ik" << Sx_result.rx[l][m] << "*" << xi << "*" << xk << "\n";
-				//logfile << atof((Sx_result.rx[l][m]).c_str())*sqrt(xi)*sqrt(xk) << "\n";
-				double tmprx = atof((Sx_result.rx[l][m]).c_str())*sqrt(xi)*sqrt(xk);
-				// find the symmetric position and insert the elements
-				//logfile << "final position :" << (Sx_result.rowcount*pos1)+pos2 << "value is: "<< tmprx << "\n";
-				//logfile << "final position :" << (Sx_result.rowcount*pos2)+pos1 << "value is: "<< tmprx << "\n";
-				tmpdata[(Sx_result.rowcount*pos1)+pos2]=tmprx;
-				tmpdata[(Sx_result.rowcount*pos2)+pos1]=tmprx;
-			}
+	Sx.rows = n;
+	Sx.column = n;
+	Sx.colptr.assign(n+1, 0);
+	for (int j=0; j < n; j++)
+	{
+		for (map<int,double>::iterator it=cols[j].begin(); it != cols[j].end(); ++it)
+		{
+			Sx.rowind.push_back(it->first);
+			Sx.data.push_back(it->second);
 		}
-		//logfile << "\n";
+		Sx.colptr[j+1] = Sx.rowind.size();
 	}
-	initColumnMatrix(tmpdata , Sx_result.rowcount, Sx_result.rowcount, tempSx);
-	matrixData Sx_data = {Sx_result.rowcount,Sx_result.rowcount,tempSx};
-	return Sx_data;
+	return Sx;
 }
 
 /*
@@ -767,60 +586,17 @@ matrixData computeCovarianceMatrixSx(csvData Sx_result, DATA* data, threadData_t
 inputData getInputDataFromStartAttribute(csvData Sx_result , DATA* data, threadData_t *threadData, ofstream & logfile)
 {
 	double *tempx = (double*)calloc(Sx_result.rowcount,sizeof(double));
-	char ** knowns = (char**)malloc(data->modelData->nInputVars * sizeof(char*));
 	vector<int> index;
-	data->callback->inputNames(data, knowns);
 	int headercount = Sx_result.headers.size();
-	/* Read data from input vars which has start attribute value set as input */
 
 	for (int h=0; h < headercount; h++)
 	{
 		tempx[h]=Sx_result.xdata[h];
-		/*
-		bool flag=false;
-		for (int in=0; in < data->modelData->nInputVars; in++)
-		{
-			if(strcmp(knowns[in], Sx_result.headers[h].c_str()) == 0)
-			{
-				//tempx[h] = data->simulationInfo->inputVars[in];
-				index.push_back(in);
-				flag=true;
-				//logfile << knowns[in] << "  start value :" << data->simulationInfo->inputVars[in] << "\n";
-				//logfile << "fetch index :" << in << "\n";
-			}
-		}
-		if(flag==false)
-		{
-			logfile << "|  error   |   " << "Input Variable Not matched or not generated: "<< Sx_result.headers[h] << " , getInputDataFromStartAttribute failed()! \n";
-			logfile.close();
-			exit(1);
-		} */
 	}
 	inputData x_data ={Sx_result.rowcount,1,tempx,index};
-	free(knowns);
 	return x_data;
 }
 
-/*
- * Function  which Copy Matrix
- * using dcopy_ LAPACK routine
- * this is mostly used when LAPACK routines override arrays
- */
-matrixData copyMatrix(matrixData matdata)
-{
-	double * tmpcopymatrix = (double*)calloc(matdata.rows*matdata.column,sizeof(double));
-	int n = matdata.rows*matdata.column;
-	int inc = 1;
-	dcopy_(&n,matdata.data,&inc,tmpcopymatrix,&inc);
-
-	//  for (int i=0; i < matdata.rows*matdata.column; i++)
-	//  {
-	//	  tmpcopymatrix[i]=matdata.data[i];
-	//  }
-	matrixData tmpcopymatrixdata = {matdata.rows, matdata.column, tmpcopymatrix};
-	return tmpcopymatrixdata;
-}
-
 /*
  * Function which scales the MAtrix with constant
  * dscal_ LAPACK_routine and result is updated in data
@@ -848,297 +624,207 @@ void calculateSquareRoot(double * data, int length)
 }
 
 /*
- * Function which calculates
- * J*=(recon_x-x)T*(Sx^-1)*(recon_x-x)+2.[f+F*(recon_x-x)]T*fstar
- * where T= transpose of matrix
- * and returns the converged value
- */
-
-double solveConvergence(DATA* data, matrixData conv_recon_x, matrixData conv_recon_sx, inputData conv_x, matrixData conv_sx, matrixData conv_jacF, matrixData conv_vector_c, matrixData conv_fstar, ofstream & logfile)
-{
-
-	//printMatrix(conv_vector_c.data,conv_vector_c.rows,conv_vector_c.column,"Convergence_C(x,y)");
-	//printMatrix(conv_fstar.data,conv_fstar.rows,conv_fstar.column,"Convergence_f*");
-	//printMatrix(conv_recon_x.data,conv_recon_x.rows,conv_recon_x.column,"check_recon_x*");
-
-	// calculate(recon_x-x)
-	double* conv_data1 = (double*)calloc(conv_x.rows*conv_x.column,sizeof(double));
-	matrixData conv_inputs = {conv_x.rows,conv_x.column,conv_x.data};
-	solveMatrixSubtraction(conv_recon_x,conv_inputs,conv_data1,logfile);
-	matrixData conv_data1result={conv_x.rows,conv_x.column,conv_data1};
-	matrixData copy_reconx_x = copyMatrix(conv_data1result);
-
-	//printMatrix(conv_inputs.data,conv_inputs.rows,conv_inputs.column,"check_inputs");
-	//printMatrix(conv_data1result.data,conv_data1result.rows,conv_data1result.column,"(recon_X - X)");
-
-	// calculate Transpose_(recon_x-x)
-	matrixData conv_data1Transpose = getTransposeMatrix(conv_data1result);
-	//printMatrix(conv_data1Transpose.data,conv_data1Transpose.rows,conv_data1Transpose.column,"Transpose(recon_X - X)");
-
-	/* solves (Sx^-1)*(recon_x-x)
-	 * Solve the inverse of matrix Sx using linear form
-	 * Ax=b
-	 * where A=Sx and b= (recon_x-x) to avoid inversion of Sx which is
-	 * expensive
-	 */
-	solveSystemFstar(conv_sx.rows,1,conv_sx.data,conv_data1result.data,logfile);
-	//printMatrix(conv_data1result.data,conv_sx.rows,conv_data1result.column,"inverse multiplication_without inverse");
-
-	double *conv_tmpmatrixlhs = (double*)calloc(conv_data1Transpose.rows*conv_data1result.column,sizeof(double));
-	/*
-	 * Solve (recon_x-x)T*(Sx^-1)*(recon_x-x)
-	 */
-	solveMatrixMultiplication(conv_data1Transpose.data,conv_data1result.data,conv_data1Transpose.rows,conv_data1Transpose.column,conv_data1result.rows,conv_data1result.column,conv_tmpmatrixlhs,logfile);
-	//printMatrix(conv_tmpmatrixlhs,conv_data1Transpose.rows,conv_data1result.column,"(recon_x-x)T*(Sx^-1)*(recon_x-x)");
-	matrixData struct_conv_tmpmatrixlhs = {conv_data1Transpose.rows,conv_data1result.column,conv_tmpmatrixlhs};
-
-	/*
-	 * Solve rhs = 2.[f+F*(recon_x-x)]T*fstar
-	 *
-	 */
-	// Calculate F*(recon_x-x)
-	double * tmp_F_recon_x_x = (double*)calloc(conv_jacF.rows*copy_reconx_x.column,sizeof(double));
-	solveMatrixMultiplication(conv_jacF.data, copy_reconx_x.data, conv_jacF.rows, conv_jacF.column, copy_reconx_x.rows, copy_reconx_x.column,tmp_F_recon_x_x, logfile);
-	//printMatrix(tmp_F_recon_x_x,conv_jacF.rows,copy_reconx_x.column,"F*(recon_x-x)");
-	matrixData mult_F_recon_x_x = {conv_jacF.rows,copy_reconx_x.column,tmp_F_recon_x_x};
-
-	// Calculate f + F*(recon_x-x)
-	matrixData add_f_F_recon_x_x = solveMatrixAddition(conv_vector_c, mult_F_recon_x_x, logfile);
-	//printMatrix(add_f_F_recon_x_x.data,add_f_F_recon_x_x.rows,add_f_F_recon_x_x.column,"f + F*(recon_x-x)");
-
-	matrixData transpose_add_f_F_recon_x_x = getTransposeMatrix(add_f_F_recon_x_x);
-	//printMatrix(transpose_add_f_F_recon_x_x.data,transpose_add_f_F_recon_x_x.rows,transpose_add_f_F_recon_x_x.column,"transpose-[f + F*(recon_x-x)]");
-
-	// calculate [f + F*(recon_x-x)]T*fstar
-	double *conv_tmpmatrixrhs = (double*)calloc(transpose_add_f_F_recon_x_x.rows*conv_fstar.column,sizeof(double));
-	solveMatrixMultiplication(transpose_add_f_F_recon_x_x.data, conv_fstar.data, transpose_add_f_F_recon_x_x.rows, transpose_add_f_F_recon_x_x.column, conv_fstar.rows, conv_fstar.column, conv_tmpmatrixrhs, logfile);
-	//printMatrix(conv_tmpmatrixrhs, transpose_add_f_F_recon_x_x.rows, conv_fstar.column,"[f + F*(recon_x-x)]*fstar");
-
-	// scale the matrix with 2*[f + F*(recon_x-x)]T*fstar
-	scaleVector(transpose_add_f_F_recon_x_x.rows , conv_fstar.column, 2.0, conv_tmpmatrixrhs);
-	//printMatrix(conv_tmpmatrixrhs, transpose_add_f_F_recon_x_x.rows, conv_fstar.column,"2*[f + F*(recon_x-x)]*fstar");
-	matrixData struct_conv_tmpmatrixrhs= {transpose_add_f_F_recon_x_x.rows, conv_fstar.column,conv_tmpmatrixrhs};
-
-	/*
-	 * solve the final J*=J*=(recon_x-x)T*(Sx^-1)*(recon_x-x)+2.[f+F*(recon_x-x)]T*fstar
-	 * J*=_struct_conv_tmpmatrixlhs + struct_conv_tmpmatrixrhs
-	 */
-	matrixData struct_Jstar= solveMatrixAddition(struct_conv_tmpmatrixlhs,struct_conv_tmpmatrixrhs, logfile);
-	//printMatrix(struct_Jstar.data,struct_Jstar.rows,struct_Jstar.column,"J*",logfile);
-
-	int r=data->modelData->nSetcVars; // number of setc equations
-	double val=1.0/r;
-
-	/*
-	 * calculate J/r < epselon
-	 */
-	scaleVector(struct_Jstar.rows,struct_Jstar.column,val,struct_Jstar.data);
-	//printMatrix(struct_Jstar.data,struct_Jstar.rows,struct_Jstar.column,"J*/r ");
-	double convergedvalue=struct_Jstar.data[0];
-
-	//  free(struct_Jstar.data);
-	//  free(struct_conv_tmpmatrixrhs.data);
-	//  free(conv_tmpmatrixrhs);
-	//  free(transpose_add_f_F_recon_x_x.data);
-	//  free(add_f_F_recon_x_x.data);
-	//  free(transpose_add_f_F_recon_x_x.data);
-	//  free(mult_F_recon_x_x.data);
-	//  free(tmp_F_recon_x_x);
-	//  free(struct_conv_tmpmatrixlhs.data);
-	//  free(conv_tmpmatrixlhs);
-	//  free(conv_data1Transpose.data);
-	//  free(copy_reconx_x.data);
-	//  free(conv_data1result.data);
-	//  free(conv_data1);
-
-	return convergedvalue;
-}
-
-/*
- * Example Function which performs matrix inverse
- * using dgetri_ and dgetrf_ LAPACK routine
- * which is expensive one and not recommended
- * use it when no other way to compute it
- */
-void checkExpensiveMatrixInverse()
-{
-	double  newval[3*3]={3,2,0,
-			0,0,1,
-			2,-2,1};
-
-	int N=3;
-	int LDA=N;
-	int LDB=N;
-	int ipiv[N];
-	int info=1;
-	int LWORK =N;
-	double * WORK = (double*)calloc(LWORK,sizeof(double));
-
-	dgetrf_(&N,&N,newval,&N,ipiv,&info);
-	dgetri_(&N,newval,&N,ipiv,WORK,&LWORK,&info);
-	//printMatrix(newval,3,3,"Expensive_Matrix_Inverse");
-}
-
-/*
- * Function which performs matrix inverse without performing
- * actual matrix inverse, Instead use the dgesv to get result
- * Ax=b where matrix mutiplication of x=bA gives the inversed
- * mutiplication result b with A inverse
+ * One step of the reconciliation at the measured values x
+ *
+ * f* = (F*Sx*Ft)^-1 * c(x,y) and recon_x = x - (Sx*Ft*f*)
+ * F*Sx*Ft is factorized with dpotrf_ and never inverted,
+ * all matrices are kept in the preallocated workspace w.
+ *
+ * returns the convergence value J* / r with
+ * J* = (recon_x-x)T*(Sx^-1)*(recon_x-x)+2.[f+F*(recon_x-x)]T*fstar
+ * since (Sx^-1)*(recon_x-x) = -Ft*f*, this is
+ * J* = [F*(recon_x-x)]T*f* + 2.fT*f*
  */
-void checkInExpensiveMatrixInverse(ofstream & logfile)
-{
-	double newchecksx[3*3]={1,1,1,
-			0,0.95,0,
-			0,0,0.95};
-	double checksx[3*1]={-0.028,0.026,-0.004};
-	solveSystemFstar(3,1,newchecksx,checksx,logfile);
-	//printMatrix(checksx,3,1,"InExpensive_Matrix_Inverse");
-}
-
-int RunReconciliation(DATA* data, threadData_t *threadData, inputData x, matrixData Sx, matrixData tmpjacF, matrixData tmpjacFt, double eps, int iterationcount, csvData csvinputs, matrixData xdiag, matrixData sxdiag, ofstream& logfile)
+double solveReconciliationStep(DATA* data, threadData_t *threadData, double * x, double * reconX, sparseMatrixData & F, sparseMatrixData & Sx, reconcileWorkspace & w, ofstream& logfile)
 {
-	// set the inputs first
-    /*
-	for (int i=0; i< x.rows*x.column; i++)
-	{
-		data->simulationInfo->inputVars[x.index[i]]=x.data[i];
-		//logfile << "input data:" << x.data[i]<<"\n";
-	}*/
+	char uplo = 'L', trans = 'T';
+	int one = 1, info = 0;
+	double minusone = -1.0, zero = 0.0;
 
-	for (int i=0; i< x.rows*x.column; i++)
+	for (int i=0; i < Sx.rows; i++)
 	{
-		data->simulationInfo->datainputVars[i]=x.data[i];
-		//logfile << "input data:" << x.data[i]<<"\n";
+		data->simulationInfo->datainputVars[i]=x[i];
 	}
 
-    /* set the inputs via this special function generated for dataReconciliation
-     * which also sets inputs for models not involving top level inputs
-     */
-    data->callback->data_function(data, threadData);
-	//data->callback->input_function(data, threadData);
+	/* set the inputs via this special function generated for dataReconciliation
+	 * which also sets inputs for models not involving top level inputs
+	 */
+	data->callback->data_function(data, threadData);
 	data->callback->functionDAE(data,threadData);
-	//data->callback->functionODE(data,threadData);
 	data->callback->setc_function(data, threadData);
 
-	matrixData jacF = getJacobianMatrixF(data,threadData,logfile);
-	matrixData jacFt = getTransposeMatrix(jacF);
-
-	printMatrix(jacF.data,jacF.rows,jacF.column,"F",logfile);
-	printMatrix(jacFt.data,jacFt.rows,jacFt.column,"Ft",logfile);
+	getSparseJacobianMatrixF(data, threadData, F, logfile);
 
+	if(w.B.empty())
+	{
+		if(F.column != Sx.rows || F.rows != data->modelData->nSetcVars)
+		{
+			logfile << "|  error   |   " << "Jacobian Matrix F (" << F.rows << "x" << F.column << ") does not match " << data->modelData->nSetcVars << " equations and " << Sx.rows << " variables to be reconciled\n";
+			logfile.close();
+			exit(1);
+		}
+		w.r = F.rows;
+		w.n = F.column;
+		w.B.resize(w.r*w.n);
+		w.A.resize(w.r*w.r);
+		w.c.resize(w.r);
+		w.fstar.resize(w.r);
+		w.d.resize(w.n);
+		w.Fd.resize(w.r);
+	}
+	const int r = w.r;
+	int n = w.n;
+	int ldr = r;
 
-	double* setc = (double*)calloc(data->modelData->nSetcVars,sizeof(double)); // allocate data for setc array
-	// store the setc data to compute for convergence as setc will be overriddeen with new values
-	double* tmpsetc = (double*)calloc(data->modelData->nSetcVars,sizeof(double));
+	/* c(x,y) rhs side, get the elements in reverse order */
+	for (int i=0; i < r; i++)
+	{
+		w.c[i] = data->simulationInfo->setcVars[r-1-i];
+		w.fstar[i] = w.c[i];
+	}
 
-	/* loop to store the data C(x,y) rhs side, get the elements in reverse order */
-	int t=0;
-	for (int i=data->modelData->nSetcVars; i > 0; i--)
+	/* F*Sx, dense r x n */
+	std::fill(w.B.begin(), w.B.end(), 0.0);
+	for (int j=0; j < n; j++)
 	{
-		setc[t]=data->simulationInfo->setcVars[i-1];
-		tmpsetc[t]=data->simulationInfo->setcVars[i-1];
-		t++;
-		//cout << "array_setc_vars:=>" << t << ":" << data->simulationInfo->setcVars[i-1] << "\n";
+		double * Bj = &w.B[j*r];
+		for (int p=Sx.colptr[j]; p < Sx.colptr[j+1]; p++)
+		{
+			int k = Sx.rowind[p];
+			double s = Sx.data[p];
+			for (int q=F.colptr[k]; q < F.colptr[k+1]; q++)
+			{
+				Bj[F.rowind[q]] += F.data[q]*s;
+			}
+		}
 	}
 
-	int nsetcvars= data->modelData->nSetcVars;
-	matrixData vector_c = {nsetcvars,1,tmpsetc};
-	//allocate data for matrix multiplication F*Sx
-	double * tmpmatrixC = (double*)calloc(jacF.rows*Sx.column,sizeof(double));
-	solveMatrixMultiplication(jacF.data,Sx.data,jacF.rows,jacF.column,Sx.rows,Sx.column,tmpmatrixC,logfile);
-	//printMatrix(tmpmatrixC,jacF.rows,Sx.column,"F*Sx");
-
-	//allocate data for matrix multiplication (F*Sx)*Ftranspose
-	double * tmpmatrixD = (double*)calloc(jacF.rows*jacFt.column,sizeof(double));
-	solveMatrixMultiplication(tmpmatrixC,jacFt.data,jacF.rows,Sx.column,jacFt.rows,jacFt.column,tmpmatrixD,logfile);
-	//printMatrix(tmpmatrixD,jacF.rows,jacFt.column,"F*Sx*Ft");
-	//printMatrix(setc,nsetcvars,1,"c(x,y)");
-	/*
-	 * Copy tmpmatrixC and tmpmatrixD to avoid loss of data
-	 * when calculating F*
-	 */
-	matrixData cpytmpmatrixC = {jacF.rows,Sx.column,tmpmatrixC};
-	matrixData cpytmpmatrixD = {jacF.rows,jacFt.column,tmpmatrixD};
-	matrixData tmpmatrixC1 = copyMatrix(cpytmpmatrixC);
-	matrixData tmpmatrixD1 = copyMatrix(cpytmpmatrixD);
+	/* (F*Sx)*Ft, dense r x r */
+	std::fill(w.A.begin(), w.A.end(), 0.0);
+	for (int k=0; k < n; k++)
+	{
+		const double * Bk = &w.B[k*r];
+		for (int q=F.colptr[k]; q < F.colptr[k+1]; q++)
+		{
+			double * Aj = &w.A[F.rowind[q]*r];
+			double f = F.data[q];
+			for (int i=0; i < r; i++)
+			{
+				Aj[i] += f*Bk[i];
+			}
+		}
+	}
 
 	if(ACTIVE_STREAM(LOG_JAC))
 	{
 		logfile << "Calculations of Matrix (F*Sx*Ft) f* = c(x,y) " << "\n";
 		logfile << "============================================\n";
-		printMatrix(tmpmatrixC,jacF.rows,Sx.column,"F*Sx",logfile);
-		printMatrix(tmpmatrixD,jacF.rows,jacFt.column,"F*Sx*Ft",logfile);
-		printMatrix(setc,nsetcvars,1,"c(x,y)",logfile);
+		printMatrix(&w.B[0],r,n,"F*Sx",logfile);
+		printMatrix(&w.A[0],r,r,"F*Sx*Ft",logfile);
+		printMatrix(&w.c[0],r,1,"c(x,y)",logfile);
 	}
-	/*
-	 * calculate f* for covariance matrix (F*Sx*Ftranspose).F*= c(x,y)
-	 * matrix setc will be overridden with new values which is the output
-	 * for the calculation A *x =B
-	 * A = tmpmatrixD
-	 * B = setc
-	 */
-	solveSystemFstar(jacF.rows,1,tmpmatrixD,setc,logfile);
-	//printMatrix(setc,jacF.rows,1,"f*");
-	if(ACTIVE_STREAM(LOG_JAC))
+
+	/* F*Sx*Ft = L*Lt */
+	dpotrf_(&uplo, &ldr, &w.A[0], &ldr, &info);
+	if(info != 0)
 	{
-		printMatrix(setc,jacF.rows,1,"f*",logfile);
-		logfile << "***** Completed ****** \n\n";
+		logfile << "|  error   |   " << "solveReconciliationStep() Failed !, F*Sx*Ft could not be factorized, The info satus is " << info << "\n";
+		logfile.close();
+		exit(1);
 	}
-	matrixData tmpxcap ={x.rows,1,x.data};
-	matrixData tmpfstar = {jacF.rows,1,setc};
-	matrixData reconciled_X = solveReconciledX(tmpxcap,Sx,jacFt,tmpfstar,logfile);
-	//printMatrix(reconciled_X.data,reconciled_X.rows,reconciled_X.column,"reconciled_X ===> (x - (Sx*Ft*fstar))");
-	if(ACTIVE_STREAM(LOG_JAC))
+
+	/* f* = (F*Sx*Ft)^-1 * c(x,y) */
+	dpotrs_(&uplo, &ldr, &one, &w.A[0], &ldr, &w.fstar[0], &ldr, &info);
+
+	/* recon_x - x = -(Sx*Ft)*f* = -(F*Sx)T*f* */
+	dgemv_(&trans, &ldr, &n, &minusone, &w.B[0], &ldr, &w.fstar[0], &one, &zero, &w.d[0], &one);
+	for (int i=0; i < n; i++)
 	{
-		logfile << "Calculations of Matrix (F*Sx*Ft) F* = F*Sx " << "\n";
-		logfile << "===============================================\n";
-		//printMatrix(tmpmatrixC,jacF.rows,Sx.column,"F*Sx");
-		//printMatrix(tmpmatrixD,jacF.rows,jacFt.column,"F*Sx*Ft");
-		printMatrix(tmpmatrixC1.data,tmpmatrixC1.rows,tmpmatrixC1.column,"F*Sx",logfile);
-		printMatrix(tmpmatrixD1.data,tmpmatrixD1.rows,tmpmatrixD1.column,"F*Sx*Ft",logfile);
+		reconX[i] = x[i] + w.d[i];
 	}
-	/*
-	 * calculate F* for covariance matrix (F*Sx*Ftranspose).F*= (F*Sx)
-	 * tmpmatrixC1 will be overridden with new values which is the output
-	 * for the calculation A *x =B
-	 * A = tmpmatrixD
-	 * B = tmpmatrixC
-	 */
-	solveSystemFstar(jacF.rows,Sx.column,tmpmatrixD1.data,tmpmatrixC1.data,logfile);
-	//printMatrix(tmpmatrixC,jacF.rows,Sx.column,"Sx_F*");
+
 	if(ACTIVE_STREAM(LOG_JAC))
 	{
-		printMatrix(tmpmatrixC1.data,jacF.rows,Sx.column,"F*",logfile);
+		printMatrix(&w.fstar[0],r,1,"f*",logfile);
+		printMatrix(reconX,n,1,"x - (Sx*Ft*f*))",logfile);
 		logfile << "***** Completed ****** \n\n";
 	}
 
-	matrixData tmpFstar = {jacF.rows,Sx.column,tmpmatrixC1.data};
-	matrixData reconciled_Sx = solveReconciledSx(Sx,jacFt,tmpFstar,logfile);
-	//printMatrix(reconciled_Sx.data,reconciled_Sx.rows,reconciled_Sx.column,"reconciled Sx ===> (Sx - (Sx*Ft*Fstar))");
+	/* J* / r */
+	solveSparseMatrixVector(F, &w.d[0], &w.Fd[0]);
+	double value = 0.0;
+	for (int i=0; i < r; i++)
+	{
+		value += (w.Fd[i] + 2.0*w.c[i])*w.fstar[i];
+	}
+	return value/data->modelData->nSetcVars;
+}
+
+/*
+ * Solves the diagonal of the reconciled covariance matrix
+ * recon_Sx = Sx - (Sx*Ft)*(F*Sx*Ft)^-1*(F*Sx)
+ * with the factor L of the last step:
+ * recon_Sx_ii = Sx_ii - ||L^-1*(F*Sx)_i||^2
+ * (F*Sx) in the workspace is overwritten
+ */
+void solveReconciledSxDiagonal(sparseMatrixData & Sx, reconcileWorkspace & w, double * reconSxDiag)
+{
+	char side = 'L', uplo = 'L', trans = 'N', diag = 'N';
+	double alpha = 1.0;
+	int r = w.r, n = w.n;
+
+	dtrsm_(&side, &uplo, &trans, &diag, &r, &n, &alpha, &w.A[0], &r, &w.B[0], &r);
 
-	double value = solveConvergence(data,reconciled_X,reconciled_Sx,x,Sx,jacF,vector_c,tmpfstar,logfile);
-	if(value > eps )
+	getSparseDiagonalElements(Sx, reconSxDiag);
+	for (int j=0; j < n; j++)
 	{
-		logfile << "J*/r" << "(" << value << ")"  << " > " << eps << ", Value not Converged \n";
-		logfile << "==========================================\n\n";
+		const double * Bj = &w.B[j*r];
+		for (int i=0; i < r; i++)
+		{
+			reconSxDiag[j] -= Bj[i]*Bj[i];
+		}
 	}
-	if(value > eps)
+}
+
+/*
+ * Iterates the reconciliation steps until J* / r < eps,
+ * x is overwritten with the reconciled values of the previous step
+ * returns the number of iterations
+ */
+int solveReconciliation(DATA* data, threadData_t *threadData, double * x, double * reconX, sparseMatrixData & F, sparseMatrixData & Sx, reconcileWorkspace & w, double eps, double & value, csvData & csvinputs, bool verbose, ofstream& logfile)
+{
+	int iterationcount = 1;
+
+	value = solveReconciliationStep(data, threadData, x, reconX, F, Sx, w, logfile);
+	while(value > eps)
 	{
-		logfile << "Running Convergence iteration: " << iterationcount << " with the following reconciled values:" << "\n";
-		logfile << "========================================================================" << "\n";
-		//cout << "J*/r :=" << value << "\n";
-		//printMatrix(jacF.data,jacF.rows,jacF.column,"F");
-		//printMatrix(jacFt.data,jacFt.rows,jacFt.column,"Ft");
-		//printMatrix(setc,jacF.rows,1,"f*");
-		//printMatrix(tmpmatrixC,jacF.rows,Sx.column,"F*");
-		printMatrixWithHeaders(reconciled_X.data,reconciled_X.rows,reconciled_X.column,csvinputs.headers,"reconciled_X ===> (x - (Sx*Ft*fstar))",logfile);
-		printMatrixWithHeaders(reconciled_Sx.data,reconciled_Sx.rows,reconciled_Sx.column,csvinputs.headers,"reconciled_Sx ===> (Sx - (Sx*Ft*Fstar))",logfile);
-		//free(x.data);
-		//free(Sx.data);
-		x.data=reconciled_X.data;
-		//Sx.data=reconciled_Sx.data;
+		if(verbose)
+		{
+			logfile << "J*/r" << "(" << value << ")"  << " > " << eps << ", Value not Converged \n";
+			logfile << "==========================================\n\n";
+			logfile << "Running Convergence iteration: " << iterationcount << " with the following reconciled values:" << "\n";
+			logfile << "========================================================================" << "\n";
+			printMatrixWithHeaders(reconX,Sx.rows,1,csvinputs.headers,"reconciled_X ===> (x - (Sx*Ft*fstar))",logfile);
+		}
+		memcpy(x, reconX, Sx.rows*sizeof(double));
 		iterationcount++;
-		return RunReconciliation(data, threadData, x, Sx, jacF, jacFt,eps,iterationcount,csvinputs,xdiag,sxdiag,logfile);
+		value = solveReconciliationStep(data, threadData, x, reconX, F, Sx, w, logfile);
+	}
+	return iterationcount;
+}
+
+int RunReconciliation(DATA* data, threadData_t *threadData, inputData x, sparseMatrixData & Sx, double eps, csvData & csvinputs, matrixData xdiag, matrixData sxdiag, ofstream& logfile)
+{
+	sparseMatrixData jacF;
+	reconcileWorkspace w;
+	double value;
+	double* reconciled_X = (double*)calloc(x.rows,sizeof(double));
+
+	int iterationcount = solveReconciliation(data, threadData, x.data, reconciled_X, jacF, Sx, w, eps, value, csvinputs, true, logfile);
+
+	if(ACTIVE_STREAM(LOG_JAC))
+	{
+		printSparseMatrixWithHeaders(jacF, csvinputs.headers, "F", logfile);
 	}
 	if(value < eps && iterationcount==1)
 	{
@@ -1148,13 +834,18 @@ int RunReconciliation(DATA* data, threadData_t *threadData, inputData x, matrixD
 	{
 		logfile << "***** Value Converged, Convergence Completed******* \n\n";
 	}
+
+	/* diagonal of the reconciled covariance matrix Sx - (Sx*Ft*F*) */
+	double* reconSx_diag = (double*)calloc(x.rows,sizeof(double));
+	solveReconciledSxDiagonal(Sx, w, reconSx_diag);
+
 	logfile << "Final Results:\n";
 	logfile << "=============\n";
 	logfile << "Total Iteration to Converge : " << iterationcount << "\n";
 	logfile << "Final Converged Value(J*/r) : " << value << "\n";
 	logfile << "Epsilon                     : " << eps << "\n";
-	printMatrixWithHeaders(reconciled_X.data,reconciled_X.rows,reconciled_X.column,csvinputs.headers,"reconciled_X ===> (x - (Sx*Ft*fstar))",logfile);
-	printMatrixWithHeaders(reconciled_Sx.data,reconciled_Sx.rows,reconciled_Sx.column,csvinputs.headers,"reconciled_Sx ===> (Sx - (Sx*Ft*Fstar))",logfile);
+	printMatrixWithHeaders(reconciled_X,x.rows,1,csvinputs.headers,"reconciled_X ===> (x - (Sx*Ft*fstar))",logfile);
+	printMatrixWithHeaders(reconSx_diag,x.rows,1,csvinputs.headers,"reconciled_Sx_Diagonal ===> (Sx - (Sx*Ft*Fstar))",logfile);
 
 	/*
 	 * Calculate half width Confidence interval
@@ -1162,54 +853,36 @@ int RunReconciliation(DATA* data, threadData_t *threadData, inputData x, matrixD
 	 * where lamba = 1.96 and
 	 * Sx - diagonal elements of reconciled_Sx
 	 */
-	double* reconSx_diag = (double*)calloc(reconciled_Sx.rows*1,sizeof(double));
-	getDiagonalElements(reconciled_Sx.data,reconciled_Sx.rows,reconciled_Sx.column,reconSx_diag);
-
-	matrixData copyreconSx_diag = {reconciled_Sx.rows,1,reconSx_diag};
-	matrixData tmpcopyreconSx_diag = copyMatrix(copyreconSx_diag);
+	double* halfwidth = (double*)calloc(x.rows,sizeof(double));
+	memcpy(halfwidth, reconSx_diag, x.rows*sizeof(double));
+	calculateSquareRoot(halfwidth,x.rows);
 	if(ACTIVE_STREAM(LOG_JAC))
 	{
 		logfile << "Calculations of HalfWidth Confidence Interval " << "\n";
 		logfile << "===============================================\n";
-		printMatrix(copyreconSx_diag.data,reconciled_Sx.rows,1,"reconciled-Sx_Diagonal",logfile);
-	}
-	calculateSquareRoot(copyreconSx_diag.data,reconciled_Sx.rows);
-	if(ACTIVE_STREAM(LOG_JAC))
-	{
-		printMatrix(copyreconSx_diag.data,reconciled_Sx.rows,1,"reconciled-Sx_SquareRoot",logfile);
+		printMatrix(halfwidth,x.rows,1,"reconciled-Sx_SquareRoot",logfile);
 		logfile << "*****Completed***********\n";
 	}
-	scaleVector(reconciled_Sx.rows,1,1.96,copyreconSx_diag.data);
-	printMatrixWithHeaders(copyreconSx_diag.data,reconciled_Sx.rows,1,csvinputs.headers,"Wx-HalfWidth-Interval-(1.96)*sqrt(Sx_diagonal)",logfile);
-
+	scaleVector(x.rows,1,1.96,halfwidth);
+	printMatrixWithHeaders(halfwidth,x.rows,1,csvinputs.headers,"Wx-HalfWidth-Interval-(1.96)*sqrt(Sx_diagonal)",logfile);
 
 	/*
 	 * Calculate individual tests
 	 * (recon_x - x)/sqrt(Sx-recon_Sx)
 	 */
-	double* newSx_diag = (double*)calloc(reconciled_Sx.rows*1,sizeof(double));
-	solveMatrixSubtraction(sxdiag,tmpcopyreconSx_diag,newSx_diag,logfile);
-	if(ACTIVE_STREAM(LOG_JAC))
+	double* newSx_diag = (double*)calloc(x.rows,sizeof(double));
+	double *newX = (double*)calloc(x.rows,sizeof(double));
+	for (int i=0; i < x.rows; i++)
 	{
-		logfile << "Calculations of Individual Tests " << "\n";
-		logfile << "===============================================\n";
-		printMatrix(newSx_diag,sxdiag.rows,sxdiag.column,"Sx-recon_Sx",logfile);
+		newSx_diag[i] = sqrt(sxdiag.data[i] - reconSx_diag[i]);
+		// calculate absolute value for this numeric analysis
+		newX[i] = fabs(reconciled_X[i] - xdiag.data[i]);
 	}
-	calculateSquareRoot(newSx_diag,reconciled_Sx.rows);
 	if(ACTIVE_STREAM(LOG_JAC))
 	{
+		logfile << "Calculations of Individual Tests " << "\n";
+		logfile << "===============================================\n";
 		printMatrix(newSx_diag,sxdiag.rows,sxdiag.column,"squareroot-newSx",logfile);
-	}
-
-	double *newX = (double*)calloc(xdiag.rows*1,sizeof(double));
-	solveMatrixSubtraction(reconciled_X,xdiag,newX,logfile);
-	// calculate absolute value for this numeric analysis
-	for (unsigned int a=0; a < sizeof(newX); a++)
-	{
-		newX[a] = fabs(newX[a]);
-	}
-	if(ACTIVE_STREAM(LOG_JAC))
-	{
 		printMatrix(newX,xdiag.rows,xdiag.column,"recon_X - X",logfile);
 		logfile << "*********Completed***********\n";
 	}
@@ -1298,14 +971,14 @@ int RunReconciliation(DATA* data, threadData_t *threadData, inputData x, matrixD
 		csvfile << csvinputs.headers[r] << ",";
 		myfile << "<td>" << xdiag.data[r] << "</td>\n";
 		csvfile << xdiag.data[r] << ",";
-		myfile << "<td>" << reconciled_X.data[r] << "</td>\n";
-		csvfile << reconciled_X.data[r] << ",";
+		myfile << "<td>" << reconciled_X[r] << "</td>\n";
+		csvfile << reconciled_X[r] << ",";
 
 		myfile << "<td>" << csvinputs.sxdata[r] << "</td>\n";
 		csvfile << csvinputs.sxdata[r] << ",";
 
-		myfile << "<td>" << copyreconSx_diag.data[r] << "</td>\n";
-		csvfile << copyreconSx_diag.data[r] << ",";
+		myfile << "<td>" << halfwidth[r] << "</td>\n";
+		csvfile << halfwidth[r] << ",";
 
 		if(newX[r] < 1.96)
 		{
@@ -1331,21 +1004,108 @@ int RunReconciliation(DATA* data, threadData_t *threadData, inputData x, matrixD
 	myfile << "</body>\n</html>";
 	myfile.close();
 
-	free(tmpFstar.data);
-	free(tmpfstar.data);
-	//free(tmpmatrixC);
-	//free(tmpmatrixD);
-	//free(setc);
-	free(reconciled_Sx.data);
-	free(reconciled_X.data);
-	free(copyreconSx_diag.data);
-	free(tmpcopyreconSx_diag.data);
+	free(reconciled_X);
+	free(reconSx_diag);
+	free(halfwidth);
 	free(newSx_diag);
 	free(newX);
-	//free(jacF.data);
-	//free(jacFt.data);
-	//free(x.data);
-	//free(Sx.data);
+	return 0;
+}
+
+/*
+ * Online reconciliation of a stream of measurement sets
+ * read line by line from the csv file given by -sxBatch.
+ * The header line contains the names of the measured variables,
+ * variables of the -sx file without a column keep their value.
+ * The structure of F and all buffers are shared by the sets.
+ */
+int RunReconciliationBatch(DATA* data, threadData_t *threadData, const char * filename, inputData x, sparseMatrixData & Sx, double eps, csvData & csvinputs, ofstream& logfile)
+{
+	sparseMatrixData jacF;
+	reconcileWorkspace w;
+	vector<int> pos;
+	string line, temp;
+	double value;
+	int setcount = 0;
+	double* setX = (double*)calloc(x.rows,sizeof(double));
+	double* reconciled_X = (double*)calloc(x.rows,sizeof(double));
+
+	ifstream ip(filename);
+	if(!ip.good())
+	{
+		logfile << "|  error   |   " << "file name not found " << filename << "\n";
+		logfile.close();
+		exit(1);
+	}
+
+	/* header with the names of the measured variables */
+	getline(ip,line);
+	std::replace(line.begin(), line.end(), ';', ' ');
+	std::replace(line.begin(), line.end(), ',', ' ');
+	stringstream header(line);
+	while(header >> temp)
+	{
+		pos.push_back(getVariableIndex(csvinputs.headers,temp,logfile));
+	}
+
+	/* create a csv file */
+	ofstream csvfile;
+	std::stringstream csv_file;
+	if (omc_flag[FLAG_OUTPUT_PATH])
+	{
+		csv_file << string(omc_flagValue[FLAG_OUTPUT_PATH]) << "/" << data->modelData->modelName << "_Batch_Outputs.csv";
+	}
+	else
+	{
+		csv_file << data->modelData->modelName <<"_Batch_Outputs.csv";
+	}
+	string tmpcsv= csv_file.str();
+	csvfile.open(tmpcsv.c_str());
+	csvfile << "Set ," << "Number of Iteration to Converge ," << "Final Converged Value(J*/r) ";
+	for (unsigned int r=0; r < csvinputs.headers.size(); r++)
+	{
+		csvfile << "," << csvinputs.headers[r];
+	}
+	csvfile << "\n";
+
+	while(getline(ip,line))
+	{
+		if(line.empty())
+		{
+			continue;
+		}
+		std::replace(line.begin(), line.end(), ';', ' ');
+		std::replace(line.begin(), line.end(), ',', ' ');
+		stringstream ss(line);
+		unsigned int k = 0;
+		memcpy(setX, x.data, x.rows*sizeof(double));
+		while(ss >> temp && k < pos.size())
+		{
+			setX[pos[k++]] = atof(temp.c_str());
+		}
+		setcount++;
+		if(k != pos.size())
+		{
+			logfile << "|  warning |   " << filename << " line " << setcount+1 << " has " << k << " values, expected " << pos.size() << ", set skipped\n";
+			continue;
+		}
+
+		int iterationcount = solveReconciliation(data, threadData, setX, reconciled_X, jacF, Sx, w, eps, value, csvinputs, false, logfile);
+		logfile << "|  info    |   " << "Set " << setcount << ": " << iterationcount << " iterations, J*/r = " << value << "\n";
+
+		csvfile << setcount << "," << iterationcount << "," << value;
+		for (int r=0; r < x.rows; r++)
+		{
+			csvfile << "," << reconciled_X[r];
+		}
+		csvfile << "\n";
+		csvfile.flush();
+	}
+	csvfile.close();
+	logfile << "|  info    |   " << "DataReconciliation of " << setcount << " measurement sets written to " << tmpcsv << "\n";
+
+	free(setX);
+	free(reconciled_X);
 	return 0;
 }
 
@@ -1382,37 +1142,36 @@ int dataReconciliation(DATA* data, threadData_t *threadData)
 		exit(1);
 	}
 	csvData Sx_data = readCovarianceMatrixSx(data, threadData,logfile);
-	//matrixData Sx = getCovarianceMatrixSx(Sx_data, data, threadData); // Prepare the data from csv file *
-	matrixData Sx = computeCovarianceMatrixSx(Sx_data,data,threadData,logfile); // Compute the covariance matrix from csv inputs
+	sparseMatrixData Sx = computeCovarianceMatrixSx(Sx_data,logfile); // Compute the covariance matrix from csv inputs
 	inputData x = getInputDataFromStartAttribute(Sx_data, data, threadData, logfile);  // Read the inputs from the start attribute of the modelica model
-	matrixData jacF = getJacobianMatrixF(data, threadData, logfile); // Compute the Jacobian Matrix F
-	matrixData jacFt = getTransposeMatrix(jacF); // Compute the Transpose of jacobian Matrix F
 
 	double* Sx_diag = (double*)calloc(Sx.rows*1,sizeof(double));
-	getDiagonalElements(Sx.data,Sx.rows,Sx.column,Sx_diag);
+	getSparseDiagonalElements(Sx,Sx_diag);
 	matrixData tmpSx_diag={Sx.rows,1,Sx_diag};
 
-	matrixData tmp_x={x.rows,x.column,x.data};
-	matrixData x_diag=copyMatrix(tmp_x);
+	double* x_copy = (double*)calloc(x.rows*x.column,sizeof(double));
+	memcpy(x_copy, x.data, x.rows*x.column*sizeof(double));
+	matrixData x_diag={x.rows,x.column,x_copy};
 
 	// Print the initial information
 	logfile << "\n\nInitial Data \n" << "=============\n";
 	printMatrixWithHeaders(x.data,x.rows,x.column,Sx_data.headers,"X",logfile);
 	printVectorMatrixWithHeaders(Sx_data.sxdata,Sx_data.rowcount,1,Sx_data.headers,"Half-WidthConfidenceInterval",logfile);
-	printMatrixWithHeaders(Sx.data,Sx.rows,Sx.column,Sx_data.headers,"Sx",logfile);
-	//printMatrix(Sx_diag,Sx.rows,1,"Sx-Diagonal elements",logfile);
+	printSparseMatrixWithHeaders(Sx,Sx_data.headers,"Sx",logfile);
 
-	//printMatrix(jacF.data,jacF.rows,jacF.column,"F",logfile);
-	//printMatrix(jacFt.data,jacFt.rows,jacFt.column,"Ft",logfile);
 	// Start the Algorithm
-	RunReconciliation(data,threadData,x,Sx,jacF,jacFt,atof(epselon),1,Sx_data,x_diag,tmpSx_diag,logfile);
+	if(omc_flagValue[FLAG_DATA_RECONCILE_BATCH])
+	{
+		RunReconciliationBatch(data,threadData,omc_flagValue[FLAG_DATA_RECONCILE_BATCH],x,Sx,atof(epselon),Sx_data,logfile);
+	}
+	else
+	{
+		RunReconciliation(data,threadData,x,Sx,atof(epselon),Sx_data,x_diag,tmpSx_diag,logfile);
+	}
 	logfile << "|  info    |   " << "DataReconciliation Completed! \n";
 	logfile.flush();
 	logfile.close();
-	free(Sx.data);
 	free(x.data);
-	free(jacF.data);
-	free(jacFt.data);
 	free(tmpSx_diag.data);
 	free(x_diag.data);
 	TRACE_POP
@@ -42,6 +42,9 @@
 #include "../util/omc_error.h"
 #include "../util/omc_file.h"
 #include "../util/omc_init.h"
+#if !(defined(OMC_MINIMAL_RUNTIME) || defined(OMC_FMI_RUNTIME))
+#include "../util/rtclock.h"
+#endif
 
 static mmc_GC_state_type x_mmc_GC_state = {0};
 mmc_GC_state_type *mmc_GC_state = &x_mmc_GC_state;
@@ -125,4 +128,66 @@ size_t omc_GC_get_max_heap_size()
 {
   return max_heap_size;
 }
+
+/* Collection statistics; the collection event callback is invoked with the
+ * allocation lock held, so the counters need no additional synchronization */
+#if ((GC_VERSION_MAJOR == 7) && (GC_VERSION_MINOR >= 6)) || (GC_VERSION_MAJOR >= 8)
+static rtclock_t gc_pause_start;
+static double gc_pause_total = 0.0;
+static double gc_pause_max = 0.0;
+
+static void omc_GC_on_collection_event(GC_EventType event)
+{
+  double t;
+  switch (event) {
+  case GC_EVENT_START:
+    rt_ext_tp_tick(&gc_pause_start);
+    break;
+  case GC_EVENT_END:
+    t = rt_ext_tp_tock(&gc_pause_start);
+    gc_pause_total += t;
+    if (t > gc_pause_max) {
+      gc_pause_max = t;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void omc_GC_enable_statistics()
+{
+  GC_set_on_collection_event(omc_GC_on_collection_event);
+}
+double omc_GC_get_pause_time()
+{
+  return gc_pause_total;
+}
+double omc_GC_get_max_pause_time()
+{
+  return gc_pause_max;
+}
+#else /* GC_set_on_collection_event NOT available */
+void omc_GC_enable_statistics()
+{
+}
+double omc_GC_get_pause_time()
+{
+  return 0.0;
+}
+double omc_GC_get_max_pause_time()
+{
+  return 0.0;
+}
+#endif
+
+void omc_GC_set_tuning(int incremental, int freeSpaceDivisor)
+{
+  if (freeSpaceDivisor > 0) {
+    GC_set_free_space_divisor(freeSpaceDivisor);
+  }
+  if (incremental) {
+    GC_enable_incremental();
+  }
+}
 #endif
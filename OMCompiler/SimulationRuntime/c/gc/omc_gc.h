@@ -178,6 +178,10 @@ static inline void* mmc_check_out_of_memory(void *ptr)
 #define GC_set_force_unmap_on_gcollect    /* nothing */
 #define omc_GC_set_max_heap_size(X)       /* nothing */
 #define omc_GC_get_max_heap_size()        0
+#define omc_GC_enable_statistics()        /* nothing */
+#define omc_GC_get_pause_time()           0.0
+#define omc_GC_get_max_pause_time()       0.0
+#define omc_GC_set_tuning(X,Y)            /* nothing */
 #endif
 
 #else /* #if (defined(OMC_MINIMAL_RUNTIME) || defined(OMC_FMI_RUNTIME)) */
@@ -191,6 +195,12 @@ int GC_pthread_join(pthread_t, void **);
 
 void omc_GC_set_max_heap_size(size_t);
 size_t omc_GC_get_max_heap_size();
+/* Records the number of seconds spent in collections (see omc_GC_get_pause_time) */
+void omc_GC_enable_statistics();
+double omc_GC_get_pause_time();
+double omc_GC_get_max_pause_time();
+/* Enables incremental collection and sets the free space divisor if it is >0 */
+void omc_GC_set_tuning(int incremental, int freeSpaceDivisor);
 
 #endif /* #if (defined(OMC_MINIMAL_RUNTIME) || defined(OMC_FMI_RUNTIME)) */
 
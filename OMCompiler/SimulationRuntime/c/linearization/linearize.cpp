@@ -35,10 +35,13 @@
 #include "simulation/solver/external_input.h"
 #include "simulation/options.h"
 #include "simulation/solver/model_help.h"
+#include "simulation/solver/jacobianSymbolical.h"
+#include "simulation/results/MatVer4.h"
 #include "linearize.h"
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -68,6 +71,99 @@ static string array2string(double* array, int row, int col)
   return retVal.str();
 }
 
+/* matrix in compressed sparse column format, leadindex has cols+1 entries */
+typedef struct
+{
+  int rows;
+  int cols;
+  vector<unsigned int> leadindex;
+  vector<unsigned int> index;
+  vector<double> values;
+} sparseMatrix;
+
+static void initSparseMatrix(sparseMatrix& matrix, int rows, int cols)
+{
+  matrix.rows = rows;
+  matrix.cols = cols;
+  matrix.leadindex.assign(cols+1, 0);
+  matrix.index.clear();
+  matrix.values.clear();
+}
+
+/* append the nonzero elements of a dense column, columns have to be appended in order */
+static void appendSparseColumn(sparseMatrix& matrix, int col, const double* column)
+{
+  int i;
+  for(i=0; i<matrix.rows; i++)
+  {
+    if(column[i] != 0.0)
+    {
+      matrix.index.push_back(i);
+      matrix.values.push_back(column[i]);
+    }
+  }
+  matrix.leadindex[col+1] = matrix.index.size();
+}
+
+static string sparse2string(const sparseMatrix& matrix)
+{
+  unsigned int i, nth;
+  double* dense = (double*)calloc(matrix.rows*matrix.cols+1,sizeof(double));
+  string retVal;
+
+  for(i=0; i<matrix.cols; i++)
+  {
+    for(nth=matrix.leadindex[i]; nth<matrix.leadindex[i+1]; nth++)
+    {
+      dense[i*matrix.rows+matrix.index[nth]] = matrix.values[nth];
+    }
+  }
+  retVal = array2string(dense, matrix.rows, matrix.cols);
+  free(dense);
+  return retVal;
+}
+
+/* write a sparse matrix as MAT v4 sparse matrix, i.e. the 1-based triplets (row, col, value)
+ * followed by the triplet (rows, cols, 0) holding the dimensions */
+static void writeSparseMatrix_matVer4(FILE* fout, const char* name, const sparseMatrix& matrix)
+{
+  unsigned int i, nth;
+  size_t nnz = matrix.values.size();
+  vector<double> triplets(3*(nnz+1));
+
+  for(i=0; i<matrix.cols; i++)
+  {
+    for(nth=matrix.leadindex[i]; nth<matrix.leadindex[i+1]; nth++)
+    {
+      triplets[nth] = matrix.index[nth]+1;
+      triplets[nnz+1+nth] = i+1;
+      triplets[2*(nnz+1)+nth] = matrix.values[nth];
+    }
+  }
+  triplets[nnz] = matrix.rows;
+  triplets[2*nnz+1] = matrix.cols;
+  triplets[3*nnz+2] = 0.0;
+
+  writeMatrix_matVer4(fout, name, nnz+1, 3, &triplets[0], MatVer4Type_SPARSE);
+}
+
+static void printSparseMatrix(const sparseMatrix& matrix, const char* name)
+{
+  unsigned int i, nth;
+  if(ACTIVE_STREAM(LOG_JAC))
+  {
+    infoStreamPrint(LOG_JAC, 1, "Print jac %s (%d x %d, %d nonzero elements):", name, matrix.rows, matrix.cols, (int) matrix.values.size());
+    for(i=0; i<matrix.cols; i++)
+    {
+      for(nth=matrix.leadindex[i]; nth<matrix.leadindex[i+1]; nth++)
+      {
+        infoStreamPrint(LOG_JAC, 0, "%s[%d,%d] = %g", name, matrix.index[nth], i, matrix.values[nth]);
+      }
+    }
+    messageClose(LOG_JAC);
+  }
+}
+
 extern "C" {
 
 int functionODE_residual(DATA* data, threadData_t *threadData, double *dx, double *dy, double *dz)
@@ -113,8 +209,9 @@ int functionODE_residual(DATA* data, threadData_t *threadData, double *dx, doubl
     return 0;
 }
 
-/*  Calculate the jacobian matrix by numerical finite difference */
-int functionJacAC_num(DATA* data, threadData_t *threadData, double *matrixA, double *matrixC, double *matrixCz)
+/*  Calculate the jacobian matrix by numerical finite difference,
+ *  only the nonzero elements are stored */
+static int functionJacAC_num(DATA* data, threadData_t *threadData, sparseMatrix& matrixA, sparseMatrix& matrixC, sparseMatrix* matrixCz)
 {
     const double delta_h = numericalDifferentiationDeltaXlinearize;
     double delta_hh;
@@ -122,7 +219,7 @@ int functionJacAC_num(DATA* data, threadData_t *threadData, double *matrixA, dou
 
     double* x;
 
-    int i,j,k;
+    int i,j;
 
     int do_data_recovery = 0;
 
@@ -154,6 +251,12 @@ int functionJacAC_num(DATA* data, threadData_t *threadData, double *matrixA, dou
         assertStreamPrint(threadData,0!=z1,"calloc failed");
     }
 
+    initSparseMatrix(matrixA, size_A, size_A);
+    initSparseMatrix(matrixC, size_C, size_A);
+    if(do_data_recovery > 0){
+        initSparseMatrix(*matrixCz, size_z, size_A);
+    }
+
     functionODE_residual(data, threadData, x0, y0, z0);
 
     x = data->localData[0]->realVars;
@@ -176,22 +279,25 @@ int functionJacAC_num(DATA* data, threadData_t *threadData, double *matrixA, dou
         functionODE_residual(data, threadData, x1, y1, z1);
 
         for(j = 0; j < size_A; j++) {
-            k = i * size_A + j;
-            matrixA[k] = (x1[j] - x0[j]) * delta_hh;
+            x1[j] = (x1[j] - x0[j]) * delta_hh;
         }
+        appendSparseColumn(matrixA, i, x1);
         for(j = 0; j < size_C; j++) {
-            k = i * size_C + j;
-            matrixC[k] = (y1[j] - y0[j]) * delta_hh;
+            y1[j] = (y1[j] - y0[j]) * delta_hh;
         }
+        appendSparseColumn(matrixC, i, y1);
         if(do_data_recovery > 0){
             for(j = 0; j < size_z; j++) {
-                k = i * size_z + j;
-                matrixCz[k] = (z1[j] - z0[j]) * delta_hh;
+                z1[j] = (z1[j] - z0[j]) * delta_hh;
             }
+            appendSparseColumn(*matrixCz, i, z1);
         }
         x[i] = xsave;
     }
 
+    /* restore the variables of the unperturbed states, the simulation may continue */
+    functionODE_residual(data, threadData, x1, y1, z1);
+
     free(xScaling);
     free(x0);
     free(y0);
@@ -205,14 +311,14 @@ int functionJacAC_num(DATA* data, threadData_t *threadData, double *matrixA, dou
     return 0;
 }
 
-int functionJacBD_num(DATA* data, threadData_t *threadData, double *matrixB, double *matrixD, double *matrixDz)
+static int functionJacBD_num(DATA* data, threadData_t *threadData, sparseMatrix& matrixB, sparseMatrix& matrixD, sparseMatrix* matrixDz)
 {
     const double delta_h = numericalDifferentiationDeltaXlinearize;
     double delta_hh;
     double usave;
     double* u;
 
-    int i,j,k;
+    int i,j;
 
     int do_data_recovery = 0;
     if(matrixDz){
@@ -242,6 +348,12 @@ int functionJacBD_num(DATA* data, threadData_t *threadData, double *matrixB, dou
         assertStreamPrint(threadData,0!=z1,"calloc failed");
     }
 
+    initSparseMatrix(matrixB, size_x, size_u);
+    initSparseMatrix(matrixD, size_y, size_u);
+    if(do_data_recovery > 0){
+        initSparseMatrix(*matrixDz, size_z, size_u);
+    }
+
     functionODE_residual(data, threadData, x0, y0, z0);
 
     u = data->simulationInfo->inputVars;
@@ -256,22 +368,25 @@ int functionJacBD_num(DATA* data, threadData_t *threadData, double *matrixB, dou
         functionODE_residual(data, threadData, x1, y1, z1);
 
         for(j = 0; j < size_x; j++) {
-            k = i * size_x + j;
-            matrixB[k] = (x1[j] - x0[j]) * delta_hh;
+            x1[j] = (x1[j] - x0[j]) * delta_hh;
         }
+        appendSparseColumn(matrixB, i, x1);
         for(j = 0; j < size_y; j++) {
-            k = i * size_y + j;
-            matrixD[k] = (y1[j] - y0[j]) * delta_hh;
+            y1[j] = (y1[j] - y0[j]) * delta_hh;
         }
+        appendSparseColumn(matrixD, i, y1);
         if(do_data_recovery > 0){
             for(j = 0; j < size_z; j++) {
-                k = i * size_z + j;
-                matrixDz[k] = (z1[j] - z0[j]) * delta_hh;
+                z1[j] = (z1[j] - z0[j]) * delta_hh;
             }
+            appendSparseColumn(*matrixDz, i, z1);
         }
         u[i] = usave;
     }
 
+    /* restore the variables of the unperturbed inputs, the simulation may continue */
+    functionODE_residual(data, threadData, x1, y1, z1);
+
     free(x0);
     free(y0);
     free(x1);
@@ -284,241 +399,108 @@ int functionJacBD_num(DATA* data, threadData_t *threadData, double *matrixB, dou
     return 0;
 }
 
-
-/*  Calculate the jacobian matrix by analytical finite difference */
-int functionJacA(DATA* data, threadData_t *threadData, double* jac){
-
-  const int index = data->callback->INDEX_JAC_A;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-  unsigned int i,j,k;
-  k = 0;
-  if (jacobian->constantEqns != NULL) {
-    jacobian->constantEqns(data, threadData, jacobian, NULL);
-  }
-
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
-    {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++)
-      {
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-      }
-    }
-
-    data->callback->functionJacA_column(data, threadData, jacobian, NULL);
-
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0,"write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
-  {
-    infoStreamPrint(LOG_JAC,0,"Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++) {
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      }
-      printf("\n");
-    }
-  }
-
-  return 0;
+static void setJacElementLinearize(int row, int col, int nth, double value, void* values, int rows)
+{
+  (void) row; (void) col; (void) rows; /* Unused, needed to match genericColoredSymbolicJacobianColumnEvaluation */
+  ((double*) values)[nth] = value;
 }
-int functionJacB(DATA* data, threadData_t *threadData, double* jac){
-
-  const int index = data->callback->INDEX_JAC_B;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-
-  unsigned int i,j,k;
-  k = 0;
-  if (jacobian->constantEqns != NULL) {
-    jacobian->constantEqns(data, threadData, jacobian, NULL);
-  }
-
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
-    {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++)
-      {
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-      }
-    }
-
-    data->callback->functionJacB_column(data, threadData, jacobian, NULL);
-
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0,"write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
-  {
-    infoStreamPrint(LOG_JAC, 0, "Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++)
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      printf("\n");
-    }
-  }
 
-  return 0;
-}
-int functionJacC(DATA* data, threadData_t *threadData, double* jac){
+/*  Calculate one of the matrices A, B, C or D by the symbolic jacobian.
+ *  If a sparse pattern is available all columns of one color are evaluated at once,
+ *  in parallel if the runtime is compiled with USE_PARJAC */
+static int functionJacSymbolic(DATA* data, threadData_t *threadData, ANALYTIC_JACOBIAN* jacobian,
+                               int (*jacobianColumn)(void*, threadData_t*, ANALYTIC_JACOBIAN*, ANALYTIC_JACOBIAN*),
+                               sparseMatrix& matrix, const char* name)
+{
+  SPARSE_PATTERN* spp = jacobian->sparsePattern;
+  unsigned int i;
 
-  const int index = data->callback->INDEX_JAC_C;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-  unsigned int i,j,k;
-  k = 0;
+  initSparseMatrix(matrix, jacobian->sizeRows, jacobian->sizeCols);
   if (jacobian->constantEqns != NULL) {
     jacobian->constantEqns(data, threadData, jacobian, NULL);
   }
 
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
-    {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++)
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-    }
-
-    data->callback->functionJacC_column(data, threadData, jacobian, NULL);
-
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0,"write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
+  if (spp != NULL && spp->maxColors > 0)
   {
-    infoStreamPrint(LOG_JAC, 0, "Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++)
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      printf("\n");
-    }
-  }
+    ANALYTIC_JACOBIAN* t_jac = jacobian;
 
-  return 0;
-}
-int functionJacD(DATA* data, threadData_t *threadData, double* jac){
-
-  const int index = data->callback->INDEX_JAC_D;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-  unsigned int i,j,k;
-  k = 0;
-  if (jacobian->constantEqns != NULL) {
-    jacobian->constantEqns(data, threadData, jacobian, NULL);
-  }
+    matrix.leadindex.assign(spp->leadindex, spp->leadindex + jacobian->sizeCols + 1);
+    matrix.index.assign(spp->index, spp->index + spp->numberOfNoneZeros);
+    matrix.values.assign(spp->numberOfNoneZeros, 0.0);
 
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
+    if (spp->numberOfNoneZeros > 0)
     {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++) {
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
+#ifdef USE_PARJAC
+      allocateThreadLocalJacobiansOf(jacobian, &t_jac);
+      /* the thread local jacobians need the results of the constant equations */
+      for (i = 0; i < omc_get_max_threads(); i++) {
+        memcpy(t_jac[i].tmpVars, jacobian->tmpVars, jacobian->sizeTmpVars*sizeof(double));
       }
+#endif
+      genericColoredSymbolicJacobianColumnEvaluation(jacobian->sizeRows, jacobian->sizeCols, spp, &matrix.values[0], t_jac,
+                                                     data, threadData, jacobianColumn, setJacElementLinearize);
+#ifdef USE_PARJAC
+      freeAnalyticalJacobian(&t_jac);
+#endif
     }
-
-    data->callback->functionJacD_column(data, threadData, jacobian, NULL);
-
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0, "write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
   }
-  if(ACTIVE_STREAM(LOG_JAC))
+  else
   {
-    infoStreamPrint(LOG_JAC, 0, "Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
+    for(i=0; i < jacobian->sizeCols; i++)
     {
-      for(j=0;  j < jacobian->sizeCols;j++)
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      printf("\n");
+      jacobian->seedVars[i] = 1.0;
+      jacobianColumn(data, threadData, jacobian, NULL);
+      appendSparseColumn(matrix, i, jacobian->resultVars);
+      jacobian->seedVars[i] = 0.0;
     }
   }
 
+  printSparseMatrix(matrix, name);
   return 0;
 }
 
-
-
 int linearize(DATA* data, threadData_t *threadData)
 {
     TRACE_PUSH
+
     /* Check if data recovery is requested */
     int do_data_recovery = omc_flag[FLAG_L_DATA_RECOVERY] ? 1 : 0;
+    int do_sparse = omc_flag[FLAG_L_SPARSE] ? 1 : 0;
+    int linIndex = data->simulationInfo->nextLinearizeTime;
+    /* symbolic jacobians A, B, C and D are initialized at the first linearization time point */
+    int *symbolicJacobianAvailable = data->simulationInfo->linearizeSymbolicJacobian;
+    double linTime = data->simulationInfo->nLinearizeTimes > 1 ? data->localData[0]->timeValue : data->simulationInfo->stopTime;
 
     /* init linearization sizes */
     int size_A = data->modelData->nStates;
     int size_Inputs = data->modelData->nInputVars;
     int size_Outputs = data->modelData->nOutputVars;
     int size_z = data->modelData->nVariablesReal - 2*data->modelData->nStates;
-    double* matrixA = (double*)calloc(size_A*size_A,sizeof(double));
-    double* matrixB = (double*)calloc(size_A*size_Inputs,sizeof(double));
-    double* matrixC = (double*)calloc(size_Outputs*size_A,sizeof(double));
-    double* matrixD = (double*)calloc(size_Outputs*size_Inputs,sizeof(double));
-    double* matrixCz = 0;
-    double* matrixDz = 0;
+    sparseMatrix matrixA, matrixB, matrixC, matrixD, matrixCz, matrixDz;
+    vector<double> z0;
     string strA, strB, strC, strD, strCz, strDz, strX, strU, strZ0, filename, ext;
-	std::size_t pos, pos1, pos2;
+    ostringstream basename(ostringstream::out);
 
-    assertStreamPrint(threadData,0!=matrixA,"calloc failed");
-    assertStreamPrint(threadData,0!=matrixB,"calloc failed");
-    assertStreamPrint(threadData,0!=matrixC,"calloc failed");
-    assertStreamPrint(threadData,0!=matrixD,"calloc failed");
-
-    if(do_data_recovery > 0){
-        matrixCz = (double*)calloc(size_z*size_A,sizeof(double));
-        matrixDz = (double*)calloc(size_z*size_Inputs,sizeof(double));
-        assertStreamPrint(threadData,0!=matrixCz,"calloc failed");
-        assertStreamPrint(threadData,0!=matrixDz,"calloc failed");
-    }
+    initSparseMatrix(matrixA, size_A, size_A);
+    initSparseMatrix(matrixB, size_A, size_Inputs);
+    initSparseMatrix(matrixC, size_Outputs, size_A);
+    initSparseMatrix(matrixD, size_Outputs, size_Inputs);
 
     /* Need to do this before changing anything so that we get a proper z0 */
     if(do_data_recovery > 0){
-        if(size_z){
-            strZ0 = "{" + array2string(&data->localData[0]->realVars[2*size_A],1,size_z) + "}";
-        }else{
-            strZ0 = "zeros(0)";
-        }
+        z0.assign(&data->localData[0]->realVars[2*size_A], &data->localData[0]->realVars[2*size_A] + size_z);
     }
 
     /* Can currently only extract data recovery matrices Cz and Dz numerically, so we do this first if necessary */
     if(do_data_recovery > 0 || data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sizeTmpVars == 0){
         /* Calculate numeric Jacobian */
-        if(functionJacAC_num(data, threadData, matrixA, matrixC, matrixCz))
+        if(functionJacAC_num(data, threadData, matrixA, matrixC, do_data_recovery > 0 ? &matrixCz : NULL))
         {
             throwStreamPrint(threadData, "Error, can not get Matrix A or C ");
             TRACE_POP
             return 1;
         }
-        if(functionJacBD_num(data, threadData, matrixB, matrixD, matrixDz))
+        if(functionJacBD_num(data, threadData, matrixB, matrixD, do_data_recovery > 0 ? &matrixDz : NULL))
         {
             throwStreamPrint(threadData, "Error, can not get Matrix B or D ");
             TRACE_POP
@@ -528,85 +510,111 @@ int linearize(DATA* data, threadData_t *threadData)
 
     /* Check if symbolic Jacobian available, if it is then use it (overwriting A,B,C,D if also doing data recovery) */
     if (data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sizeTmpVars > 0){
-        /* Retrieve symbolic Jacobian */
-        /* Determine Matrix A */
-        ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A]);
-        if(!data->callback->initialAnalyticJacobianA(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacA(data, threadData, matrixA),"Error, can not get Matrix A ");
+        ANALYTIC_JACOBIAN* jacA = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A]);
+        ANALYTIC_JACOBIAN* jacB = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_B]);
+        ANALYTIC_JACOBIAN* jacC = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_C]);
+        ANALYTIC_JACOBIAN* jacD = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_D]);
+
+        if(linIndex == 0){
+            symbolicJacobianAvailable[0] = !data->callback->initialAnalyticJacobianA(data, threadData, jacA);
+            symbolicJacobianAvailable[1] = !data->callback->initialAnalyticJacobianB(data, threadData, jacB);
+            symbolicJacobianAvailable[2] = !data->callback->initialAnalyticJacobianC(data, threadData, jacC);
+            symbolicJacobianAvailable[3] = !data->callback->initialAnalyticJacobianD(data, threadData, jacD);
         }
 
-        /* Determine Matrix B */
-        jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_B]);
-        if(!data->callback->initialAnalyticJacobianB(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacB(data, threadData, matrixB),"Error, can not get Matrix B ");
+        /* Retrieve symbolic Jacobian */
+        if(symbolicJacobianAvailable[0]){
+            assertStreamPrint(threadData,0==functionJacSymbolic(data, threadData, jacA, data->callback->functionJacA_column, matrixA, "A"),"Error, can not get Matrix A ");
         }
-
-        /* Determine Matrix C */
-        jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_C]);
-        if(!data->callback->initialAnalyticJacobianC(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacC(data, threadData, matrixC),"Error, can not get Matrix C ");
+        if(symbolicJacobianAvailable[1]){
+            assertStreamPrint(threadData,0==functionJacSymbolic(data, threadData, jacB, data->callback->functionJacB_column, matrixB, "B"),"Error, can not get Matrix B ");
         }
-
-        /* Determine Matrix D */
-        jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_D]);
-        if(!data->callback->initialAnalyticJacobianD(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacD(data, threadData, matrixD),"Error, can not get Matrix D ");
+        if(symbolicJacobianAvailable[2]){
+            assertStreamPrint(threadData,0==functionJacSymbolic(data, threadData, jacC, data->callback->functionJacC_column, matrixC, "C"),"Error, can not get Matrix C ");
+        }
+        if(symbolicJacobianAvailable[3]){
+            assertStreamPrint(threadData,0==functionJacSymbolic(data, threadData, jacD, data->callback->functionJacD_column, matrixD, "D"),"Error, can not get Matrix D ");
         }
     }
 
-    strA = array2string(matrixA,size_A,size_A);
-    strB = array2string(matrixB,size_A,size_Inputs);
-    strC = array2string(matrixC,size_Outputs,size_A);
-    strD = array2string(matrixD,size_Outputs,size_Inputs);
-    if(do_data_recovery > 0){
-        strCz = array2string(matrixCz,size_z,size_A);
-        strDz = array2string(matrixDz,size_z,size_Inputs);
+    /* ticket #5927: Don't use the model name to prevent bad names for certain languages. */
+    basename << "linearized_model";
+    if(data->simulationInfo->nLinearizeTimes > 1){
+        basename << "_" << (linIndex + 1);
     }
 
-    // The empty array {} is not valid modelica, so we need to put something
-    //   inside the curly braces for x0 and u0. {for i in in 1:0} will create an
-    //   empty array if needed.
-    if(size_A)
-      strX = "{" + array2string(data->localData[0]->realVars, 1, size_A) + "}";
-    else
-      strX = "zeros(0)";
-
-    if(size_Inputs)
-      strU = "{" + array2string(data->simulationInfo->inputVars, 1, size_Inputs) + "}";
-    else
-      strU = "zeros(0)";
-
-    free(matrixA);
-    free(matrixB);
-    free(matrixC);
-    free(matrixD);
-    if(do_data_recovery > 0){
-        free(matrixCz);
-        free(matrixDz);
-    }
-    switch(data->modelData->linearizationDumpLanguage){
-      case OMC_LINEARIZE_DUMP_LANGUAGE_MODELICA: ext = ".mo";  break;
-      case OMC_LINEARIZE_DUMP_LANGUAGE_MATLAB: ext = ".m";   break;
-      case OMC_LINEARIZE_DUMP_LANGUAGE_JULIA: ext = ".jl";  break;
-      case OMC_LINEARIZE_DUMP_LANGUAGE_PYTHON: ext = ".py";  break;
-    }
-    /* ticket #5927: Don't use the model name to prevent bad names for certain languages. */
-    filename = "linearized_model" + string(ext);
+    if(do_sparse > 0){
+        filename = basename.str() + ".mat";
+        FILE *fout = omc_fopen(filename.c_str(),"wb");
+        assertStreamPrint(threadData,0!=fout,"Cannot open File %s",filename.c_str());
 
-    FILE *fout = omc_fopen(filename.c_str(),"wb");
-    assertStreamPrint(threadData,0!=fout,"Cannot open File %s",filename.c_str());
+        writeSparseMatrix_matVer4(fout, "A", matrixA);
+        writeSparseMatrix_matVer4(fout, "B", matrixB);
+        writeSparseMatrix_matVer4(fout, "C", matrixC);
+        writeSparseMatrix_matVer4(fout, "D", matrixD);
+        if(do_data_recovery > 0){
+            writeSparseMatrix_matVer4(fout, "Cz", matrixCz);
+            writeSparseMatrix_matVer4(fout, "Dz", matrixDz);
+            writeMatrix_matVer4(fout, "z0", size_z, 1, size_z ? &z0[0] : NULL, MatVer4Type_DOUBLE);
+        }
+        writeMatrix_matVer4(fout, "x0", size_A, 1, data->localData[0]->realVars, MatVer4Type_DOUBLE);
+        writeMatrix_matVer4(fout, "u0", size_Inputs, 1, data->simulationInfo->inputVars, MatVer4Type_DOUBLE);
+        writeMatrix_matVer4(fout, "time", 1, 1, &linTime, MatVer4Type_DOUBLE);
 
-    if(do_data_recovery > 0){
-        fprintf(fout, data->callback->linear_model_datarecovery_frame(), strX.c_str(), strU.c_str(), strZ0.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), strCz.c_str(), strDz.c_str());
+        fflush(fout);
+        fclose(fout);
     }else{
-        fprintf(fout, data->callback->linear_model_frame(), strX.c_str(), strU.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), (double) data->simulationInfo->stopTime);
-    }
-    if(ACTIVE_STREAM(LOG_STATS)) {
-      infoStreamPrint(LOG_STATS, 0, data->callback->linear_model_frame(), strX.c_str(), strU.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), (double) data->simulationInfo->stopTime);
-    }
+        strA = sparse2string(matrixA);
+        strB = sparse2string(matrixB);
+        strC = sparse2string(matrixC);
+        strD = sparse2string(matrixD);
+        if(do_data_recovery > 0){
+            strCz = sparse2string(matrixCz);
+            strDz = sparse2string(matrixDz);
+            if(size_z){
+                strZ0 = "{" + array2string(&z0[0],1,size_z) + "}";
+            }else{
+                strZ0 = "zeros(0)";
+            }
+        }
 
-    fflush(fout);
-    fclose(fout);
+        // The empty array {} is not valid modelica, so we need to put something
+        //   inside the curly braces for x0 and u0. {for i in in 1:0} will create an
+        //   empty array if needed.
+        if(size_A)
+          strX = "{" + array2string(data->localData[0]->realVars, 1, size_A) + "}";
+        else
+          strX = "zeros(0)";
+
+        if(size_Inputs)
+          strU = "{" + array2string(data->simulationInfo->inputVars, 1, size_Inputs) + "}";
+        else
+          strU = "zeros(0)";
+
+        switch(data->modelData->linearizationDumpLanguage){
+          case OMC_LINEARIZE_DUMP_LANGUAGE_MODELICA: ext = ".mo";  break;
+          case OMC_LINEARIZE_DUMP_LANGUAGE_MATLAB: ext = ".m";   break;
+          case OMC_LINEARIZE_DUMP_LANGUAGE_JULIA: ext = ".jl";  break;
+          case OMC_LINEARIZE_DUMP_LANGUAGE_PYTHON: ext = ".py";  break;
+        }
+        filename = basename.str() + ext;
+
+        FILE *fout = omc_fopen(filename.c_str(),"wb");
+        assertStreamPrint(threadData,0!=fout,"Cannot open File %s",filename.c_str());
+
+        if(do_data_recovery > 0){
+            fprintf(fout, data->callback->linear_model_datarecovery_frame(), strX.c_str(), strU.c_str(), strZ0.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), strCz.c_str(), strDz.c_str());
+        }else{
+            fprintf(fout, data->callback->linear_model_frame(), strX.c_str(), strU.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), linTime);
+        }
+        if(ACTIVE_STREAM(LOG_STATS)) {
+          infoStreamPrint(LOG_STATS, 0, data->callback->linear_model_frame(), strX.c_str(), strU.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), linTime);
+        }
+
+        fflush(fout);
+        fclose(fout);
+    }
+    data->simulationInfo->nextLinearizeTime++;
 
     if (data->modelData->runTestsuite) {
         infoStreamPrint(LOG_STDOUT, 0, "Linear model is created.");
@@ -620,8 +628,10 @@ int linearize(DATA* data, threadData_t *threadData)
           infoStreamPrint(LOG_STDOUT, 0, "Linear model is created at %s/%s", cwd, filename.c_str());
           free(cwd);
         }
-        infoStreamPrint(LOG_STDOUT, 0, "The output format can be changed with the command line option --linearizationDumpLanguage.");
-        infoStreamPrint(LOG_STDOUT, 0, "The options are: --linearizationDumpLanguage=modelica, matlab, julia, python.");
+        if(do_sparse == 0){
+          infoStreamPrint(LOG_STDOUT, 0, "The output format can be changed with the command line option --linearizationDumpLanguage.");
+          infoStreamPrint(LOG_STDOUT, 0, "The options are: --linearizationDumpLanguage=modelica, matlab, julia, python.");
+        }
     }
     TRACE_POP
     return 0;
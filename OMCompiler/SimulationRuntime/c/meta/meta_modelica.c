@@ -952,3 +952,18 @@ void* boxptr_valueHashMod(threadData_t *threadData,void *p, void *mod)
 {
   return mmc_mk_icon(mmc_prim_hash(p,5381) % (mmc_uint_t) mmc_unbox_integer(mod));
 }
+
+/* Incremental djb2 hashing of structured keys (like component references)
+ * without building an intermediate string. The result is kept non-negative
+ * and small enough to be boxed, so it can be passed back as hash argument. */
+#define MMC_HASH_CONTINUE_MASK (((mmc_uint_t)-1) >> 2)
+
+modelica_integer mmc_stringHashDjb2Continue(const char *str, modelica_integer hash)
+{
+  return (modelica_integer) (djb2_hash_iter((const unsigned char*)str, strlen(str), (mmc_uint_t) hash) & MMC_HASH_CONTINUE_MASK);
+}
+
+modelica_integer mmc_integerHashDjb2Continue(modelica_integer i, modelica_integer hash)
+{
+  return (modelica_integer) (djb2_hash_iter((const unsigned char*)&i, sizeof(modelica_integer), (mmc_uint_t) hash) & MMC_HASH_CONTINUE_MASK);
+}
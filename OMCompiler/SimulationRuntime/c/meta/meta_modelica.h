@@ -153,6 +153,8 @@ extern modelica_integer valueCompare(modelica_metatype lhs,modelica_metatype rhs
 
 extern modelica_integer valueHashMod(modelica_metatype p,modelica_integer mod);
 extern void* boxptr_valueHashMod(threadData_t *,void *p, void *mod);
+extern modelica_integer mmc_stringHashDjb2Continue(const char *str, modelica_integer hash);
+extern modelica_integer mmc_integerHashDjb2Continue(modelica_integer i, modelica_integer hash);
 
 extern void mmc__unbox(modelica_metatype box, void* res);
 
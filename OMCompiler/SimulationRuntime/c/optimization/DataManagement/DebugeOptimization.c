@@ -346,3 +346,31 @@ void debugeJac(OptData * optData, Number* vopt){
 }
 
 
+
+/*!
+ *  timing breakdown per evaluation kind
+ **/
+void optTimerTick(OptData * optData, const int kind){
+  rt_ext_tp_tick(&optData->timer.tick[kind]);
+}
+
+void optTimerTock(OptData * optData, const int kind){
+  optData->timer.total[kind] += rt_ext_tp_tock(&optData->timer.tick[kind]);
+  ++optData->timer.ncall[kind];
+}
+
+void optTimerPrint(OptData * optData){
+  const char *name[OPT_TIMER_MAX] = {"model and constraint jacobian", "objective", "gradient of the objective",
+                                     "constraints", "jacobian of the constraints", "hessian of the lagrangian"};
+  int i;
+
+  if(!ACTIVE_STREAM(LOG_STATS))
+    return;
+
+  infoStreamPrint(LOG_STATS, 1, "optimizer evaluations (%d intervals, %d collocation points, %d/%d hessian colors)",
+      (int)optData->dim.nsi, optData->dim.np, optData->s.nColorH[0], optData->dim.nv);
+  for(i = 0; i < OPT_TIMER_MAX; ++i){
+    infoStreamPrint(LOG_STATS, 0, "%12gs [%5d calls] %s", optData->timer.total[i], optData->timer.ncall[i], name[i]);
+  }
+  messageClose(LOG_STATS);
+}
@@ -40,6 +40,7 @@ static inline void print_local_jac_struct(DATA * data, OptDataDim * dim, OptData
 static inline void local_hessian_struct(DATA * data, OptDataDim * dim, OptDataStructure *s);
 static inline void print_local_hessian_struct(DATA * data, OptDataDim * dim, OptDataStructure *s);
 static inline void update_local_jac_struct(OptDataDim * dim, OptDataStructure *s);
+static inline void local_hessian_coloring(modelica_boolean ** H, modelica_boolean *** Hcf, const int ncf, const int nv, int ** color, int * nColor);
 static inline void copy_JacVars(OptData *optData);
 
 /* pick up jac struct
@@ -113,6 +114,8 @@ inline void allocate_der_struct(OptDataStructure *s, OptDataDim * dim, DATA* dat
   local_hessian_struct(data, dim, s);
   if(ACTIVE_STREAM(LOG_IPOPT_JAC) || ACTIVE_STREAM(LOG_IPOPT_HESSE))
     print_local_hessian_struct(data, dim, s);
+  local_hessian_coloring(s->H0, NULL, 0, dim->nv, &s->colorH[0], &s->nColorH[0]);
+  local_hessian_coloring(s->H1, s->Hcf, dim->ncf, dim->nv, &s->colorH[1], &s->nColorH[1]);
 
   update_local_jac_struct(dim, s);
 
@@ -185,6 +188,9 @@ inline void allocate_der_struct(OptDataStructure *s, OptDataDim * dim, DATA* dat
   for(j = 0; j < nv; ++j)
     optData->Hl[j] = (long double *)calloc(nv, sizeof(long double));
 
+  optData->hessVSave = (long double *)malloc(nv*sizeof(long double));
+  optData->hessStep = (long double *)malloc(nv*sizeof(long double));
+
   if(optData->dim.updateHessian > 0){
     const int nH0 = optData->dim.nH0_;
     const int nH1 = optData->dim.nH1_;
@@ -613,3 +619,49 @@ static inline void update_local_jac_struct(OptDataDim * dim, OptDataStructure *s
   }
 }
 
+/*
+ *  coloring of the (symmetric) hessian matrix struct H united with the
+ *  hessian structs Hcf of the ncf final constraints
+ *  columns without a common nonzero row get the same color and are perturbed
+ *  together in the numerical hessian, columns without nonzeros get color -1
+ */
+static inline modelica_boolean local_hessian_nz(modelica_boolean ** H, modelica_boolean *** Hcf, const int ncf, const int i, const int j){
+  int l;
+  if(H[i][j])
+    return (modelica_boolean)1;
+  for(l = 0; l < ncf; ++l){
+    if(Hcf[l][i][j])
+      return (modelica_boolean)1;
+  }
+  return (modelica_boolean)0;
+}
+
+static inline void local_hessian_coloring(modelica_boolean ** H, modelica_boolean *** Hcf, const int ncf, const int nv, int ** color, int * nColor){
+  int ii, jj, kk, c;
+  modelica_boolean * forbidden = (modelica_boolean *) malloc((nv+1)*sizeof(modelica_boolean));
+
+  *color = (int *) malloc(nv*sizeof(int));
+  *nColor = 0;
+
+  for(ii = 0; ii < nv; ++ii){
+    (*color)[ii] = -1;
+    memset(forbidden, 0, (nv+1)*sizeof(modelica_boolean));
+    for(jj = 0, c = 0; jj < nv; ++jj){
+      if(local_hessian_nz(H, Hcf, ncf, jj, ii)){
+        c = 1;
+        for(kk = 0; kk < ii; ++kk){
+          if((*color)[kk] >= 0 && local_hessian_nz(H, Hcf, ncf, jj, kk))
+            forbidden[(*color)[kk]] = (modelica_boolean)1;
+        }
+      }
+    }
+    if(c){
+      for(c = 0; forbidden[c]; ++c);
+      (*color)[ii] = c;
+      if(c + 1 > *nColor)
+        *nColor = c + 1;
+    }
+  }
+
+  free(forbidden);
+}
@@ -585,10 +585,18 @@ static inline void printSomeModelInfos(OptDataBounds * bounds, OptDataDim * dim,
  *  author: Vitalij Ruge
  **/
 void res2file(OptData *optData, SOLVER_INFO* solverInfo, double *vopt){
+  optResult2file(optData, solverInfo, vopt, optData->dim.nsi, 1);
+  fclose(optData->pFile);
+}
+
+/*!
+ *  write the first nsi intervals of the solution in the result file,
+ *  the start point only if emitStart is set (first receding horizon step)
+ **/
+void optResult2file(OptData *optData, SOLVER_INFO* solverInfo, double *vopt, const int nsi, const modelica_boolean emitStart){
   const int nu = optData->dim.nu;
   const int nx = optData->dim.nx;
   const int nv = optData->dim.nv;
-  const int nsi = optData->dim.nsi;
   const int np = optData->dim.np;
   const int nReal = optData->dim.nReal;
   const int nBoolean = optData->data->modelData->nVariablesBoolean;
@@ -625,38 +633,40 @@ void res2file(OptData *optData, SOLVER_INFO* solverInfo, double *vopt){
 
   optData2ModelData(optData, vopt, 0);
 
-  /******************/
-  fprintf(pFile, "%lf ",(double)t0);
+  if(emitStart){
+    /******************/
+    fprintf(pFile, "%lf ",(double)t0);
 
-  for(i=0,j = nx; i < nu; ++i,++j){
-    for(k = 0, tmpv = 0.0; k < np; ++k){
-      tmpv += a[k]*vopt[k*nv + j];
+    for(i=0,j = nx; i < nu; ++i,++j){
+      for(k = 0, tmpv = 0.0; k < np; ++k){
+        tmpv += a[k]*vopt[k*nv + j];
+      }
+      tmpv = fmin(fmax(tmpv,optData->bounds.vmin[j]),optData->bounds.vmax[j]);
+      data->simulationInfo->inputVars[i] = (double)tmpv*vnom[j];
+      fprintf(pFile, "%lf ", (float)data->simulationInfo->inputVars[i]);
     }
-    tmpv = fmin(fmax(tmpv,optData->bounds.vmin[j]),optData->bounds.vmax[j]);
-    data->simulationInfo->inputVars[i] = (double)tmpv*vnom[j];
-    fprintf(pFile, "%lf ", (float)data->simulationInfo->inputVars[i]);
-  }
-  fprintf(pFile, "%s", "\n");
-  /******************/
-  memcpy(sData->realVars, v0, nReal*sizeof(modelica_real));
-  memcpy(data->localData[0]->integerVars, optData->i0, nInteger*sizeof(modelica_integer));
-  memcpy(data->localData[0]->booleanVars, optData->b0, nBoolean*sizeof(modelica_boolean));
-  memcpy(data->simulationInfo->integerVarsPre, optData->i0Pre, nInteger*sizeof(modelica_integer));
-  memcpy(data->simulationInfo->booleanVarsPre, optData->b0Pre, nBoolean*sizeof(modelica_boolean));
-  memcpy(data->simulationInfo->realVarsPre, optData->v0Pre, nReal*sizeof(modelica_real));
-  memcpy(data->simulationInfo->relationsPre, optData->rePre, nRelations*sizeof(modelica_boolean));
-  memcpy(data->simulationInfo->relations, optData->re, nRelations*sizeof(modelica_boolean));
-  memcpy(data->simulationInfo->storedRelations, optData->storeR, nRelations*sizeof(modelica_boolean));
-  /******************/
-  solverInfo->currentTime = (double)t0;
-  sData->timeValue = solverInfo->currentTime;
-
-  /*updateDiscreteSystem(data);*/
-  data->callback->input_function(data, threadData);
-  /*data->callback->functionDAE(data);*/
-  updateDiscreteSystem(data, threadData);
+    fprintf(pFile, "%s", "\n");
+    /******************/
+    memcpy(sData->realVars, v0, nReal*sizeof(modelica_real));
+    memcpy(data->localData[0]->integerVars, optData->i0, nInteger*sizeof(modelica_integer));
+    memcpy(data->localData[0]->booleanVars, optData->b0, nBoolean*sizeof(modelica_boolean));
+    memcpy(data->simulationInfo->integerVarsPre, optData->i0Pre, nInteger*sizeof(modelica_integer));
+    memcpy(data->simulationInfo->booleanVarsPre, optData->b0Pre, nBoolean*sizeof(modelica_boolean));
+    memcpy(data->simulationInfo->realVarsPre, optData->v0Pre, nReal*sizeof(modelica_real));
+    memcpy(data->simulationInfo->relationsPre, optData->rePre, nRelations*sizeof(modelica_boolean));
+    memcpy(data->simulationInfo->relations, optData->re, nRelations*sizeof(modelica_boolean));
+    memcpy(data->simulationInfo->storedRelations, optData->storeR, nRelations*sizeof(modelica_boolean));
+    /******************/
+    solverInfo->currentTime = (double)t0;
+    sData->timeValue = solverInfo->currentTime;
+
+    /*updateDiscreteSystem(data);*/
+    data->callback->input_function(data, threadData);
+    /*data->callback->functionDAE(data);*/
+    updateDiscreteSystem(data, threadData);
 
-  sim_result.emit(&sim_result, data, threadData);
+    sim_result.emit(&sim_result, data, threadData);
+  }
   /******************/
 
   for(ii = 0; ii < nsi; ++ii){
@@ -676,7 +686,83 @@ void res2file(OptData *optData, SOLVER_INFO* solverInfo, double *vopt){
       sim_result.emit(&sim_result, data, threadData);
     }
   }
-  fclose(pFile);
+}
+
+/*!
+ *  receding horizon: shift the time grid and the last solution by the first
+ *  interval and take the new initial states, the shifted solution and
+ *  multipliers are the warm start of the next solve. Every interval moves
+ *  forward by one and keeps its length (and scaling), the new last interval
+ *  repeats the length of the old one, so non-uniform grids keep their shape
+ **/
+void shiftOptimizerHorizon(OptData *optData){
+  const int nx = optData->dim.nx;
+  const int nv = optData->dim.nv;
+  const int nsi = optData->dim.nsi;
+  const int np = optData->dim.np;
+  const int nJ = optData->dim.nJ;
+  const int nReal = optData->dim.nReal;
+  const int NV = optData->dim.NV;
+  const int nvnp = nv*np;
+  const int nJnp = nJ*np;
+  const int nRes = optData->dim.nt*nJ;
+  const long double dtFirst = optData->time.dt[0];
+  const long double dtLast = optData->time.dt[nsi-1];
+  OptDataIpopt *ipop = &optData->ipop;
+  OptDataTime *time = &optData->time;
+  OptDataBounds *bounds = &optData->bounds;
+  modelica_real **v0;
+  long double *t0, *scaldt0, *scalb0;
+  int i, j;
+
+  /* predicted states at the end of the first interval (see optData2ModelData in optResult2file) */
+  memcpy(optData->v0, optData->v[0][np-1], nReal*sizeof(modelica_real));
+  for(i = 0; i < nx; ++i)
+    optData->data->localData[0]->realVars[i] = optData->v0[i];
+  /* measured states */
+  pickUpStates(optData);
+  for(i = 0; i < nx; ++i)
+    optData->sv0[i] = optData->v0[i] * bounds->scalF[i];
+
+  time->t0 += dtFirst;
+  time->tf += dtLast;
+  if(nsi < 2){
+    for(j = 0; j < np; ++j)
+      time->t[0][j] += dtFirst;
+    return;
+  }
+
+  /* time grid */
+  t0 = time->t[0];
+  scaldt0 = bounds->scaldt[0];
+  scalb0 = bounds->scalb[0];
+  for(i = 1; i < nsi; ++i){
+    time->t[i-1] = time->t[i];
+    time->dt[i-1] = time->dt[i];
+    bounds->scaldt[i-1] = bounds->scaldt[i];
+    bounds->scalb[i-1] = bounds->scalb[i];
+  }
+  time->t[nsi-1] = t0;
+  time->dt[nsi-1] = dtLast;
+  bounds->scaldt[nsi-1] = scaldt0;
+  bounds->scalb[nsi-1] = scalb0;
+  for(j = 0; j < np; ++j)
+    time->t[nsi-1][j] = time->t[nsi-2][j] + dtLast;
+  memcpy(bounds->scaldt[nsi-1], bounds->scaldt[nsi-2], nx*sizeof(long double));
+  memcpy(bounds->scalb[nsi-1], bounds->scalb[nsi-2], np*sizeof(long double));
+
+  /* solution, the last interval keeps its old values */
+  v0 = optData->v[0];
+  for(i = 1; i < nsi; ++i)
+    optData->v[i-1] = optData->v[i];
+  optData->v[nsi-1] = v0;
+  for(j = 0; j < np; ++j)
+    memcpy(optData->v[nsi-1][j], optData->v[nsi-2][j], nReal*sizeof(modelica_real));
+
+  memmove(ipop->vopt, ipop->vopt + nvnp, (NV - nvnp)*sizeof(double));
+  memmove(ipop->mult_x_L, ipop->mult_x_L + nvnp, (NV - nvnp)*sizeof(double));
+  memmove(ipop->mult_x_U, ipop->mult_x_U + nvnp, (NV - nvnp)*sizeof(double));
+  memmove(ipop->mult_g, ipop->mult_g + nJnp, (nRes - nJnp)*sizeof(double));
 }
 
 /*!
@@ -702,6 +788,7 @@ void optData2ModelData(OptData *optData, double *vopt, const int index){
   const int * indexBC = optData->s.indexABCD + 3;
   threadData_t *threadData = optData->threadData;
 
+  optTimerTick(optData, OPT_TIMER_MODEL);
   for(l = 0; l < 3; ++l)
     realVars[l] = data->localData[l]->realVars;
 
@@ -747,6 +834,7 @@ void optData2ModelData(OptData *optData, double *vopt, const int index){
     if(optData->s.matrix[l])
       data->simulationInfo->analyticJacobians[indexBC[l]].tmpVars = tmpVars[l];
 
+  optTimerTock(optData, OPT_TIMER_MODEL);
 }
 
 
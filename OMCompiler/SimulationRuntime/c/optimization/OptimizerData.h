@@ -34,6 +34,7 @@
 #include "omc_config.h"
 #include "../simulation_data.h"
 #include "../simulation/solver/solver_main.h"
+#include "../util/rtclock.h"
 #include <string.h>
 #include <coin/IpStdCInterface.h>
 #include <stdlib.h>
@@ -152,8 +153,27 @@ typedef struct OptDataStructure{
   int * indexJ2;
   int * indexJ3;
   int indexABCD[5];
+  int * colorH[2];
+  int nColorH[2];
 }OptDataStructure;
 
+/* evaluation kinds of the timing breakdown (-lv=LOG_STATS) */
+enum OPT_TIMER{
+  OPT_TIMER_MODEL = 0, /* model and constraint jacobian at all collocation nodes */
+  OPT_TIMER_F,         /* objective */
+  OPT_TIMER_DF,        /* gradient of the objective */
+  OPT_TIMER_G,         /* constraints */
+  OPT_TIMER_DG,        /* jacobian of the constraints */
+  OPT_TIMER_H,         /* hessian of the lagrangian */
+  OPT_TIMER_MAX
+};
+
+typedef struct OptDataTimer{
+  rtclock_t tick[OPT_TIMER_MAX];
+  double total[OPT_TIMER_MAX];
+  unsigned int ncall[OPT_TIMER_MAX];
+}OptDataTimer;
+
 
 typedef struct OptData{
   OptDataDim dim;
@@ -162,6 +182,7 @@ typedef struct OptData{
   OptDataRK rk;
   OptDataStructure s;
   OptDataIpopt ipop;
+  OptDataTimer timer;
 
   modelica_real ***v;
   modelica_real *v0;
@@ -186,6 +207,8 @@ typedef struct OptData{
   long double **Hl;
   long double **Hm;
   long double ***Hcf;
+  long double *hessVSave; /* saved variables and step sizes of the perturbed color in the numerical hessian */
+  long double *hessStep;
   DATA *data;
   threadData_t *threadData;
   FILE * pFile;
@@ -42,12 +42,17 @@ void allocate_der_struct(OptDataStructure *s, OptDataDim * dim, DATA* data, OptD
 void initial_guess_optimizer(OptData *optData, SOLVER_INFO* solverInfo);
 
 void res2file(OptData *optData, SOLVER_INFO* solverInfo,double * v);
+void optResult2file(OptData *optData, SOLVER_INFO* solverInfo, double *vopt, const int nsi, const modelica_boolean emitStart);
+void shiftOptimizerHorizon(OptData *optData);
 void optData2ModelData(OptData *optData, double *vopt, const int index);
 
 void diffSynColoredOptimizerSystem(OptData *optData, modelica_real **J, const int i, const int j, const int index);
 void diffSynColoredOptimizerSystemF(OptData *optData, modelica_real **J);
 void debugeJac(OptData * optData,Number* vopt);
 void debugeSteps(OptData * optData, modelica_real*vopt, modelica_real * lambda);
+void optTimerTick(OptData * optData, const int kind);
+void optTimerTock(OptData * optData, const int kind);
+void optTimerPrint(OptData * optData);
 
 /*ipopt*/
 
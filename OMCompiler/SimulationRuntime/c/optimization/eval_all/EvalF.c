@@ -51,6 +51,8 @@ Bool evalfF(Index n, Number * vopt, Bool new_x, Number *objValue, void * useData
   if(new_x)
     optData2ModelData(optData, vopt, 1);
 
+  optTimerTick(optData, OPT_TIMER_F);
+
   if(la){
     const int nsi = optData->dim.nsi;
     const int np = optData->dim.np;
@@ -87,6 +89,7 @@ Bool evalfF(Index n, Number * vopt, Bool new_x, Number *objValue, void * useData
 
   *objValue = (Number)(lagrange + mayer);
 
+  optTimerTock(optData, OPT_TIMER_F);
   return TRUE;
 }
 
@@ -110,6 +113,7 @@ Bool evalfDiffF(Index n, double * vopt, Bool new_x, Number *gradF, void * useDat
   if(new_x)
     optData2ModelData(optData, vopt, 1);
 
+  optTimerTick(optData, OPT_TIMER_DF);
   if(la){
 
     int i, j, ii;
@@ -144,5 +148,6 @@ Bool evalfDiffF(Index n, double * vopt, Bool new_x, Number *gradF, void * useDat
 
   }
 
+  optTimerTock(optData, OPT_TIMER_DF);
   return TRUE;
 }
@@ -92,6 +92,7 @@ Bool evalfG(Index n, double * vopt, Bool new_x, int m, Number *g, void * useData
   if(new_x){
     optData2ModelData(optData, vopt, optData->index);
   }
+  optTimerTick(optData, OPT_TIMER_G);
 
   v = optData->v;
   memcpy(a ,optData->rk.a, sizeof(optData->rk.a));
@@ -154,6 +155,7 @@ Bool evalfG(Index n, double * vopt, Bool new_x, int m, Number *g, void * useData
     const int nJ = optData->dim.nJ;
     printMaxError(g, m, nx, nJ, optData->time.t, np ,nsi ,optData->data, optData);
   }
+  optTimerTock(optData, OPT_TIMER_G);
   return TRUE;
 }
 
@@ -210,6 +212,7 @@ Bool evalfDiffG(Index n, double * vopt, Bool new_x, Index m, Index njac, Index *
     if(new_x){
       optData2ModelData(optData, vopt, 1);
     }
+    optTimerTick(optData, OPT_TIMER_DG);
     if(np == 3){
       /*****************************/
       for(j = 0, k = 0; j < np; ++j){
@@ -318,6 +321,7 @@ Bool evalfDiffG(Index n, double * vopt, Bool new_x, Index m, Index njac, Index *
     printf("\nvalues[%i] = %g",i,values[i]);
     assert(0);
     */
+    optTimerTock(optData, OPT_TIMER_DG);
    {
     if(optData->ipop.debugeJ){
       int ijac = 0;
@@ -133,6 +133,7 @@ Bool ipopt_h(int n, double *vopt, Bool new_x, double obj_factor, int m, double *
     const int nRelations =  optData->data->modelData->nRelations;
     DATA * data = optData->data;
 
+    optTimerTick(optData, OPT_TIMER_H);
     upC = obj_factor != 0;
     /*
     if(new_x){
@@ -189,6 +190,7 @@ Bool ipopt_h(int n, double *vopt, Bool new_x, double obj_factor, int m, double *
     }
     if(optData->dim.updateHessian > 0)
       memcpy(optData->oldH, values, nele_hess*sizeof(double));
+    optTimerTock(optData, OPT_TIMER_H);
   }
 
 
@@ -197,6 +199,8 @@ Bool ipopt_h(int n, double *vopt, Bool new_x, double obj_factor, int m, double *
 
 /* numerical approximation
  *  hessian
+ *  all variables of one color of the hessian struct H0 are perturbed together,
+ *  they have no common nonzero row
  * author: Vitalij Ruge
  */
 static inline void num_hessian0(double * v, const double * const lambda,
@@ -212,9 +216,13 @@ static inline void num_hessian0(double * v, const double * const lambda,
   const int nJ = optData->dim.nJ;
   const modelica_real * const vmax = optData->bounds.vmax;
   const modelica_real * const vnom = optData->bounds.vnom;
+  const int * const color = optData->s.colorH[0];
+  const int nColor = optData->s.nColorH[0];
 
-  int ii,jj, l;
-  long double v_save, h;
+  int ii,jj, l, c;
+  long double * const v_save = optData->hessVSave;
+  long double * const h = optData->hessStep;
+  long double hh;
   modelica_real * realV[3];
 
 
@@ -225,14 +233,18 @@ static inline void num_hessian0(double * v, const double * const lambda,
   }
   data->localData[0]->timeValue = (modelica_real) optData->time.t[i][j];
 
-  for(ii = 0; ii < nv; ++ii){
+  for(c = 0; c < nColor; ++c){
     /********************/
-    v_save = (long double) v[ii];
-    h = (long double)DF_STEP(v_save);
-    v[ii] += h;
-    if( v[ii] >=  vmax[ii]){
-      h *= -1.0;
-      v[ii] = v_save + h;
+    for(ii = 0; ii < nv; ++ii){
+      if(color[ii] != c)
+        continue;
+      v_save[ii] = (long double) v[ii];
+      h[ii] = (long double)DF_STEP(v_save[ii]);
+      v[ii] += h[ii];
+      if( v[ii] >=  vmax[ii]){
+        h[ii] *= -1.0;
+        v[ii] = v_save[ii] + h[ii];
+      }
     }
     /********************/
     for(l = 0; l < nx; ++l)
@@ -245,28 +257,32 @@ static inline void num_hessian0(double * v, const double * const lambda,
     /********************/
     diffSynColoredOptimizerSystem(optData, optData->tmpJ, i,j,2);
     /********************/
-    v[ii] = (double)v_save;
-    /********************/
-    for(jj = 0; jj <ii+1; ++jj){
-      if(optData->s.H0[ii][jj]){
-        for(l = 0; l < nJ; ++l){
-          if(optData->s.Hg[l][ii][jj] && lambda[l] != 0)
-              optData->H[l][ii][jj] = (long double)(optData->tmpJ[l][jj] - optData->J[i][j][l][jj])*lambda[l]/h;
+    for(ii = 0; ii < nv; ++ii){
+      if(color[ii] != c)
+        continue;
+      v[ii] = (double)v_save[ii];
+      /********************/
+      for(jj = 0; jj <ii+1; ++jj){
+        if(optData->s.H0[ii][jj]){
+          for(l = 0; l < nJ; ++l){
+            if(optData->s.Hg[l][ii][jj] && lambda[l] != 0)
+                optData->H[l][ii][jj] = (long double)(optData->tmpJ[l][jj] - optData->J[i][j][l][jj])*lambda[l]/h[ii];
+          }
         }
       }
-    }
-    /********************/
-    if(upCost){
-      h = objFactor/h;
-      for(jj = 0; jj <ii+1; ++jj){
-        if(optData->s.Hl[ii][jj]){
-          optData->Hl[ii][jj] = (long double)(optData->tmpJ[nJ][jj] - optData->J[i][j][nJ][jj])*h;
-        }else{
-          optData->Hl[ii][jj] = 0.0;
+      /********************/
+      if(upCost){
+        hh = objFactor/h[ii];
+        for(jj = 0; jj <ii+1; ++jj){
+          if(optData->s.Hl[ii][jj]){
+            optData->Hl[ii][jj] = (long double)(optData->tmpJ[nJ][jj] - optData->J[i][j][nJ][jj])*hh;
+          }else{
+            optData->Hl[ii][jj] = 0.0;
+          }
         }
       }
+      /********************/
     }
-    /********************/
   }
 
   for(l = 1; l<3; ++l){
@@ -279,6 +295,7 @@ static inline void num_hessian0(double * v, const double * const lambda,
 
 /* numerical approximation
  *  hessian
+ *  same as num_hessian0 with the hessian struct H1 of the last collocation point
  * author: Vitalij Ruge
  */
 static inline void num_hessian1(double * v, const double * const lambda,
@@ -300,8 +317,12 @@ static inline void num_hessian1(double * v, const double * const lambda,
   const modelica_boolean upFinalCon = np == j + 1 && nsi == i  +1;
   const modelica_boolean upCost2 = upFinalCon && ma && objFactor != 0;
   const short indexJ = (upCost2) ? 3 : 2;
-  int ii,jj, l,k;
-  long double v_save, h;
+  const int * const color = optData->s.colorH[1];
+  const int nColor = optData->s.nColorH[1];
+  int ii,jj, l, c;
+  long double * const v_save = optData->hessVSave;
+  long double * const h = optData->hessStep;
+  long double hh;
   DATA * data = optData->data;
   threadData_t *threadData = optData->threadData;
 
@@ -314,14 +335,18 @@ static inline void num_hessian1(double * v, const double * const lambda,
     data->localData[l]->timeValue = (modelica_real) optData->time.t[i][j];
   }
 
-  for(ii = 0; ii < nv; ++ii){
+  for(c = 0; c < nColor; ++c){
     /********************/
-    v_save = (long double) v[ii];
-    h = (long double)DF_STEP(v_save);
-    v[ii] += h;
-    if(v[ii] > vmax[ii]){
-      h *= -1.0;
-      v[ii] = v_save + h;
+    for(ii = 0; ii < nv; ++ii){
+      if(color[ii] != c)
+        continue;
+      v_save[ii] = (long double) v[ii];
+      h[ii] = (long double)DF_STEP(v_save[ii]);
+      v[ii] += h[ii];
+      if(v[ii] > vmax[ii]){
+        h[ii] *= -1.0;
+        v[ii] = v_save[ii] + h[ii];
+      }
     }
     /********************/
     for(l = 0; l < nx; ++l)
@@ -334,51 +359,54 @@ static inline void num_hessian1(double * v, const double * const lambda,
     updateDiscreteSystem(data, threadData);
     /********************/
     diffSynColoredOptimizerSystem(optData, optData->tmpJ, i,j,indexJ);
+    if(upFinalCon && ncf > 0)
+      diffSynColoredOptimizerSystemF(optData, optData->tmpJf);
     /********************/
-    v[ii] = (double)v_save;
-    /********************/
-    for(jj = 0; jj <ii+1; ++jj){
-      if(optData->s.H0[ii][jj]){
-        for(l = 0; l < nJ; ++l){
-          if(optData->s.Hg[l][ii][jj])
-            optData->H[l][ii][jj] = (long double)(optData->tmpJ[l][jj] - optData->J[i][j][l][jj])*lambda[l]/h;
+    for(ii = 0; ii < nv; ++ii){
+      if(color[ii] != c)
+        continue;
+      v[ii] = (double)v_save[ii];
+      /********************/
+      for(jj = 0; jj <ii+1; ++jj){
+        if(optData->s.H0[ii][jj]){
+          for(l = 0; l < nJ; ++l){
+            if(optData->s.Hg[l][ii][jj])
+              optData->H[l][ii][jj] = (long double)(optData->tmpJ[l][jj] - optData->J[i][j][l][jj])*lambda[l]/h[ii];
+          }
         }
       }
-    }
-    /********************/
-    if(upCost){
-      long double hh;
-      hh = objFactor/h;
-      for(jj = 0; jj <ii+1; ++jj){
-        if(optData->s.Hl[ii][jj]){
-          optData->Hl[ii][jj] = (long double)(optData->tmpJ[nJ][jj] - optData->J[i][j][nJ][jj])*hh;
+      /********************/
+      if(upCost){
+        hh = objFactor/h[ii];
+        for(jj = 0; jj <ii+1; ++jj){
+          if(optData->s.Hl[ii][jj]){
+            optData->Hl[ii][jj] = (long double)(optData->tmpJ[nJ][jj] - optData->J[i][j][nJ][jj])*hh;
+          }
         }
       }
-    }
-    /********************/
-    if(upCost2){
-      long double hh;
-      hh = objFactor/h;
-      for(jj = 0; jj <ii+1; ++jj){
-        if(optData->s.Hm[ii][jj]){
-          optData->Hm[ii][jj] = (long double)(optData->tmpJ[nJ1][jj] - optData->J[i][j][nJ1][jj])*hh;
+      /********************/
+      if(upCost2){
+        hh = objFactor/h[ii];
+        for(jj = 0; jj <ii+1; ++jj){
+          if(optData->s.Hm[ii][jj]){
+            optData->Hm[ii][jj] = (long double)(optData->tmpJ[nJ1][jj] - optData->J[i][j][nJ1][jj])*hh;
+          }
         }
       }
-    }
-    /********************/
-    if(upFinalCon && ncf > 0){
-      diffSynColoredOptimizerSystemF(optData, optData->tmpJf);
-      for(jj = 0; jj <ii+1; ++jj){
-        if(optData->s.H0[ii][jj]){
-          for(l = 0; l < ncf; ++l){
-            if(optData->s.Hcf[l][ii][jj]){
-              optData->Hcf[l][ii][jj] = (long double)(optData->tmpJf[l][jj] - optData->Jf[l][jj])*lambda[nJ+l]/h;
+      /********************/
+      if(upFinalCon && ncf > 0){
+        for(jj = 0; jj <ii+1; ++jj){
+          if(optData->s.H1[ii][jj]){
+            for(l = 0; l < ncf; ++l){
+              if(optData->s.Hcf[l][ii][jj]){
+                optData->Hcf[l][ii][jj] = (long double)(optData->tmpJf[l][jj] - optData->Jf[l][jj])*lambda[nJ+l]/h[ii];
+              }
             }
           }
         }
       }
+      /********************/
     }
-    /********************/
   }
 
   for(l = 1; l<3; ++l){
@@ -37,11 +37,16 @@
 #include "simulation_data.h"
 #include "simulation/options.h"
 
-static inline void optimizationWithIpopt(OptData*optData);
+static inline IpoptProblem createOptimizerIpoptProblem(OptData*optData, int * max_iter);
+static inline void optimizationWithIpopt(OptData*optData, IpoptProblem nlp, const int max_iter);
+static inline void setMPCWarmStart(IpoptProblem nlp);
 static inline void freeOptimizerData(OptData*optData);
 
 int runOptimizer(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo){
   OptData *optData, optData_;
+  IpoptProblem nlp;
+  int max_iter, mpc = 1, k;
+  char *cflags = (char*)omc_flagValue[FLAG_OPTIMIZER_MPC];
 
   solverInfo->solverData = &optData_;
   data->simulationInfo->noThrowDivZero = 1;
@@ -52,17 +57,38 @@ int runOptimizer(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo){
   initial_guess_optimizer(optData, solverInfo);
   allocate_der_struct(&optData->s, &optData->dim ,data, optData);
 
-  optimizationWithIpopt(optData);
-  res2file(optData, solverInfo, optData->ipop.vopt);
+  memset(&optData->timer, 0, sizeof(OptDataTimer));
+  nlp = createOptimizerIpoptProblem(optData, &max_iter);
+  optimizationWithIpopt(optData, nlp, max_iter);
+
+  /* receding horizon: keep structure and ipopt problem, shift and warm start */
+  if(cflags)
+    mpc = atoi(cflags);
+  for(k = 1; k < mpc; ++k){
+    optResult2file(optData, solverInfo, optData->ipop.vopt, 1, k == 1);
+    shiftOptimizerHorizon(optData);
+    if(k == 1)
+      setMPCWarmStart(nlp);
+    infoStreamPrint(LOG_SOLVER, 0, "receding horizon step %i/%i: [%g, %g]", k+1, mpc, (double)optData->time.t0, (double)optData->time.tf);
+    optimizationWithIpopt(optData, nlp, max_iter);
+  }
+
+  FreeIpoptProblem(nlp);
+  optTimerPrint(optData);
+  if(mpc > 1){
+    optResult2file(optData, solverInfo, optData->ipop.vopt, optData->dim.nsi, 0);
+    fclose(optData->pFile);
+  }else
+    res2file(optData, solverInfo, optData->ipop.vopt);
   freeOptimizerData(optData);
   return 0;
 }
 
 /*!
- *  run optimization with ipopt
+ *  create ipopt problem and set the ipopt flags
  *  author: Vitalij Ruge
  **/
-static inline void optimizationWithIpopt(OptData*optData){
+static inline IpoptProblem createOptimizerIpoptProblem(OptData*optData, int * max_iter_){
   IpoptProblem nlp = NULL;
 
   const int NV = optData->dim.NV;
@@ -81,15 +107,9 @@ static inline void optimizationWithIpopt(OptData*optData){
   Number * Vmax = optData->bounds.Vmax;
   Number * gmin = optData->ipop.gmin;
   Number * gmax = optData->ipop.gmax;
-  Number * vopt = optData->ipop.vopt;
-  Number * mult_g = optData->ipop.mult_g;
-  Number * mult_x_L = optData->ipop.mult_x_L;
-  Number * mult_x_U = optData->ipop.mult_x_U;
-  Number obj;
 
   char *cflags;
   int max_iter = 5000;
-  int res = 0;
 
   nlp = CreateIpoptProblem(NV, Vmin, Vmax,
       NRes, gmin, gmax, njac, nhess, 0, &evalfF,
@@ -209,6 +229,21 @@ static inline void optimizationWithIpopt(OptData*optData){
 
   /********************************************************************/
 
+  *max_iter_ = max_iter;
+  return nlp;
+}
+
+/*!
+ *  run optimization with ipopt
+ *  author: Vitalij Ruge
+ **/
+static inline void optimizationWithIpopt(OptData*optData, IpoptProblem nlp, const int max_iter){
+  Number * vopt = optData->ipop.vopt;
+  Number * mult_g = optData->ipop.mult_g;
+  Number * mult_x_L = optData->ipop.mult_x_L;
+  Number * mult_x_U = optData->ipop.mult_x_U;
+  Number obj;
+  int res = 0;
 
   if(max_iter >=0){
     optData->iter_ = 0.0;
@@ -217,7 +252,19 @@ static inline void optimizationWithIpopt(OptData*optData){
   }
   if(res != 0 && !ACTIVE_STREAM(LOG_IPOPT))
     warningStreamPrint(LOG_STDOUT, 0, "No optimal solution found!\nUse -lv=LOG_IPOPT for more information.");
-  FreeIpoptProblem(nlp);
+}
+
+/*!
+ *  start the next receding horizon step from the shifted primal and dual solution
+ **/
+static inline void setMPCWarmStart(IpoptProblem nlp){
+  AddIpoptStrOption(nlp, "warm_start_init_point", "yes");
+  AddIpoptNumOption(nlp, "warm_start_bound_push", 1e-9);
+  AddIpoptNumOption(nlp, "warm_start_bound_frac", 1e-9);
+  AddIpoptNumOption(nlp, "warm_start_slack_bound_push", 1e-9);
+  AddIpoptNumOption(nlp, "warm_start_slack_bound_frac", 1e-9);
+  AddIpoptNumOption(nlp, "warm_start_mult_bound_push", 1e-9);
+  AddIpoptNumOption(nlp, "mu_init", 1e-6);
 }
 
 
@@ -324,6 +371,8 @@ static inline void freeOptimizerData(OptData*optData){
   }
   free(optData->Hl);
   free(optData->Hm);
+  free(optData->hessVSave);
+  free(optData->hessStep);
   if(optData->dim.updateHessian > 0)
     free(optData->oldH);
 
@@ -347,4 +396,6 @@ static inline void freeOptimizerData(OptData*optData){
   free(optData->s.JderCon);
   free(optData->s.gradM);
   free(optData->s.gradL);
+  free(optData->s.colorH[0]);
+  free(optData->s.colorH[1]);
 }
@@ -57,6 +57,7 @@ size_t sizeofMatVer4Type(MatVer4Type_t type)
   switch (type)
   {
   case MatVer4Type_DOUBLE:
+  case MatVer4Type_SPARSE:
     return sizeof(double);
   case MatVer4Type_SINGLE:
     return sizeof(float);
@@ -42,6 +42,7 @@ extern "C" {
 typedef enum MatVer4Type_t
 {
   MatVer4Type_DOUBLE = 0,
+  MatVer4Type_SPARSE = 2,   /* double triplets (row, col, value), last row holds the dimensions */
   MatVer4Type_SINGLE = 10,
   MatVer4Type_INT32 = 20,
   MatVer4Type_CHAR = 51
@@ -0,0 +1,435 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+#include "util/omc_error.h"
+#include "util/omc_file.h"
+#include "util/rtclock.h"
+#include "util/result_columnar.h"
+#include "simulation/options.h"
+#include "simulation_result_col.h"
+#include "simulation_result_plan.h"
+#include "meta/meta_modelica.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <stdint.h>
+
+typedef struct col_variable
+{
+  std::string name;
+  std::string descr;
+  int32_t isParam;
+  int32_t index;
+} col_variable;
+
+typedef struct col_data
+{
+  FILE *file;
+  uint64_t pos;                       /* current end of the file */
+  OUTPUT_PLAN plan;
+  uint32_t nvar;                      /* number of columns */
+  uint32_t chunkRows;                 /* rows per chunk */
+  uint32_t rows;                      /* rows in the buffer */
+  uint32_t nrows;                     /* rows in the file */
+  std::vector<double> buffer;         /* chunkRows x nvar, row by row */
+  std::vector<double> columns;        /* the buffer transposed, column by column */
+  std::multimap<uint64_t, uint32_t> stored; /* hash -> columns of the current chunk stored as data */
+  std::vector<unsigned char> packed;
+  std::vector<uint32_t> chunkRowCount;
+  std::vector<uint64_t> chunkOffset;  /* nvar entries per chunk */
+  std::vector<uint32_t> chunkSize;
+  std::vector<col_variable> variables;
+  /* parameters: the source of every value, negated Boolean parameters get their own value */
+  std::vector<char> paramType;        /* 'r', 'i', 'b' or 'n' (negated Boolean) */
+  std::vector<int> paramIndex;
+  std::vector<double> params;
+} col_data;
+
+/* Buffered values per chunk, so the buffer does not grow without bounds for large models */
+#define COL_CHUNK_VALUES (1<<21)
+#define COL_MIN_CHUNK_ROWS 16
+#define COL_MAX_CHUNK_ROWS 4096
+
+static const char timeName[] = "time";
+static const char timeDesc[] = "Simulation time [s]";
+static const char cpuTimeName[] = "$cpuTime";
+static const char cpuTimeDesc[] = "cpu time [s]";
+static const char solverStepsName[] = "$solverSteps";
+static const char solverStepsDesc[] = "number of steps taken by the integrator";
+
+static std::string col_description(const char *comment, modelica_string unit)
+{
+  const char *unitStr = unit ? MMC_STRINGDATA(unit) : NULL;
+  if (unitStr && *unitStr) {
+    return std::string(comment) + " [" + unitStr + "]";
+  }
+  return comment;
+}
+
+static void col_add_variable(col_data *colData, const std::string &name, const std::string &descr, int isParam, int index)
+{
+  col_variable var;
+  var.name = name;
+  var.descr = descr;
+  var.isParam = isParam;
+  var.index = index;
+  colData->variables.push_back(var);
+}
+
+static int col_add_param(col_data *colData, char type, int index)
+{
+  colData->paramType.push_back(type);
+  colData->paramIndex.push_back(index);
+  return colData->paramType.size();
+}
+
+static void col_write(col_data *colData, const void *data, size_t size, threadData_t *threadData)
+{
+  if (size && 1 != fwrite(data, size, 1, colData->file)) {
+    throwStreamPrint(threadData, "Error while writing columnar result file");
+  }
+  colData->pos += size;
+}
+
+static uint64_t col_bits(double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(uint64_t));
+  return bits;
+}
+
+/* FNV-1a of the values without their sign, so negated copies collide */
+static uint64_t col_hash(const double *values, uint32_t n)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  uint32_t i;
+  for (i = 0; i < n; i++) {
+    hash = (hash ^ (col_bits(values[i]) & ~OMC_COLUMNAR_NEGATED)) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/* Returns the entry of a stored column of the current chunk that has the same
+ * (or only negated) values, or OMC_COLUMNAR_REFERENCE if there is none */
+static uint64_t col_find_copy(col_data *colData, const double *values, uint32_t n, uint64_t hash)
+{
+  std::multimap<uint64_t, uint32_t>::const_iterator it;
+  uint32_t i;
+
+  for (it = colData->stored.lower_bound(hash); it != colData->stored.end() && it->first == hash; ++it) {
+    const double *other = &colData->columns[(size_t)it->second * n];
+    if (0 == memcmp(values, other, n * sizeof(double))) {
+      return it->second;
+    }
+    for (i = 0; i < n && col_bits(values[i]) == (col_bits(other[i]) ^ OMC_COLUMNAR_NEGATED); i++);
+    if (i == n) {
+      return it->second | OMC_COLUMNAR_NEGATED;
+    }
+  }
+  return OMC_COLUMNAR_REFERENCE;
+}
+
+/* Transposes the buffered rows and writes one compressed chunk per column.
+ * Columns that are constant or copies of an earlier column within the chunk
+ * are only recorded in the index. */
+static void col_flush(col_data *colData, threadData_t *threadData)
+{
+  const uint32_t nvar = colData->nvar, rows = colData->rows;
+  uint32_t v, r;
+  size_t size;
+
+  if (rows == 0) {
+    return;
+  }
+  colData->columns.resize((size_t)rows * nvar);
+  colData->packed.resize(OMC_COLUMNAR_MAX_SIZE(rows));
+  for (r = 0; r < rows; r++) {
+    for (v = 0; v < nvar; v++) {
+      colData->columns[(size_t)v*rows + r] = colData->buffer[(size_t)r*nvar + v];
+    }
+  }
+  colData->stored.clear();
+  for (v = 0; v < nvar; v++) {
+    const double *values = &colData->columns[(size_t)v*rows];
+    uint64_t first = col_bits(values[0]), copy, hash;
+
+    for (r = 1; r < rows && col_bits(values[r]) == first; r++);
+    if (r == rows) {
+      colData->chunkOffset.push_back(first);
+      colData->chunkSize.push_back(OMC_COLUMNAR_CONSTANT);
+      continue;
+    }
+    hash = col_hash(values, rows);
+    copy = col_find_copy(colData, values, rows, hash);
+    if (copy != OMC_COLUMNAR_REFERENCE) {
+      colData->chunkOffset.push_back(copy);
+      colData->chunkSize.push_back(OMC_COLUMNAR_REFERENCE);
+      continue;
+    }
+    colData->stored.insert(std::make_pair(hash, v));
+    size = omc_columnar_encode(values, rows, &colData->packed[0]);
+    colData->chunkOffset.push_back(colData->pos);
+    colData->chunkSize.push_back(size);
+    col_write(colData, &colData->packed[0], size, threadData);
+  }
+  colData->chunkRowCount.push_back(rows);
+  colData->nrows += rows;
+  colData->rows = 0;
+}
+
+extern "C" {
+
+void col_init(simulation_result *self, DATA *data, threadData_t *threadData)
+{
+  const MODEL_DATA *mData = data->modelData;
+  col_data *colData = new col_data();
+  std::vector<int> realCol(mData->nVariablesReal, 0), integerCol(mData->nVariablesInteger, 0), booleanCol(mData->nVariablesBoolean, 0);
+  std::vector<int> realParam(mData->nParametersReal, 0), integerParam(mData->nParametersInteger, 0), booleanParam(mData->nParametersBoolean, 0);
+  uint32_t bom = OMC_COLUMNAR_BOM;
+  int i, cur = 1;
+
+  self->storage = colData;
+  rt_tick(SIM_TIMER_OUTPUT);
+
+  colData->file = omc_fopen(self->filename, "wb");
+  if (!colData->file) {
+    throwStreamPrint(threadData, "Cannot open File %s for writing", self->filename);
+  }
+  colData->pos = 0;
+  col_write(colData, OMC_COLUMNAR_MAGIC, 8, threadData);
+  col_write(colData, &bom, sizeof(uint32_t), threadData);
+
+  /* The columns: time, $cpuTime, $solverSteps, the variables and the negated Boolean aliases */
+  omc_output_plan_init(&colData->plan, mData, OUTPUT_PLAN_VARIABLE_ALIASES | OUTPUT_PLAN_NEGATED_BOOLEANS_ONLY);
+  col_add_variable(colData, timeName, timeDesc, 0, cur++);
+  if (self->cpuTime) {
+    col_add_variable(colData, cpuTimeName, cpuTimeDesc, 0, cur++);
+  }
+  if (omc_flag[FLAG_SOLVER_STEPS]) {
+    col_add_variable(colData, solverStepsName, solverStepsDesc, 0, cur++);
+  }
+  for (i = 0; i < colData->plan.nReal; i++) {
+    const STATIC_REAL_DATA *var = &mData->realVarsData[colData->plan.realIndex[i]];
+    realCol[colData->plan.realIndex[i]] = cur;
+    col_add_variable(colData, var->info.name, col_description(var->info.comment, var->attribute.unit), 0, cur++);
+  }
+  for (i = 0; i < colData->plan.nInteger; i++) {
+    const STATIC_INTEGER_DATA *var = &mData->integerVarsData[colData->plan.integerIndex[i]];
+    integerCol[colData->plan.integerIndex[i]] = cur;
+    col_add_variable(colData, var->info.name, var->info.comment, 0, cur++);
+  }
+  for (i = 0; i < colData->plan.nBoolean; i++) {
+    const STATIC_BOOLEAN_DATA *var = &mData->booleanVarsData[colData->plan.booleanIndex[i]];
+    booleanCol[colData->plan.booleanIndex[i]] = cur;
+    col_add_variable(colData, var->info.name, var->info.comment, 0, cur++);
+  }
+  /* same order as the aliases of the plan */
+  for (i = 0; i < mData->nAliasBoolean; i++) {
+    const DATA_BOOLEAN_ALIAS *alias = &mData->booleanAlias[i];
+    if (!alias->filterOutput && alias->aliasType != 1 && alias->negate) {
+      col_add_variable(colData, alias->info.name, alias->info.comment, 0, cur++);
+    }
+  }
+  colData->nvar = cur - 1;
+
+  /* parameters */
+  for (i = 0; i < mData->nParametersReal; i++) {
+    const STATIC_REAL_DATA *par = &mData->realParameterData[i];
+    if (!par->filterOutput) {
+      realParam[i] = col_add_param(colData, 'r', i);
+      col_add_variable(colData, par->info.name, col_description(par->info.comment, par->attribute.unit), 1, realParam[i]);
+    }
+  }
+  for (i = 0; i < mData->nParametersInteger; i++) {
+    const STATIC_INTEGER_DATA *par = &mData->integerParameterData[i];
+    if (!par->filterOutput) {
+      integerParam[i] = col_add_param(colData, 'i', i);
+      col_add_variable(colData, par->info.name, par->info.comment, 1, integerParam[i]);
+    }
+  }
+  for (i = 0; i < mData->nParametersBoolean; i++) {
+    const STATIC_BOOLEAN_DATA *par = &mData->booleanParameterData[i];
+    if (!par->filterOutput) {
+      booleanParam[i] = col_add_param(colData, 'b', i);
+      col_add_variable(colData, par->info.name, par->info.comment, 1, booleanParam[i]);
+    }
+  }
+
+  /* aliases refer to a column or parameter, negated ones with a negative index */
+  for (i = 0; i < mData->nAliasReal; i++) {
+    const DATA_REAL_ALIAS *alias = &mData->realAlias[i];
+    int isParam = alias->aliasType == 1;
+    int index = alias->aliasType == 2 ? 1 : isParam ? realParam[alias->nameID] : realCol[alias->nameID];
+    std::string descr;
+    if (alias->filterOutput || !index) {
+      continue;
+    }
+    if (alias->aliasType == 2) {
+      descr = std::string(alias->info.comment) + " [s]";
+    } else {
+      descr = col_description(alias->info.comment, isParam ? mData->realParameterData[alias->nameID].attribute.unit : mData->realVarsData[alias->nameID].attribute.unit);
+    }
+    col_add_variable(colData, alias->info.name, descr, isParam, alias->negate ? -index : index);
+  }
+  for (i = 0; i < mData->nAliasInteger; i++) {
+    const DATA_INTEGER_ALIAS *alias = &mData->integerAlias[i];
+    int isParam = alias->aliasType == 1;
+    int index = isParam ? integerParam[alias->nameID] : integerCol[alias->nameID];
+    if (!alias->filterOutput && index) {
+      col_add_variable(colData, alias->info.name, alias->info.comment, isParam, alias->negate ? -index : index);
+    }
+  }
+  for (i = 0; i < mData->nAliasBoolean; i++) {
+    const DATA_BOOLEAN_ALIAS *alias = &mData->booleanAlias[i];
+    if (alias->filterOutput || (alias->negate && alias->aliasType != 1)) {
+      continue; /* negated variables have their own column */
+    }
+    if (alias->aliasType == 1) {
+      int index = booleanParam[alias->nameID];
+      if (index && alias->negate) {
+        index = col_add_param(colData, 'n', alias->nameID);
+      }
+      if (index) {
+        col_add_variable(colData, alias->info.name, alias->info.comment, 1, index);
+      }
+    } else if (booleanCol[alias->nameID]) {
+      col_add_variable(colData, alias->info.name, alias->info.comment, 0, booleanCol[alias->nameID]);
+    }
+  }
+  colData->params.assign(colData->paramType.size(), 0.0);
+
+  colData->chunkRows = COL_CHUNK_VALUES / colData->nvar;
+  if (colData->chunkRows < COL_MIN_CHUNK_ROWS) colData->chunkRows = COL_MIN_CHUNK_ROWS;
+  if (colData->chunkRows > COL_MAX_CHUNK_ROWS) colData->chunkRows = COL_MAX_CHUNK_ROWS;
+  colData->buffer.resize((size_t)colData->chunkRows * colData->nvar);
+  colData->rows = 0;
+  colData->nrows = 0;
+
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+void col_emit(simulation_result *self, DATA *data, threadData_t *threadData)
+{
+  col_data *colData = (col_data*) self->storage;
+  const OUTPUT_PLAN *plan = &colData->plan;
+  double *row;
+  int i;
+
+  rt_tick(SIM_TIMER_OUTPUT);
+  rt_accumulate(SIM_TIMER_TOTAL);
+  double cpuTimeValue = rt_accumulated(SIM_TIMER_TOTAL);
+  rt_tick(SIM_TIMER_TOTAL);
+
+  omc_output_plan_gather(&colData->plan, data);
+  row = &colData->buffer[(size_t)colData->rows * colData->nvar];
+  *row++ = data->localData[0]->timeValue;
+  if (self->cpuTime)
+    *row++ = cpuTimeValue;
+  if (omc_flag[FLAG_SOLVER_STEPS])
+    *row++ = data->simulationInfo->solverSteps;
+  for (i = 0; i < plan->nReal; i++)
+    *row++ = plan->realRow[i];
+  for (i = 0; i < plan->nInteger; i++)
+    *row++ = plan->integerRow[i];
+  for (i = 0; i < OUTPUT_PLAN_BOOLEANS(plan); i++)
+    *row++ = plan->booleanRow[i];
+
+  if (++colData->rows == colData->chunkRows) {
+    col_flush(colData, threadData);
+  }
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+void col_writeParameterData(simulation_result *self, DATA *data, threadData_t *threadData)
+{
+  col_data *colData = (col_data*) self->storage;
+  const SIMULATION_INFO *sInfo = data->simulationInfo;
+  size_t i;
+
+  rt_tick(SIM_TIMER_OUTPUT);
+  for (i = 0; i < colData->params.size(); i++) {
+    int k = colData->paramIndex[i];
+    switch (colData->paramType[i]) {
+    case 'r': colData->params[i] = sInfo->realParameter[k]; break;
+    case 'i': colData->params[i] = sInfo->integerParameter[k]; break;
+    case 'b': colData->params[i] = sInfo->booleanParameter[k]; break;
+    default:  colData->params[i] = sInfo->booleanParameter[k] ? 0 : 1; break;
+    }
+  }
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+void col_free(simulation_result *self, DATA *data, threadData_t *threadData)
+{
+  col_data *colData = (col_data*) self->storage;
+  uint32_t header[5];
+  uint64_t indexOffset;
+  size_t i;
+
+  rt_tick(SIM_TIMER_OUTPUT);
+  col_flush(colData, threadData);
+
+  indexOffset = colData->pos;
+  header[0] = colData->nvar;
+  header[1] = colData->nrows;
+  header[2] = colData->params.size();
+  header[3] = colData->variables.size();
+  header[4] = colData->chunkRowCount.size();
+  col_write(colData, header, sizeof(header), threadData);
+  col_write(colData, colData->params.empty() ? NULL : &colData->params[0], colData->params.size() * sizeof(double), threadData);
+  for (i = 0; i < colData->variables.size(); i++) {
+    const col_variable *var = &colData->variables[i];
+    col_write(colData, &var->isParam, sizeof(int32_t), threadData);
+    col_write(colData, &var->index, sizeof(int32_t), threadData);
+    col_write(colData, var->name.c_str(), var->name.size() + 1, threadData);
+    col_write(colData, var->descr.c_str(), var->descr.size() + 1, threadData);
+  }
+  for (i = 0; i < colData->chunkRowCount.size(); i++) {
+    uint32_t v;
+    col_write(colData, &colData->chunkRowCount[i], sizeof(uint32_t), threadData);
+    for (v = 0; v < colData->nvar; v++) {
+      col_write(colData, &colData->chunkOffset[i*colData->nvar + v], sizeof(uint64_t), threadData);
+      col_write(colData, &colData->chunkSize[i*colData->nvar + v], sizeof(uint32_t), threadData);
+    }
+  }
+  col_write(colData, &indexOffset, sizeof(uint64_t), threadData);
+  col_write(colData, OMC_COLUMNAR_INDEX_MAGIC, 8, threadData);
+
+  fclose(colData->file);
+  omc_output_plan_free(&colData->plan);
+  delete colData;
+  self->storage = NULL;
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+} /* extern "C" */
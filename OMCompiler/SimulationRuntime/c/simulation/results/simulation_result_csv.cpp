@@ -41,24 +41,31 @@
 #include "util/omc_error.h"
 #include "util/omc_file.h"
 #include "simulation_result_csv.h"
+#include "simulation_result_plan.h"
 #include "util/rtclock.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <time.h>
 
 extern "C" {
 
+typedef struct csv_data {
+  FILE *fout;
+  OUTPUT_PLAN plan;
+} csv_data;
+
 void omc_csv_emit(simulation_result *self, DATA *data, threadData_t *threadData)
 {
-  FILE *fout = (FILE*) self->storage;
+  csv_data *csvData = (csv_data*) self->storage;
+  FILE *fout = csvData->fout;
+  const OUTPUT_PLAN *plan = &csvData->plan;
   const char* format = ",%.16g";
   const char* formatint = ",%i";
   const char* formatbool = ",%i";
-  const char* formatstring = ",\"%s\"";
   int i;
-  modelica_real value = 0;
   double cpuTimeValue = 0;
   rt_tick(SIM_TIMER_OUTPUT);
 
@@ -66,48 +73,25 @@ void omc_csv_emit(simulation_result *self, DATA *data, threadData_t *threadData)
   cpuTimeValue = rt_accumulated(SIM_TIMER_TOTAL);
   rt_tick(SIM_TIMER_TOTAL);
 
+  omc_output_plan_gather(&csvData->plan, data);
+
   fprintf(fout, "%.16g", data->localData[0]->timeValue);
   if(self->cpuTime)
     fprintf(fout, format, cpuTimeValue);
-  for(i = 0; i < data->modelData->nVariablesReal; i++) if(!data->modelData->realVarsData[i].filterOutput)
-    fprintf(fout, format, (data->localData[0])->realVars[i]);
-  for(i = 0; i < data->modelData->nVariablesInteger; i++) if(!data->modelData->integerVarsData[i].filterOutput)
-    fprintf(fout, formatint, (data->localData[0])->integerVars[i]);
-  for(i = 0; i < data->modelData->nVariablesBoolean; i++) if(!data->modelData->booleanVarsData[i].filterOutput)
-    fprintf(fout, formatbool, (data->localData[0])->booleanVars[i]);
-  //for(i = 0; i < data->modelData->nVariablesString; i++) if(!data->modelData->stringVarsData[i].filterOutput)
-  //  fprintf(fout, formatstring, MMC_STRINGDATA((data->localData[0])->stringVars[i]));
-
-  for(i = 0; i < data->modelData->nAliasReal; i++) if(!data->modelData->realAlias[i].filterOutput && data->modelData->realAlias[i].aliasType != 1) {
-    if (data->modelData->realAlias[i].aliasType == 2) {
-      value = (data->localData[0])->timeValue;
-    } else {
-      value = (data->localData[0])->realVars[data->modelData->realAlias[i].nameID];
-    }
-    if (data->modelData->realAlias[i].negate) {
-      fprintf(fout, format, -value);
-    } else {
-      fprintf(fout, format, value);
-    }
-  }
-  for(i = 0; i < data->modelData->nAliasInteger; i++) if(!data->modelData->integerAlias[i].filterOutput && data->modelData->integerAlias[i].aliasType != 1) {
-    if (data->modelData->integerAlias[i].negate) {
-      fprintf(fout, formatint, -(data->localData[0])->integerVars[data->modelData->integerAlias[i].nameID]);
-    } else {
-      fprintf(fout, formatint, (data->localData[0])->integerVars[data->modelData->integerAlias[i].nameID]);
-    }
-  }
-  for(i = 0; i < data->modelData->nAliasBoolean; i++) if(!data->modelData->booleanAlias[i].filterOutput && data->modelData->booleanAlias[i].aliasType != 1) {
-    if (data->modelData->booleanAlias[i].negate) {
-      fprintf(fout, formatbool, (data->localData[0])->booleanVars[data->modelData->booleanAlias[i].nameID]==1?0:1);
-    } else {
-      fprintf(fout, formatbool, (data->localData[0])->booleanVars[data->modelData->booleanAlias[i].nameID]);
-    }
-  }
-  //for(i = 0; i < data->modelData->nAliasString; i++) if(!data->modelData->stringAlias[i].filterOutput && data->modelData->stringAlias[i].aliasType != 1) {
-  //  /* there would no negation of a string happen */
-  //  fprintf(fout, formatstring, MMC_STRINGDATA((data->localData[0])->stringVars[data->modelData->stringAlias[i].nameID]));
-  //}
+  for(i = 0; i < plan->nReal; i++)
+    fprintf(fout, format, plan->realRow[i]);
+  for(i = 0; i < plan->nInteger; i++)
+    fprintf(fout, formatint, plan->integerRow[i]);
+  for(i = 0; i < plan->nBoolean; i++)
+    fprintf(fout, formatbool, plan->booleanRow[i]);
+  /* strings are not written */
+
+  for(i = plan->nReal; i < OUTPUT_PLAN_REALS(plan); i++)
+    fprintf(fout, format, plan->realRow[i]);
+  for(i = plan->nInteger; i < OUTPUT_PLAN_INTEGERS(plan); i++)
+    fprintf(fout, formatint, plan->integerRow[i]);
+  for(i = plan->nBoolean; i < OUTPUT_PLAN_BOOLEANS(plan); i++)
+    fprintf(fout, formatbool, plan->booleanRow[i]);
   fprintf(fout, "\n");
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
@@ -143,14 +127,21 @@ void omc_csv_init(simulation_result *self, DATA *data, threadData_t *threadData)
   //for(i = 0; i < mData->nAliasString; i++) if(!mData->stringAlias[i].filterOutput && data->modelData->stringAlias[i].aliasType != 1)
   //  fprintf(fout, format, mData->stringAlias[i].info.name);
   fprintf(fout, "\n");
-  self->storage = fout;
+
+  csv_data *csvData = (csv_data*) malloc(sizeof(csv_data));
+  csvData->fout = fout;
+  omc_output_plan_init(&csvData->plan, mData, OUTPUT_PLAN_VARIABLE_ALIASES);
+  self->storage = csvData;
 }
 
 void omc_csv_free(simulation_result *self, DATA *data, threadData_t *threadData)
 {
-  FILE *fout = (FILE*) self->storage;
+  csv_data *csvData = (csv_data*) self->storage;
   rt_tick(SIM_TIMER_OUTPUT);
-  fclose(fout);
+  fclose(csvData->fout);
+  omc_output_plan_free(&csvData->plan);
+  free(csvData);
+  self->storage = NULL;
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
 
@@ -39,11 +39,33 @@
  * A message with ID=2 contains the number of Real, Integer, Boolean and String variables together with their names.
  * A message with ID=4 contains all the values (same order as for ID=2: Real, Integer, Boolean, String).
  * A message with ID=6 indicates that the simulation is completed.
+ *
+ * Streaming of selected signals:
+ * A client can send a message with ID=8 to subscribe to a subset of the signals:
+ *   DATA: [DECIMATION | INTERVAL | N | INDEX_1 ... INDEX_N]
+ *   DECIMATION: 4 bytes, only every DECIMATION-th output step is sampled (0 and 1 sample every step)
+ *   INTERVAL: 8 bytes (double), minimal simulation time between two samples
+ *   N: 4 bytes, number of signals; N=0 pauses the streaming
+ *   INDEX_i: 4 bytes, position of the signal in the message with ID=2 (Real, Integer, Boolean);
+ *            String signals cannot be subscribed
+ * With the simulation flag -portSubscribe the simulation waits for the first message of the
+ * client before the first output step.
+ * After the first subscription no more messages with ID=4 are sent. Instead a background thread
+ * sends the sampled rows in batches with ID=10:
+ *   DATA: [N | ROWS | ROW_1 ... ROW_ROWS]
+ *   ROW: [TIME | MASK | VALUES]
+ *   TIME: 8 bytes (double)
+ *   MASK: (N+7)/8 bytes, bit i%8 of byte i/8 is set if signal i changed since the previous row
+ *   VALUES: the values of the changed signals as doubles (8 bytes each)
+ * The first row after a subscription contains all signals. Integers, booleans and doubles are
+ * sent in host byte order, like the other messages.
  */
 
 #include "util/omc_error.h"
 #include "simulation_result_ia.h"
+#include "simulation_result_plan.h"
 #include "util/rtclock.h"
+#include "simulation/options.h"
 
 #include <fstream>
 #include <iostream>
@@ -54,17 +76,289 @@
 #include <cstdlib>
 #include <stdint.h>
 #include <assert.h>
+#include <float.h>
+#include <time.h>
+#include <vector>
+#include <pthread.h>
 #include "../simulation_runtime.h"
 #include "meta/meta_modelica.h"
 
+/* A subscribed signal and where its value is stored */
+typedef struct IA_SIGNAL
+{
+  char type;      /* 0: Real, 1: Integer, 2: Boolean */
+  char source;    /* OUTPUT_PLAN_SOURCE */
+  int index;
+  modelica_boolean negate;
+} IA_SIGNAL;
+
 typedef struct IA_DATA
 {
   unsigned int nReal;
   unsigned int nInteger;
   unsigned int nBoolean;
   unsigned int nString;
+  OUTPUT_PLAN plan;
+  /* buffer for the value messages, only grows with the length of the string values */
+  char *msgDATA;
+  unsigned int msgCapacity;
+
+  /* streaming of subscribed signals, see the protocol above */
+  pthread_t thread;
+  pthread_mutex_t mutex;      /* protects everything below and the messages with ID=4 */
+  pthread_cond_t cond;
+  int running;
+  int subscribed;
+  std::vector<IA_SIGNAL> signals;
+  unsigned int decimation;
+  double interval;
+  unsigned long nEmits;
+  double nextSample;
+  std::vector<double> pending; /* sampled rows [time, values...] not sent yet */
 } IA_DATA;
 
+/* maximum number of buffered values, rows are dropped if the client does not keep up */
+#define IA_MAX_PENDING (1<<22)
+
+static modelica_real ia_signal_value(const IA_SIGNAL *signal, const DATA *data)
+{
+  const SIMULATION_DATA *sData = data->localData[0];
+  const SIMULATION_INFO *sInfo = data->simulationInfo;
+
+  switch(signal->type)
+  {
+  case 0:
+  {
+    modelica_real value = signal->source == OUTPUT_SOURCE_TIME ? sData->timeValue
+      : signal->source == OUTPUT_SOURCE_PARAMETER ? sInfo->realParameter[signal->index]
+      : sData->realVars[signal->index];
+    return signal->negate ? -value : value;
+  }
+  case 1:
+  {
+    modelica_integer value = signal->source == OUTPUT_SOURCE_PARAMETER ? sInfo->integerParameter[signal->index]
+      : sData->integerVars[signal->index];
+    return signal->negate ? -value : value;
+  }
+  default:
+  {
+    modelica_boolean value = signal->source == OUTPUT_SOURCE_PARAMETER ? sInfo->booleanParameter[signal->index]
+      : sData->booleanVars[signal->index];
+    return signal->negate ? (value==1?0:1) : value;
+  }
+  }
+}
+
+/* resolves a position of the message with ID=2, returns 0 for String and invalid signals */
+static int ia_resolve_signal(const IA_DATA *iaData, unsigned int k, IA_SIGNAL *signal)
+{
+  const OUTPUT_PLAN *plan = &iaData->plan;
+  const OUTPUT_PLAN_ALIASES *aliases;
+  const int *index;
+  int nVars;
+
+  signal->negate = 0;
+  if(k == 0)
+  {
+    signal->type = 0;
+    signal->source = OUTPUT_SOURCE_TIME;
+    signal->index = 0;
+    return 1;
+  }
+
+  if(k < iaData->nReal) {
+    k -= 1; signal->type = 0; nVars = plan->nReal; index = plan->realIndex; aliases = &plan->realAlias;
+  } else if((k -= iaData->nReal) < iaData->nInteger) {
+    signal->type = 1; nVars = plan->nInteger; index = plan->integerIndex; aliases = &plan->integerAlias;
+  } else if((k -= iaData->nInteger) < iaData->nBoolean) {
+    signal->type = 2; nVars = plan->nBoolean; index = plan->booleanIndex; aliases = &plan->booleanAlias;
+  } else {
+    return 0;
+  }
+
+  if((int)k < nVars)
+  {
+    signal->source = OUTPUT_SOURCE_VARIABLE;
+    signal->index = index[k];
+  }
+  else
+  {
+    k -= nVars;
+    signal->source = aliases->source[k];
+    signal->index = aliases->index[k];
+    signal->negate = aliases->negate[k];
+  }
+  return 1;
+}
+
+/* handles a subscription (ID=8) of the client */
+static void ia_subscribe(IA_DATA *iaData, const char *msg, unsigned int size)
+{
+  unsigned int decimation, n, k, i;
+  double interval;
+  std::vector<IA_SIGNAL> signals;
+  IA_SIGNAL signal;
+
+  if(size < 2*sizeof(unsigned int) + sizeof(double))
+  {
+    warningStreamPrint(LOG_STDOUT, 0, "Ignoring malformed subscription message.");
+    return;
+  }
+  memcpy(&decimation, msg, sizeof(unsigned int)); msg += sizeof(unsigned int);
+  memcpy(&interval, msg, sizeof(double)); msg += sizeof(double);
+  memcpy(&n, msg, sizeof(unsigned int)); msg += sizeof(unsigned int);
+  if((size - 2*sizeof(unsigned int) - sizeof(double)) / sizeof(unsigned int) < n)
+  {
+    warningStreamPrint(LOG_STDOUT, 0, "Ignoring malformed subscription message.");
+    return;
+  }
+
+  for(i=0; i<n; i++)
+  {
+    memcpy(&k, msg, sizeof(unsigned int)); msg += sizeof(unsigned int);
+    if(ia_resolve_signal(iaData, k, &signal))
+      signals.push_back(signal);
+    else
+      warningStreamPrint(LOG_STDOUT, 0, "Cannot subscribe to signal %u, only Real, Integer and Boolean signals can be streamed.", k);
+  }
+
+  pthread_mutex_lock(&iaData->mutex);
+  iaData->signals.swap(signals);
+  iaData->decimation = decimation > 1 ? decimation : 1;
+  iaData->interval = interval;
+  iaData->nEmits = 0;
+  iaData->nextSample = -DBL_MAX;
+  iaData->pending.clear();
+  iaData->subscribed = 1;
+  pthread_mutex_unlock(&iaData->mutex);
+}
+
+/* receives a message of the client
+ * returns -1 if the connection was closed, 1 for a subscription and 0 otherwise
+ */
+static int ia_receive(IA_DATA *iaData)
+{
+  char id;
+  unsigned int size;
+  char *msg = NULL;
+  int result = 0;
+
+  if(!communicateRecvMsg(&id, &size, &msg))
+    return -1;
+  if(id == 8)
+  {
+    ia_subscribe(iaData, msg, size);
+    result = 1;
+  }
+  free(msg);
+  return result;
+}
+
+/* samples the subscribed signals, called with the mutex locked */
+static void ia_sample(IA_DATA *iaData, const DATA *data)
+{
+  double time = data->localData[0]->timeValue;
+  size_t i;
+
+  if((iaData->nEmits++ % iaData->decimation) != 0 || time < iaData->nextSample || iaData->signals.empty())
+    return;
+  if(iaData->pending.size() + iaData->signals.size() + 1 > IA_MAX_PENDING)
+    return;
+
+  iaData->nextSample = time + iaData->interval;
+  iaData->pending.push_back(time);
+  for(i=0; i<iaData->signals.size(); i++)
+    iaData->pending.push_back(ia_signal_value(&iaData->signals[i], data));
+  pthread_cond_signal(&iaData->cond);
+}
+
+/* encodes the rows relative to the previously sent values and sends them with ID=10 */
+static void ia_send_batch(const std::vector<double> &rows, unsigned int n, std::vector<double> &last, int *fresh, std::vector<char> &batch)
+{
+  unsigned int nRows = rows.size() / (n+1);
+  unsigned int maskSize = (n+7)/8;
+  const double *row = &rows[0];
+  unsigned int r, i;
+
+  batch.resize(2*sizeof(unsigned int));
+  memcpy(&batch[0], &n, sizeof(unsigned int));
+  memcpy(&batch[sizeof(unsigned int)], &nRows, sizeof(unsigned int));
+
+  for(r=0; r<nRows; r++, row += n+1)
+  {
+    size_t mask = batch.size() + sizeof(double);
+    batch.insert(batch.end(), (const char*)row, (const char*)(row+1));
+    batch.resize(batch.size() + maskSize, 0);
+    for(i=0; i<n; i++)
+    {
+      /* compare the bits, changes of the sign of zero and NaN are sent too */
+      if(!*fresh && memcmp(&last[i], &row[i+1], sizeof(double)) == 0)
+        continue;
+      last[i] = row[i+1];
+      batch[mask + i/8] |= (char)(1 << (i%8));
+      batch.insert(batch.end(), (const char*)&row[i+1], (const char*)(&row[i+2]));
+    }
+    *fresh = 0;
+  }
+
+  communicateMsg(10, batch.size(), &batch[0]);
+}
+
+/* sends the sampled rows and receives the subscriptions of the client */
+static void* ia_stream_thread(void *arg)
+{
+  IA_DATA *iaData = (IA_DATA*) arg;
+  std::vector<double> rows, last;
+  std::vector<char> batch;
+  unsigned int n = 0;
+  int fresh = 1;
+  int connected = 1;
+  struct timespec timeout;
+
+  pthread_mutex_lock(&iaData->mutex);
+  while(iaData->running || !iaData->pending.empty())
+  {
+    if(iaData->running && iaData->pending.empty())
+    {
+      clock_gettime(CLOCK_REALTIME, &timeout);
+      timeout.tv_nsec += 20000000;
+      if(timeout.tv_nsec >= 1000000000) {
+        timeout.tv_sec++;
+        timeout.tv_nsec -= 1000000000;
+      }
+      pthread_cond_timedwait(&iaData->cond, &iaData->mutex, &timeout);
+    }
+
+    rows.swap(iaData->pending);
+    if(fresh) {
+      /* new subscription, the next row contains all values */
+      n = iaData->signals.size();
+      last.assign(n, 0.0);
+    }
+    pthread_mutex_unlock(&iaData->mutex);
+
+    if(!rows.empty())
+    {
+      ia_send_batch(rows, n, last, &fresh, batch);
+      rows.clear();
+    }
+
+    while(connected && iaData->running && communicateWaitMsg(0))
+    {
+      switch(ia_receive(iaData))
+      {
+      case -1: connected = 0; break;
+      case 1: fresh = 1; break;
+      }
+    }
+
+    pthread_mutex_lock(&iaData->mutex);
+  }
+  pthread_mutex_unlock(&iaData->mutex);
+
+  return NULL;
+}
+
 void ia_init(simulation_result *self, DATA *data, threadData_t *threadData)
 {
   TRACE_PUSH
@@ -195,6 +489,24 @@ void ia_init(simulation_result *self, DATA *data, threadData_t *threadData)
   communicateMsg(2, msgSIZE, msgDATA);
   delete[] msgDATA;
 
+  omc_output_plan_init(&iaData->plan, mData, OUTPUT_PLAN_VARIABLE_ALIASES);
+  iaData->msgCapacity = iaData->nReal*sizeof(modelica_real) + iaData->nInteger*sizeof(modelica_integer) + iaData->nBoolean*sizeof(modelica_boolean) + iaData->nString;
+  iaData->msgDATA = new char[iaData->msgCapacity];
+
+  pthread_mutex_init(&iaData->mutex, NULL);
+  pthread_cond_init(&iaData->cond, NULL);
+  iaData->subscribed = 0;
+  /* with -portSubscribe the first output step waits for the first message of the client,
+   * so a client that subscribes right away gets all output steps */
+  if(omc_flag[FLAG_PORT_SUBSCRIBE] && communicateWaitMsg(-1))
+    ia_receive(iaData);
+  iaData->running = 1;
+  if(pthread_create(&iaData->thread, NULL, ia_stream_thread, iaData))
+  {
+    warningStreamPrint(LOG_STDOUT, 0, "Could not start the streaming thread, subscriptions are not available.");
+    iaData->running = 0;
+  }
+
   TRACE_POP
 }
 
@@ -204,91 +516,56 @@ void ia_emit(simulation_result *self, DATA *data, threadData_t *threadData)
   rt_tick(SIM_TIMER_OUTPUT);
 
   int i;
-  const IA_DATA *iaData = (IA_DATA*)self->storage;
+  IA_DATA *iaData = (IA_DATA*)self->storage;
+  OUTPUT_PLAN *plan = &iaData->plan;
 
-  // count string length
-  unsigned int strLength = 0;
-  for(i=0; i<data->modelData->nVariablesString; i++) if(!data->modelData->stringVarsData[i].filterOutput) {
-    strLength += MMC_STRLEN(data->localData[0]->stringVars[i]) + 1;
-  }
-  for(i=0; i<data->modelData->nAliasString; i++) if(!data->modelData->stringAlias[i].filterOutput && data->modelData->stringAlias[i].aliasType != 1) {
-    strLength += MMC_STRLEN(data->localData[0]->stringVars[data->modelData->stringAlias[i].nameID]) + 1;
-  }
-
-  unsigned int msgSIZE = iaData->nReal*sizeof(modelica_real) + iaData->nInteger*sizeof(modelica_integer) + iaData->nBoolean*sizeof(modelica_boolean) + strLength;
-  char* msgDATA = new char[msgSIZE];
-  unsigned int offset = 0;
-
-  // time
-  memcpy(msgDATA+offset, &(data->localData[0]->timeValue), sizeof(modelica_real)); offset += sizeof(modelica_real);
-  for(i=0; i<data->modelData->nVariablesReal; i++) if(!data->modelData->realVarsData[i].filterOutput)
+  pthread_mutex_lock(&iaData->mutex);
+  if(iaData->subscribed)
   {
-    memcpy(msgDATA+offset, &(data->localData[0]->realVars[i]), sizeof(modelica_real)); offset += sizeof(modelica_real);
+    ia_sample(iaData, data);
+    pthread_mutex_unlock(&iaData->mutex);
+    rt_accumulate(SIM_TIMER_OUTPUT);
+    TRACE_POP
+    return;
   }
 
-  modelica_real value = 0;
-  for(i=0; i<data->modelData->nAliasReal; i++) if(!data->modelData->realAlias[i].filterOutput && data->modelData->realAlias[i].aliasType != 1)
-  {
-    if (data->modelData->realAlias[i].aliasType == 2)
-      value = (data->localData[0])->timeValue;
-    else
-      value = (data->localData[0])->realVars[data->modelData->realAlias[i].nameID];
+  omc_output_plan_gather(plan, data);
 
-    if (data->modelData->realAlias[i].negate)
-      value *= -1.0;
-
-    memcpy(msgDATA+offset, &value, sizeof(modelica_real)); offset += sizeof(modelica_real);
-  }
-
-
-  for(i=0; i<data->modelData->nVariablesInteger; i++) if(!data->modelData->integerVarsData[i].filterOutput)
-  {
-    memcpy(msgDATA+offset, &(data->localData[0]->integerVars[i]), sizeof(modelica_integer)); offset += sizeof(modelica_integer);
-  }
-
-  modelica_integer intValue = 0;
-  for(i=0; i<data->modelData->nAliasInteger; i++) if(!data->modelData->integerAlias[i].filterOutput && data->modelData->integerAlias[i].aliasType != 1)
-  {
-    if (data->modelData->integerAlias[i].negate)
-      intValue = -(data->localData[0]->integerVars[data->modelData->integerAlias[i].nameID]);
-    else
-      intValue = data->localData[0]->integerVars[data->modelData->integerAlias[i].nameID];
-
-    memcpy(msgDATA+offset, &intValue, sizeof(modelica_integer)); offset += sizeof(modelica_integer);
+  // count string length
+  unsigned int strLength = 0;
+  for(i=0; i<OUTPUT_PLAN_STRINGS(plan); i++) {
+    strLength += MMC_STRLEN(plan->stringRow[i]) + 1;
   }
 
-
-  for(i=0; i<data->modelData->nVariablesBoolean; i++) if(!data->modelData->booleanVarsData[i].filterOutput)
+  unsigned int msgSIZE = iaData->nReal*sizeof(modelica_real) + iaData->nInteger*sizeof(modelica_integer) + iaData->nBoolean*sizeof(modelica_boolean) + strLength;
+  if(msgSIZE > iaData->msgCapacity)
   {
-    memcpy(msgDATA+offset, &(data->localData[0]->booleanVars[i]), sizeof(modelica_boolean)); offset += sizeof(modelica_boolean);
+    delete[] iaData->msgDATA;
+    iaData->msgCapacity = msgSIZE + msgSIZE/2;
+    iaData->msgDATA = new char[iaData->msgCapacity];
   }
+  char* msgDATA = iaData->msgDATA;
+  unsigned int offset = 0;
 
-  modelica_boolean boolValue;
-  for(i=0; i<data->modelData->nAliasBoolean; i++) if(!data->modelData->booleanAlias[i].filterOutput && data->modelData->booleanAlias[i].aliasType != 1)
-  {
-    if (data->modelData->booleanAlias[i].negate)
-      boolValue = (data->localData[0])->booleanVars[data->modelData->booleanAlias[i].nameID]==1?0:1;
-    else
-      boolValue = (data->localData[0])->booleanVars[data->modelData->booleanAlias[i].nameID];
-
-    memcpy(msgDATA+offset, &boolValue, sizeof(modelica_boolean)); offset += sizeof(modelica_boolean);
-  }
+  // time, real variables and aliases
+  memcpy(msgDATA+offset, &(data->localData[0]->timeValue), sizeof(modelica_real)); offset += sizeof(modelica_real);
+  memcpy(msgDATA+offset, plan->realRow, OUTPUT_PLAN_REALS(plan)*sizeof(modelica_real)); offset += OUTPUT_PLAN_REALS(plan)*sizeof(modelica_real);
 
+  // integer variables and aliases
+  memcpy(msgDATA+offset, plan->integerRow, OUTPUT_PLAN_INTEGERS(plan)*sizeof(modelica_integer)); offset += OUTPUT_PLAN_INTEGERS(plan)*sizeof(modelica_integer);
 
-  for(i=0; i<data->modelData->nVariablesString; i++) if(!data->modelData->stringVarsData[i].filterOutput)
-  {
-    strLength = MMC_STRLEN((data->localData[0])->stringVars[i]) + 1;
-    memcpy(msgDATA+offset, MMC_STRINGDATA((data->localData[0])->stringVars[i]), strLength); offset += strLength;
-  }
+  // boolean variables and aliases
+  memcpy(msgDATA+offset, plan->booleanRow, OUTPUT_PLAN_BOOLEANS(plan)*sizeof(modelica_boolean)); offset += OUTPUT_PLAN_BOOLEANS(plan)*sizeof(modelica_boolean);
 
-  for(i=0; i<data->modelData->nAliasString; i++) if(!data->modelData->stringAlias[i].filterOutput && data->modelData->stringAlias[i].aliasType != 1)
+  // string variables and aliases
+  for(i=0; i<OUTPUT_PLAN_STRINGS(plan); i++)
   {
-    strLength = MMC_STRLEN((data->localData[0])->stringVars[data->modelData->stringAlias[i].nameID]) + 1;
-    memcpy(msgDATA+offset, MMC_STRINGDATA((data->localData[0])->stringVars[data->modelData->stringAlias[i].nameID]), strLength); offset += strLength;
+    strLength = MMC_STRLEN(plan->stringRow[i]) + 1;
+    memcpy(msgDATA+offset, MMC_STRINGDATA(plan->stringRow[i]), strLength); offset += strLength;
   }
 
   communicateMsg(4, msgSIZE, msgDATA);
-  delete[] msgDATA;
+  pthread_mutex_unlock(&iaData->mutex);
 
   rt_accumulate(SIM_TIMER_OUTPUT);
   TRACE_POP
@@ -299,7 +576,20 @@ void ia_free(simulation_result *self, DATA *data, threadData_t *threadData)
   TRACE_PUSH
   rt_tick(SIM_TIMER_OUTPUT);
 
-  delete (IA_DATA*)self->storage;
+  IA_DATA *iaData = (IA_DATA*)self->storage;
+  pthread_mutex_lock(&iaData->mutex);
+  int running = iaData->running;
+  iaData->running = 0;
+  pthread_cond_signal(&iaData->cond);
+  pthread_mutex_unlock(&iaData->mutex);
+  if(running)
+    pthread_join(iaData->thread, NULL);
+  pthread_cond_destroy(&iaData->cond);
+  pthread_mutex_destroy(&iaData->mutex);
+
+  omc_output_plan_free(&iaData->plan);
+  delete[] iaData->msgDATA;
+  delete iaData;
   communicateMsg(6, 0, 0);
 
   rt_accumulate(SIM_TIMER_OUTPUT);
@@ -34,6 +34,7 @@
 #include "util/rtclock.h"
 #include "simulation/options.h"
 #include "simulation_result_mat4.h"
+#include "simulation_result_plan.h"
 
 #include <fstream>
 #include <iostream>
@@ -45,6 +46,28 @@
 #include <stdint.h>
 #include <assert.h>
 
+/* Copies the gathered signals of data_2 after time, $cpuTime and $solverSteps */
+template<typename T>
+static void fill_data_2(T *row, const OUTPUT_PLAN *plan, const DATA *data)
+{
+  const MODEL_DATA *mData = data->modelData;
+  int i;
+
+  for (i = 0; i < plan->nReal; i++)
+    *row++ = (T) plan->realRow[i];
+
+  if (omc_flag[FLAG_IDAS])
+    for (i = mData->nSensitivityParamVars; i < mData->nSensitivityVars; i++)
+      *row++ = (T) data->simulationInfo->sensitivityMatrix[i];
+
+  for (i = 0; i < plan->nInteger; i++)
+    *row++ = (T) plan->integerRow[i];
+
+  /* the variables followed by the negated boolean aliases */
+  for (i = 0; i < OUTPUT_PLAN_BOOLEANS(plan); i++)
+    *row++ = (T) plan->booleanRow[i];
+}
+
 extern "C" {
 
 typedef struct mat_data {
@@ -58,6 +81,7 @@ typedef struct mat_data {
   size_t sync;
   void* data_2;
   MatVer4Type_t type;
+  OUTPUT_PLAN plan; /* the signals of data_2 */
 } mat_data;
 
 static const char timeName[] = "time";
@@ -707,6 +731,8 @@ void mat4_writeParameterData4(simulation_result *self, DATA *data, threadData_t
   //  Data Type: IEEE 754 double-precision
   matData->data2HdrPos = ftell(matData->pFile);
   matData->data_2 = malloc(size * matData->nData2);
+  /* other aliases refer to their variable in dataInfo, only negated booleans are stored */
+  omc_output_plan_init(&matData->plan, mData, OUTPUT_PLAN_SKIP_TIME_UNVARYING | OUTPUT_PLAN_VARIABLE_ALIASES | OUTPUT_PLAN_NEGATED_BOOLEANS_ONLY);
   writeMatrix_matVer4(matData->pFile, "data_2", matData->nData2, 0, NULL, matData->type);
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
@@ -714,8 +740,6 @@ void mat4_writeParameterData4(simulation_result *self, DATA *data, threadData_t
 void mat4_emit4(simulation_result *self, DATA *data, threadData_t *threadData)
 {
   mat_data *matData = (mat_data*) self->storage;
-  const SIMULATION_INFO *sInfo = data->simulationInfo;
-  const MODEL_DATA      *mData = data->modelData;
 
   if (!matData->pFile)
     return;
@@ -735,27 +759,11 @@ void mat4_emit4(simulation_result *self, DATA *data, threadData_t *threadData)
   if (omc_flag[FLAG_SOLVER_STEPS])
     WRITE_REAL_VALUE(matData->data_2, cur++, data->simulationInfo->solverSteps);
 
-  for (int i=0; i < mData->nVariablesReal; i++)
-    if (!mData->realVarsData[i].filterOutput && !mData->realVarsData[i].time_unvarying)
-      WRITE_REAL_VALUE(matData->data_2, cur++, data->localData[0]->realVars[i]);
-
-  if (omc_flag[FLAG_IDAS])
-    for (int i=mData->nSensitivityParamVars; i < mData->nSensitivityVars; i++)
-      WRITE_REAL_VALUE(matData->data_2, cur++, data->simulationInfo->sensitivityMatrix[i]);
-
-  for (int i=0; i < mData->nVariablesInteger; i++)
-    if (!mData->integerVarsData[i].filterOutput && !mData->integerVarsData[i].time_unvarying)
-      WRITE_REAL_VALUE(matData->data_2, cur++, data->localData[0]->integerVars[i]);
-
-  for (int i=0; i < mData->nVariablesBoolean; i++)
-    if (!mData->booleanVarsData[i].filterOutput && !mData->booleanVarsData[i].time_unvarying)
-      WRITE_REAL_VALUE(matData->data_2, cur++, data->localData[0]->booleanVars[i]);
-
-  for (int i=0; i < mData->nAliasBoolean; i++)
-    if (!mData->booleanAlias[i].filterOutput)
-      if (mData->booleanAlias[i].aliasType == 0)
-        if (mData->booleanAlias[i].negate)
-          WRITE_REAL_VALUE(matData->data_2, cur++, (1-data->localData[0]->booleanVars[mData->booleanAlias[i].nameID]));
+  omc_output_plan_gather(&matData->plan, data);
+  if (matData->type == MatVer4Type_SINGLE)
+    fill_data_2((float*) matData->data_2 + cur, &matData->plan, data);
+  else
+    fill_data_2((double*) matData->data_2 + cur, &matData->plan, data);
 
   fwrite(matData->data_2, sizeofMatVer4Type(matData->type), matData->nData2, matData->pFile);
   matData->nEmits++;
@@ -789,6 +797,7 @@ void mat4_free4(simulation_result *self, DATA *data, threadData_t *threadData)
     free(matData->data_2);
     matData->data_2 = NULL;
   }
+  omc_output_plan_free(&matData->plan);
 
   fclose(matData->pFile);
   matData->pFile = NULL;
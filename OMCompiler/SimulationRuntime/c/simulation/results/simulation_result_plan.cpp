@@ -0,0 +1,183 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+#include "simulation_result_plan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Returns the indices of the emitted variables and the length of the leading run index[i] == i */
+template<typename STATIC_DATA>
+static int* plan_variables(int n, const STATIC_DATA *vars, int flags, int *nOut, int *nBlock)
+{
+  int *index = (int*) malloc((n > 0 ? n : 1) * sizeof(int));
+  int i, k = 0;
+  for (i = 0; i < n; i++) {
+    if (vars[i].filterOutput || ((flags & OUTPUT_PLAN_SKIP_TIME_UNVARYING) && vars[i].time_unvarying)) {
+      continue;
+    }
+    index[k++] = i;
+  }
+  *nOut = k;
+  for (*nBlock = 0; *nBlock < k && index[*nBlock] == *nBlock; (*nBlock)++);
+  return index;
+}
+
+/* Resolves the aliases that need their own values. Aliases of time are only
+ * possible for Real; for the other types aliasType 2 is read from the variables
+ * as the writers always did. */
+static void plan_aliases(OUTPUT_PLAN_ALIASES *aliases, int n, const DATA_ALIAS *alias, int flags, int isBoolean, int isReal)
+{
+  int i, k = 0;
+  aliases->source = (char*) malloc(n > 0 ? n : 1);
+  aliases->index = (int*) malloc((n > 0 ? n : 1) * sizeof(int));
+  aliases->negate = (modelica_boolean*) malloc((n > 0 ? n : 1) * sizeof(modelica_boolean));
+  for (i = 0; i < n; i++) {
+    if (alias[i].filterOutput) {
+      continue;
+    }
+    if (alias[i].aliasType == 1 ? !(flags & OUTPUT_PLAN_PARAMETER_ALIASES) : !(flags & OUTPUT_PLAN_VARIABLE_ALIASES)) {
+      continue;
+    }
+    if ((flags & OUTPUT_PLAN_NEGATED_BOOLEANS_ONLY) && !(isBoolean && alias[i].negate)) {
+      continue;
+    }
+    if (alias[i].aliasType == 1) {
+      aliases->source[k] = OUTPUT_SOURCE_PARAMETER;
+      aliases->index[k] = alias[i].nameID;
+    } else if (alias[i].aliasType == 2 && isReal) {
+      aliases->source[k] = OUTPUT_SOURCE_TIME;
+      aliases->index[k] = 0;
+    } else {
+      aliases->source[k] = OUTPUT_SOURCE_VARIABLE;
+      aliases->index[k] = alias[i].nameID;
+    }
+    aliases->negate[k] = alias[i].negate ? 1 : 0;
+    k++;
+  }
+  aliases->n = k;
+}
+
+static void free_aliases(OUTPUT_PLAN_ALIASES *aliases)
+{
+  free(aliases->source);
+  free(aliases->index);
+  free(aliases->negate);
+  aliases->n = 0;
+}
+
+extern "C" {
+
+void omc_output_plan_init(OUTPUT_PLAN *plan, const MODEL_DATA *modelData, int flags)
+{
+  plan->realIndex = plan_variables(modelData->nVariablesReal, modelData->realVarsData, flags, &plan->nReal, &plan->nRealBlock);
+  plan->integerIndex = plan_variables(modelData->nVariablesInteger, modelData->integerVarsData, flags, &plan->nInteger, &plan->nIntegerBlock);
+  plan->booleanIndex = plan_variables(modelData->nVariablesBoolean, modelData->booleanVarsData, flags, &plan->nBoolean, &plan->nBooleanBlock);
+  plan->stringIndex = plan_variables(modelData->nVariablesString, modelData->stringVarsData, flags, &plan->nString, &plan->nStringBlock);
+
+  plan_aliases(&plan->realAlias, modelData->nAliasReal, modelData->realAlias, flags, 0, 1);
+  plan_aliases(&plan->integerAlias, modelData->nAliasInteger, modelData->integerAlias, flags, 0, 0);
+  plan_aliases(&plan->booleanAlias, modelData->nAliasBoolean, modelData->booleanAlias, flags, 1, 0);
+  plan_aliases(&plan->stringAlias, modelData->nAliasString, modelData->stringAlias, flags, 0, 0);
+
+  plan->realRow = (modelica_real*) calloc(OUTPUT_PLAN_REALS(plan) + 1, sizeof(modelica_real));
+  plan->integerRow = (modelica_integer*) calloc(OUTPUT_PLAN_INTEGERS(plan) + 1, sizeof(modelica_integer));
+  plan->booleanRow = (modelica_boolean*) calloc(OUTPUT_PLAN_BOOLEANS(plan) + 1, sizeof(modelica_boolean));
+  plan->stringRow = (modelica_string*) calloc(OUTPUT_PLAN_STRINGS(plan) + 1, sizeof(modelica_string));
+}
+
+void omc_output_plan_gather(OUTPUT_PLAN *plan, const DATA *data)
+{
+  const SIMULATION_DATA *sData = data->localData[0];
+  const SIMULATION_INFO *sInfo = data->simulationInfo;
+  const modelica_real *realSource[3] = {sData->realVars, sInfo->realParameter, &sData->timeValue};
+  const modelica_integer *integerSource[3] = {sData->integerVars, sInfo->integerParameter, sData->integerVars};
+  const modelica_boolean *booleanSource[3] = {sData->booleanVars, sInfo->booleanParameter, sData->booleanVars};
+  const modelica_string *stringSource[3] = {sData->stringVars, sInfo->stringParameter, sData->stringVars};
+  int i, k;
+
+  /* variables */
+  memcpy(plan->realRow, sData->realVars, plan->nRealBlock * sizeof(modelica_real));
+  for (i = plan->nRealBlock; i < plan->nReal; i++) {
+    plan->realRow[i] = sData->realVars[plan->realIndex[i]];
+  }
+  memcpy(plan->integerRow, sData->integerVars, plan->nIntegerBlock * sizeof(modelica_integer));
+  for (i = plan->nIntegerBlock; i < plan->nInteger; i++) {
+    plan->integerRow[i] = sData->integerVars[plan->integerIndex[i]];
+  }
+  memcpy(plan->booleanRow, sData->booleanVars, plan->nBooleanBlock * sizeof(modelica_boolean));
+  for (i = plan->nBooleanBlock; i < plan->nBoolean; i++) {
+    plan->booleanRow[i] = sData->booleanVars[plan->booleanIndex[i]];
+  }
+  memcpy(plan->stringRow, sData->stringVars, plan->nStringBlock * sizeof(modelica_string));
+  for (i = plan->nStringBlock; i < plan->nString; i++) {
+    plan->stringRow[i] = sData->stringVars[plan->stringIndex[i]];
+  }
+
+  /* aliases */
+  for (i = 0, k = plan->nReal; i < plan->realAlias.n; i++, k++) {
+    modelica_real value = realSource[(int)plan->realAlias.source[i]][plan->realAlias.index[i]];
+    plan->realRow[k] = plan->realAlias.negate[i] ? -value : value;
+  }
+  for (i = 0, k = plan->nInteger; i < plan->integerAlias.n; i++, k++) {
+    modelica_integer value = integerSource[(int)plan->integerAlias.source[i]][plan->integerAlias.index[i]];
+    plan->integerRow[k] = plan->integerAlias.negate[i] ? -value : value;
+  }
+  for (i = 0, k = plan->nBoolean; i < plan->booleanAlias.n; i++, k++) {
+    modelica_boolean value = booleanSource[(int)plan->booleanAlias.source[i]][plan->booleanAlias.index[i]];
+    plan->booleanRow[k] = plan->booleanAlias.negate[i] ? (value==1?0:1) : value;
+  }
+  for (i = 0, k = plan->nString; i < plan->stringAlias.n; i++, k++) {
+    plan->stringRow[k] = stringSource[(int)plan->stringAlias.source[i]][plan->stringAlias.index[i]];
+  }
+}
+
+void omc_output_plan_free(OUTPUT_PLAN *plan)
+{
+  free(plan->realIndex);
+  free(plan->integerIndex);
+  free(plan->booleanIndex);
+  free(plan->stringIndex);
+  free_aliases(&plan->realAlias);
+  free_aliases(&plan->integerAlias);
+  free_aliases(&plan->booleanAlias);
+  free_aliases(&plan->stringAlias);
+  free(plan->realRow);
+  free(plan->integerRow);
+  free(plan->booleanRow);
+  free(plan->stringRow);
+  plan->realIndex = plan->integerIndex = plan->booleanIndex = plan->stringIndex = NULL;
+  plan->realRow = NULL;
+  plan->integerRow = NULL;
+  plan->booleanRow = NULL;
+  plan->stringRow = NULL;
+}
+
+}
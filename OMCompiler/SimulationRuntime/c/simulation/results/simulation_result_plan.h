@@ -0,0 +1,101 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+/*
+ * Output gather plans for the result writers.
+ *
+ * The filterOutput, time_unvarying, aliasType and negate attributes of the
+ * variables and aliases do not change during a simulation. A plan resolves
+ * them once when the writer is initialized into index lists, so that an emit
+ * only gathers the values of the current time step into preallocated rows.
+ */
+
+#ifndef _SIMULATION_RESULT_PLAN_H
+#define _SIMULATION_RESULT_PLAN_H
+
+#include "simulation_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* cplusplus */
+
+/* Selects the signals of a plan */
+enum OUTPUT_PLAN_FLAGS {
+  OUTPUT_PLAN_VARIABLE_ALIASES = 1,     /* aliases of variables and of time (aliasType 0 and 2) */
+  OUTPUT_PLAN_PARAMETER_ALIASES = 2,    /* aliases of parameters (aliasType 1) */
+  OUTPUT_PLAN_SKIP_TIME_UNVARYING = 4,  /* leave out variables that are only computed during initialization */
+  OUTPUT_PLAN_NEGATED_BOOLEANS_ONLY = 8 /* the writer refers to aliased signals, only negated boolean aliases need values */
+};
+
+/* Where an alias gets its value from */
+enum OUTPUT_PLAN_SOURCE {
+  OUTPUT_SOURCE_VARIABLE = 0,
+  OUTPUT_SOURCE_PARAMETER = 1,
+  OUTPUT_SOURCE_TIME = 2
+};
+
+typedef struct OUTPUT_PLAN_ALIASES {
+  int n;
+  char *source;       /* OUTPUT_PLAN_SOURCE */
+  int *index;         /* index in the variables or parameters */
+  modelica_boolean *negate;
+} OUTPUT_PLAN_ALIASES;
+
+typedef struct OUTPUT_PLAN {
+  /* indices of the variables that are copied directly, in output order */
+  int nReal, nInteger, nBoolean, nString;
+  int *realIndex, *integerIndex, *booleanIndex, *stringIndex;
+  /* length of the leading runs realIndex[i] == i, copied as a block */
+  int nRealBlock, nIntegerBlock, nBooleanBlock, nStringBlock;
+
+  OUTPUT_PLAN_ALIASES realAlias, integerAlias, booleanAlias, stringAlias;
+
+  /* Rows filled by omc_output_plan_gather: the variables followed by the aliases */
+  modelica_real *realRow;
+  modelica_integer *integerRow;
+  modelica_boolean *booleanRow;
+  modelica_string *stringRow;
+} OUTPUT_PLAN;
+
+void omc_output_plan_init(OUTPUT_PLAN *plan, const MODEL_DATA *modelData, int flags);
+void omc_output_plan_gather(OUTPUT_PLAN *plan, const DATA *data);
+void omc_output_plan_free(OUTPUT_PLAN *plan);
+
+/* number of values in each row */
+#define OUTPUT_PLAN_REALS(plan) ((plan)->nReal + (plan)->realAlias.n)
+#define OUTPUT_PLAN_INTEGERS(plan) ((plan)->nInteger + (plan)->integerAlias.n)
+#define OUTPUT_PLAN_BOOLEANS(plan) ((plan)->nBoolean + (plan)->booleanAlias.n)
+#define OUTPUT_PLAN_STRINGS(plan) ((plan)->nString + (plan)->stringAlias.n)
+
+#ifdef __cplusplus
+}
+#endif /* cplusplus */
+
+#endif
@@ -41,6 +41,7 @@
 #include "util/omc_error.h"
 #include "util/omc_file.h"
 #include "simulation_result_plt.h"
+#include "simulation_result_plan.h"
 #include "util/rtclock.h"
 
 #include <stdio.h>
@@ -57,6 +58,7 @@ typedef struct plt_data {
   long maxPoints;
   long dataSize;
   int num_vars;
+  OUTPUT_PLAN plan;
 } plt_data;
 
 static void add_result(simulation_result *self,DATA *data,double *data_, long *actualPoints);
@@ -115,73 +117,32 @@ static void add_result(simulation_result *self,DATA *data,double *data_, long *a
   rt_tick(SIM_TIMER_TOTAL);
 
   {
-    data_[pltData->currentPos++] = simData->localData[0]->timeValue;
+    const OUTPUT_PLAN *plan = &pltData->plan;
+    double *row;
 
-    if(self->cpuTime)
-      data_[pltData->currentPos++] = cpuTimeValue;
+    omc_output_plan_gather(&pltData->plan, simData);
+    row = data_ + pltData->currentPos;
+    *row++ = simData->localData[0]->timeValue;
 
-    /* .. reals .. */
-    for(i = 0; i < simData->modelData->nVariablesReal; i++) {
-      if(!simData->modelData->realVarsData[i].filterOutput) {
-        data_[pltData->currentPos++] = simData->localData[0]->realVars[i];
-      }
-    }
-    /* .. integers .. */
-    for(i = 0; i < simData->modelData->nVariablesInteger; i++) {
-      if(!simData->modelData->integerVarsData[i].filterOutput) {
-        data_[pltData->currentPos++] = simData->localData[0]->integerVars[i];
-      }
-    }
-    /* .. booleans .. */
-    for(i = 0; i < simData->modelData->nVariablesBoolean; i++) {
-      if(!simData->modelData->booleanVarsData[i].filterOutput) {
-        data_[pltData->currentPos++] = simData->localData[0]->booleanVars[i];
-      }
-    }
-    /* .. alias reals .. */
-    for(i = 0; i < simData->modelData->nAliasReal; i++) {
-      if(!simData->modelData->realAlias[i].filterOutput) {
-        double value;
-        if(simData->modelData->realAlias[i].aliasType == 2)
-          value = (simData->localData[0])->timeValue;
-        else if(simData->modelData->realAlias[i].aliasType == 1)
-          value = simData->simulationInfo->realParameter[simData->modelData->realAlias[i].nameID];
-        else
-          value = (simData->localData[0])->realVars[simData->modelData->realAlias[i].nameID];
-        if(simData->modelData->realAlias[i].negate)
-          data_[pltData->currentPos++] = -value;
-        else
-          data_[pltData->currentPos++] = value;
-      }
-    }
-    /* .. alias integers .. */
-    for(i = 0; i < simData->modelData->nAliasInteger; i++) {
-      if(!simData->modelData->integerAlias[i].filterOutput) {
-        modelica_integer value;
-        if(simData->modelData->integerAlias[i].aliasType == 1)
-          value = simData->simulationInfo->integerParameter[simData->modelData->realAlias[i].nameID];
-        else
-          value = (simData->localData[0])->integerVars[simData->modelData->realAlias[i].nameID];
-        if(simData->modelData->integerAlias[i].negate)
-          data_[pltData->currentPos++] = -value;
-        else
-          data_[pltData->currentPos++] = value;
-      }
-    }
-    /* .. alias booleans .. */
-    for(i = 0; i < simData->modelData->nAliasBoolean; i++) {
-      if(!simData->modelData->booleanAlias[i].filterOutput) {
-        modelica_boolean value;
-        if(simData->modelData->integerAlias[i].aliasType == 1)
-          value = simData->simulationInfo->booleanParameter[simData->modelData->realAlias[i].nameID];
-        else
-          value = (simData->localData[0])->booleanVars[simData->modelData->realAlias[i].nameID];
-        if(simData->modelData->booleanAlias[i].negate)
-          data_[pltData->currentPos++] = value==1?0:1;
-        else
-          data_[pltData->currentPos++] = value;
-      }
-    }
+    if(self->cpuTime)
+      *row++ = cpuTimeValue;
+
+    /* variables */
+    for(i = 0; i < plan->nReal; i++)
+      *row++ = plan->realRow[i];
+    for(i = 0; i < plan->nInteger; i++)
+      *row++ = plan->integerRow[i];
+    for(i = 0; i < plan->nBoolean; i++)
+      *row++ = plan->booleanRow[i];
+    /* aliases */
+    for(i = plan->nReal; i < OUTPUT_PLAN_REALS(plan); i++)
+      *row++ = plan->realRow[i];
+    for(i = plan->nInteger; i < OUTPUT_PLAN_INTEGERS(plan); i++)
+      *row++ = plan->integerRow[i];
+    for(i = plan->nBoolean; i < OUTPUT_PLAN_BOOLEANS(plan); i++)
+      *row++ = plan->booleanRow[i];
+
+    pltData->currentPos = row - data_;
   }
 
   /*cerr << "  ... done" << endl; */
@@ -210,6 +171,7 @@ void plt_init(simulation_result *self,DATA *data, threadData_t *threadData)
     throwStreamPrint(threadData, "Error allocating simulation result data of size %ld failed",self->numpoints * pltData->dataSize);
   }
   pltData->currentPos = 0;
+  omc_output_plan_init(&pltData->plan, data->modelData, OUTPUT_PLAN_VARIABLE_ALIASES | OUTPUT_PLAN_PARAMETER_ALIASES);
   self->storage = pltData;
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
@@ -346,6 +308,7 @@ void plt_free(simulation_result *self,DATA *data, threadData_t *threadData)
   }
 
   deallocResult(pltData);
+  omc_output_plan_free(&pltData->plan);
   if(fclose(f))
   {
     throwStreamPrint(threadData, "Error, couldn't write to output file %s\n", self->filename);
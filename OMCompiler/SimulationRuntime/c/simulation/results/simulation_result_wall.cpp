@@ -36,6 +36,7 @@
 #include "meta/meta_modelica.h"
 
 #include <fstream>
+#include <vector>
 #include <string.h>
 #include <assert.h>
 
@@ -61,6 +62,7 @@ typedef struct wall_storage {
   std::ofstream fp;
   long header_length;
   long data_start;
+  std::vector<char> row; /* a continuous row is packed here and written at once */
 } wall_storage;
 
 static void msgpack_obj_header(std::ofstream &fp, int n) {
@@ -131,6 +133,29 @@ static void msgpack_double(std::ofstream &fp, double d) {
   fp.write(dbuffer, 8);
 }
 
+/* The following functions pack into the row buffer of an emit */
+static void pack_byte(std::vector<char> &buf, char c) {
+  buf.push_back(c);
+}
+
+static void pack_uint32(std::vector<char> &buf, uint32_t n) {
+  uint32_t ibuffer = htonl(n);
+  buf.insert(buf.end(), (char *)&ibuffer, (char *)&ibuffer + 4);
+}
+
+static void pack_double(std::vector<char> &buf, double d) {
+  char dbuffer[8];
+  marshall_double(d, dbuffer);
+  buf.push_back((char)0xcb);
+  buf.insert(buf.end(), dbuffer, dbuffer + 8);
+}
+
+static void pack_str(std::vector<char> &buf, const char *s, size_t len) {
+  buf.push_back((char)0xDB);
+  pack_uint32(buf, len);
+  buf.insert(buf.end(), s, s + len);
+}
+
 static void write_description(std::ofstream &fp, const char *name, const char *comment) {
   msgpack_str(fp, name); // key
   msgpack_obj_header(fp, 1); // value (is an object of one field)
@@ -325,6 +350,8 @@ void recon_wall_init(simulation_result *self,DATA *data, threadData_t *threadDat
     /* Write header */
     write_header(storage->fp, data->modelData);
     storage->data_start = storage->fp.tellp();
+    storage->row.reserve(4+5+5+strlen(CONT_TABLE_NAME)+5+9*(1+data->modelData->nVariablesReal)+
+      5*data->modelData->nVariablesInteger+data->modelData->nVariablesBoolean+5*data->modelData->nVariablesString);
     uint32_t sz = storage->data_start-(storage->header_length+4);
     storage->fp.seekp(storage->header_length);
     raw_uint32(storage->fp, sz);
@@ -379,37 +406,42 @@ void recon_wall_emit(simulation_result *self,DATA *data, threadData_t *threadDat
   wall_storage *storage = (wall_storage *)self->storage;
   std::ofstream &fp = storage->fp;
   MODEL_DATA *modelData = data->modelData;
-  const SIMULATION_INFO *sInfo = data->simulationInfo;
 
+  std::vector<char> &row = storage->row;
+  const char *str;
+  uint32_t length;
   long i;
-  long length_pos = fp.tellp();
-  raw_uint32(fp, 0);
 
-  long data_pos = fp.tellp();
-  msgpack_obj_header(fp, 1); // table name
-  msgpack_str(fp, CONT_TABLE_NAME);
+  row.clear();
+  pack_uint32(row, 0); // length, filled in below
+
+  pack_byte(row, (char)0xDF); // table name
+  pack_uint32(row, 1);
+  pack_str(row, CONT_TABLE_NAME, strlen(CONT_TABLE_NAME));
 
-  msgpack_array_header(fp, 1+modelData->nVariablesReal+modelData->nVariablesInteger+
+  pack_byte(row, (char)0xDD);
+  pack_uint32(row, 1+modelData->nVariablesReal+modelData->nVariablesInteger+
     modelData->nVariablesBoolean+modelData->nVariablesString);
 
-  msgpack_double(fp, data->localData[0]->timeValue);
+  pack_double(row, data->localData[0]->timeValue);
   for(i=0;i<modelData->nVariablesReal;i++) {
-    msgpack_double(fp, data->localData[0]->realVars[i]);
+    pack_double(row, data->localData[0]->realVars[i]);
   }
   for(i=0;i<modelData->nVariablesInteger;i++) {
-    msgpack_int32(fp, data->localData[0]->integerVars[i]);
+    pack_byte(row, (char)0xd2);
+    pack_uint32(row, (int32_t)data->localData[0]->integerVars[i]);
   }
   for(i=0;i<modelData->nVariablesBoolean;i++) {
-    msgpack_boolean(fp, data->localData[0]->booleanVars[i]);
+    pack_byte(row, data->localData[0]->booleanVars[i] ? (char)0xc3 : (char)0xc2);
   }
   for(i=0;i<modelData->nVariablesString;i++) {
-    msgpack_str(fp, MMC_STRINGDATA(data->localData[0]->stringVars[i]));
+    str = MMC_STRINGDATA(data->localData[0]->stringVars[i]);
+    pack_str(row, str, strlen(str));
   }
 
-  long end_pos = fp.tellp();
-  fp.seekp(length_pos);
-  raw_uint32(fp, end_pos-data_pos);
-  fp.seekp(end_pos);
+  length = htonl(row.size()-4);
+  memcpy(&row[0], &length, 4);
+  fp.write(&row[0], row.size());
 }
 
 void recon_wall_free(simulation_result *self,DATA *data, threadData_t *threadData)
@@ -73,6 +73,7 @@
 #include "simulation/results/simulation_result_csv.h"
 #include "simulation/results/simulation_result_mat4.h"
 #include "simulation/results/simulation_result_wall.h"
+#include "simulation/results/simulation_result_col.h"
 #include "simulation/results/simulation_result_ia.h"
 #include "simulation/solver/solver_main.h"
 #include "simulation_info_json.h"
@@ -280,6 +281,64 @@ void setGlobalLoggingTime(int argc, char**argv, SIMULATION_INFO *simulationInfo)
 }
 
 
+/**
+ * Reads the time points of the linearization from flag -l, a single time
+ * or a comma separated list of times. The stop time is set to the last one.
+ */
+static void setLinearizationTimes(SIMULATION_INFO *simulationInfo, const char *lintime)
+{
+  list<double> times;
+  list<double>::iterator it;
+  const char *str = lintime;
+  char *endptr;
+  int i;
+
+  if (lintime == NULL)
+  {
+    times.push_back(simulationInfo->startTime);
+  }
+  else
+  {
+    while (1)
+    {
+      times.push_back(om_strtod(str, &endptr));
+      if (endptr == str)
+      {
+        throwStreamPrint(NULL, "Simulation flag %s expects a time or a comma separated list of times. Got: %s", FLAG_NAME[FLAG_L], lintime);
+      }
+      if (*endptr != ',')
+      {
+        break;
+      }
+      str = endptr+1;
+    }
+    times.sort();
+  }
+
+  simulationInfo->nLinearizeTimes = times.size();
+  simulationInfo->nextLinearizeTime = 0;
+  simulationInfo->linearizeTimes = (double*) malloc(times.size()*sizeof(double));
+  for (it = times.begin(), i = 0; it != times.end(); ++it, ++i)
+  {
+    simulationInfo->linearizeTimes[i] = *it;
+  }
+  simulationInfo->stopTime = times.back();
+
+  if (simulationInfo->nLinearizeTimes == 1)
+  {
+    infoStreamPrint(LOG_STDOUT, 0, "Linearization will be performed at point of time: %f", simulationInfo->stopTime);
+  }
+  else
+  {
+    infoStreamPrint(LOG_STDOUT, 1, "Linearization will be performed at %d points of time:", simulationInfo->nLinearizeTimes);
+    for (i = 0; i < simulationInfo->nLinearizeTimes; ++i)
+    {
+      infoStreamPrint(LOG_STDOUT, 0, "%f", simulationInfo->linearizeTimes[i]);
+    }
+    messageClose(LOG_STDOUT);
+  }
+}
+
 static void readFlag(int *flag, int max, const char *value, const char *flagName, const char **names, const char **desc)
 {
   int i;
@@ -480,12 +539,7 @@ int startNonInteractiveSimulation(int argc, char**argv, DATA* data, threadData_t
 
   if(create_linearmodel)
   {
-    if(lintime == NULL) {
-      data->simulationInfo->stopTime = data->simulationInfo->startTime;
-    } else {
-      data->simulationInfo->stopTime = atof(lintime);
-    }
-    infoStreamPrint(LOG_STDOUT, 0, "Linearization will be performed at point of time: %f", data->simulationInfo->stopTime);
+    setLinearizationTimes(data->simulationInfo, lintime);
   }
 
   /* set delta x for linearization */
@@ -668,6 +722,12 @@ int initializeResultData(DATA* simData, threadData_t *threadData, int cpuTime)
     sim_result.writeParameterData = recon_wall_writeParameterData;
     sim_result.free = recon_wall_free;
     resultFormatHasCheapAliasesAndParameters = 1;
+  } else if(0 == strcmp("col", simData->simulationInfo->outputFormat)) {
+    sim_result.init = col_init;
+    sim_result.emit = col_emit;
+    sim_result.writeParameterData = col_writeParameterData;
+    sim_result.free = col_free;
+    resultFormatHasCheapAliasesAndParameters = 1;
   } else if(0 == strcmp("plt", simData->simulationInfo->outputFormat)) {
     sim_result.init = plt_init;
     sim_result.emit = plt_emit;
@@ -824,6 +884,18 @@ int initRuntimeAndSimulation(int argc, char**argv, DATA *data, threadData_t *thr
         /* detailed information for some flags */
         switch(i)
         {
+          case FLAG_CVODE_LS:
+            for(j=1; j<CVODE_LS_MAX; ++j) {
+              infoStreamPrint(LOG_STDOUT, 0, "%-18s [%s]", CVODE_LS_METHOD[j], CVODE_LS_METHOD_DESC[j]);
+            }
+            break;
+
+          case FLAG_CVODE_PRECON:
+            for(j=1; j<CVODE_PRECON_MAX; ++j) {
+              infoStreamPrint(LOG_STDOUT, 0, "%-18s [%s]", CVODE_PRECON_METHOD[j], CVODE_PRECON_METHOD_DESC[j]);
+            }
+            break;
+
           case FLAG_IDA_LS:
             for(j=1; j<IDA_LS_MAX; ++j) {
               infoStreamPrint(LOG_STDOUT, 0, "%-18s [%s]", IDA_LS_METHOD[j], IDA_LS_METHOD_DESC[j]);
@@ -1111,6 +1183,44 @@ void communicateMsg(char id, unsigned int size, const char *data)
 #endif
 }
 
+/* returns 1 if a message from the client is available within timeoutMillis (< 0: no timeout) */
+int communicateWaitMsg(int timeoutMillis)
+{
+#ifndef NO_INTERACTIVE_DEPENDENCY
+  if(sim_communication_port_open)
+  {
+    return sim_communication_port.waitForData(timeoutMillis);
+  }
+#endif
+  return 0;
+}
+
+/* receives a message [ID | SIZE | DATA] from the client, the caller frees *data
+ * returns 0 if the connection was closed
+ */
+int communicateRecvMsg(char *id, unsigned int *size, char **data)
+{
+#ifndef NO_INTERACTIVE_DEPENDENCY
+  if(sim_communication_port_open)
+  {
+    if(!sim_communication_port.recvBytes(id, sizeof(char)) ||
+       !sim_communication_port.recvBytes((char*)size, sizeof(unsigned int)))
+    {
+      return 0;
+    }
+    *data = (char*) malloc(*size + 1);
+    if(!sim_communication_port.recvBytes(*data, *size))
+    {
+      free(*data);
+      *data = NULL;
+      return 0;
+    }
+    return 1;
+  }
+#endif
+  return 0;
+}
+
 
 /* \brief main function for simulator
  *
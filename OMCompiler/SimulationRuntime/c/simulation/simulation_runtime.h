@@ -75,6 +75,8 @@ extern void printSimulationStepSize(double in_stepSize, double time);
 
 extern void communicateStatus(const char *phase, double completionPercent, double currentTime, double currentStepSize);
 extern void communicateMsg(char id, unsigned int size, const char *data);
+extern int communicateWaitMsg(int timeoutMillis);
+extern int communicateRecvMsg(char *id, unsigned int *size, char **data);
 
 /* the main function of the simulation runtime!
  * simulation runtime no longer has main, is defined by the generated model code which calls this function.
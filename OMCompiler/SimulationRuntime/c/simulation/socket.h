@@ -61,6 +61,8 @@ public:
   bool send( const std::string& ) const;
   bool sendBytes(char* msg, int size) const;
   int recv ( std::string& ) const;
+  bool recvBytes(char* buf, int size) const;   // receive exactly size bytes
+  bool waitForData(int timeoutMillis) const;   // true if there is data to receive, waits forever for timeoutMillis < 0
 
   // Data transmission - UDP
   bool UDP_send( const std::string&, const std::string&,
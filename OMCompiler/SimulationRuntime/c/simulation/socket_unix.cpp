@@ -4,6 +4,7 @@
 #include <cstring>
 #include <errno.h>
 #include <unistd.h>
+#include <sys/select.h>
 #include "socket.h"
 
 template<typename T>
@@ -127,6 +128,31 @@ int Socket::recv(std::string &s) const
   return bytes_sent;
 }
 
+bool Socket::recvBytes(char* buf, int size) const
+{
+  while(size > 0)
+  {
+    int n = ::recv(m_sock, buf, size, 0);
+    if(n <= 0)
+      return false;
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool Socket::waitForData(int timeoutMillis) const
+{
+  fd_set fds;
+  struct timeval tv;
+
+  FD_ZERO(&fds);
+  FD_SET(m_sock, &fds);
+  tv.tv_sec = timeoutMillis / 1000;
+  tv.tv_usec = (timeoutMillis % 1000) * 1000;
+  return ::select(m_sock + 1, &fds, NULL, NULL, timeoutMillis < 0 ? NULL : &tv) > 0;
+}
+
 bool Socket::UDP_send(const std::string &addr, const std::string &s, const int port) const
 {
   struct addrinfo hints, *res;
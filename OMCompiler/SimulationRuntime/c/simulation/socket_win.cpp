@@ -193,6 +193,35 @@ int Socket::recv (string& s) const
   }
 }
 
+//receive exactly size bytes via TCP
+bool Socket::recvBytes(char* buf, int size) const
+{
+  while (size > 0)
+  {
+    int n = ::recv(m_sock, buf, size, 0);
+    if (n == SOCKET_ERROR || n == 0)
+    {
+      return false;
+    }
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+// check if there is data to receive via TCP
+bool Socket::waitForData(int timeoutMillis) const
+{
+  fd_set fds;
+  struct timeval tv;
+
+  FD_ZERO(&fds);
+  FD_SET(m_sock, &fds);
+  tv.tv_sec = timeoutMillis / 1000;
+  tv.tv_usec = (timeoutMillis % 1000) * 1000;
+  return ::select(0, &fds, NULL, NULL, timeoutMillis < 0 ? NULL : &tv) > 0;
+}
+
 // transmit data via UDP
 bool Socket::UDP_send(const string &addr, const string &s, const int port) const
 {
@@ -46,6 +46,9 @@
 
 #include "dassl.h"
 #include "epsilon.h"
+#ifndef OMC_FMI_RUNTIME
+  #include "jacobianSymbolical.h"
+#endif
 
 
 
@@ -136,6 +139,12 @@ int cvodeRightHandSideODEFunction(realtype time, N_Vector y, N_Vector ydot, void
     messageClose(LOG_SOLVER_V);
   }
 
+  /* CVODE evaluates f on its internal vectors, copy states into the model */
+  if (N_VGetArrayPointer(y) != data->localData[0]->realVars)
+  {
+    memcpy(data->localData[0]->realVars, N_VGetArrayPointer(y), data->modelData->nStates * sizeof(double));
+  }
+
   /* Read input vars (exclude from timer) */
   if (measure_time_flag)
     rt_accumulate(SIM_TIMER_SOLVER);
@@ -197,15 +206,208 @@ int cvodeRightHandSideODEFunction(realtype time, N_Vector y, N_Vector ydot, void
   return retVal;
 }
 
-/*
- *  function calculates a jacobian matrix by
- *  numerical method finite differences with coloring
- *  into a dense DlsMat matrix
+/* Element function for dense matrix set */
+static void setJacElementCvodeDense(int row, int col, int nth, double value, void *Jac, int rows)
+{
+  (void) nth;  /* Unused, needed to match genericColoredSymbolicJacobianEvaluation */
+  (void) rows;
+  DENSE_ELEM((DlsMat)Jac, row, col) = value;
+}
+
+/* Element function for the diagonal of the Jacobian, used by the diagonal preconditioner */
+static void setJacElementCvodeDiagonal(int row, int col, int nth, double value, void *diag, int rows)
+{
+  (void) nth;  /* Unused, needed to match genericColoredSymbolicJacobianEvaluation */
+  (void) rows;
+  if (row == col)
+  {
+    ((double *)diag)[row] = value;
+  }
+}
+
+#ifndef OMC_FMI_RUNTIME
+/* Element function for sparse matrix set */
+static void setJacElementCvodeSparse(int row, int col, int nth, double value, void *spJac, int rows)
+{
+  (void) rows; /* Unused, needed to match genericColoredSymbolicJacobianEvaluation */
+  SlsMat mat = (SlsMat)spJac;
+  if (col > 0 && mat->colptrs[col] == 0)
+  {
+    mat->colptrs[col] = nth;
+  }
+  mat->rowvals[nth] = row;
+  mat->data[nth] = value;
+}
+
+/* finish sparse matrix, by fixing colprts */
+static void finishSparseColPtr(SlsMat mat, int nnz)
+{
+  int i;
+  for (i = 1; i < mat->N + 1; ++i)
+  {
+    if (mat->colptrs[i] == 0)
+    {
+      mat->colptrs[i] = mat->colptrs[i - 1];
+    }
+  }
+  /* finish matrix colptrs */
+  mat->colptrs[mat->N] = nnz;
+}
+#endif
+
+/**
+ * @brief Calculates the Jacobian df/dy with finite differences and coloring
+ *
+ * All columns of one color are perturbed at once, so the Jacobian costs
+ * maxColors evaluations of the right-hand side.
+ *
+ * @param currentTime     Current time.
+ * @param y               States vector, restored on return.
+ * @param fy              Right-hand side f(t, y).
+ * @param Jac             Matrix to fill, dense, sparse or diagonal.
+ * @param cvodeData       CVODE solver data struckt.
+ * @param setJacElement   Element function for Jac.
+ * @return int            Return 0 on success.
+ */
+static int jacColoredNumerical(double currentTime, N_Vector y, N_Vector fy, void *Jac, CVODE_SOLVER *cvodeData,
+                               void (*setJacElement)(int, int, int, double, void *, int))
+{
+  DATA *data = cvodeData->simData->data;
+  const int index = data->callback->INDEX_JAC_A;
+  SPARSE_PATTERN *sparsePattern = data->simulationInfo->analyticJacobians[index].sparsePattern;
+
+  /* prepare variables */
+  double *states = N_VGetArrayPointer(y);
+  double *f = N_VGetArrayPointer(fy);
+  double *newf = N_VGetArrayPointer(cvodeData->newfy);
+  double *errwgt = N_VGetArrayPointer(cvodeData->errwgt);
+  double *ysave = cvodeData->ysave;
+  double *delta_hh = cvodeData->delta_hh;
+  double delta_h = numericalDifferentiationDeltaXsolver;
+
+  long int N = cvodeData->N;
+  long int i, ii, j;
+  int nth;
+  int retVal = 0;
+
+  infoStreamPrint(LOG_SOLVER_V, 1, "### eval jacColoredNumerical ###");
+
+  CVodeGetErrWeights(cvodeData->cvode_mem, cvodeData->errwgt);
+
+  setContext(data, &currentTime, CONTEXT_JACOBIAN);
+
+  for (i = 0; i < sparsePattern->maxColors; i++)
+  {
+    for (ii = 0; ii < N; ii++)
+    {
+      if (sparsePattern->colorCols[ii] - 1 == i)
+      {
+        delta_hh[ii] = delta_h * fmax(fabs(states[ii]), fabs(1. / errwgt[ii]));
+        delta_hh[ii] = (states[ii] + delta_hh[ii]) - states[ii];
+        ysave[ii] = states[ii];
+        states[ii] += delta_hh[ii];
+        delta_hh[ii] = 1. / delta_hh[ii];
+      }
+    }
+
+    if (cvodeRightHandSideODEFunction(currentTime, y, cvodeData->newfy, cvodeData))
+    {
+      retVal = 1; /* recoverable, CVODE retries with a smaller step */
+    }
+    increaseJacContext(data);
+
+    for (ii = 0; ii < N; ii++)
+    {
+      if (sparsePattern->colorCols[ii] - 1 == i)
+      {
+        for (nth = sparsePattern->leadindex[ii]; nth < sparsePattern->leadindex[ii + 1]; nth++)
+        {
+          j = sparsePattern->index[nth];
+          setJacElement(j, ii, nth, (newf[j] - f[j]) * delta_hh[ii], Jac, N);
+        }
+        states[ii] = ysave[ii];
+      }
+    }
+
+    if (retVal)
+    {
+      break;
+    }
+  }
+
+  unsetContext(data);
+  messageClose(LOG_SOLVER_V);
+
+  return retVal;
+}
+
+#ifndef OMC_FMI_RUNTIME
+/**
+ * @brief Calculates the Jacobian df/dy symbolically while exploiting coloring
+ *
+ * CVODE evaluates f(t, y) right before it asks for the Jacobian, so the
+ * model variables already correspond to y.
+ *
+ * @param currentTime     Current time.
+ * @param Jac             Matrix to fill, dense, sparse or diagonal.
+ * @param cvodeData       CVODE solver data struckt.
+ * @param setJacElement   Element function for Jac.
+ * @return int            Return 0 on success.
  */
-static int jacColoredNumericalDense(double currentTime, N_Vector y, N_Vector fy,
-                                    DlsMat Jac, void *userData)
+static int jacColoredSymbolical(double currentTime, void *Jac, CVODE_SOLVER *cvodeData,
+                                void (*setJacElement)(int, int, int, double, void *, int))
 {
-  /* TODO: Add stuff for colored dense jacobian */
+  DATA *data = cvodeData->simData->data;
+  threadData_t *threadData = cvodeData->simData->threadData;
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A]);
+#ifdef USE_PARJAC
+  ANALYTIC_JACOBIAN *t_jac = cvodeData->jacColumns;
+#else
+  ANALYTIC_JACOBIAN *t_jac = jac;
+#endif
+
+  setContext(data, &currentTime, CONTEXT_SYM_JACOBIAN);
+
+  /* Evaluate constant equations if available */
+  if (jac->constantEqns != NULL)
+  {
+    jac->constantEqns(data, threadData, jac, NULL);
+  }
+
+  genericColoredSymbolicJacobianEvaluation(jac->sizeRows, jac->sizeCols, jac->sparsePattern, Jac, t_jac,
+                                           data, threadData, setJacElement);
+
+  unsetContext(data);
+
+  return 0;
+}
+#endif
+
+/**
+ * @brief Calculates the Jacobian with the configured colored method
+ *
+ * @param currentTime     Current time.
+ * @param y               States vector.
+ * @param fy              Right-hand side f(t, y).
+ * @param Jac             Matrix to fill, dense, sparse or diagonal.
+ * @param cvodeData       CVODE solver data struckt.
+ * @param setJacElement   Element function for Jac.
+ * @return int            Return 0 on success.
+ */
+static int jacColored(double currentTime, N_Vector y, N_Vector fy, void *Jac, CVODE_SOLVER *cvodeData,
+                      void (*setJacElement)(int, int, int, double, void *, int))
+{
+  switch (cvodeData->config.jacobianMethod)
+  {
+  case COLOREDNUMJAC:
+    return jacColoredNumerical(currentTime, y, fy, Jac, cvodeData, setJacElement);
+#ifndef OMC_FMI_RUNTIME
+  case COLOREDSYMJAC:
+    return jacColoredSymbolical(currentTime, Jac, cvodeData, setJacElement);
+#endif
+  default:
+    throwStreamPrint(cvodeData->simData->threadData, "##CVODE## Something goes wrong while obtain jacobian matrix!");
+  }
   return -1;
 }
 
@@ -231,28 +433,19 @@ static int callDenseJacobian(long int N, double t,
   /* Variables */
   CVODE_SOLVER *cvodeData;
   DATA *data;
-  threadData_t *threadData;
-  int retVal = -1;
+  int retVal;
   _omc_matrix *dumpJac;
 
   /* Access userData */
   cvodeData = (CVODE_SOLVER *)user_data;
   data = cvodeData->simData->data;
-  threadData = cvodeData->simData->threadData;
 
   /* profiling */
   if (measure_time_flag)
     rt_accumulate(SIM_TIMER_SOLVER);
   rt_tick(SIM_TIMER_JACOBIAN);
 
-  if (cvodeData->config.jacobianMethod == COLOREDNUMJAC || cvodeData->config.jacobianMethod == NUMJAC)
-  {
-    retVal = jacColoredNumericalDense(t, y, fy, Jac, user_data);
-  }
-  else
-  {
-    throwStreamPrint(threadData, "##CVODE## Something goes wrong while obtain jacobian matrix!");
-  }
+  retVal = jacColored(t, y, fy, Jac, cvodeData, setJacElementCvodeDense);
 
   /* debug */
   if (ACTIVE_STREAM(LOG_JAC))
@@ -270,6 +463,167 @@ static int callDenseJacobian(long int N, double t,
   return retVal;
 }
 
+#ifndef OMC_FMI_RUNTIME
+/**
+ * @brief Wrapper function to call sparse Jacobian for KLU
+ *
+ * @param t
+ * @param y
+ * @param fy
+ * @param Jac
+ * @param user_data
+ * @param tmp1
+ * @param tmp2
+ * @param tmp3
+ * @return int
+ */
+static int callSparseJacobian(double t, N_Vector y, N_Vector fy,
+                              SlsMat Jac, void *user_data,
+                              N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  CVODE_SOLVER *cvodeData = (CVODE_SOLVER *)user_data;
+  int retVal;
+
+  /* profiling */
+  if (measure_time_flag)
+    rt_accumulate(SIM_TIMER_SOLVER);
+  rt_tick(SIM_TIMER_JACOBIAN);
+
+  /* it's needed to clear the matrix */
+  SlsSetToZero(Jac);
+
+  retVal = jacColored(t, y, fy, Jac, cvodeData, setJacElementCvodeSparse);
+  finishSparseColPtr(Jac, cvodeData->NNZ);
+
+  /* debug */
+  if (ACTIVE_STREAM(LOG_JAC))
+  {
+    infoStreamPrint(LOG_JAC, 0, "##CVODE## Sparse Matrix A.");
+    PrintSparseMat(Jac);
+  }
+
+  /* profiling */
+  rt_accumulate(SIM_TIMER_JACOBIAN);
+  if (measure_time_flag)
+    rt_tick(SIM_TIMER_SOLVER);
+
+  return retVal;
+}
+#endif
+
+/**
+ * @brief Setup of the diagonal preconditioner P = I - gamma*diag(J)
+ *
+ * Only diag(J) is stored, gamma is applied in cvodePreconditionerSolve.
+ * The diagonal is reused as long as CVODE considers the Jacobian current.
+ *
+ * @param t
+ * @param y
+ * @param fy
+ * @param jok         If TRUE the saved diagonal may be reused.
+ * @param jcurPtr     Set to TRUE if the diagonal was recomputed.
+ * @param gamma
+ * @param user_data
+ * @param tmp1
+ * @param tmp2
+ * @param tmp3
+ * @return int
+ */
+static int cvodePreconditionerSetup(realtype t, N_Vector y, N_Vector fy,
+                                    booleantype jok, booleantype *jcurPtr, realtype gamma,
+                                    void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  CVODE_SOLVER *cvodeData = (CVODE_SOLVER *)user_data;
+  int retVal = 0;
+
+  if (jok)
+  {
+    *jcurPtr = FALSE;
+    return 0;
+  }
+
+  /* profiling */
+  if (measure_time_flag)
+    rt_accumulate(SIM_TIMER_SOLVER);
+  rt_tick(SIM_TIMER_JACOBIAN);
+
+  memset(cvodeData->preconDiag, 0, cvodeData->N * sizeof(double));
+  retVal = jacColored(t, y, fy, cvodeData->preconDiag, cvodeData, setJacElementCvodeDiagonal);
+  *jcurPtr = TRUE;
+
+  /* profiling */
+  rt_accumulate(SIM_TIMER_JACOBIAN);
+  if (measure_time_flag)
+    rt_tick(SIM_TIMER_SOLVER);
+
+  return retVal;
+}
+
+/**
+ * @brief Solves P*z = r with the diagonal preconditioner
+ *
+ * @param t
+ * @param y
+ * @param fy
+ * @param r           Right-hand side.
+ * @param z           Solution.
+ * @param gamma
+ * @param delta       Unused, the system is solved exactly.
+ * @param lr          Unused, P is diagonal.
+ * @param user_data
+ * @param tmp
+ * @return int
+ */
+static int cvodePreconditionerSolve(realtype t, N_Vector y, N_Vector fy,
+                                    N_Vector r, N_Vector z, realtype gamma, realtype delta,
+                                    int lr, void *user_data, N_Vector tmp)
+{
+  CVODE_SOLVER *cvodeData = (CVODE_SOLVER *)user_data;
+  double *rr = N_VGetArrayPointer(r);
+  double *zz = N_VGetArrayPointer(z);
+  double p;
+  long int i;
+
+  for (i = 0; i < cvodeData->N; ++i)
+  {
+    p = 1.0 - gamma * cvodeData->preconDiag[i];
+    zz[i] = (p != 0.0) ? rr[i] / p : rr[i];
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Get lower and upper bandwidth of the ODE Jacobian from its sparsity pattern
+ *
+ * @param sparsePattern   Sparsity pattern in compressed column format, may be NULL.
+ * @param N               Number of states.
+ * @param mu              Upper bandwidth.
+ * @param ml              Lower bandwidth.
+ */
+static void cvodeBandwidth(SPARSE_PATTERN *sparsePattern, long int N, long int *mu, long int *ml)
+{
+  long int col, row;
+  unsigned int nth;
+
+  if (sparsePattern == NULL)
+  {
+    *mu = *ml = N - 1;
+    return;
+  }
+
+  *mu = *ml = 0;
+  for (col = 0; col < N; col++)
+  {
+    for (nth = sparsePattern->leadindex[col]; nth < sparsePattern->leadindex[col + 1]; nth++)
+    {
+      row = sparsePattern->index[nth];
+      *mu = (col - row > *mu) ? col - row : *mu;
+      *ml = (row - col > *ml) ? row - col : *ml;
+    }
+  }
+}
+
 /**
  * @brief Root function for CVODE
  *
@@ -351,11 +705,11 @@ void cvodeGetConfig(CVODE_CONFIG *config, threadData_t *threadData, booleantype
   /* Set linear multistep method */
   if (omc_flag[FLAG_CVODE_LMM])
   {
-    if (strcmp((const char *)omc_flagValue[FLAG_CVODE_LMM], CVODE_LMM_NAME[CV_ADAMS]))
+    if (!strcmp((const char *)omc_flagValue[FLAG_CVODE_LMM], CVODE_LMM_NAME[CV_ADAMS]))
     {
       config->lmm = CV_ADAMS;
     }
-    else if (strcmp((const char *)omc_flagValue[FLAG_CVODE_LMM], CVODE_LMM_NAME[CV_BDF]))
+    else if (!strcmp((const char *)omc_flagValue[FLAG_CVODE_LMM], CVODE_LMM_NAME[CV_BDF]))
     {
       config->lmm = CV_BDF;
     }
@@ -381,11 +735,11 @@ void cvodeGetConfig(CVODE_CONFIG *config, threadData_t *threadData, booleantype
   /* Set nonlinear solver iteration type */
   if (omc_flag[FLAG_CVODE_ITER])
   {
-    if (strcmp((const char *)omc_flagValue[FLAG_CVODE_ITER], CVODE_ITER_NAME[CV_FUNCTIONAL]))
+    if (!strcmp((const char *)omc_flagValue[FLAG_CVODE_ITER], CVODE_ITER_NAME[CV_FUNCTIONAL]))
     {
       config->iter = CV_FUNCTIONAL;
     }
-    else if (strcmp((const char *)omc_flagValue[FLAG_CVODE_ITER], CVODE_ITER_NAME[CV_NEWTON]))
+    else if (!strcmp((const char *)omc_flagValue[FLAG_CVODE_ITER], CVODE_ITER_NAME[CV_NEWTON]))
     {
       config->iter = CV_NEWTON;
     }
@@ -400,7 +754,7 @@ void cvodeGetConfig(CVODE_CONFIG *config, threadData_t *threadData, booleantype
         }
         messageClose(LOG_SOLVER);
       }
-      throwStreamPrint(threadData, "Unrecognized type of nonlinear solver iteration %s for CVODE.", (const char *)omc_flagValue[FLAG_CVODE_LMM]);
+      throwStreamPrint(threadData, "Unrecognized type of nonlinear solver iteration %s for CVODE.", (const char *)omc_flagValue[FLAG_CVODE_ITER]);
     }
   }
   else /* No user provided flag */
@@ -439,13 +793,144 @@ void cvodeGetConfig(CVODE_CONFIG *config, threadData_t *threadData, booleantype
   config->internalSteps = FALSE;    // TODO: Setting not used yet
   infoStreamPrint(LOG_SOLVER, 0, "CVODE use equidistant time grid %s", config->internalSteps ? "NO" : "YES");
 
+  /* Set linear solver */
+  config->linearSolverMethod = CVODE_LS_UNKNOWN;
+  if (omc_flag[FLAG_CVODE_LS])
+  {
+    for (i = 1; i < CVODE_LS_MAX; i++)
+    {
+      if (!strcmp((const char *)omc_flagValue[FLAG_CVODE_LS], CVODE_LS_METHOD[i]))
+      {
+        config->linearSolverMethod = (enum CVODE_LS)i;
+        break;
+      }
+    }
+    if (config->linearSolverMethod == CVODE_LS_UNKNOWN)
+    {
+      if (ACTIVE_WARNING_STREAM(LOG_SOLVER))
+      {
+        warningStreamPrint(LOG_SOLVER, 1, "Unrecognized linear solver method %s for CVODE, current options are:", (const char *)omc_flagValue[FLAG_CVODE_LS]);
+        for (i = 1; i < CVODE_LS_MAX; ++i)
+        {
+          warningStreamPrint(LOG_SOLVER, 0, "%-15s [%s]", CVODE_LS_METHOD[i], CVODE_LS_METHOD_DESC[i]);
+        }
+        messageClose(LOG_SOLVER);
+      }
+      throwStreamPrint(threadData, "Unrecognized linear solver method %s for CVODE.", (const char *)omc_flagValue[FLAG_CVODE_LS]);
+    }
+  }
+  else /* No user provided flag */
+  {
+    config->linearSolverMethod = CVODE_LS_DENSE;
+  }
+#ifdef OMC_FMI_RUNTIME
+  if (config->linearSolverMethod == CVODE_LS_KLU)
+  {
+    warningStreamPrint(LOG_SOLVER, 0, "CVODE linear solver %s is not available in FMUs, using %s.", CVODE_LS_METHOD[CVODE_LS_KLU], CVODE_LS_METHOD[CVODE_LS_DENSE]);
+    config->linearSolverMethod = CVODE_LS_DENSE;
+  }
+#endif
+  infoStreamPrint(LOG_SOLVER, 0, "CVODE linear solver method %s", CVODE_LS_METHOD_DESC[config->linearSolverMethod]);
+
+  /* Set preconditioner for iterative linear solvers */
+  config->preconditioner = CVODE_PRECON_UNKNOWN;
+  if (omc_flag[FLAG_CVODE_PRECON])
+  {
+    for (i = 1; i < CVODE_PRECON_MAX; i++)
+    {
+      if (!strcmp((const char *)omc_flagValue[FLAG_CVODE_PRECON], CVODE_PRECON_METHOD[i]))
+      {
+        config->preconditioner = (enum CVODE_PRECON)i;
+        break;
+      }
+    }
+    if (config->preconditioner == CVODE_PRECON_UNKNOWN)
+    {
+      if (ACTIVE_WARNING_STREAM(LOG_SOLVER))
+      {
+        warningStreamPrint(LOG_SOLVER, 1, "Unrecognized preconditioner %s for CVODE, current options are:", (const char *)omc_flagValue[FLAG_CVODE_PRECON]);
+        for (i = 1; i < CVODE_PRECON_MAX; ++i)
+        {
+          warningStreamPrint(LOG_SOLVER, 0, "%-15s [%s]", CVODE_PRECON_METHOD[i], CVODE_PRECON_METHOD_DESC[i]);
+        }
+        messageClose(LOG_SOLVER);
+      }
+      throwStreamPrint(threadData, "Unrecognized preconditioner %s for CVODE.", (const char *)omc_flagValue[FLAG_CVODE_PRECON]);
+    }
+  }
+  else /* No user provided flag */
+  {
+    config->preconditioner = CVODE_PRECON_DIAG;
+  }
+  if (config->linearSolverMethod == CVODE_LS_SPGMR ||
+      config->linearSolverMethod == CVODE_LS_SPBCG ||
+      config->linearSolverMethod == CVODE_LS_SPTFQMR)
+  {
+    infoStreamPrint(LOG_SOLVER, 0, "CVODE preconditioner %s", CVODE_PRECON_METHOD_DESC[config->preconditioner]);
+  }
+  else if (omc_flag[FLAG_CVODE_PRECON])
+  {
+    warningStreamPrint(LOG_SOLVER, 0, "Ignoring user supplied flag \"%s\", only used by the iterative linear solvers of CVODE.", FLAG_NAME[FLAG_CVODE_PRECON]);
+  }
+
   /* Set jacobian method */
   if (omc_flag[FLAG_JACOBIAN])
   {
-    warningStreamPrint(LOG_SOLVER, 0, "Ignoring user supplied flag \"%s\", using internal dense Jacobian of CVODE.", omc_flagValue[FLAG_JACOBIAN]);
+    config->jacobianMethod = JAC_UNKNOWN;
+    for (i = 1; i < JAC_MAX; i++)
+    {
+      if (!strcmp((const char *)omc_flagValue[FLAG_JACOBIAN], JACOBIAN_METHOD[i]))
+      {
+        config->jacobianMethod = (enum JACOBIAN_METHOD)i;
+        break;
+      }
+    }
+    if (config->jacobianMethod == JAC_UNKNOWN)
+    {
+      if (ACTIVE_WARNING_STREAM(LOG_SOLVER))
+      {
+        warningStreamPrint(LOG_SOLVER, 1, "Unrecognized jacobian calculation method %s for CVODE, current options are:", (const char *)omc_flagValue[FLAG_JACOBIAN]);
+        for (i = 1; i < JAC_MAX; ++i)
+        {
+          warningStreamPrint(LOG_SOLVER, 0, "%-15s [%s]", JACOBIAN_METHOD[i], JACOBIAN_METHOD_DESC[i]);
+        }
+        messageClose(LOG_SOLVER);
+      }
+      throwStreamPrint(threadData, "Unrecognized jacobian calculation method %s for CVODE.", (const char *)omc_flagValue[FLAG_JACOBIAN]);
+    }
+    if (config->jacobianMethod == SYMJAC)
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "Symbolic Jacobians without coloring are currently not supported by CVODE. Colored symbolical Jacobian will be used.");
+      config->jacobianMethod = COLOREDSYMJAC;
+    }
+    if (config->jacobianMethod == NUMJAC)
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "Numerical Jacobians without coloring are currently not supported by CVODE. Colored numerical Jacobian will be used.");
+      config->jacobianMethod = COLOREDNUMJAC;
+    }
+#ifdef OMC_FMI_RUNTIME
+    if (config->jacobianMethod == COLOREDSYMJAC)
+    {
+      config->jacobianMethod = COLOREDNUMJAC;
+    }
+#endif
+  }
+  else if (config->linearSolverMethod == CVODE_LS_DENSE)
+  {
+    config->jacobianMethod = INTERNALNUMJAC;
+  }
+  else /* KLU and the diagonal preconditioner need the colored Jacobian */
+  {
+    config->jacobianMethod = COLOREDNUMJAC;
+  }
+  if (config->jacobianMethod == INTERNALNUMJAC &&
+      (config->linearSolverMethod == CVODE_LS_KLU || config->preconditioner == CVODE_PRECON_DIAG) &&
+      config->linearSolverMethod != CVODE_LS_DENSE)
+  {
+    warningStreamPrint(LOG_STDOUT, 0, "Jacobian method %s is not supported by CVODE linear solver %s. Colored numerical Jacobian will be used.",
+                       JACOBIAN_METHOD[INTERNALNUMJAC], CVODE_LS_METHOD[config->linearSolverMethod]);
+    config->jacobianMethod = COLOREDNUMJAC;
   }
-  config->jacobianMethod = INTERNALNUMJAC;
-  //config->jacobianMethod = COLOREDNUMJAC;
 
   /* Minimum absolute step size */
   config->minStepSize = 1e-12; /* TODO: This should be depending on the system? Bigger for 32 bit? */
@@ -520,6 +1005,8 @@ int cvode_solver_initial(DATA *data, threadData_t *threadData, SOLVER_INFO *solv
   int i;
   double *abstol_tmp;
   ANALYTIC_JACOBIAN *jacobian;
+  booleantype isIterative;
+  long int mu, ml;
 
   /* Log cvode_initial */
   infoStreamPrint(LOG_SOLVER_V, 0, "### Start initialize of CVODE solver ###");
@@ -574,41 +1061,130 @@ int cvode_solver_initial(DATA *data, threadData_t *threadData, SOLVER_INFO *solv
   assertStreamPrint(threadData, flag != CV_MEM_NULL, "CVODE_ERROR: CVodeSetUserData failed with flag CV_MEM_NULL: \"The cvode mem pointer is NULL.\"");
   assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVodeInit failed with unknown flag %i", flag);
 
-  /* Specify the CVDENSE dense linear solver */
-  switch (cvodeData->config.jacobianMethod)
-  {
-  case INTERNALNUMJAC:
-  case COLOREDNUMJAC:
-    flag = CVDense(cvodeData->cvode_mem, (long int)data->modelData->nStates);
-    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDense failed with flag %i", flag);
-    break;
-  default:
-    throwStreamPrint(threadData, "Unknown linear solver method %s for CVODE.", JACOBIAN_METHOD[cvodeData->config.jacobianMethod]);
-  }
-
-  /* Set Jacobian function */
+  /* Work arrays for the colored Jacobian */
+  cvodeData->N = (long int)data->modelData->nStates;
+  cvodeData->NNZ = 0;
+  cvodeData->ysave = (double *)malloc(cvodeData->N * sizeof(double));
+  cvodeData->delta_hh = (double *)malloc(cvodeData->N * sizeof(double));
+  cvodeData->preconDiag = (double *)calloc(cvodeData->N, sizeof(double));
+  assertStreamPrint(threadData, cvodeData->ysave != NULL && cvodeData->delta_hh != NULL && cvodeData->preconDiag != NULL, "Out of memory.");
+  cvodeData->newfy = N_VNew_Serial(cvodeData->N);
+  cvodeData->errwgt = N_VNew_Serial(cvodeData->N);
+  cvodeData->allocatedParMem = 0; /* false */
+
+  isIterative = cvodeData->config.linearSolverMethod == CVODE_LS_SPGMR ||
+                cvodeData->config.linearSolverMethod == CVODE_LS_SPBCG ||
+                cvodeData->config.linearSolverMethod == CVODE_LS_SPTFQMR;
+
+  /* Initialize Jacobian and its sparsity pattern */
   jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A]);
-  if (data->callback->initialAnalyticJacobianA(data, threadData, jacobian) == 0)
+  if (cvodeData->config.jacobianMethod != INTERNALNUMJAC ||
+      (isIterative && cvodeData->config.preconditioner == CVODE_PRECON_BAND))
   {
+    if (data->callback->initialAnalyticJacobianA(data, threadData, jacobian))
+    {
+      infoStreamPrint(LOG_STDOUT, 0, "Jacobian or SparsePattern is not generated or failed to initialize! Switch back to normal.");
+      jacobian = NULL;
+      cvodeData->config.jacobianMethod = INTERNALNUMJAC;
+      if (cvodeData->config.linearSolverMethod == CVODE_LS_KLU)
+      {
+        cvodeData->config.linearSolverMethod = CVODE_LS_DENSE;
+        warningStreamPrint(LOG_STDOUT, 0, "CVODE linear solver method also switched back to %s", CVODE_LS_METHOD_DESC[cvodeData->config.linearSolverMethod]);
+      }
+      if (isIterative && cvodeData->config.preconditioner == CVODE_PRECON_DIAG)
+      {
+        cvodeData->config.preconditioner = CVODE_PRECON_BAND;
+        warningStreamPrint(LOG_STDOUT, 0, "CVODE preconditioner also switched back to %s", CVODE_PRECON_METHOD_DESC[cvodeData->config.preconditioner]);
+      }
+    }
+    else
+    {
+      infoStreamPrint(LOG_SIMULATION, 1, "Initialized colored Jacobian:");
+      infoStreamPrint(LOG_SIMULATION, 0, "columns: %d rows: %d", jacobian->sizeCols, jacobian->sizeRows);
+      infoStreamPrint(LOG_SIMULATION, 0, "NNZ:  %d colors: %d", jacobian->sparsePattern->numberOfNoneZeros, jacobian->sparsePattern->maxColors);
+      messageClose(LOG_SIMULATION);
+    }
   }
   else
   {
+    jacobian = NULL;
   }
 
-  switch (cvodeData->config.jacobianMethod)
+#if !defined(OMC_FMI_RUNTIME) && defined(USE_PARJAC)
+  if (cvodeData->config.jacobianMethod == COLOREDSYMJAC)
   {
-  case INTERNALNUMJAC:
-    flag = CVDlsSetDenseJacFn(cvodeData->cvode_mem, NULL);
-    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsSetDenseJacFn failed with flag %i", flag);
-    infoStreamPrint(LOG_SOLVER, 0, "CVODE uses internal dense numeric jacobian method");
+    allocateThreadLocalJacobians(data, &(cvodeData->jacColumns));
+    cvodeData->allocatedParMem = 1; /* true */
+  }
+#endif
+
+  /* Specify the linear solver and set Jacobian function */
+  switch (cvodeData->config.linearSolverMethod)
+  {
+  case CVODE_LS_DENSE:
+    flag = CVDense(cvodeData->cvode_mem, cvodeData->N);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDense failed with flag %i", flag);
+    if (cvodeData->config.jacobianMethod == INTERNALNUMJAC)
+    {
+      flag = CVDlsSetDenseJacFn(cvodeData->cvode_mem, NULL);
+      assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsSetDenseJacFn failed with flag %i", flag);
+      infoStreamPrint(LOG_SOLVER, 0, "CVODE uses internal dense numeric jacobian method");
+    }
+    else
+    {
+      flag = CVDlsSetDenseJacFn(cvodeData->cvode_mem, callDenseJacobian);
+      assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsSetDenseJacFn failed with flag %i", flag);
+      infoStreamPrint(LOG_SOLVER, 0, "CVODE uses dense %s jacobian method", JACOBIAN_METHOD[cvodeData->config.jacobianMethod]);
+    }
     break;
-  case COLOREDNUMJAC:
-    flag = CVDlsSetDenseJacFn(cvodeData->cvode_mem, callDenseJacobian);
-    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsSetDenseJacFn failed with flag %i", flag);
-    infoStreamPrint(LOG_SOLVER, 0, "CVODE uses colored dense numeric jacobian method");
+#ifndef OMC_FMI_RUNTIME
+  case CVODE_LS_KLU:
+    cvodeData->NNZ = jacobian->sparsePattern->numberOfNoneZeros;
+    flag = CVKLU(cvodeData->cvode_mem, (int)cvodeData->N, (int)cvodeData->NNZ);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVKLU failed with flag %i", flag);
+    flag = CVSlsSetSparseJacFn(cvodeData->cvode_mem, callSparseJacobian);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSlsSetSparseJacFn failed with flag %i", flag);
+    infoStreamPrint(LOG_SOLVER, 0, "CVODE uses sparse %s jacobian method with %ld non-zero elements", JACOBIAN_METHOD[cvodeData->config.jacobianMethod], cvodeData->NNZ);
+    break;
+#endif
+  case CVODE_LS_SPGMR:
+    flag = CVSpgmr(cvodeData->cvode_mem, cvodeData->config.preconditioner == CVODE_PRECON_NONE ? PREC_NONE : PREC_LEFT, 0);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSpgmr failed with flag %i", flag);
+    break;
+  case CVODE_LS_SPBCG:
+    flag = CVSpbcg(cvodeData->cvode_mem, cvodeData->config.preconditioner == CVODE_PRECON_NONE ? PREC_NONE : PREC_LEFT, 0);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSpbcg failed with flag %i", flag);
+    break;
+  case CVODE_LS_SPTFQMR:
+    flag = CVSptfqmr(cvodeData->cvode_mem, cvodeData->config.preconditioner == CVODE_PRECON_NONE ? PREC_NONE : PREC_LEFT, 0);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSptfqmr failed with flag %i", flag);
     break;
   default:
-    throwStreamPrint(threadData, "Unknown linear solver method %s for CVODE.", JACOBIAN_METHOD[cvodeData->config.jacobianMethod]);
+    throwStreamPrint(threadData, "Unknown linear solver method %s for CVODE.", CVODE_LS_METHOD[cvodeData->config.linearSolverMethod]);
+  }
+
+  /* Set preconditioner of iterative linear solvers */
+  if (isIterative)
+  {
+    switch (cvodeData->config.preconditioner)
+    {
+    case CVODE_PRECON_NONE:
+      break;
+    case CVODE_PRECON_DIAG:
+      flag = CVSpilsSetPreconditioner(cvodeData->cvode_mem, cvodePreconditionerSetup, cvodePreconditionerSolve);
+      assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSpilsSetPreconditioner failed with flag %i", flag);
+      break;
+    case CVODE_PRECON_BAND:
+      cvodeBandwidth(jacobian ? jacobian->sparsePattern : NULL, cvodeData->N, &mu, &ml);
+      flag = CVBandPrecInit(cvodeData->cvode_mem, cvodeData->N, mu, ml);
+      assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVBandPrecInit failed with flag %i", flag);
+      infoStreamPrint(LOG_SOLVER, 0, "CVODE banded preconditioner with upper bandwidth %ld and lower bandwidth %ld", mu, ml);
+      break;
+    default:
+      throwStreamPrint(threadData, "Unknown preconditioner %s for CVODE.", CVODE_PRECON_METHOD[cvodeData->config.preconditioner]);
+    }
+    infoStreamPrint(LOG_SOLVER, 0, "CVODE uses iterative linear solver %s with preconditioner %s",
+                    CVODE_LS_METHOD[cvodeData->config.linearSolverMethod], CVODE_PRECON_METHOD[cvodeData->config.preconditioner]);
   }
 
   /* Set root finding function */
@@ -723,6 +1299,20 @@ int cvode_solver_deinitial(CVODE_SOLVER *cvodeData)
   free(NV_DATA_S(cvodeData->absoluteTolerance));
   N_VDestroy_Serial(cvodeData->absoluteTolerance);
 
+  free(cvodeData->ysave);
+  free(cvodeData->delta_hh);
+  free(cvodeData->preconDiag);
+  N_VDestroy_Serial(cvodeData->newfy);
+  N_VDestroy_Serial(cvodeData->errwgt);
+
+#if !defined(OMC_FMI_RUNTIME) && defined(USE_PARJAC)
+  if (cvodeData->allocatedParMem)
+  {
+    freeAnalyticalJacobian(&(cvodeData->jacColumns));
+    cvodeData->allocatedParMem = 0;
+  }
+#endif
+
   CVodeFree(&cvodeData->cvode_mem);
 
   free(cvodeData);
@@ -737,13 +1327,14 @@ int cvode_solver_deinitial(CVODE_SOLVER *cvodeData)
  *
  * If flag LOG_SOLVER_V is provided even more statistics will be collected.
  *
- * @param cvode_mem         Pointer to CVODE memory block.
+ * @param cvodeData         CVODE solver data struckt.
  * @param solverStatsTmp    Pointer to solverStatsTmp of solverInfo.
  * @param threadData        Thread data for error handling.
  */
-void cvode_save_statistics(void *cvode_mem, unsigned int *solverStatsTmp, threadData_t *threadData)
+void cvode_save_statistics(CVODE_SOLVER *cvodeData, unsigned int *solverStatsTmp, threadData_t *threadData)
 {
   /* Variables */
+  void *cvode_mem = cvodeData->cvode_mem;
   long int tmp1, tmp2;
   double dtmp;
   int flag;
@@ -761,11 +1352,33 @@ void cvode_save_statistics(void *cvode_mem, unsigned int *solverStatsTmp, thread
   assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVodeGetNumRhsEvals failed with flag %i", flag);
   solverStatsTmp[1] = tmp1;
 
-  /* Get number of right hand side evaluations for Jacobian */
-  /* TODO: Is it okay to add this to the Jacobian? */
+  /* Get number of Jacobian evaluations */
   tmp1 = 0;
-  flag = CVDlsGetNumRhsEvals(cvode_mem, &tmp1);
-  assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsGetNumRhsEvals failed with flag %i", flag);
+  switch (cvodeData->config.linearSolverMethod)
+  {
+  case CVODE_LS_DENSE:
+    if (cvodeData->config.jacobianMethod == INTERNALNUMJAC)
+    {
+      /* TODO: Is it okay to add this to the Jacobian? */
+      flag = CVDlsGetNumRhsEvals(cvode_mem, &tmp1);
+      assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsGetNumRhsEvals failed with flag %i", flag);
+    }
+    else
+    {
+      flag = CVDlsGetNumJacEvals(cvode_mem, &tmp1);
+      assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVDlsGetNumJacEvals failed with flag %i", flag);
+    }
+    break;
+#ifndef OMC_FMI_RUNTIME
+  case CVODE_LS_KLU:
+    flag = CVSlsGetNumJacEvals(cvode_mem, &tmp1);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSlsGetNumJacEvals failed with flag %i", flag);
+    break;
+#endif
+  default: /* iterative solvers, count preconditioner evaluations */
+    flag = CVSpilsGetNumPrecEvals(cvode_mem, &tmp1);
+    assertStreamPrint(threadData, flag >= 0, "CVODE_ERROR: CVSpilsGetNumPrecEvals failed with flag %i", flag);
+  }
   solverStatsTmp[2] = tmp1;
 
   /* Get number of local error test failures */
@@ -797,6 +1410,18 @@ void cvode_save_statistics(void *cvode_mem, unsigned int *solverStatsTmp, thread
     flag = CVodeGetNumLinSolvSetups(cvode_mem, &tmp1);
     infoStreamPrint(LOG_SOLVER_V, 0, " ## Number of calls made to the linear solver setup function: %ld", tmp1);
 
+    if (cvodeData->config.linearSolverMethod == CVODE_LS_SPGMR ||
+        cvodeData->config.linearSolverMethod == CVODE_LS_SPBCG ||
+        cvodeData->config.linearSolverMethod == CVODE_LS_SPTFQMR)
+    {
+      flag = CVSpilsGetNumLinIters(cvode_mem, &tmp1);
+      infoStreamPrint(LOG_SOLVER_V, 0, " ## Cumulative number of linear iterations: %ld", tmp1);
+      flag = CVSpilsGetNumConvFails(cvode_mem, &tmp1);
+      infoStreamPrint(LOG_SOLVER_V, 0, " ## Cumulative number of linear convergence failures: %ld", tmp1);
+      flag = CVSpilsGetNumRhsEvals(cvode_mem, &tmp1);
+      infoStreamPrint(LOG_SOLVER_V, 0, " ## Number of right-hand side evaluations for Jacobian-vector products: %ld", tmp1);
+    }
+
     messageClose(LOG_SOLVER_V);
   }
 }
@@ -939,7 +1564,7 @@ int cvode_solver_step(DATA *data, threadData_t *threadData, SOLVER_INFO *solverI
   }
 
   /* Save statistics */
-  cvode_save_statistics(cvodeData->cvode_mem, solverInfo->solverStatsTmp, threadData);
+  cvode_save_statistics(cvodeData, solverInfo->solverStatsTmp, threadData);
 
   infoStreamPrint(LOG_SOLVER, 0, "##CVODE## Finished Integrator step.");
   /* Measure time */
@@ -50,6 +50,15 @@
 #include <cvode/cvode.h>             /* prototypes for CVODE fcts., consts. */
 #include <cvode/cvode_impl.h>        /* prototypes for CVODE internal consts.*/
 #include <cvode/cvode_dense.h>       /* prototype for CVODE dense matrix functions and constants */
+#include <cvode/cvode_spgmr.h>       /* prototypes for CVODE Krylov linear solvers */
+#include <cvode/cvode_spbcgs.h>
+#include <cvode/cvode_sptfqmr.h>
+#include <cvode/cvode_spils.h>
+#include <cvode/cvode_bandpre.h>     /* prototypes for CVODE banded preconditioner module */
+#ifndef OMC_FMI_RUNTIME
+  #include <cvode/cvode_klu.h>       /* prototypes for CVODE sparse direct solver KLU */
+  #include <cvode/cvode_sparse.h>
+#endif
 #include <nvector/nvector_serial.h>  /* serial N_Vector types, fcts., macros */
 #include <sundials/sundials_types.h> /* definition of type realtype */
 
@@ -71,6 +80,8 @@ typedef struct CVODE_CONFIG
 
   booleantype internalSteps;           /* if TRUE internal step of the integrator are used, default FALSE */
   enum JACOBIAN_METHOD jacobianMethod; /* Method for Jacobian computation */
+  enum CVODE_LS linearSolverMethod;    /* Linear solver used by the Newton iteration */
+  enum CVODE_PRECON preconditioner;    /* Preconditioner for the iterative linear solvers */
 
   /* Optional configurations */
   double minStepSize;          /* Lower bound on the magnitude of the step size.
@@ -100,6 +111,19 @@ typedef struct CVODE_SOLVER
   N_Vector y;                 /* dependent variable vector of ODE */
   N_Vector absoluteTolerance; /* vector of absolute integrator tolerances for CVODE */
 
+  /* work arrays for the colored Jacobian */
+  long int N;                 /* number of states */
+  long int NNZ;               /* number of non-zero elements of the ODE Jacobian */
+  double *ysave;              /* saved states during finite differences */
+  double *delta_hh;           /* perturbation of each column */
+  N_Vector newfy;             /* perturbed right-hand side */
+  N_Vector errwgt;            /* error weights of CVODE */
+  double *preconDiag;         /* diagonal of the ODE Jacobian for the diagonal preconditioner */
+#ifdef USE_PARJAC
+  ANALYTIC_JACOBIAN* jacColumns;
+#endif
+  int allocatedParMem;        /* 1 if jacColumns is allocated */
+
   /* CVODE internal data */
   void *cvode_mem;            /* Internal CVODE memory block */
   CVODE_USERDATA *simData;
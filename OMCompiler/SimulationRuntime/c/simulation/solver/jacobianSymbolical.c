@@ -45,12 +45,17 @@
  */
 // ToDo AHEu: Make this usable without OpenMP and use it as default!
 void allocateThreadLocalJacobians(DATA* data, ANALYTIC_JACOBIAN** jacColumns)
+{
+  allocateThreadLocalJacobiansOf(&(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A]), jacColumns);
+}
+
+/** Allocate thread local copies of an arbitrary Jacobian, e.g. for the linearization matrices B, C and D.
+ */
+void allocateThreadLocalJacobiansOf(ANALYTIC_JACOBIAN* jac, ANALYTIC_JACOBIAN** jacColumns)
 {
   int maxTh = omc_get_max_threads();
   *jacColumns = (ANALYTIC_JACOBIAN*) malloc(maxTh*sizeof(ANALYTIC_JACOBIAN));
-  const int index = data->callback->INDEX_JAC_A;
-  ANALYTIC_JACOBIAN* jac = &(data->simulationInfo->analyticJacobians[index]);
-  SPARSE_PATTERN* sparsePattern = data->simulationInfo->analyticJacobians[index].sparsePattern;
+  SPARSE_PATTERN* sparsePattern = jac->sparsePattern;
 
   unsigned int columns = jac->sizeCols;
   unsigned int rows = jac->sizeRows;
@@ -62,7 +67,7 @@ void allocateThreadLocalJacobians(DATA* data, ANALYTIC_JACOBIAN** jacColumns)
   GC_allow_register_threads();
 #endif
 
-#pragma omp parallel default(none) firstprivate(maxTh, columns, rows, sizeTmpVars, index) shared(sparsePattern, jacColumns, i)
+#pragma omp parallel default(none) firstprivate(maxTh, columns, rows, sizeTmpVars) shared(sparsePattern, jacColumns, i)
   /* Benchmarks indicate that it is beneficial to initialize and malloc the jacColumns using a parallel for loop. */
   {
   /* Register omp-thread in GC */
@@ -109,13 +114,31 @@ void genericColoredSymbolicJacobianEvaluation(int rows, int columns, SPARSE_PATT
                                               threadData_t* threadData,
                                               void (*setJacElement)(int, int, int, double, void*, int))
 {
+  genericColoredSymbolicJacobianColumnEvaluation(rows, columns, spp, matrixA, jacColumns, data, threadData,
+                                                 data->callback->functionJacA_column, setJacElement);
+}
+
+/**
+ * \brief Generic parallel computation of any colored symbolic Jacobian.
+ *
+ * Same as genericColoredSymbolicJacobianEvaluation, but the column function
+ * is given, so it can be used for the matrices B, C and D of the linearization too.
+ *
+ * \param [in]      jacobianColumn      Generated function evaluating one (colored) column.
+ */
+void genericColoredSymbolicJacobianColumnEvaluation(int rows, int columns, SPARSE_PATTERN* spp,
+                                                    void* matrixA, ANALYTIC_JACOBIAN* jacColumns, DATA* data,
+                                                    threadData_t* threadData,
+                                                    int (*jacobianColumn)(void*, threadData_t*, ANALYTIC_JACOBIAN*, ANALYTIC_JACOBIAN*),
+                                                    void (*setJacElement)(int, int, int, double, void*, int))
+{
 
 #ifdef USE_PARJAC
   GC_allow_register_threads();
 #endif
 
 #pragma omp parallel default(none) firstprivate(columns, rows) \
-                                   shared(spp, matrixA, jacColumns, data, threadData, setJacElement)
+                                   shared(spp, matrixA, jacColumns, data, threadData, jacobianColumn, setJacElement)
 {
 #ifdef USE_PARJAC
   /* Register omp-thread in GC */
@@ -141,7 +164,7 @@ void genericColoredSymbolicJacobianEvaluation(int rows, int columns, SPARSE_PATT
     }
 
     /* Evaluate with updated seed vector */
-    data->callback->functionJacA_column(data, threadData, t_jac, NULL);
+    jacobianColumn(data, threadData, t_jac, NULL);
     /* Save jacobian elements in matrixA*/
     for (j=0; j < columns; j++) {
       if (t_jac->seedVars[j] == 1) {
@@ -37,7 +37,12 @@
 #include "../../simulation_data.h"
 #include "util/parallel_helper.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void allocateThreadLocalJacobians(DATA* data, ANALYTIC_JACOBIAN** jacColumns);
+void allocateThreadLocalJacobiansOf(ANALYTIC_JACOBIAN* jac, ANALYTIC_JACOBIAN** jacColumns);
 
 void genericColoredSymbolicJacobianEvaluation(int rows, int columns, SPARSE_PATTERN* spp,
                                               void* matrixA, ANALYTIC_JACOBIAN* jacColumns,
@@ -45,6 +50,17 @@ void genericColoredSymbolicJacobianEvaluation(int rows, int columns, SPARSE_PATT
                                               threadData_t* threadData,
                                               void (*setJacElement)(int, int, int, double, void*, int));
 
+void genericColoredSymbolicJacobianColumnEvaluation(int rows, int columns, SPARSE_PATTERN* spp,
+                                                    void* matrixA, ANALYTIC_JACOBIAN* jacColumns,
+                                                    DATA* data,
+                                                    threadData_t* threadData,
+                                                    int (*jacobianColumn)(void*, threadData_t*, ANALYTIC_JACOBIAN*, ANALYTIC_JACOBIAN*),
+                                                    void (*setJacElement)(int, int, int, double, void*, int));
+
 void freeAnalyticalJacobian(ANALYTIC_JACOBIAN** jacColumns);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -959,6 +959,10 @@ void initializeDataStruc(DATA *data, threadData_t *threadData)
   data->simulationInfo->nlsCsvInfomation = 0;
   data->simulationInfo->currentContext = CONTEXT_ALGEBRAIC;
   data->simulationInfo->jacobianEvals = data->modelData->nStates;
+  data->simulationInfo->linearizeTimes = NULL;
+  data->simulationInfo->nLinearizeTimes = 0;
+  data->simulationInfo->nextLinearizeTime = 0;
+  memset(data->simulationInfo->linearizeSymbolicJacobian, 0, sizeof(data->simulationInfo->linearizeSymbolicJacobian));
 
   data->simulationInfo->zeroCrossings = (modelica_real*) calloc(data->modelData->nZeroCrossings, sizeof(modelica_real));
   data->simulationInfo->zeroCrossingsPre = (modelica_real*) calloc(data->modelData->nZeroCrossings, sizeof(modelica_real));
@@ -1170,6 +1174,7 @@ void deInitializeDataStruc(DATA *data)
   omc_alloc_interface.free_uncollectable(data->modelData->samplesInfo);
   free(data->simulationInfo->nextSampleTimes);
   free(data->simulationInfo->samples);
+  free(data->simulationInfo->linearizeTimes);
 
   omc_alloc_interface.free_uncollectable(data->modelData->clocksInfo);
   omc_alloc_interface.free_uncollectable(data->modelData->subClocksInfo);
@@ -621,6 +621,11 @@ typedef struct SIMULATION_INFO
   double loggingTimeRecord[2];          /* Time interval in which logging is active. Only used if useLoggingTime=1 */
   int useLoggingTime;                   /* 0 if logging is currently disabled, 1 if enabled */
 
+  double *linearizeTimes;               /* sorted time points of the linearization (flag -l), the last one is the stop time */
+  int nLinearizeTimes;                  /* number of linearization time points, 0 if no linearization is performed */
+  int nextLinearizeTime;                /* index of the next linearization time point */
+  int linearizeSymbolicJacobian[4];    /* symbolic jacobians A, B, C and D are available, set at the first linearization time point */
+
   int lsMethod;                        /* linear solver */
   int lssMethod;                       /* linear sparse solver */
   int mixedMethod;                     /* mixed solver */
@@ -35,6 +35,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include "read_matlab4.h"
+#include "result_columnar.h"
 #include "omc_file.h"
 
 extern const char *omc_mat_Aclass;
@@ -47,6 +48,21 @@ typedef struct {
   uint32_t namelen;
 } MHeader_t;
 
+struct omc_columnar_index {
+  uint32_t nchunks;
+  uint32_t *rows;   /* rows of every chunk */
+  uint64_t *offset; /* nvar offsets per chunk */
+  uint32_t *size;   /* nvar sizes per chunk */
+};
+
+static void free_columnar_index(struct omc_columnar_index *index)
+{
+  free(index->rows);
+  free(index->offset);
+  free(index->size);
+  free(index);
+}
+
 /* Make Visual Studio not complain about deprecated items */
 #ifdef _MSC_VER
 #define strdup _strdup
@@ -123,7 +139,7 @@ void omc_free_matlab4_reader(ModelicaMatReader *reader)
     free(reader->allInfo[i].descr);
   }
   reader->nall = 0;
-  if (reader->file) {
+  if (reader->allInfo) {
     free(reader->allInfo);
     reader->allInfo=NULL;
   }
@@ -139,6 +155,10 @@ void omc_free_matlab4_reader(ModelicaMatReader *reader)
     free(reader->vars);
     reader->vars=NULL;
   }
+  if (reader->columnar) {
+    free_columnar_index(reader->columnar);
+    reader->columnar=NULL;
+  }
 }
 
 void remSpaces(char *ch){
@@ -216,6 +236,143 @@ static int read_double(int type, size_t n, FILE *file, double *val)
 }
 
 
+/* Reads a '\0'-terminated string of the columnar index */
+static char* read_columnar_string(FILE *file)
+{
+  size_t len = 0, capacity = 32;
+  char *str = (char*) malloc(capacity);
+  int c;
+  while (EOF != (c = fgetc(file))) {
+    if (len+1 == capacity) {
+      capacity *= 2;
+      str = (char*) realloc(str, capacity);
+    }
+    str[len++] = (char) c;
+    if (c == 0) {
+      return str;
+    }
+  }
+  free(str);
+  return NULL;
+}
+
+/* Reads the index of a columnar result file, see result_columnar.h */
+static const char* read_columnar_index(ModelicaMatReader *reader)
+{
+  FILE *file = reader->file;
+  struct omc_columnar_index *index;
+  char magic[8];
+  uint32_t bom, header[5], i, v, nrows = 0;
+  uint64_t indexOffset;
+
+  if (1 != fread(&bom, sizeof(uint32_t), 1, file)) return "Corrupt header: columnar result file";
+  if (bom != OMC_COLUMNAR_BOM) return "Columnar result file was written with a different byte order";
+  if (fseek(file, -16, SEEK_END) || 1 != fread(&indexOffset, sizeof(uint64_t), 1, file) || 1 != fread(magic, 8, 1, file)) {
+    return "Corrupt columnar result file: missing trailer";
+  }
+  if (memcmp(magic, OMC_COLUMNAR_INDEX_MAGIC, 8)) return "Corrupt columnar result file: missing index (was the simulation aborted?)";
+  if (fseek(file, indexOffset, SEEK_SET) || 1 != fread(header, sizeof(header), 1, file)) return "Corrupt columnar result file: index";
+
+  reader->nvar = header[0];
+  reader->nrows = header[1];
+  reader->nparam = header[2];
+  reader->doublePrecision = 1;
+  reader->params = reader->nparam > 0 ? (double*) malloc(reader->nparam*sizeof(double)) : NULL;
+  if (reader->nparam && reader->nparam != fread(reader->params, sizeof(double), reader->nparam, file)) {
+    return "Corrupt columnar result file: parameters";
+  }
+  reader->allInfo = (ModelicaMatVariable_t*) calloc(header[3], sizeof(ModelicaMatVariable_t));
+  for (i=0; i<header[3]; i++) {
+    ModelicaMatVariable_t *var = &reader->allInfo[i];
+    int32_t info[2];
+    if (1 != fread(info, sizeof(info), 1, file)) return "Corrupt columnar result file: variables";
+    reader->nall = i+1;
+    var->isParam = info[0];
+    var->index = info[1];
+    var->name = read_columnar_string(file);
+    var->descr = var->name ? read_columnar_string(file) : NULL;
+    if (!var->descr) return "Corrupt columnar result file: variables";
+    if (var->index == 0 || (uint32_t) abs(var->index) > (var->isParam ? reader->nparam : reader->nvar)) {
+      return "Corrupt columnar result file: variable index out of range";
+    }
+  }
+  qsort(reader->allInfo, reader->nall, sizeof(ModelicaMatVariable_t), omc_matlab4_comp_var);
+
+  index = (struct omc_columnar_index*) calloc(1, sizeof(struct omc_columnar_index));
+  reader->columnar = index;
+  index->nchunks = header[4];
+  index->rows = (uint32_t*) malloc((header[4]+1)*sizeof(uint32_t));
+  index->offset = (uint64_t*) malloc(((size_t)header[4]*reader->nvar+1)*sizeof(uint64_t));
+  index->size = (uint32_t*) malloc(((size_t)header[4]*reader->nvar+1)*sizeof(uint32_t));
+  for (i=0; i<index->nchunks; i++) {
+    if (1 != fread(&index->rows[i], sizeof(uint32_t), 1, file)) return "Corrupt columnar result file: chunks";
+    nrows += index->rows[i];
+    for (v=0; v<reader->nvar; v++) {
+      size_t k = (size_t)i*reader->nvar + v;
+      if (1 != fread(&index->offset[k], sizeof(uint64_t), 1, file) || 1 != fread(&index->size[k], sizeof(uint32_t), 1, file)) {
+        return "Corrupt columnar result file: chunks";
+      }
+      if (index->size[k] == OMC_COLUMNAR_REFERENCE) {
+        /* a copy of an earlier column of the chunk, which is stored as data */
+        uint64_t col = index->offset[k] & ~OMC_COLUMNAR_NEGATED;
+        if (col >= v || index->size[k-v+col] == OMC_COLUMNAR_CONSTANT || index->size[k-v+col] == OMC_COLUMNAR_REFERENCE) {
+          return "Corrupt columnar result file: invalid chunk reference";
+        }
+      } else if (index->size[k] != OMC_COLUMNAR_CONSTANT && index->offset[k] + index->size[k] > indexOffset) {
+        return "Corrupt columnar result file: chunk out of range";
+      }
+    }
+  }
+  if (nrows != reader->nrows) return "Corrupt columnar result file: number of rows";
+  reader->vars = (double**) calloc(reader->nvar*2, sizeof(double*));
+  return 0;
+}
+
+/* Decodes all chunks of a column of a columnar result file, expanding constant and copied chunks */
+static double* read_columnar_vals(ModelicaMatReader *reader, size_t absVarIndex)
+{
+  struct omc_columnar_index *index = reader->columnar;
+  double *vals = (double*) malloc(reader->nrows*sizeof(double));
+  unsigned char *buffer = NULL;
+  size_t capacity = 0, row = 0, j;
+  uint32_t i;
+
+  for (i=0; i<index->nchunks; i++) {
+    size_t k = (size_t)i*reader->nvar + absVarIndex-1;
+    uint64_t negated = 0, bits;
+    if (index->size[k] == OMC_COLUMNAR_CONSTANT) {
+      for (j=0; j<index->rows[i]; j++) {
+        memcpy(vals + row + j, &index->offset[k], sizeof(double));
+      }
+      row += index->rows[i];
+      continue;
+    }
+    if (index->size[k] == OMC_COLUMNAR_REFERENCE) {
+      negated = index->offset[k] & OMC_COLUMNAR_NEGATED;
+      k = (size_t)i*reader->nvar + (index->offset[k] & ~OMC_COLUMNAR_NEGATED);
+    }
+    if (index->size[k] > capacity) {
+      capacity = index->size[k];
+      buffer = (unsigned char*) realloc(buffer, capacity);
+    }
+    if (fseek(reader->file, index->offset[k], SEEK_SET) ||
+        1 != fread(buffer, index->size[k], 1, reader->file) ||
+        omc_columnar_decode(buffer, index->size[k], vals + row, index->rows[i])) {
+      free(buffer);
+      free(vals);
+      return NULL;
+    }
+    for (j=0; negated && j<index->rows[i]; j++) {
+      memcpy(&bits, vals + row + j, sizeof(double));
+      bits ^= negated;
+      memcpy(vals + row + j, &bits, sizeof(double));
+    }
+    row += index->rows[i];
+  }
+  free(buffer);
+  return vals;
+}
+
 /* Returns 0 on success; the error message on error */
 const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *reader)
 {
@@ -230,7 +387,15 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
   if(!reader->file) return strerror(errno);
   reader->fileName = strdup(filename);
   reader->readAll = 0;
+  reader->startTime = NAN;
   reader->stopTime = NAN;
+  {
+    char magic[8];
+    if (1 == fread(magic, 8, 1, reader->file) && 0 == memcmp(magic, OMC_COLUMNAR_MAGIC, 8)) {
+      return read_columnar_index(reader);
+    }
+    rewind(reader->file);
+  }
   for(i=0; i<nMatrix;i++) {
     MHeader_t hdr;
     int nr = fread(&hdr,sizeof(MHeader_t),1,reader->file);
@@ -569,6 +734,27 @@ double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex)
   assert(absVarIndex > 0 && absVarIndex <= reader->nvar);
   if (0 == reader->nrows) {
     return NULL;
+  } else if(!reader->vars[ix] && reader->columnar) {
+    unsigned int i;
+    size_t negIx = (varIndex < 0 ? absVarIndex : absVarIndex + reader->nvar) -1;
+    double *tmp;
+    if (reader->vars[negIx]) {
+      /* the column with the opposite sign is already decoded */
+      tmp = (double*) malloc(reader->nrows*sizeof(double));
+      if (tmp) {
+        for(i=0; i<reader->nrows; i++) {
+          tmp[i] = -reader->vars[negIx][i];
+        }
+      }
+    } else {
+      tmp = read_columnar_vals(reader, absVarIndex);
+      if (tmp && varIndex < 0) {
+        for(i=0; i<reader->nrows; i++) {
+          tmp[i] = -tmp[i];
+        }
+      }
+    }
+    reader->vars[ix] = tmp;
   } else if(!reader->vars[ix]) {
     unsigned int i;
     double *tmp = (double*) malloc(reader->nrows*sizeof(double));
@@ -679,6 +865,16 @@ int omc_matlab4_read_all_vals(ModelicaMatReader *reader)
     reader->readAll = 1;
     return 0;
   }
+  if (reader->columnar) {
+    /* every column is decoded once, the negated one is derived from it */
+    for (i=1; i<=nvar; i++) {
+      if (!omc_matlab4_read_vals(reader, i) || !omc_matlab4_read_vals(reader, -i)) {
+        return 1;
+      }
+    }
+    reader->readAll = 1;
+    return 0;
+  }
   tmp = (double*) malloc(2*nvar*nrows*sizeof(double));
   if (!tmp) {
     return 1;
@@ -719,6 +915,12 @@ double omc_matlab4_read_single_val(double *res, ModelicaMatReader *reader, int v
     *res = reader->vars[ix][timeIndex];
     return 0;
   }
+  if(reader->columnar) {
+    /* the chunks are compressed; decode and cache the whole column */
+    double *vals = omc_matlab4_read_vals(reader, varIndex);
+    *res = vals ? vals[timeIndex] : 0;
+    return vals == NULL;
+  }
   if(reader->doublePrecision==1) {
     fseek(reader->file,reader->var_offset + sizeof(double)*(timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
     if(1 != fread(res, sizeof(double), 1, reader->file)) {
@@ -740,6 +942,41 @@ double omc_matlab4_read_single_val(double *res, ModelicaMatReader *reader, int v
   return 0;
 }
 
+int omc_matlab4_read_row(double *res, ModelicaMatReader *reader, int timeIndex)
+{
+  unsigned int i;
+  if (timeIndex < 0 || timeIndex >= reader->nrows) {
+    return 1;
+  }
+  if (reader->columnar && omc_matlab4_read_all_vals(reader)) {
+    return 1;
+  }
+  if (reader->readAll) {
+    for (i=0; i<reader->nvar; i++) {
+      res[i] = reader->vars[i][timeIndex];
+    }
+    return 0;
+  }
+  if (reader->doublePrecision==1) {
+    fseek(reader->file, reader->var_offset + sizeof(double)*timeIndex*reader->nvar, SEEK_SET);
+    if (reader->nvar != fread(res, sizeof(double), reader->nvar, reader->file)) {
+      return 1;
+    }
+  } else {
+    float *buffer = (float*) malloc(reader->nvar*sizeof(float));
+    fseek(reader->file, reader->var_offset + sizeof(float)*timeIndex*reader->nvar, SEEK_SET);
+    if (reader->nvar != fread(buffer, sizeof(float), reader->nvar, reader->file)) {
+      free(buffer);
+      return 1;
+    }
+    for (i=0; i<reader->nvar; i++) {
+      res[i] = buffer[i];
+    }
+    free(buffer);
+  }
+  return 0;
+}
+
 void find_closest_points(double key, double *vec, int nelem, int *index1, double *weight1, int *index2, double *weight2)
 {
   int min = 0;
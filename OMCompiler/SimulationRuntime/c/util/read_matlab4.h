@@ -55,9 +55,11 @@ typedef struct {
   int readAll; /* Read all variables already */
   double **vars;
   char doublePrecision; /* data_1 and data_2 in double ore single precision */
+  struct omc_columnar_index *columnar; /* The chunk index of columnar result files (see result_columnar.h); NULL for MATLAB v4 files */
 } ModelicaMatReader;
 
 /* Returns 0 on success; the error message on error.
+ * Columnar result files (see result_columnar.h) are detected by their magic and read through the same interface.
  * The internal data is free'd by omc_free_matlab4_reader.
  * The data persists until free'd, and is safe to use in your own data-structures
  */
@@ -85,6 +87,11 @@ int omc_matlab4_val(double *res, ModelicaMatReader *reader, ModelicaMatVariable_
  * Returns 0 on success */
 int omc_matlab4_read_vars_val(double *res, ModelicaMatReader *reader, ModelicaMatVariable_t **var, int N, double time);
 
+/* Reads the values of all variables (data_2) at the given time index with a single read.
+ * res must have room for reader->nvar values; res[i] belongs to variable index i+1.
+ * Returns 0 on success */
+int omc_matlab4_read_row(double *res, ModelicaMatReader *reader, int timeIndex);
+
 /* For debugging */
 void omc_matlab4_print_all_vars(FILE *stream, ModelicaMatReader *reader);
 
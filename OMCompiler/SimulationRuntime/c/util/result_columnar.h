@@ -0,0 +1,211 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-2014, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+/*
+ * Columnar result files (outputFormat="col")
+ *
+ * The writer buffers the output rows, transposes them into chunks of single
+ * columns and compresses every column chunk on its own. An index at the end of
+ * the file lists the variables and the location of all chunks, so reading one
+ * signal does not touch the data of the others.
+ *
+ * The index is written when the result is closed, also after a failed
+ * simulation, but not if the process is killed; such a file cannot be read.
+ *
+ * Layout (host byte order, like the MATLAB v4 files):
+ *   header:  OMC_COLUMNAR_MAGIC (8 bytes), uint32_t OMC_COLUMNAR_BOM
+ *   chunks:  compressed column chunks
+ *   index:   uint32_t nvar, nrows, nparam, nall, nchunks
+ *            double params[nparam]
+ *            nall times: int32_t isParam, int32_t index, name '\0', description '\0'
+ *            nchunks times: uint32_t rows, nvar times: uint64_t offset, uint32_t size
+ *   trailer: uint64_t offset of the index, OMC_COLUMNAR_INDEX_MAGIC (8 bytes)
+ *
+ * isParam and index have the meaning of ModelicaMatVariable_t: columns and
+ * parameters are counted from 1, column 1 is time and negative indices are
+ * negated aliases.
+ *
+ * Column chunks that need no data of their own are only recorded in the index:
+ *   size OMC_COLUMNAR_CONSTANT:  all values of the chunk are equal, offset holds
+ *                                the bits of the value
+ *   size OMC_COLUMNAR_REFERENCE: the chunk is bit-identical to the chunk of an
+ *                                earlier column, offset holds that column (from 0),
+ *                                or'ed with OMC_COLUMNAR_NEGATED if every value
+ *                                has the opposite sign. The referenced chunk is
+ *                                always stored as data.
+ *
+ * A column chunk starts with a byte selecting the predictor of the values:
+ *   0: the previous value, the residual is the XOR of the bits
+ *   1: linear extrapolation of the bits as 64-bit integers, the residual is
+ *      the zigzag encoded difference
+ * Both predictors work on the bits only, so decoding is exact on every platform.
+ * The writer uses the one giving the smaller chunk. A control byte describes
+ * each residual:
+ *   0x80 | (n-1):    n (1..128) values are predicted exactly
+ *   (lz << 3) | tz:  the residual has lz leading and tz trailing zero bytes, the
+ *                    8-lz-tz bytes in between follow, most significant first
+ */
+
+#ifndef OMC_RESULT_COLUMNAR_H
+#define OMC_RESULT_COLUMNAR_H
+
+#include <stdint.h>
+#include <string.h>
+#include "omc_msvc.h"
+
+#define OMC_COLUMNAR_MAGIC "OMCCOL01"
+#define OMC_COLUMNAR_INDEX_MAGIC "OMCCOLIX"
+#define OMC_COLUMNAR_BOM 0x01020304
+
+#define OMC_COLUMNAR_CONSTANT 0
+#define OMC_COLUMNAR_REFERENCE 0xFFFFFFFF
+#define OMC_COLUMNAR_NEGATED (((uint64_t) 1) << 63)
+
+/* size of the buffer omc_columnar_encode needs for n values */
+#define OMC_COLUMNAR_MAX_SIZE(n) (1+2*9*(n))
+
+static OMC_INLINE uint64_t omc_columnar_predict(int predictor, uint64_t prev, uint64_t prev2)
+{
+  return predictor ? 2*prev - prev2 : prev;
+}
+
+static OMC_INLINE uint64_t omc_columnar_residual(int predictor, uint64_t bits, uint64_t predicted)
+{
+  uint64_t d;
+  if (!predictor) {
+    return bits ^ predicted;
+  }
+  d = bits - predicted;
+  return (d << 1) ^ (0 - (d >> 63)); /* zigzag */
+}
+
+static OMC_INLINE size_t omc_columnar_encode_predictor(const double *values, size_t n, int predictor, unsigned char *out)
+{
+  unsigned char *pos = out;
+  uint64_t prev = 0, prev2 = 0, bits, x;
+  size_t i = 0;
+  int lz, tz, k, run;
+
+  while (i < n) {
+    memcpy(&bits, values + i, sizeof(uint64_t));
+    x = omc_columnar_residual(predictor, bits, omc_columnar_predict(predictor, prev, prev2));
+    prev2 = prev;
+    prev = bits;
+    i++;
+    if (x == 0) {
+      for (run = 1; run < 128 && i < n; run++, i++) {
+        memcpy(&bits, values + i, sizeof(uint64_t));
+        if (bits != omc_columnar_predict(predictor, prev, prev2)) {
+          break;
+        }
+        prev2 = prev;
+        prev = bits;
+      }
+      *pos++ = (unsigned char) (0x80 | (run-1));
+      continue;
+    }
+    for (lz = 0; !(x >> (56 - 8*lz) & 0xff); lz++);
+    for (tz = 0; !(x >> (8*tz) & 0xff); tz++);
+    *pos++ = (unsigned char) ((lz << 3) | tz);
+    for (k = 7 - lz; k >= tz; k--) {
+      *pos++ = (unsigned char) (x >> (8*k));
+    }
+  }
+  return pos - out;
+}
+
+/* Compresses n values into out, which needs room for OMC_COLUMNAR_MAX_SIZE(n) bytes.
+ * Returns the compressed size. */
+static OMC_INLINE size_t omc_columnar_encode(const double *values, size_t n, unsigned char *out)
+{
+  size_t size0, size1;
+  size0 = omc_columnar_encode_predictor(values, n, 0, out + 1);
+  size1 = omc_columnar_encode_predictor(values, n, 1, out + 1 + size0);
+  if (size1 < size0) {
+    out[0] = 1;
+    memmove(out + 1, out + 1 + size0, size1);
+    return 1 + size1;
+  }
+  out[0] = 0;
+  return 1 + size0;
+}
+
+/* Decompresses n values. Returns 0 on success. */
+static OMC_INLINE int omc_columnar_decode(const unsigned char *in, size_t size, double *values, size_t n)
+{
+  const unsigned char *end = in + size;
+  uint64_t prev = 0, prev2 = 0, x, bits;
+  size_t i = 0;
+  int predictor, lz, tz, k, run;
+
+  if (size < 1 || *in > 1) {
+    return 1;
+  }
+  predictor = *in++;
+  while (i < n) {
+    if (in >= end) {
+      return 1;
+    }
+    if (*in & 0x80) {
+      run = (*in++ & 0x7f) + 1;
+      if (i + run > n) {
+        return 1;
+      }
+      while (run--) {
+        bits = omc_columnar_predict(predictor, prev, prev2);
+        memcpy(values + i++, &bits, sizeof(uint64_t));
+        prev2 = prev;
+        prev = bits;
+      }
+      continue;
+    }
+    lz = *in >> 3;
+    tz = *in++ & 7;
+    if (lz + tz > 7 || in + (8 - lz - tz) > end) {
+      return 1;
+    }
+    x = 0;
+    for (k = 7 - lz; k >= tz; k--) {
+      x |= ((uint64_t) *in++) << (8*k);
+    }
+    bits = omc_columnar_predict(predictor, prev, prev2);
+    if (predictor) {
+      bits += (x >> 1) ^ (0 - (x & 1)); /* inverse zigzag */
+    } else {
+      bits ^= x;
+    }
+    memcpy(values + i++, &bits, sizeof(uint64_t));
+    prev2 = prev;
+    prev = bits;
+  }
+  return in != end;
+}
+
+#endif
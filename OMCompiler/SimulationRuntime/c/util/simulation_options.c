@@ -40,6 +40,8 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_CSV_OSTEP */                    "csvOstep",
   /* FLAG_CVODE_ITER */                   "cvodeNonlinearSolverIteration",
   /* FLAG_CVODE_LMM */                    "cvodeLinearMultistepMethod",
+  /* FLAG_CVODE_LS */                     "cvodeLS",
+  /* FLAG_CVODE_PRECON */                 "cvodePreconditioner",
   /* FLAG_DAE_MODE */                     "daeMode",
   /* FLAG_DELTA_X_LINEARIZE */            "deltaXLinearize",
   /* FLAG_DELTA_X_SOLVER */               "deltaXSolver",
@@ -94,6 +96,7 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_JACOBIAN_THREADS */             "jacobianThreads",
   /* FLAG_L */                            "l",
   /* FLAG_L_DATA_RECOVERY */              "l_datarec",
+  /* FLAG_L_SPARSE */                     "l_sparse",
   /* FLAG_LOG_FORMAT */                   "logFormat",
   /* FLAG_LS */                           "ls",
   /* FLAG_LS_IPOPT */                     "ls_ipopt",
@@ -128,11 +131,13 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_OPTDEBUGEJAC */                 "optDebugJac",
   /* FLAG_OPTIMIZER_NP */                 "optimizerNP",
   /* FLAG_OPTIMIZER_TGRID */              "optimizerTimeGrid",
+  /* FLAG_OPTIMIZER_MPC */                "optimizerMPC",
   /* FLAG_OUTPUT */                       "output",
   /* FLAG_OUTPUT_PATH */                  "outputPath",
   /* FLAG_OVERRIDE */                     "override",
   /* FLAG_OVERRIDE_FILE */                "overrideFile",
   /* FLAG_PORT */                         "port",
+  /* FLAG_PORT_SUBSCRIBE */               "portSubscribe",
   /* FLAG_R */                            "r",
   /* FLAG_DATA_RECONCILE  */              "reconcile",
   /* FLAG_RT */                           "rt",
@@ -142,6 +147,7 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_STEADY_STATE */                 "steadyState",
   /* FLAG_STEADY_STATE_TOL */             "steadyStateTol",
   /* FLAG_DATA_RECONCILE_Sx */            "sx",
+  /* FLAG_DATA_RECONCILE_BATCH */         "sxBatch",
   /* FLAG_UP_HESSIAN */                   "keepHessian",
   /* FLAG_W */                            "w",
 
@@ -158,6 +164,8 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_CSV_OSTEP */                    "value specifies csv-files for debug values for optimizer step",
   /* FLAG_CVODE_ITER */                   "nonlinear solver iteration for CVODE solver",
   /* FLAG_CVODE_LMM */                    "linear multistep method for CVODE solver",
+  /* FLAG_CVODE_LS */                     "select the linear solver used by CVODE",
+  /* FLAG_CVODE_PRECON */                 "select the preconditioner for the iterative linear solvers of CVODE",
   /* FLAG_DAE_MODE */                     "flag to let the integrator use daeResiduals",
   /* FLAG_DELTA_X_LINEARIZE */            "value specifies the delta x value for numerical differentiation used by linearization. The default value is 1e-5.",
   /* FLAG_DELTA_X_SOLVER */               "value specifies the delta x value for numerical differentiation used by integrator. The default values is sqrt(DBL_EPSILON).",
@@ -208,10 +216,11 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_IPOPT_JAC */                    "value specifies the Jacobian for Ipopt",
   /* FLAG_IPOPT_MAX_ITER */               "value specifies the max number of iteration for ipopt",
   /* FLAG_IPOPT_WARM_START */             "value specifies lvl for a warm start in ipopt: 1,2,3,...",
-  /* FLAG_JACOBIAN */                     "select the calculation method of the Jacobian used only by ida and dassl solver.",
+  /* FLAG_JACOBIAN */                     "select the calculation method of the Jacobian used only by ida, dassl and cvode solver.",
   /* FLAG_JACOBIAN_THREADS */             "[int default: 1] value specifies the number of threads for jacobian evaluation in dassl or ida.",
-  /* FLAG_L */                            "value specifies a time where the linearization of the model should be performed",
+  /* FLAG_L */                            "value specifies a time or a comma separated list of times where the linearization of the model should be performed",
   /* FLAG_L_DATA_RECOVERY */              "emit data recovery matrices with model linearization",
+  /* FLAG_L_SPARSE */                     "write the linearized model as sparse matrices to a MAT file",
   /* FLAG_LOG_FORMAT */                   "value specifies the log format of the executable. -logFormat=text (default), -logFormat=xml or -logFormat=xmltcp",
   /* FLAG_LS */                           "value specifies the linear solver method (default: lapack, totalpivot (fallback))",
   /* FLAG_LS_IPOPT */                     "value specifies the linear solver method for ipopt",
@@ -246,11 +255,13 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_OPTDEBUGEJAC */                 "value specifies the number of iter from the dyn. optimization, which will be debug, creating *csv and *py file",
   /* FLAG_OPTIMIZER_NP */                 "value specifies the number of points in a subinterval",
   /* FLAG_OPTIMIZER_TGRID */              "value specifies external file with time points.",
+  /* FLAG_OPTIMIZER_MPC */                "value specifies the number of receding horizon (MPC) steps of the optimizer",
   /* FLAG_OUTPUT */                       "output the variables a, b and c at the end of the simulation to the standard output",
   /* FLAG_OUTPUT_PATH */                  "value specifies a path for writing the output files i.e., model_res.mat, model_prof.intdata, model_prof.realdata etc.",
   /* FLAG_OVERRIDE */                     "override the variables or the simulation settings in the XML setup file",
   /* FLAG_OVERRIDE_FILE */                "will override the variables or the simulation settings in the XML setup file with the values from the file",
   /* FLAG_PORT */                         "value specifies the port for simulation status (default disabled)",
+  /* FLAG_PORT_SUBSCRIBE */               "wait for the first message of the -port client before the first output step (interactive output format)",
   /* FLAG_R */                            "value specifies a new result file than the default Model_res.mat",
   /* FLAG_DATA_RECONCILE */               "Run the DataReconciliation algorithm for constrained equation",
   /* FLAG_RT */                           "value specifies the scaling factor for real-time synchronization (0 disables)",
@@ -260,6 +271,7 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_STEADY_STATE */                 "aborts if steady state is reached",
   /* FLAG_STEADY_STATE_TOL */             "[double (default 1e-3)] This relative tolerance is used to detect steady state.",
   /* FLAG_DATA_RECONCILE_Sx */            "value specifies a csv-file with inputs as covariance matrix Sx for DataReconciliation",
+  /* FLAG_DATA_RECONCILE_BATCH */         "value specifies a csv-file with one set of measured values per line for online DataReconciliation",
   /* FLAG_UP_HESSIAN */                   "value specifies the number of steps, which keep hessian matrix constant",
   /* FLAG_W */                            "shows all warnings even if a related log-stream is inactive",
 
@@ -293,6 +305,10 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "                Use together with flag -cvodeNonlinearSolverIteration=CV_NEWTON or don't set cvodeNonlinearSolverIteration.\n"
   "  * CV_ADAMS  - Adams-Moulton linear multistep method for nonstiff problems.\n"
   "                Use together with flag -cvodeNonlinearSolverIteration=CV_FUNCTIONAL or don't set cvodeNonlinearSolverIteration.",
+  /* FLAG_CVODE_LS */
+  "  Value specifies the linear solver used by the Newton iteration of the cvode integration method. Valid values:\n",
+  /* FLAG_CVODE_PRECON */
+  "  Value specifies the preconditioner used together with the iterative linear solvers spgmr, spbcg and sptfqmr of cvode. Valid values:\n",
   /* FLAG_DAE_MODE */
   "  Enables daeMode simulation if the model was compiled with the omc flag --daeMode and ida method is used.",
   /* FLAG_DELTA_X_LINEARIZE */
@@ -414,9 +430,14 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  Value specifies the number of threads for jacobian evaluation in dassl or ida."
   "  The value is an Integer with default value 1.",
   /* FLAG_L */
-  "  Value specifies a time where the linearization of the model should be performed.",
+  "  Value specifies a time where the linearization of the model should be performed.\n"
+  "  A comma separated list of times linearizes the model at all of them in one simulation run,\n"
+  "  the results are written to numbered files, e.g. linearized_model_1.mo.",
   /* FLAG_L_DATA_RECOVERY */
   "  Emit data recovery matrices with model linearization.",
+  /* FLAG_L_SPARSE */
+  "  Write the matrices of the linearized model in sparse form to the MAT-file linearized_model.mat\n"
+  "  instead of the text file given by --linearizationDumpLanguage. Use this for large models.",
   /* FLAG_LOG_FORMAT */
   "  Value specifies the log format of the executable:\n\n"
   "  * text (default)\n"
@@ -515,6 +536,12 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  Currently supports numbers 1 and 3.",
   /* FLAG_OPTIMIZER_TGRID */
   "  Value specifies external file with time points.",
+  /* FLAG_OPTIMIZER_MPC */
+  "  Value specifies the number of receding horizon (MPC) steps of the dynamic\n"
+  "  optimization. After each solve the horizon is shifted by the first interval,\n"
+  "  the states are updated from the file given by -stateFile (or predicted by the\n"
+  "  last solution if the flag is not set) and ipopt is warm started from the\n"
+  "  shifted solution. The problem structure and the ipopt instance are kept.",
   /* FLAG_OUTPUT */
   "  Output the variables a, b and c at the end of the simulation to the standard\n"
   "  output: time = value, a = value, b = value, c = value",
@@ -531,6 +558,10 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  overrideFileName contains lines of the form: var1=start1",
   /* FLAG_PORT */
   "  Value specifies the port for simulation status (default disabled).",
+  /* FLAG_PORT_SUBSCRIBE */
+  "  With -port and the interactive output format (outputFormat=\"ia\"), waits for\n"
+  "  the first message of the client before the first output step, so a client that\n"
+  "  subscribes to a subset of the signals receives all output steps.",
   /* FLAG_R */
   "  Value specifies the name of the output result file.\n"
   "  The default file-name is based on the model name and output format.\n"
@@ -552,6 +583,11 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  This relative tolerance is used to detect steady state: max(|d(x_i)/dt|/nominal(x_i)) < steadyStateTol",
   /* FLAG_DATA_RECONCILE_Sx */
   "  Value specifies an csv-file with inputs as covariance matrix Sx for DataReconciliation",
+  /* FLAG_DATA_RECONCILE_BATCH */
+  "  Value specifies a csv-file with one set of measured values per line for online\n"
+  "  DataReconciliation. The header line contains the names of the measured variables,\n"
+  "  variables of the -sx file without a column keep their measured value from -sx.\n"
+  "  The reconciled values of every set are written to <model>_Batch_Outputs.csv.",
   /* FLAG_UP_HESSIAN */
   "  Value specifies the number of steps, which keep Hessian matrix constant.",
   /* FLAG_W */
@@ -570,6 +606,8 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_CSV_OSTEP */                    FLAG_TYPE_OPTION,
   /* FLAG_CVODE_ITER */                   FLAG_TYPE_OPTION,
   /* FLAG_CVODE_LMM */                    FLAG_TYPE_OPTION,
+  /* FLAG_CVODE_LS */                     FLAG_TYPE_OPTION,
+  /* FLAG_CVODE_PRECON */                 FLAG_TYPE_OPTION,
   /* FLAG_DAE_SOLVING */                  FLAG_TYPE_FLAG,
   /* FLAG_DELTA_X_LINEARIZE */            FLAG_TYPE_OPTION,
   /* FLAG_DELTA_X_SOLVER */               FLAG_TYPE_OPTION,
@@ -624,6 +662,7 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_JACOBIAN_THREADS */             FLAG_TYPE_OPTION,
   /* FLAG_L */                            FLAG_TYPE_OPTION,
   /* FLAG_L_DATA_RECOVERY */              FLAG_TYPE_FLAG,
+  /* FLAG_L_SPARSE */                     FLAG_TYPE_FLAG,
   /* FLAG_LOG_FORMAT */                   FLAG_TYPE_OPTION,
   /* FLAG_LS */                           FLAG_TYPE_OPTION,
   /* FLAG_LS_IPOPT */                     FLAG_TYPE_OPTION,
@@ -658,11 +697,13 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_OPTDEBUGEJAC */                 FLAG_TYPE_OPTION,
   /* FLAG_OPTIZER_NP */                   FLAG_TYPE_OPTION,
   /* FLAG_OPTIZER_TGRID */                FLAG_TYPE_OPTION,
+  /* FLAG_OPTIMIZER_MPC */                FLAG_TYPE_OPTION,
   /* FLAG_OUTPUT */                       FLAG_TYPE_OPTION,
   /* FLAG_OUTPUT_PATH */                  FLAG_TYPE_OPTION,
   /* FLAG_OVERRIDE */                     FLAG_TYPE_OPTION,
   /* FLAG_OVERRIDE_FILE */                FLAG_TYPE_OPTION,
   /* FLAG_PORT */                         FLAG_TYPE_OPTION,
+  /* FLAG_PORT_SUBSCRIBE */               FLAG_TYPE_FLAG,
   /* FLAG_R */                            FLAG_TYPE_OPTION,
   /* FLAG_DATA_RECONCILE */               FLAG_TYPE_FLAG,
   /* FLAG_RT */                           FLAG_TYPE_OPTION,
@@ -672,6 +713,7 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_STEADY_STATE */                 FLAG_TYPE_FLAG,
   /* FLAG_STEADY_STATE_TOL */             FLAG_TYPE_OPTION,
   /* FLAG_DATA_RECONCILE_Sx */            FLAG_TYPE_OPTION,
+  /* FLAG_DATA_RECONCILE_BATCH */         FLAG_TYPE_OPTION,
   /* FLAG_UP_HESSIAN */                   FLAG_TYPE_OPTION,
   /* FLAG_W */                            FLAG_TYPE_FLAG
 };
@@ -848,9 +890,9 @@ const char *JACOBIAN_METHOD[JAC_MAX] = {
 const char *JACOBIAN_METHOD_DESC[JAC_MAX] = {
   "unknown",
 
-  "Colored numerical Jacobian, which is default for dassl and ida. With option -idaLS=klu a sparse matrix is used.",
+  "Colored numerical Jacobian, which is default for dassl and ida. With option -idaLS=klu or -cvodeLS=klu a sparse matrix is used.",
   "Dense solver internal numerical Jacobian.",
-  "Colored symbolical Jacobian. Needs omc compiler flag --generateSymbolicJacobian. With option -idaLS=klu a sparse matrix is used.",
+  "Colored symbolical Jacobian. Needs omc compiler flag --generateSymbolicJacobian. With option -idaLS=klu or -cvodeLS=klu a sparse matrix is used.",
   "Dense numerical Jacobian.",
   "Dense symbolical Jacobian. Needs omc compiler flag --generateSymbolicJacobian.",
  };
@@ -875,6 +917,42 @@ const char *IDA_LS_METHOD_DESC[IDA_LS_MAX] = {
   "ida TFQMR. Iterative method"
 };
 
+const char *CVODE_LS_METHOD[CVODE_LS_MAX] = {
+  "unknown",
+
+  "dense",
+  "klu",
+  "spgmr",
+  "spbcg",
+  "sptfqmr"
+};
+
+const char *CVODE_LS_METHOD_DESC[CVODE_LS_MAX] = {
+  "unknown",
+
+  "cvode internal dense method. (default)",
+  "cvode use sparse direct solver KLU with the sparsity pattern of the ODE Jacobian.",
+  "cvode generalized minimal residual method. Iterative method",
+  "cvode Bi-CGStab. Iterative method",
+  "cvode TFQMR. Iterative method"
+};
+
+const char *CVODE_PRECON_METHOD[CVODE_PRECON_MAX] = {
+  "unknown",
+
+  "none",
+  "diag",
+  "band"
+};
+
+const char *CVODE_PRECON_METHOD_DESC[CVODE_PRECON_MAX] = {
+  "unknown",
+
+  "no preconditioning.",
+  "diagonal (Jacobi) preconditioner I-gamma*diag(J), the diagonal is evaluated with the colored Jacobian. (default)",
+  "banded preconditioner with the bandwidths of the sparsity pattern of the ODE Jacobian."
+};
+
 const char *NLS_LS_METHOD[NLS_LS_MAX] = {
   "unknown",
 
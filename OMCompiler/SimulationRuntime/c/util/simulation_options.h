@@ -48,6 +48,8 @@ enum _FLAG
   FLAG_CSV_OSTEP,
   FLAG_CVODE_ITER,
   FLAG_CVODE_LMM,
+  FLAG_CVODE_LS,
+  FLAG_CVODE_PRECON,
   FLAG_DAE_MODE,
   FLAG_DELTA_X_LINEARIZE,
   FLAG_DELTA_X_SOLVER,
@@ -102,6 +104,7 @@ enum _FLAG
   FLAG_JACOBIAN_THREADS,
   FLAG_L,
   FLAG_L_DATA_RECOVERY,
+  FLAG_L_SPARSE,
   FLAG_LOG_FORMAT,
   FLAG_LS,
   FLAG_LS_IPOPT,
@@ -136,11 +139,13 @@ enum _FLAG
   FLAG_OPTDEBUGEJAC,
   FLAG_OPTIMIZER_NP,
   FLAG_OPTIMIZER_TGRID,
+  FLAG_OPTIMIZER_MPC,
   FLAG_OUTPUT,
   FLAG_OUTPUT_PATH,
   FLAG_OVERRIDE,
   FLAG_OVERRIDE_FILE,
   FLAG_PORT,
+  FLAG_PORT_SUBSCRIBE,
   FLAG_R,
   FLAG_DATA_RECONCILE,
   FLAG_RT,
@@ -150,6 +155,7 @@ enum _FLAG
   FLAG_STEADY_STATE,
   FLAG_STEADY_STATE_TOL,
   FLAG_DATA_RECONCILE_Sx,
+  FLAG_DATA_RECONCILE_BATCH,
   FLAG_UP_HESSIAN,
   FLAG_W,
 
@@ -317,6 +323,36 @@ enum IDA_LS
 extern const char *IDA_LS_METHOD[IDA_LS_MAX];
 extern const char *IDA_LS_METHOD_DESC[IDA_LS_MAX];
 
+enum CVODE_LS
+{
+  CVODE_LS_UNKNOWN = 0,
+
+  CVODE_LS_DENSE,
+  CVODE_LS_KLU,
+  CVODE_LS_SPGMR,
+  CVODE_LS_SPBCG,
+  CVODE_LS_SPTFQMR,
+
+  CVODE_LS_MAX
+};
+
+extern const char *CVODE_LS_METHOD[CVODE_LS_MAX];
+extern const char *CVODE_LS_METHOD_DESC[CVODE_LS_MAX];
+
+enum CVODE_PRECON
+{
+  CVODE_PRECON_UNKNOWN = 0,
+
+  CVODE_PRECON_NONE,
+  CVODE_PRECON_DIAG,
+  CVODE_PRECON_BAND,
+
+  CVODE_PRECON_MAX
+};
+
+extern const char *CVODE_PRECON_METHOD[CVODE_PRECON_MAX];
+extern const char *CVODE_PRECON_METHOD_DESC[CVODE_PRECON_MAX];
+
 enum NLS_LS
 {
   NLS_LS_UNKNOWN = 0,
@@ -46,6 +46,10 @@ public:
 
   virtual void getAColorOfColumn(int* aSparsePatternColorCols, int size) = 0;
   virtual int getAMaxColors() = 0;
+  /// Number of structural non-zeros of the state Jacobian A
+  virtual int getANonZeros() = 0;
+  /// Sparsity pattern of A in compressed sparse column format (leadindex has dim+1 entries)
+  virtual void getASparsePattern(int* aSparsePatternLeadindex, int* aSparsePatternIndex) = 0;
 
   // Copy the given IMixedSystem instance
   virtual IMixedSystem* clone() = 0;
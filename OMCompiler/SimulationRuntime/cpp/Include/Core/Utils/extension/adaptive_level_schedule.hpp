@@ -0,0 +1,204 @@
+#ifndef ADAPTIVE_LEVEL_SCHEDULE_HPP_
+#define ADAPTIVE_LEVEL_SCHEDULE_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Runtime re-balancing of a hpcom level schedule.
+ *
+ * The generated code executes the tasks of every level dynamically and reports their execution
+ * times for the first measureCalls calls. Afterwards each level is executed in the mode that fits
+ * the measured task granularity:
+ *  - SERIAL:  the parallel gain of the level is below the cost of a barrier, the master thread
+ *             executes all tasks.
+ *  - STATIC:  the tasks are assigned to the threads with longest-processing-time-first, used for
+ *             fine-grained levels where dynamic distribution does not pay off.
+ *  - DYNAMIC: coarse-grained levels with many or fluctuating tasks are distributed dynamically,
+ *             so faster cores take over work from slower ones.
+ * If the estimated parallel execution time of the whole schedule is not smaller than the serial
+ * time, the schedule is evaluated without a parallel region at all.
+ */
+class AdaptiveLevelSchedule
+{
+  public:
+    enum LevelMode { MEASURE, SERIAL, STATIC, DYNAMIC };
+
+    AdaptiveLevelSchedule() : _numThreads(1), _measureCalls(0), _calls(0), _serial(false),
+      _barrierCost(2e-6), _dynamicTaskCost(1e-6), _maxStaticVariation(0.2)
+    {
+    }
+
+    ~AdaptiveLevelSchedule()
+    {
+    }
+
+    /// Adds a level with the given number of independent tasks, must be called before init
+    void addLevel(int numTasks)
+    {
+      std::vector<int> tasks(numTasks);
+      for(int i = 0; i < numTasks; i++)
+        tasks[i] = i;
+
+      _tasksOfLevels.push_back(tasks);
+      _levelModes.push_back(MEASURE);
+      _taskTimes.push_back(std::vector<double>(numTasks, 0.0));
+      _taskQuadTimes.push_back(std::vector<double>(numTasks, 0.0));
+      _tasksOfThreads.push_back(std::vector<std::vector<int> >());
+    }
+
+    void init(int numThreads, int measureCalls)
+    {
+      _numThreads = std::max(numThreads, 1);
+      _measureCalls = measureCalls;
+      _calls = 0;
+      _serial = false;
+      for(size_t level = 0; level < _tasksOfLevels.size(); level++)
+      {
+        _levelModes[level] = MEASURE;
+        _tasksOfThreads[level].assign(_numThreads, std::vector<int>());
+        std::fill(_taskTimes[level].begin(), _taskTimes[level].end(), 0.0);
+        std::fill(_taskQuadTimes[level].begin(), _taskQuadTimes[level].end(), 0.0);
+      }
+    }
+
+    /// Sets the cost of a barrier and of a dynamically distributed task in seconds
+    void setOverheads(double barrierCost, double dynamicTaskCost)
+    {
+      _barrierCost = barrierCost;
+      _dynamicTaskCost = dynamicTaskCost;
+    }
+
+    int getNumberOfLevels() const
+    {
+      return (int)_tasksOfLevels.size();
+    }
+
+    /// Number of thread slots the STATIC levels are distributed to
+    int getNumberOfThreads() const
+    {
+      return _numThreads;
+    }
+
+    bool isMeasuring() const
+    {
+      return _calls < _measureCalls;
+    }
+
+    bool isSerial() const
+    {
+      return _serial;
+    }
+
+    LevelMode getLevelMode(int level) const
+    {
+      return _levelModes[level];
+    }
+
+    const std::vector<int>& getTasksOfLevel(int level) const
+    {
+      return _tasksOfLevels[level];
+    }
+
+    const std::vector<int>& getTasksOfThread(int level, int threadNum) const
+    {
+      return _tasksOfThreads[level][threadNum];
+    }
+
+    /// Adds a measured execution time (seconds), each task is executed by exactly one thread
+    void addTaskTime(int level, int task, double time)
+    {
+      _taskTimes[level][task] += time;
+      _taskQuadTimes[level][task] += time * time;
+    }
+
+    /// Has to be called by the master thread after every evaluation of the whole schedule
+    void finishCall()
+    {
+      if(isMeasuring() && (++_calls == _measureCalls))
+        rebalance();
+    }
+
+  private:
+    struct TaskTimeCompare
+    {
+      const std::vector<double>& _times;
+      TaskTimeCompare(const std::vector<double>& times) : _times(times) {}
+      bool operator()(int a, int b) const
+      {
+        return _times[a] > _times[b];
+      }
+    };
+
+    void rebalance()
+    {
+      double serialTime = 0.0;
+      double parallelTime = 0.0;
+
+      for(size_t level = 0; level < _tasksOfLevels.size(); level++)
+      {
+        std::vector<int>& tasks = _tasksOfLevels[level];
+        std::vector<double>& times = _taskTimes[level];
+        int numTasks = (int)tasks.size();
+        double levelTime = 0.0;
+        double maxVariation = 0.0;
+
+        for(int i = 0; i < numTasks; i++)
+        {
+          double mean = times[i] / _calls;
+          double variance = std::max(_taskQuadTimes[level][i] / _calls - mean * mean, 0.0);
+          times[i] = mean;
+          levelTime += mean;
+          if(mean > 0.0)
+            maxVariation = std::max(maxVariation, std::sqrt(variance) / mean);
+        }
+
+        //longest processing time first, the task lists stay sorted by cost
+        std::sort(tasks.begin(), tasks.end(), TaskTimeCompare(times));
+        std::vector<double> threadLoads(_numThreads, 0.0);
+        for(int t = 0; t < _numThreads; t++)
+          _tasksOfThreads[level][t].clear();
+        for(int i = 0; i < numTasks; i++)
+        {
+          int thread = (int)(std::min_element(threadLoads.begin(), threadLoads.end()) - threadLoads.begin());
+          _tasksOfThreads[level][thread].push_back(tasks[i]);
+          threadLoads[thread] += times[tasks[i]];
+        }
+        double makespan = *std::max_element(threadLoads.begin(), threadLoads.end());
+
+        if(numTasks < 2 || levelTime - makespan <= _barrierCost)
+        {
+          _levelModes[level] = SERIAL;
+          parallelTime += levelTime + _barrierCost;
+        }
+        else if(levelTime / numTasks > 10.0 * _dynamicTaskCost && (numTasks >= 2 * _numThreads || maxVariation > _maxStaticVariation))
+        {
+          _levelModes[level] = DYNAMIC;
+          parallelTime += makespan + _barrierCost + numTasks * _dynamicTaskCost / _numThreads;
+        }
+        else
+        {
+          _levelModes[level] = STATIC;
+          parallelTime += makespan + _barrierCost;
+        }
+        serialTime += levelTime;
+      }
+      _serial = (_numThreads < 2) || (serialTime <= parallelTime);
+    }
+
+    std::vector<std::vector<int> > _tasksOfLevels;
+    std::vector<std::vector<std::vector<int> > > _tasksOfThreads;
+    std::vector<LevelMode> _levelModes;
+    std::vector<std::vector<double> > _taskTimes;
+    std::vector<std::vector<double> > _taskQuadTimes;
+    int _numThreads;
+    int _measureCalls;
+    int _calls;
+    bool _serial;
+    double _barrierCost;
+    double _dynamicTaskCost;
+    double _maxStaticVariation;
+};
+
+#endif /* ADAPTIVE_LEVEL_SCHEDULE_HPP_ */
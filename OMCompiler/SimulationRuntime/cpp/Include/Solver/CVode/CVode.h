@@ -16,6 +16,10 @@
 #endif //USE_SUNDIALS_LAPACK
 #include <nvector/nvector_serial.h>
 #include <sundials/sundials_direct.h>
+#if defined(klu)
+  #include <cvode/cvode_sparse.h>
+  #include <cvode/cvode_klu.h>
+#endif
 
 #ifdef RUNTIME_PROFILING
   #include <Core/Utils/extension/measure_time.hpp>
@@ -106,8 +110,15 @@ private:
 
   // Functions for Coloured Jacobian
   static int CV_JCallback(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat Jac,void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+#if defined(klu)
+  static int CV_JSparseCallback(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+#endif
   int calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthcol, double* y, N_Vector fy, DlsMat Jac);
+  /// Colored finite differences over the sparsity pattern of A, result in dense (column major) or CSC layout
+  int calcColoredJacobian(double t, long int N, N_Vector errorWeight, double* y, N_Vector fy, double* jac, bool sparse);
   void initializeColoredJac();
+  /// Copies the current variables and conditions of _system into the clones of the parallel Jacobian evaluation
+  void syncColoredJacSystems();
 
 
 
@@ -170,8 +181,24 @@ double
   int  _maxColors;
   matrix_t _jacobianA;
   int _jacobianANonzeros;
-  int const* _jacobianAIndex;
-  int const* _jacobianALeadindex;
+  int* _jacobianAIndex;
+  int* _jacobianALeadindex;
+  bool _useSparseJacobian;         ///< KLU with the sparsity pattern of A instead of the dense linear solver
+
+  // Parallel evaluation of the colored columns (one system instance per thread, index 0 is _system)
+  int _numThreads;
+  std::vector<IMixedSystem*> _jacSystems;
+  std::vector<IContinuous*> _jacContinuousSystems;
+  std::vector<ITime*> _jacTimeSystems;
+  std::vector<IEvent*> _jacEventSystems;
+  double
+    *_jacY,                        ///< Temp      - Perturbed states, one row per thread
+    *_jacF,                        ///< Temp      - Perturbed right hand sides, one row per thread
+    *_jacRealVars;                 ///< Temp      - Real variables of _system copied into the clones
+  int* _jacIntVars;                ///< Temp      - Integer variables of _system copied into the clones
+  bool
+    *_jacBoolVars,                 ///< Temp      - Boolean variables of _system copied into the clones
+    *_jacConditions;               ///< Temp      - Conditions of _system copied into the clones
 
 
 
@@ -8,6 +8,10 @@
 #include <nvector/nvector_serial.h>
 #include <sundials/sundials_direct.h>
 #include <idas/idas_dense.h>
+#if defined(klu)
+  #include <idas/idas_sparse.h>
+  #include <idas/idas_klu.h>
+#endif
 
 
 #ifdef RUNTIME_PROFILING
@@ -98,8 +102,15 @@ private:
   static int zeroFunctionCB(double t, N_Vector y, N_Vector yp, double *zeroval, void *user_data);
 
   // Functions for Coloured Jacobian
-  static int jacobianFunctionCB(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat Jac,void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
-  int calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthcol, double* y, N_Vector fy, DlsMat Jac);
+  static int jacobianFunctionCB(long int N, realtype t, realtype cj, N_Vector y, N_Vector yp, N_Vector res, DlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+#if defined(klu)
+  static int jacobianSparseFunctionCB(realtype t, realtype cj, N_Vector y, N_Vector yp, N_Vector res, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+#endif
+  /// Colored finite differences of dF/dy + cj*dF/dyp over the pattern of A, result in dense (column major) or CSC layout
+  int calcJacobian(double t, double cj, double* y, double* yp, N_Vector res, N_Vector errorWeight, double* jac, bool sparse);
+  void initializeColoredJac();
+  /// Copies the current variables and conditions of _system into the clones of the parallel Jacobian evaluation
+  void syncColoredJacSystems();
 
 
 
@@ -173,8 +184,26 @@ double
   int  _maxColors;
   matrix_t _jacobianA;
   int _jacobianANonzeros;
-  int const* _jacobianAIndex;
-  int const* _jacobianALeadindex;
+  int* _jacobianAIndex;            ///< Pattern of A extended by the diagonal (needed for the cj term)
+  int* _jacobianALeadindex;
+  bool* _jacobianAStructural;      ///< Entry belongs to the pattern of A (false for added diagonal entries)
+  int* _jacobianADiagonal;         ///< Position of the diagonal entry of each column
+  bool _useSparseJacobian;         ///< KLU with the sparsity pattern of A instead of the dense linear solver
+
+  // Parallel evaluation of the colored columns (one system instance per thread, index 0 is _system)
+  int _numThreads;
+  std::vector<IMixedSystem*> _jacSystems;
+  std::vector<IContinuous*> _jacContinuousSystems;
+  std::vector<ITime*> _jacTimeSystems;
+  std::vector<IEvent*> _jacEventSystems;
+  double
+    *_jacY,                        ///< Temp      - Perturbed states, one row per thread
+    *_jacF,                        ///< Temp      - Perturbed right hand sides, one row per thread
+    *_jacRealVars;                 ///< Temp      - Real variables of _system copied into the clones
+  int* _jacIntVars;                ///< Temp      - Integer variables of _system copied into the clones
+  bool
+    *_jacBoolVars,                 ///< Temp      - Boolean variables of _system copied into the clones
+    *_jacConditions;               ///< Temp      - Conditions of _system copied into the clones
 
 
   bool _ida_initialized;
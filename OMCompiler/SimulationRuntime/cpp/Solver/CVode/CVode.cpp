@@ -8,6 +8,10 @@
 #include <Core/Math/Functions.h>
 #include <Core/Utils/numeric/bindings/ublas/matrix_sparse.hpp>
 
+#if defined(USE_OPENMP)
+#include "omp.h"
+#endif
+
 
 Cvode::Cvode(IMixedSystem* system, ISolverSettings* settings)
 	: SolverDefaultImplementation(system, settings),
@@ -49,7 +53,19 @@ Cvode::Cvode(IMixedSystem* system, ISolverSettings* settings)
 	_CV_y(),
 	_CV_yWrite(),
 	_maxColors(0),
-	_jacobianANonzeros(0)
+	_jacobianANonzeros(0),
+	_useSparseJacobian(false),
+	_numThreads(1),
+	_jacSystems(),
+	_jacContinuousSystems(),
+	_jacTimeSystems(),
+	_jacEventSystems(),
+	_jacY(NULL),
+	_jacF(NULL),
+	_jacRealVars(NULL),
+	_jacIntVars(NULL),
+	_jacBoolVars(NULL),
+	_jacConditions(NULL)
 {
 	_data = ((void*) this);
 
@@ -116,6 +132,24 @@ Cvode::~Cvode()
 		delete[] _deltaInv;
 	if (_ysave)
 		delete[] _ysave;
+	if (_jacobianALeadindex)
+		delete[] _jacobianALeadindex;
+	if (_jacobianAIndex)
+		delete[] _jacobianAIndex;
+	if (_jacY)
+		delete[] _jacY;
+	if (_jacF)
+		delete[] _jacF;
+	if (_jacRealVars)
+		delete[] _jacRealVars;
+	if (_jacIntVars)
+		delete[] _jacIntVars;
+	if (_jacBoolVars)
+		delete[] _jacBoolVars;
+	if (_jacConditions)
+		delete[] _jacConditions;
+	for (size_t i = 1; i < _jacSystems.size(); i++)
+		delete _jacSystems[i];
 
 #ifdef RUNTIME_PROFILING
 	if (measuredFunctionStartValues)
@@ -283,29 +317,49 @@ void Cvode::initialize()
 		if (_idid < 0)
 			throw ModelicaSimulationError(SOLVER,/*_idid,_tCurrent,*/"Cvode::initialize()");
 
-		// Initialize linear solver
-#ifdef USE_SUNDIALS_LAPACK
-		_idid = CVLapackDense(_cvodeMem, _dimSys);
-#else
-		_idid = CVDense(_cvodeMem, _dimSys);
-#endif
-		if (_idid < 0)
-			throw ModelicaSimulationError(SOLVER, "Cvode::initialize()");
-
 		// Use own jacobian matrix
 		// Check if Colored Jacobians are worth to use
-#if SUNDIALS_MAJOR_VERSION >= 2 || (SUNDIALS_MAJOR_VERSION == 2 && SUNDIALS_MINOR_VERSION >= 4)
 		_maxColors = _system->getAMaxColors();
-		if (_maxColors < _dimSys && _continuous_system->getDimContinuousStates() > 0)
+		_jacobianANonzeros = 0;
+		_useSparseJacobian = false;
+		if (_maxColors > 0 && _maxColors < _dimSys && _continuous_system->getDimContinuousStates() > 0)
+			initializeColoredJac();
+
+#if defined(klu)
+		// A sparse factorization only pays off for larger systems with a low fill-in
+		_useSparseJacobian = _jacobianANonzeros > 0 && _dimSys >= 20 && _jacobianANonzeros < 0.2 * _dimSys * _dimSys;
+		if (_useSparseJacobian)
 		{
-			// _idid = CVDlsSetDenseJacFn(_cvodeMem, &CV_JCallback);
-			// initializeColoredJac();
+			_idid = CVKLU(_cvodeMem, _dimSys, _jacobianANonzeros);
+			if (_idid < 0)
+				throw ModelicaSimulationError(SOLVER, "Cvode::initialize()");
+			_idid = CVSlsSetSparseJacFn(_cvodeMem, &CV_JSparseCallback);
+			if (_idid < 0)
+				throw ModelicaSimulationError(SOLVER, "Cvode::initialize()");
 		}
 #endif
+		if (!_useSparseJacobian)
+		{
+			// Initialize linear solver
+#ifdef USE_SUNDIALS_LAPACK
+			_idid = CVLapackDense(_cvodeMem, _dimSys);
+#else
+			_idid = CVDense(_cvodeMem, _dimSys);
+#endif
+			if (_idid < 0)
+				throw ModelicaSimulationError(SOLVER, "Cvode::initialize()");
+			if (_jacobianANonzeros > 0)
+				_idid = CVDlsSetDenseJacFn(_cvodeMem, &CV_JCallback);
+		}
 
 		if (_idid < 0)
 			throw ModelicaSimulationError(SOLVER, "CVode::initialize()");
 
+		if (_useSparseJacobian)
+			LOGGER_WRITE("Cvode: KLU with colored jacobian, nonzeros = " + to_string(_jacobianANonzeros) + ", colors = " + to_string(_maxColors) + ", threads = " + to_string(_numThreads), LC_SOLVER, LL_INFO);
+		else if (_jacobianANonzeros > 0)
+			LOGGER_WRITE("Cvode: dense with colored jacobian, colors = " + to_string(_maxColors) + ", threads = " + to_string(_numThreads), LC_SOLVER, LL_INFO);
+
 		if (_dimZeroFunc)
 		{
 			_idid = CVodeRootInit(_cvodeMem, _dimZeroFunc, &CV_ZerofCallback);
@@ -818,17 +872,35 @@ int Cvode::CV_JCallback(long int N, double t, N_Vector y, N_Vector fy, DlsMat Ja
 
 }
 
+#if defined(klu)
+int Cvode::CV_JSparseCallback(double t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+	Cvode* cvode = (Cvode*)user_data;
+
+	// KLU works directly on the compressed sparse column pattern of A
+	SlsSetToZero(Jac);
+	memcpy(Jac->colptrs, cvode->_jacobianALeadindex, (cvode->_dimSys + 1) * sizeof(int));
+	memcpy(Jac->rowvals, cvode->_jacobianAIndex, cvode->_jacobianANonzeros * sizeof(int));
+
+	return cvode->calcColoredJacobian(t, cvode->_dimSys, tmp1, NV_DATA_S(y), fy, Jac->data, true);
+}
+#endif
+
 int Cvode::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthCol, double* y, N_Vector fy, DlsMat Jac)
+{
+	// Entries outside of the sparsity pattern stay zero
+	SetToZero(Jac);
+	return calcColoredJacobian(t, N, errorWeight, y, fy, Jac->data, false);
+}
+
+int Cvode::calcColoredJacobian(double t, long int N, N_Vector errorWeight, double* y, N_Vector fy, double* jac, bool sparse)
 {
 	try
 	{
-		int l, g;
-		double fnorm, minInc, *f_data, *fHelp_data, *errorWeight_data, h, srur, delta_inv;
+		double fnorm, minInc, *f_data, *errorWeight_data, h, srur;
 
 		f_data = NV_DATA_S(fy);
 		errorWeight_data = NV_DATA_S(errorWeight);
-		fHelp_data = NV_DATA_S(fHelp);
-
 
 		//Get relevant info
 		_idid = CVodeGetErrWeights(_cvodeMem, errorWeight);
@@ -853,85 +925,63 @@ int Cvode::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeig
 		for (int j = 0; j < N; j++)
 		{
 			_delta[j] = max(srur*abs(y[j]), minInc / errorWeight_data[j]);
-		}
-
-		for (int j = 0; j < N; j++)
-		{
 			_deltaInv[j] = 1 / _delta[j];
 		}
 
-		if (_jacobianANonzeros != 0)
+		// Columns of the same color do not share a row, thus one evaluation gives all of them.
+		// Different colors are independent and are distributed over the system instances.
+		syncColoredJacSystems();
+		bool failed = false;
+#if defined(USE_OPENMP)
+#pragma omp parallel for num_threads(_numThreads) reduction(||:failed)
+#endif
+		for (int color = 1; color <= _maxColors; color++)
 		{
-			for (int color = 1; color <= _maxColors; color++)
+#if defined(USE_OPENMP)
+			int thread = omp_get_thread_num();
+#else
+			int thread = 0;
+#endif
+			double* yColor = _jacY + thread * _dimSys;
+			double* fColor = _jacF + thread * _dimSys;
+
+			memcpy(yColor, y, _dimSys * sizeof(double));
+			for (int k = 0; k < _dimSys; k++)
 			{
-				for (int k = 0; k < _dimSys; k++)
-				{
-					if ((_colorOfColumn[k]) == color)
-					{
-						_ysave[k] = y[k];
-						y[k] += _delta[k];
-					}
-				}
+				if (_colorOfColumn[k] == color)
+					yColor[k] += _delta[k];
+			}
 
-				calcFunction(t, y, fHelp_data);
+			try
+			{
+				_jacTimeSystems[thread]->setTime(t);
+				_jacContinuousSystems[thread]->setContinuousStates(yColor);
+				_jacContinuousSystems[thread]->evaluateODE(IContinuous::CONTINUOUS);
+				_jacContinuousSystems[thread]->getRHS(fColor);
+			}
+			catch (std::exception & ex)
+			{
+				failed = true;
+				continue;
+			}
 
-				for (int k = 0; k < _dimSys; k++)
+			for (int k = 0; k < _dimSys; k++)
+			{
+				if (_colorOfColumn[k] == color)
 				{
-					if ((_colorOfColumn[k]) == color)
+					for (int j = _jacobianALeadindex[k]; j < _jacobianALeadindex[k + 1]; j++)
 					{
-						y[k] = _ysave[k];
-
-						int startOfColumn = k * _dimSys;
-						for (int j = _jacobianALeadindex[k]; j < _jacobianALeadindex[k + 1]; j++)
-						{
-							l = _jacobianAIndex[j];
-							g = l + startOfColumn;
-							Jac->data[g] = (fHelp_data[l] - f_data[l]) * _deltaInv[k];
-						}
+						int l = _jacobianAIndex[j];
+						jac[sparse ? j : l + k * _dimSys] = (fColor[l] - f_data[l]) * _deltaInv[k];
 					}
 				}
 			}
 		}
+		_numberOfOdeEvaluations += _maxColors;
 
-
-
-
-
-	}
-
-
-
-
-
-
-	/*
-	//Calculation of J without colouring
-	for (j = 0; j < N; j++)
-	{
-
-
-	//N_VSetArrayPointer(DENSE_COL(Jac,j), jthCol);
-
-	_ysave[j] = y[j];
-
-	y[j] += _delta[j];
-
-	calcFunction(t, y, fHelp_data);
-
-	y[j] = _ysave[j];
-
-	delta_inv = 1.0/_delta[j];
-	N_VLinearSum(delta_inv, fHelp, -delta_inv, fy, jthCol);
-
-	for(int i=0; i<_dimSys; ++i)
-	{
-	Jac->data[i+j*_dimSys] = NV_Ith_S(jthCol,i);
-	}
-
-	//DENSE_COL(Jac,j) = N_VGetArrayPointer(jthCol);
+		if (failed)
+			throw ModelicaSimulationError(SOLVER, "Cvode::calcJacobian()");
 	}
-	*/
-
 	//workaround until exception can be catch from c- libraries
 	catch (std::exception & ex)
 	{
@@ -952,11 +1002,78 @@ void Cvode::initializeColoredJac()
 	_colorOfColumn = new int[_dimSys];
 	_system->getAColorOfColumn(_colorOfColumn, _dimSys);
 
-	// _system->getJacobian(_jacobianA);
-	//_jacobianANonzeros  = boost::numeric::bindings::traits::spmatrix_num_nonzeros (_jacobianA);
-	// _jacobianAIndex     = bindings::begin_index_minor(_jacobianA);
-	//_jacobianALeadindex = bindings::begin_index_major(_jacobianA);
+	// Sparsity pattern of A in compressed sparse column format
+	_jacobianANonzeros = _system->getANonZeros();
+	if (_jacobianALeadindex)
+		delete[] _jacobianALeadindex;
+	if (_jacobianAIndex)
+		delete[] _jacobianAIndex;
+	_jacobianALeadindex = new int[_dimSys + 1];
+	_jacobianAIndex = new int[_jacobianANonzeros + 1];
+	_system->getASparsePattern(_jacobianALeadindex, _jacobianAIndex);
+
+	// One system instance per thread, the colors are evaluated concurrently
+	_numThreads = 1;
+#if defined(USE_OPENMP)
+	_numThreads = max(1, min(dynamic_cast<ISolverSettings*>(_cvodesettings)->getGlobalSettings()->getSolverThreads(), _maxColors));
+#endif
+	for (size_t i = 1; i < _jacSystems.size(); i++)
+		delete _jacSystems[i];
+	_jacSystems.assign(1, _system);
+	_jacContinuousSystems.assign(1, _continuous_system);
+	_jacTimeSystems.assign(1, _time_system);
+	_jacEventSystems.assign(1, _event_system);
+	for (int i = 1; i < _numThreads; i++)
+	{
+		IMixedSystem* clonedSystem = _system->clone();
+		dynamic_cast<ISystemInitialization*>(clonedSystem)->initialize();
+		_jacSystems.push_back(clonedSystem);
+		_jacContinuousSystems.push_back(dynamic_cast<IContinuous*>(clonedSystem));
+		_jacTimeSystems.push_back(dynamic_cast<ITime*>(clonedSystem));
+		_jacEventSystems.push_back(dynamic_cast<IEvent*>(clonedSystem));
+	}
 
+	if (_jacY)
+		delete[] _jacY;
+	if (_jacF)
+		delete[] _jacF;
+	_jacY = new double[_numThreads * _dimSys];
+	_jacF = new double[_numThreads * _dimSys];
+
+	// Buffers to copy the current values of _system into the clones
+	if (_jacRealVars)
+		delete[] _jacRealVars;
+	if (_jacIntVars)
+		delete[] _jacIntVars;
+	if (_jacBoolVars)
+		delete[] _jacBoolVars;
+	if (_jacConditions)
+		delete[] _jacConditions;
+	_jacRealVars = new double[_continuous_system->getDimReal()];
+	_jacIntVars = new int[_continuous_system->getDimInteger()];
+	_jacBoolVars = new bool[_continuous_system->getDimBoolean()];
+	_jacConditions = new bool[_event_system->getDimZeroFunc()];
+}
+
+void Cvode::syncColoredJacSystems()
+{
+	if (_numThreads < 2)
+		return;
+
+	// The clones only hold the values of the time they were created at, thus the parameters,
+	// discrete variables and conditions of _system are copied before each evaluation.
+	_continuous_system->getReal(_jacRealVars);
+	_continuous_system->getInteger(_jacIntVars);
+	_continuous_system->getBoolean(_jacBoolVars);
+	_event_system->getConditions(_jacConditions);
+	for (int i = 1; i < _numThreads; i++)
+	{
+		_jacContinuousSystems[i]->setReal(_jacRealVars);
+		_jacContinuousSystems[i]->setInteger(_jacIntVars);
+		_jacContinuousSystems[i]->setBoolean(_jacBoolVars);
+		_jacEventSystems[i]->setConditions(_jacConditions);
+		_jacEventSystems[i]->saveAll();
+	}
 }
 
 int Cvode::reportErrorMessage(ostream& messageStream)
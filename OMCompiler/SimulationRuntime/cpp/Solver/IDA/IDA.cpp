@@ -3,6 +3,10 @@
 #include <Solver/IDA/IDA.h>
 #include <Core/Math/Functions.h>
 
+#if defined(USE_OPENMP)
+#include "omp.h"
+#endif
+
 //#include <Core/Utils/numeric/bindings/traits/ublas_vector.hpp>
 //#include <Core/Utils/numeric/bindings/traits/ublas_sparse.hpp>
 
@@ -56,7 +60,21 @@ Ida::Ida(IMixedSystem* system, ISolverSettings* settings)
       _zeroFound(false),
       _maxColors(0),
       _tLastWrite(-1.0),
-      _jacobianANonzeros(0)
+      _jacobianANonzeros(0),
+      _jacobianAStructural(NULL),
+      _jacobianADiagonal(NULL),
+      _useSparseJacobian(false),
+      _numThreads(1),
+      _jacSystems(),
+      _jacContinuousSystems(),
+      _jacTimeSystems(),
+      _jacEventSystems(),
+      _jacY(NULL),
+      _jacF(NULL),
+      _jacRealVars(NULL),
+      _jacIntVars(NULL),
+      _jacBoolVars(NULL),
+      _jacConditions(NULL)
 {
   _data = ((void*) this);
   #ifdef RUNTIME_PROFILING
@@ -137,6 +155,28 @@ Ida::~Ida()
     delete [] _deltaInv;
   if(_ysave)
     delete [] _ysave;
+  if(_jacobianALeadindex)
+    delete [] _jacobianALeadindex;
+  if(_jacobianAIndex)
+    delete [] _jacobianAIndex;
+  if(_jacobianAStructural)
+    delete [] _jacobianAStructural;
+  if(_jacobianADiagonal)
+    delete [] _jacobianADiagonal;
+  if(_jacY)
+    delete [] _jacY;
+  if(_jacF)
+    delete [] _jacF;
+  if(_jacRealVars)
+    delete [] _jacRealVars;
+  if(_jacIntVars)
+    delete [] _jacIntVars;
+  if(_jacBoolVars)
+    delete [] _jacBoolVars;
+  if(_jacConditions)
+    delete [] _jacConditions;
+  for(size_t i = 1; i < _jacSystems.size(); i++)
+    delete _jacSystems[i];
 
   #ifdef RUNTIME_PROFILING
   if(measuredFunctionStartValues)
@@ -328,10 +368,45 @@ void Ida::initialize()
     if (_idid < 0)
       throw std::invalid_argument(/*_idid,_tCurrent,*/"IDA::initialize()");
 
-    // Initialize linear solver
-    _idid = IDADense(_idaMem, _dimSys);
-    if (_idid < 0)
-      throw std::invalid_argument("IDA::initialize()");
+    // Use own jacobian matrix for ODE systems if the sparsity pattern of A is available
+    _maxColors = _system->getAMaxColors();
+    _jacobianANonzeros = 0;
+    _useSparseJacobian = false;
+    if (_dimAE == 0 && _maxColors > 0 && _maxColors < _dimSys)
+      initializeColoredJac();
+
+#if defined(klu)
+    // A sparse factorization only pays off for larger systems with a low fill-in
+    _useSparseJacobian = _jacobianANonzeros > 0 && _dimSys >= 20 && _jacobianANonzeros < 0.2 * _dimSys * _dimSys;
+    if (_useSparseJacobian)
+    {
+      _idid = IDAKLU(_idaMem, _dimSys, _jacobianALeadindex[_dimSys]);
+      if (_idid < 0)
+        throw std::invalid_argument("IDA::initialize()");
+      _idid = IDASlsSetSparseJacFn(_idaMem, &jacobianSparseFunctionCB);
+      if (_idid < 0)
+        throw std::invalid_argument("IDA::initialize()");
+    }
+#endif
+    if (!_useSparseJacobian)
+    {
+      // Initialize linear solver
+      _idid = IDADense(_idaMem, _dimSys);
+      if (_idid < 0)
+        throw std::invalid_argument("IDA::initialize()");
+      if (_jacobianANonzeros > 0)
+      {
+        _idid = IDADlsSetDenseJacFn(_idaMem, &jacobianFunctionCB);
+        if (_idid < 0)
+          throw std::invalid_argument("IDA::initialize()");
+      }
+    }
+
+    if (_useSparseJacobian)
+      LOGGER_WRITE("IDA: KLU with colored jacobian, nonzeros = " + to_string(_jacobianANonzeros) + ", colors = " + to_string(_maxColors) + ", threads = " + to_string(_numThreads), LC_SOLVER, LL_INFO);
+    else if (_jacobianANonzeros > 0)
+      LOGGER_WRITE("IDA: dense with colored jacobian, colors = " + to_string(_maxColors) + ", threads = " + to_string(_numThreads), LC_SOLVER, LL_INFO);
+
     if(_dimAE>0)
 	{
 	    _idid = IDASetSuppressAlg(_idaMem, TRUE);
@@ -344,11 +419,6 @@ void Ida::initialize()
          throw std::invalid_argument("IDA::initialize()");
 	}
 
-  // Use own jacobian matrix
-  //_idid = CVDlsSetDenseJacFn(_idaMem, &jacobianFunctionCB);
-  //if (_idid < 0)
-  //    throw std::invalid_argument("IDA::initialize()");
-
     if (_dimZeroFunc)
     {
       _idid = IDARootInit(_idaMem, _dimZeroFunc, &zeroFunctionCB);
@@ -910,24 +980,35 @@ int Ida::zeroFunctionCB(double t, N_Vector y, N_Vector yp, double *zeroval, void
   return (0);
 }
 
-int Ida::jacobianFunctionCB(long int N, double t, N_Vector y, N_Vector fy, DlsMat Jac,void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+int Ida::jacobianFunctionCB(long int N, double t, double cj, N_Vector y, N_Vector yp, N_Vector res, DlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
 {
-  return ((Ida*) user_data)->calcJacobian(t,N, tmp1, tmp2, tmp3,  NV_DATA_S(y), fy, Jac);
-
+  // Entries outside of the sparsity pattern stay zero
+  SetToZero(Jac);
+  return ((Ida*) user_data)->calcJacobian(t, cj, NV_DATA_S(y), NV_DATA_S(yp), res, tmp1, Jac->data, false);
 }
 
+#if defined(klu)
+int Ida::jacobianSparseFunctionCB(double t, double cj, N_Vector y, N_Vector yp, N_Vector res, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  Ida* ida = (Ida*) user_data;
+
+  // KLU works directly on the compressed sparse column pattern
+  SlsSetToZero(Jac);
+  memcpy(Jac->colptrs, ida->_jacobianALeadindex, (ida->_dimSys + 1) * sizeof(int));
+  memcpy(Jac->rowvals, ida->_jacobianAIndex, ida->_jacobianALeadindex[ida->_dimSys] * sizeof(int));
 
-int Ida::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthCol, double* y, N_Vector fy, DlsMat Jac)
+  return ida->calcJacobian(t, cj, NV_DATA_S(y), NV_DATA_S(yp), res, tmp1, Jac->data, true);
+}
+#endif
+
+int Ida::calcJacobian(double t, double cj, double* y, double* yp, N_Vector res, N_Vector errorWeight, double* jac, bool sparse)
 {
   try
   {
-  int l,g;
-  double fnorm, minInc, *f_data, *fHelp_data, *errorWeight_data, h, srur, delta_inv;
+  double *res_data, *errorWeight_data, h, srur;
 
-  f_data = NV_DATA_S(fy);
+  res_data = NV_DATA_S(res);
   errorWeight_data = NV_DATA_S(errorWeight);
-  fHelp_data = NV_DATA_S(fHelp);
-
 
   //Get relevant info
   _idid = IDAGetErrWeights(_idaMem, errorWeight);
@@ -945,81 +1026,72 @@ int Ida::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight
 
   srur = sqrt(UROUND);
 
-  fnorm = N_VWrmsNorm(fy, errorWeight);
-  minInc = (fnorm != 0.0) ?
-           (1000.0 * abs(h) * UROUND * N * fnorm) : 1.0;
-
-  for(int j=0;j<N;j++)
-  {
-    _delta[j] = max(srur*abs(y[j]), minInc/errorWeight_data[j]);
-  }
-    for(int j=0;j<N;j++)
+  // Increments like the internal difference quotient of IDA
+  for(int j=0;j<_dimSys;j++)
   {
+    _delta[j] = max(srur*max(abs(y[j]), abs(h*yp[j])), 1.0/errorWeight_data[j]);
+    if (h*yp[j] < 0.0)
+      _delta[j] = -_delta[j];
     _deltaInv[j] = 1/_delta[j];
   }
 
-  // Calculation of the jacobian
-
- if (_jacobianANonzeros != 0)
- {
+  // Calculation of the jacobian, F(t,y,yp) = f(t,y) - yp gives dF/dy + cj*dF/dyp = A - cj*I.
+  // Columns of the same color do not share a row, thus one evaluation gives all of them.
+  syncColoredJacSystems();
+  bool failed = false;
+#if defined(USE_OPENMP)
+#pragma omp parallel for num_threads(_numThreads) reduction(||:failed)
+#endif
   for(int color=1; color <= _maxColors; color++)
   {
-      for(int k=0; k < _dimSys; k++)
+#if defined(USE_OPENMP)
+    int thread = omp_get_thread_num();
+#else
+    int thread = 0;
+#endif
+    double* yColor = _jacY + thread * _dimSys;
+    double* fColor = _jacF + thread * _dimSys;
+
+    memcpy(yColor, y, _dimSys * sizeof(double));
+    for(int k=0; k < _dimSys; k++)
     {
-      if((_colorOfColumn[k] ) == color)
-      {
-        _ysave[k] = y[k];
-        y[k]+= _delta[k];
-      }
+      if(_colorOfColumn[k] == color)
+        yColor[k] += _delta[k];
     }
 
-    calcFunction(t, y, fHelp_data,fHelp_data);
-
-  for (int k = 0; k < _dimSys; k++)
-   {
-       if((_colorOfColumn[k]) == color)
-     {
-        y[k] = _ysave[k];
+    try
+    {
+      _jacTimeSystems[thread]->setTime(t);
+      _jacContinuousSystems[thread]->setContinuousStates(yColor);
+      _jacContinuousSystems[thread]->evaluateODE(IContinuous::CONTINUOUS);
+      _jacContinuousSystems[thread]->getRHS(fColor);
+    }
+    catch (std::exception& ex)
+    {
+      failed = true;
+      continue;
+    }
 
-    int startOfColumn = k * _dimSys;
-    for (int j = _jacobianALeadindex[k]; j < _jacobianALeadindex[k+1];j++)
+    for (int k = 0; k < _dimSys; k++)
+    {
+      if(_colorOfColumn[k] == color)
       {
-        l = _jacobianAIndex[j];
-        g = l + startOfColumn;
-        Jac->data[g] = (fHelp_data[l] - f_data[l]) * _deltaInv[k];
+        for (int j = _jacobianALeadindex[k]; j < _jacobianALeadindex[k+1]; j++)
+        {
+          if (!_jacobianAStructural[j])
+            continue;
+          int l = _jacobianAIndex[j];
+          jac[sparse ? j : l + k * _dimSys] = (fColor[l] - yp[l] - res_data[l]) * _deltaInv[k];
+        }
       }
     }
   }
-  }
- }
-
-  /*
-  //Calculation of J without colouring
-   for (j = 0; j < N; j++)
-   {
-
-
-    //N_VSetArrayPointer(DENSE_COL(Jac,j), jthCol);
-
-     _ysave[j] = y[j];
-
-    y[j] += _delta[j];
-
-    calcFunction(t, y, fHelp_data);
-
-    y[j] = _ysave[j];
 
-    delta_inv = 1.0/_delta[j];
-    N_VLinearSum(delta_inv, fHelp, -delta_inv, fy, jthCol);
+  if (failed)
+    throw std::invalid_argument("IDA::calcJacobian()");
 
-    for(int i=0; i<_dimSys; ++i)
-        {
-            Jac->data[i+j*_dimSys] = NV_Ith_S(jthCol,i);
-        }
-
-    //DENSE_COL(Jac,j) = N_VGetArrayPointer(jthCol);
-  }
-  */
+  for (int k = 0; k < _dimSys; k++)
+    jac[sparse ? _jacobianADiagonal[k] : k + k * _dimSys] -= cj;
 
  }      //workaround until exception can be catch from c- libraries
   catch (std::exception& ex)
@@ -1033,7 +1105,127 @@ int Ida::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight
   return 0;
 }
 
+void Ida::initializeColoredJac()
+{
+  if (_colorOfColumn)
+    delete [] _colorOfColumn;
+  _colorOfColumn = new int[_dimSys];
+  _system->getAColorOfColumn(_colorOfColumn, _dimSys);
+
+  // Sparsity pattern of A in compressed sparse column format
+  _jacobianANonzeros = _system->getANonZeros();
+  int* leadindex = new int[_dimSys + 1];
+  int* index = new int[_jacobianANonzeros + 1];
+  _system->getASparsePattern(leadindex, index);
+
+  // Extend the pattern by the diagonal, IDA needs the entries for the cj term
+  if (_jacobianALeadindex)
+    delete [] _jacobianALeadindex;
+  if (_jacobianAIndex)
+    delete [] _jacobianAIndex;
+  if (_jacobianAStructural)
+    delete [] _jacobianAStructural;
+  if (_jacobianADiagonal)
+    delete [] _jacobianADiagonal;
+  _jacobianALeadindex = new int[_dimSys + 1];
+  _jacobianAIndex = new int[_jacobianANonzeros + _dimSys];
+  _jacobianAStructural = new bool[_jacobianANonzeros + _dimSys];
+  _jacobianADiagonal = new int[_dimSys];
+
+  int nnz = 0;
+  _jacobianALeadindex[0] = 0;
+  for (int k = 0; k < _dimSys; k++)
+  {
+    bool diagonal = false;
+    for (int j = leadindex[k]; j < leadindex[k+1]; j++)
+    {
+      if (!diagonal && index[j] >= k)
+      {
+        _jacobianADiagonal[k] = nnz;
+        if (index[j] > k)
+        {
+          _jacobianAStructural[nnz] = false;
+          _jacobianAIndex[nnz++] = k;
+        }
+        diagonal = true;
+      }
+      _jacobianAStructural[nnz] = true;
+      _jacobianAIndex[nnz++] = index[j];
+    }
+    if (!diagonal)
+    {
+      _jacobianADiagonal[k] = nnz;
+      _jacobianAStructural[nnz] = false;
+      _jacobianAIndex[nnz++] = k;
+    }
+    _jacobianALeadindex[k+1] = nnz;
+  }
+  delete [] leadindex;
+  delete [] index;
+
+  // One system instance per thread, the colors are evaluated concurrently
+  _numThreads = 1;
+#if defined(USE_OPENMP)
+  _numThreads = max(1, min(dynamic_cast<ISolverSettings*>(_idasettings)->getGlobalSettings()->getSolverThreads(), _maxColors));
+#endif
+  for (size_t i = 1; i < _jacSystems.size(); i++)
+    delete _jacSystems[i];
+  _jacSystems.assign(1, _system);
+  _jacContinuousSystems.assign(1, _continuous_system);
+  _jacTimeSystems.assign(1, _time_system);
+  _jacEventSystems.assign(1, _event_system);
+  for (int i = 1; i < _numThreads; i++)
+  {
+    IMixedSystem* clonedSystem = _system->clone();
+    dynamic_cast<ISystemInitialization*>(clonedSystem)->initialize();
+    _jacSystems.push_back(clonedSystem);
+    _jacContinuousSystems.push_back(dynamic_cast<IContinuous*>(clonedSystem));
+    _jacTimeSystems.push_back(dynamic_cast<ITime*>(clonedSystem));
+    _jacEventSystems.push_back(dynamic_cast<IEvent*>(clonedSystem));
+  }
+
+  if (_jacY)
+    delete [] _jacY;
+  if (_jacF)
+    delete [] _jacF;
+  _jacY = new double[_numThreads * _dimSys];
+  _jacF = new double[_numThreads * _dimSys];
+
+  // Buffers to copy the current values of _system into the clones
+  if (_jacRealVars)
+    delete [] _jacRealVars;
+  if (_jacIntVars)
+    delete [] _jacIntVars;
+  if (_jacBoolVars)
+    delete [] _jacBoolVars;
+  if (_jacConditions)
+    delete [] _jacConditions;
+  _jacRealVars = new double[_continuous_system->getDimReal()];
+  _jacIntVars = new int[_continuous_system->getDimInteger()];
+  _jacBoolVars = new bool[_continuous_system->getDimBoolean()];
+  _jacConditions = new bool[_event_system->getDimZeroFunc()];
+}
 
+void Ida::syncColoredJacSystems()
+{
+  if (_numThreads < 2)
+    return;
+
+  // The clones only hold the values of the time they were created at, thus the parameters,
+  // discrete variables and conditions of _system are copied before each evaluation.
+  _continuous_system->getReal(_jacRealVars);
+  _continuous_system->getInteger(_jacIntVars);
+  _continuous_system->getBoolean(_jacBoolVars);
+  _event_system->getConditions(_jacConditions);
+  for (int i = 1; i < _numThreads; i++)
+  {
+    _jacContinuousSystems[i]->setReal(_jacRealVars);
+    _jacContinuousSystems[i]->setInteger(_jacIntVars);
+    _jacContinuousSystems[i]->setBoolean(_jacBoolVars);
+    _jacEventSystems[i]->setConditions(_jacConditions);
+    _jacEventSystems[i]->saveAll();
+  }
+}
 
 int Ida::reportErrorMessage(ostream& messageStream)
 {
@@ -69,6 +69,14 @@ typedef enum {
   modelError              = 1<<6  /* ME and CS */
 } ModelState;
 
+/* equation blocks that have to be evaluated before a variable can be read */
+typedef enum {
+  updateLevelNone    = 0, /* states, parameters: known without evaluating equations */
+  updateLevelODE     = 1, /* assigned in functionODE */
+  updateLevelOutputs = 2, /* assigned by the algebraic equations the outputs depend on */
+  updateLevelAll     = 3  /* needs functionAlgebraics and output_function as well */
+} UpdateLevel;
+
 typedef struct {
   fmi2String instanceName;
   fmi2Type type;
@@ -89,9 +97,15 @@ typedef struct {
   fmi2Boolean stopTimeDefined;
   fmi2Real stopTime;
 
-  int _need_update;
+  int _need_update;     /* functionODE is out of date */
+  int _need_update_alg; /* functionAlgebraics/output_function are out of date */
+  int _need_update_out; /* the algebraic equations of the outputs are out of date */
   int _has_jacobian;
   ANALYTIC_JACOBIAN* fmiDerJac;
+  int _need_update_jac;        /* the current point changed since the last directional derivative */
+  int _jac_calls;              /* directional derivatives requested at the current point */
+  fmi2Real* fmiDerJacValues;   /* fmiDerJac at the current point, nonzeros in sparse pattern order */
+  fmi2Real* fmiDerJacSeeds;    /* coloring seeds used to evaluate fmiDerJacValues */
 } ModelInstance;
 
 /* reset alignment policy to the one set before reading this file */
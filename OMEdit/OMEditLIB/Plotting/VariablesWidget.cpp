@@ -169,6 +169,7 @@ QIcon VariablesTreeItem::getVariableTreeItemIcon(QString name) const
 void VariablesTreeItem::insertChild(int position, VariablesTreeItem *pVariablesTreeItem)
 {
   mChildren.insert(position, pVariablesTreeItem);
+  mChildrenHash.insert(pVariablesTreeItem->getVariableName(), pVariablesTreeItem);
 }
 
 VariablesTreeItem* VariablesTreeItem::child(int row)
@@ -180,11 +181,13 @@ void VariablesTreeItem::removeChildren()
 {
   qDeleteAll(mChildren);
   mChildren.clear();
+  mChildrenHash.clear();
 }
 
 void VariablesTreeItem::removeChild(VariablesTreeItem *pVariablesTreeItem)
 {
   mChildren.removeOne(pVariablesTreeItem);
+  mChildrenHash.remove(pVariablesTreeItem->getVariableName());
 }
 
 int VariablesTreeItem::columnCount() const
@@ -347,6 +350,130 @@ QVariant VariablesTreeItem::getValue(QString fromUnit, QString toUnit)
   return value;
 }
 
+ScalarVariablesStore::ScalarVariablesStore()
+{
+  clear();
+}
+
+/*!
+ * \brief ScalarVariablesStore::clear
+ * Removes all the variables. The empty string is always interned at index 0.
+ */
+void ScalarVariablesStore::clear()
+{
+  mNames.clear();
+  mNameIndex.clear();
+  mStrings.clear();
+  mStringIndex.clear();
+  mDescriptions.clear();
+  mVariabilities.clear();
+  mStarts.clear();
+  mUnits.clear();
+  mDisplayUnits.clear();
+  mValueChangeable.clear();
+  mResultValues.clear();
+  mHasResultValue.clear();
+  intern(QString(""));
+}
+
+/*!
+ * \brief ScalarVariablesStore::append
+ * Adds a variable to the store. A variable that already exists is overwritten.
+ * \param name
+ * \param description
+ * \param isValueChangeable
+ * \param variability
+ * \param start
+ * \param unit
+ * \param displayUnit
+ */
+void ScalarVariablesStore::append(const QString &name, const QString &description, bool isValueChangeable, const QString &variability,
+                                  const QString &start, const QString &unit, const QString &displayUnit)
+{
+  int index = indexOf(name);
+  if (index < 0) {
+    index = mNames.size();
+    mNames.append(name);
+    mNameIndex.insert(name, index);
+    mDescriptions.append(0);
+    mVariabilities.append(0);
+    mStarts.append(0);
+    mUnits.append(0);
+    mDisplayUnits.append(0);
+    mValueChangeable.resize(index + 1);
+  }
+  mDescriptions[index] = intern(description);
+  mVariabilities[index] = intern(variability);
+  mStarts[index] = intern(start);
+  mUnits[index] = intern(unit);
+  mDisplayUnits[index] = intern(displayUnit);
+  mValueChangeable.setBit(index, isValueChangeable);
+}
+
+/*!
+ * \brief ScalarVariablesStore::readResultValues
+ * Reads the final values of all the variables that are not tunable parameters from the result file.
+ * The variables are stored row-wise in the mat file so the values at the stop time are read with a single read.
+ * Only mat result files are supported.
+ * \param pMatReader
+ */
+void ScalarVariablesStore::readResultValues(ModelicaMatReader *pMatReader)
+{
+  mResultValues.fill(0.0, size());
+  mHasResultValue.fill(false, size());
+  if ((pMatReader->file == NULL) || !strcmp(pMatReader->fileName, "")) {
+    return;
+  }
+  QVector<double> lastRow;
+  bool lastRowRead = false;
+  for (int i = 0 ; i < size() ; i++) {
+    if (isValueChangeable(i)) {
+      continue;
+    }
+    ModelicaMatVariable_t *var = omc_matlab4_find_var(pMatReader, mNames.at(i).toUtf8().constData());
+    if (!var) {
+      qDebug() << QString("%1 not found in %2").arg(mNames.at(i)).arg(pMatReader->fileName);
+      continue;
+    }
+    double value;
+    if (var->isParam) {
+      value = pMatReader->params[qAbs(var->index) - 1];
+    } else {
+      if (!lastRowRead) {
+        lastRowRead = true;
+        lastRow.resize(pMatReader->nvar);
+        if (omc_matlab4_read_row(lastRow.data(), pMatReader, pMatReader->nrows - 1)) {
+          lastRow.clear();
+        }
+      }
+      if (lastRow.isEmpty()) {
+        continue;
+      }
+      value = lastRow.at(qAbs(var->index) - 1);
+    }
+    mResultValues[i] = var->index < 0 ? -value : value;
+    mHasResultValue.setBit(i);
+  }
+}
+
+/*!
+ * \brief ScalarVariablesStore::intern
+ * Returns the index of the string in the string pool. Adds the string to the pool if it is not there.
+ * \param string
+ * \return
+ */
+int ScalarVariablesStore::intern(const QString &string)
+{
+  QHash<QString, int>::const_iterator it = mStringIndex.constFind(string);
+  if (it != mStringIndex.constEnd()) {
+    return it.value();
+  }
+  int index = mStrings.size();
+  mStrings.append(string);
+  mStringIndex.insert(string, index);
+  return index;
+}
+
 VariablesTreeModel::VariablesTreeModel(VariablesTreeView *pVariablesTreeView)
   : QAbstractItemModel(pVariablesTreeView)
 {
@@ -538,8 +665,7 @@ void VariablesTreeModel::parseInitXml(QXmlStreamReader &xmlReader)
     if (token == QXmlStreamReader::StartElement) {
       /* If it's named ScalarVariable, we'll dig the information from there.*/
       if (xmlReader.name() == "ScalarVariable") {
-        QHash<QString, QString> scalarVariable = parseScalarVariable(xmlReader);
-        mScalarVariablesHash.insert(scalarVariable.value("name"),scalarVariable);
+        parseScalarVariable(xmlReader);
       }
     }
   }
@@ -564,23 +690,16 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
   }
   QRegExp resultTypeRegExp("(\\.mat|\\.plt|\\.csv|_res.mat|_res.plt|_res.csv)");
   QString text = QString(fileName).remove(resultTypeRegExp);
-  QModelIndex index = variablesTreeItemIndex(mpRootVariablesTreeItem);
   QVector<QVariant> Variabledata;
   Variabledata << filePath << fileName << fileName << text << "" << "" << "" << QStringList() << "" << toolTip << false << QVariantList() << QVariantList() << QVariantList() << "dummy.json";
 
+  /* The top level item is built detached and is inserted in the model once all its children are created.
+   * This avoids notifying the views for every single variable.
+   */
   VariablesTreeItem *pTopVariablesTreeItem = new VariablesTreeItem(Variabledata, mpRootVariablesTreeItem, true);
   pTopVariablesTreeItem->setSimulationOptions(simulationOptions);
-  int row = rowCount();
-  beginInsertRows(index, row, row);
-  mpRootVariablesTreeItem->insertChild(row, pTopVariablesTreeItem);
-  endInsertRows();
-  // set the newly inserted VariablesTreeItem active
-  mpActiveVariablesTreeItem = pTopVariablesTreeItem;
-  if (simulationOptions.isValid() && !simulationOptions.isInteractiveSimulation()) {
-    pTopVariablesTreeItem->setActive();
-  }
   /* open the model_init.xml file for reading */
-  mScalarVariablesHash.clear();
+  mScalarVariablesStore.clear();
   QString initFileName, infoFileName;
   if (simulationOptions.isValid()) {
     initFileName = QString("%1_init.xml").arg(simulationOptions.getOutputFileName());
@@ -632,6 +751,7 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
       MessagesWidget::instance()->addGUIMessage(MessageItem(MessageItem::Modelica, GUIMessages::getMessage(GUIMessages::ERROR_OPENING_FILE).arg(infoFile.fileName())
                                                             .arg(parser.errorString()), Helper::scriptingKind, Helper::errorLevel));
       MainWindow::instance()->printStandardOutAndErrorFilesMessages();
+      insertTopVariablesTreeItem(pTopVariablesTreeItem);
       return;
     } else {
       if (MainWindow::instance()->isDebug()) {
@@ -680,6 +800,8 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
                                                             .arg(QString(msg[0])), Helper::scriptingKind, Helper::errorLevel));
     }
   }
+  /* read the final values of all the variables at once */
+  mScalarVariablesStore.readResultValues(&matReader);
 
   // remove time from variables list
   variablesList.removeOne("time");
@@ -698,11 +820,8 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
       variables = StringHandler::makeVariablePartsWithInd(plotVariable);
     }
     int count = 1;
-    VariablesTreeItem *pParentVariablesTreeItem = 0;
+    VariablesTreeItem *pParentVariablesTreeItem = pTopVariablesTreeItem;
     foreach (QString variable, variables) {
-      if (count == 1) { /* first loop iteration */
-        pParentVariablesTreeItem = pTopVariablesTreeItem;
-      }
       QString findVariable;
       /* if last item of derivative */
       if ((variables.size() == count) && (plotVariable.startsWith("der("))) {
@@ -724,7 +843,9 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
           findVariable = QString("%1.%2.%3").arg(fileName, parentVariable, variable);
         }
       }
-      if ((pParentVariablesTreeItem = findVariablesTreeItem(findVariable, pParentVariablesTreeItem)) != NULL) {
+      VariablesTreeItem *pVariablesTreeItem = pParentVariablesTreeItem->findChild(findVariable);
+      if (pVariablesTreeItem) {
+        pParentVariablesTreeItem = pVariablesTreeItem;
         QString addVar = "";
         /* if last item of derivative */
         if ((variables.size() == count) && (plotVariable.startsWith("der("))) {
@@ -742,15 +863,6 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
         count++;
         continue;
       }
-      /* If pParentVariablesTreeItem is 0 and it is first loop iteration then use pTopVariablesTreeItem as parent.
-       * If loop iteration is not first and pParentVariablesTreeItem is 0 then find the parent item.
-       */
-      if (!pParentVariablesTreeItem && count > 1) {
-        pParentVariablesTreeItem = findVariablesTreeItem(fileName + "." + parentVariable, pTopVariablesTreeItem);
-      } else {
-        pParentVariablesTreeItem = pTopVariablesTreeItem;
-      }
-      QModelIndex index = variablesTreeItemIndex(pParentVariablesTreeItem);
       QVector<QVariant> variableData;
       /* if last item of derivative */
       if ((variables.size() == count) && (plotVariable.startsWith("der("))) {
@@ -769,7 +881,7 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
       /* get the variable information i.e value, unit, displayunit, description */
       QString value, variability, unit, displayUnit, description;
       bool changeAble = false;
-      getVariableInformation(&matReader, variableToFind, &value, &changeAble, &variability, &unit, &displayUnit, &description);
+      getVariableInformation(variableToFind, &value, &changeAble, &variability, &unit, &displayUnit, &description);
       variableData << StringHandler::unparse(QString("\"").append(value).append("\""));
       /* set the variable unit */
       variableData << StringHandler::unparse(QString("\"").append(unit).append("\""));
@@ -840,13 +952,11 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
       variableData << variantDefinedIn;
       variableData << infoFileName;
 
-      VariablesTreeItem *pVariablesTreeItem = new VariablesTreeItem(variableData, pParentVariablesTreeItem);
+      pVariablesTreeItem = new VariablesTreeItem(variableData, pParentVariablesTreeItem);
       pVariablesTreeItem->setEditable(changeAble);
       pVariablesTreeItem->setVariability(variability);
-      int row = rowCount(index);
-      beginInsertRows(index, row, row);
-      pParentVariablesTreeItem->insertChild(row, pVariablesTreeItem);
-      endInsertRows();
+      pParentVariablesTreeItem->insertChild(pParentVariablesTreeItem->getChildren().size(), pVariablesTreeItem);
+      pParentVariablesTreeItem = pVariablesTreeItem;
       QString addVar = "";
       /* if last item of derivative */
       if ((variables.size() == count) && (plotVariable.startsWith("der("))) {
@@ -870,6 +980,7 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
       omc_free_matlab4_reader(&matReader);
     }
   }
+  insertTopVariablesTreeItem(pTopVariablesTreeItem);
   mpVariablesTreeView->collapseAll();
   QModelIndex idx = variablesTreeItemIndex(pTopVariablesTreeItem);
   idx = mpVariablesTreeView->getVariablesWidget()->getVariableTreeProxyModel()->mapFromSource(idx);
@@ -883,6 +994,25 @@ void VariablesTreeModel::insertVariablesItems(QString fileName, QString filePath
   MainWindow::instance()->enableReSimulationToolbar(MainWindow::instance()->getVariablesDockWidget()->isVisible());
 }
 
+/*!
+ * \brief VariablesTreeModel::insertTopVariablesTreeItem
+ * Inserts the top level item of a result file together with all its children and sets it active.
+ * \param pTopVariablesTreeItem
+ */
+void VariablesTreeModel::insertTopVariablesTreeItem(VariablesTreeItem *pTopVariablesTreeItem)
+{
+  int row = rowCount();
+  beginInsertRows(variablesTreeItemIndex(mpRootVariablesTreeItem), row, row);
+  mpRootVariablesTreeItem->insertChild(row, pTopVariablesTreeItem);
+  endInsertRows();
+  // set the newly inserted VariablesTreeItem active
+  mpActiveVariablesTreeItem = pTopVariablesTreeItem;
+  SimulationOptions simulationOptions = pTopVariablesTreeItem->getSimulationOptions();
+  if (simulationOptions.isValid() && !simulationOptions.isInteractiveSimulation()) {
+    pTopVariablesTreeItem->setActive();
+  }
+}
+
 /*!
  * \brief VariablesTreeModel::removeVariableTreeItem
  * Removes the VariablesTreeItem.
@@ -954,43 +1084,42 @@ void VariablesTreeModel::plotAllVariables(VariablesTreeItem *pVariablesTreeItem,
 
 /*!
  * \brief VariablesTreeModel::parseScalarVariable
- * Parses the scalar variable.
+ * Parses the scalar variable and adds it to the ScalarVariablesStore.
  * Helper function for VariablesTreeModel::parseInitXml
  * \param xmlReader
- * \return
  */
-QHash<QString, QString> VariablesTreeModel::parseScalarVariable(QXmlStreamReader &xmlReader)
+void VariablesTreeModel::parseScalarVariable(QXmlStreamReader &xmlReader)
 {
-  QHash<QString, QString> scalarVariable;
   /* Let's check that we're really getting a ScalarVariable. */
   if (xmlReader.tokenType() != QXmlStreamReader::StartElement && xmlReader.name() == "ScalarVariable") {
-    return scalarVariable;
+    return;
   }
   /* Let's get the attributes for ScalarVariable */
   QXmlStreamAttributes attributes = xmlReader.attributes();
   /* Read the ScalarVariable attributes. */
-  scalarVariable["name"] = attributes.value("name").toString();
-  scalarVariable["description"] = attributes.value("description").toString();
-  scalarVariable["isValueChangeable"] = attributes.value("isValueChangeable").toString();
-  scalarVariable["variability"] = attributes.value("variability").toString();
+  QString name = attributes.value("name").toString();
+  QString description = attributes.value("description").toString();
+  bool isValueChangeable = attributes.value("isValueChangeable") == "true";
+  QString variability = attributes.value("variability").toString();
+  QString start, unit, displayUnit;
   /* Read the next element i.e Real, Integer, Boolean etc. */
   xmlReader.readNext();
   while (!(xmlReader.tokenType() == QXmlStreamReader::EndElement && xmlReader.name() == "ScalarVariable")) {
     if (xmlReader.tokenType() == QXmlStreamReader::StartElement) {
       QXmlStreamAttributes attributes = xmlReader.attributes();
-      scalarVariable["start"] = attributes.value("start").toString();
-      scalarVariable["unit"] = attributes.value("unit").toString();
-      scalarVariable["displayUnit"] = attributes.value("displayUnit").toString();
+      start = attributes.value("start").toString();
+      unit = attributes.value("unit").toString();
+      displayUnit = attributes.value("displayUnit").toString();
     }
     xmlReader.readNext();
   }
-  return scalarVariable;
+  mScalarVariablesStore.append(name, description, isValueChangeable, variability, start, unit, displayUnit);
 }
 
 /*!
  * \brief VariablesTreeModel::getVariableInformation
  * Returns the variable information like value, unit, displayunit and description.
- * \param pMatReader
+ * The final values of the variables that are not tunable parameters must be read before with ScalarVariablesStore::readResultValues.
  * \param variableToFind
  * \param value
  * \param changeAble
@@ -999,31 +1128,21 @@ QHash<QString, QString> VariablesTreeModel::parseScalarVariable(QXmlStreamReader
  * \param displayUnit
  * \param description
  */
-void VariablesTreeModel::getVariableInformation(ModelicaMatReader *pMatReader, QString variableToFind, QString *value, bool *changeAble,
+void VariablesTreeModel::getVariableInformation(QString variableToFind, QString *value, bool *changeAble,
                                                 QString *variability, QString *unit, QString *displayUnit, QString *description)
 {
-  QHash<QString, QString> hash = mScalarVariablesHash.value(variableToFind);
-  if (hash["name"].compare(variableToFind) == 0) {
-    *changeAble = (hash["isValueChangeable"].compare("true") == 0) ? true : false;
-    *variability = hash["variability"];
+  int index = mScalarVariablesStore.indexOf(variableToFind);
+  if (index >= 0) {
+    *changeAble = mScalarVariablesStore.isValueChangeable(index);
+    *variability = mScalarVariablesStore.variability(index);
     if (*changeAble) {
-      *value = hash["start"];
-    } else { /* if the variable is not a tunable parameter then read the final value of the variable. Only mat result files are supported. */
-      if ((pMatReader->file != NULL) && strcmp(pMatReader->fileName, "")) {
-        *value = "";
-        ModelicaMatVariable_t *var;
-        if (0 == (var = omc_matlab4_find_var(pMatReader, variableToFind.toUtf8().constData()))) {
-          qDebug() << QString("%1 not found in %2").arg(variableToFind).arg(pMatReader->fileName);
-        }
-        double res;
-        if (var && !omc_matlab4_val(&res, pMatReader, var, omc_matlab4_stopTime(pMatReader))) {
-          *value = QString::number(res);
-        }
-      }
+      *value = mScalarVariablesStore.start(index);
+    } else if (mScalarVariablesStore.hasResultValue(index)) {
+      *value = QString::number(mScalarVariablesStore.resultValue(index));
     }
-    *unit = hash["unit"];
-    *displayUnit = hash["displayUnit"];
-    *description = hash["description"];
+    *unit = mScalarVariablesStore.unit(index);
+    *displayUnit = mScalarVariablesStore.displayUnit(index);
+    *description = mScalarVariablesStore.description(index);
   }
 }
 
@@ -36,6 +36,7 @@
 #define VARIABLESWIDGET_H
 
 #include <QDomDocument>
+#include <QBitArray>
 
 #include "Simulation/SimulationOptions.h"
 #include "PlotWindow.h"
@@ -82,6 +83,7 @@ public:
   QIcon getVariableTreeItemIcon(QString name) const;
   void insertChild(int position, VariablesTreeItem *pVariablesTreeItem);
   VariablesTreeItem* child(int row);
+  VariablesTreeItem* findChild(const QString &variableName) const {return mChildrenHash.value(variableName, 0);}
   void removeChildren();
   void removeChild(VariablesTreeItem *pVariablesTreeItem);
   int columnCount() const;
@@ -94,6 +96,7 @@ public:
   QVariant getValue(QString fromUnit, QString toUnit);
 private:
   QList<VariablesTreeItem*> mChildren;
+  QHash<QString, VariablesTreeItem*> mChildrenHash;
   VariablesTreeItem *mpParentVariablesTreeItem;
   bool mIsRootItem;
   QString mFilePath;
@@ -120,6 +123,45 @@ protected:
   bool mActive;
 };
 
+/*!
+ * \class ScalarVariablesStore
+ * \brief Columnar storage of the ScalarVariable entries read from model_init.xml.
+ * Each attribute is stored in its own column and repeated strings (units, start values, descriptions etc.) are interned.
+ */
+class ScalarVariablesStore
+{
+public:
+  ScalarVariablesStore();
+  void clear();
+  int size() const {return mNames.size();}
+  int indexOf(const QString &name) const {return mNameIndex.value(name, -1);}
+  void append(const QString &name, const QString &description, bool isValueChangeable, const QString &variability,
+              const QString &start, const QString &unit, const QString &displayUnit);
+  void readResultValues(ModelicaMatReader *pMatReader);
+  bool isValueChangeable(int index) const {return mValueChangeable.testBit(index);}
+  const QString& variability(int index) const {return mStrings.at(mVariabilities.at(index));}
+  const QString& start(int index) const {return mStrings.at(mStarts.at(index));}
+  const QString& unit(int index) const {return mStrings.at(mUnits.at(index));}
+  const QString& displayUnit(int index) const {return mStrings.at(mDisplayUnits.at(index));}
+  const QString& description(int index) const {return mStrings.at(mDescriptions.at(index));}
+  bool hasResultValue(int index) const {return mHasResultValue.testBit(index);}
+  double resultValue(int index) const {return mResultValues.at(index);}
+private:
+  QVector<QString> mNames;
+  QHash<QString, int> mNameIndex;
+  QVector<QString> mStrings;
+  QHash<QString, int> mStringIndex;
+  QVector<int> mDescriptions;
+  QVector<int> mVariabilities;
+  QVector<int> mStarts;
+  QVector<int> mUnits;
+  QVector<int> mDisplayUnits;
+  QBitArray mValueChangeable;
+  QVector<double> mResultValues;
+  QBitArray mHasResultValue;
+  int intern(const QString &string);
+};
+
 class VariablesTreeView;
 
 class VariableTreeProxyModel : public QSortFilterProxyModel
@@ -153,6 +195,7 @@ public:
                                            const QModelIndex &parentIndex) const;
   void parseInitXml(QXmlStreamReader &xmlReader);
   void insertVariablesItems(QString fileName, QString filePath, QStringList variablesList, SimulationOptions simulationOptions);
+  void insertTopVariablesTreeItem(VariablesTreeItem *pTopVariablesTreeItem);
   bool removeVariableTreeItem(QString variable);
   void unCheckVariables(VariablesTreeItem *pVariablesTreeItem);
   void plotAllVariables(VariablesTreeItem *pVariablesTreeItem, OMPlot::PlotWindow *pPlotWindow);
@@ -160,9 +203,9 @@ private:
   VariablesTreeView *mpVariablesTreeView;
   VariablesTreeItem *mpRootVariablesTreeItem;
   VariablesTreeItem *mpActiveVariablesTreeItem;
-  QHash<QString, QHash<QString,QString> > mScalarVariablesHash;
-  QHash<QString, QString> parseScalarVariable(QXmlStreamReader &xmlReader);
-  void getVariableInformation(ModelicaMatReader *pMatReader, QString variableToFind, QString *value, bool *changeAble, QString *variability,
+  ScalarVariablesStore mScalarVariablesStore;
+  void parseScalarVariable(QXmlStreamReader &xmlReader);
+  void getVariableInformation(QString variableToFind, QString *value, bool *changeAble, QString *variability,
                               QString *unit, QString *displayUnit, QString *description);
 signals:
   void itemChecked(const QModelIndex &index, qreal curveThickness, int curveStyle);
@@ -242,7 +242,7 @@ void PlotWindow::getStartStopTime(double &start, double &stop){
     omc_free_csv_reader(csvReader);
   }
   //PLOT MAT
-  else if(mFile.fileName().endsWith("mat"))
+  else if(mFile.fileName().endsWith("mat") || mFile.fileName().endsWith("col"))
   {
     ModelicaMatReader reader;
     const char *msg = "";
@@ -497,7 +497,7 @@ void PlotWindow::plot(PlotCurve *pPlotCurve)
     omc_free_csv_reader(csvReader);
   }
   //PLOT MAT
-  else if(mFile.fileName().endsWith("mat"))
+  else if(mFile.fileName().endsWith("mat") || mFile.fileName().endsWith("col"))
   {
     ModelicaMatReader reader;
     ModelicaMatVariable_t *var;
@@ -741,7 +741,7 @@ void PlotWindow::plotParametric(PlotCurve *pPlotCurve)
       omc_free_csv_reader(csvReader);
     }
     //PLOT MAT
-    else if(mFile.fileName().endsWith("mat"))
+    else if(mFile.fileName().endsWith("mat") || mFile.fileName().endsWith("col"))
     {
       //Declare variables
       ModelicaMatReader reader;
@@ -1041,7 +1041,7 @@ void PlotWindow::plotArray(double time, PlotCurve *pPlotCurve)
   }
   //PLOT MAT
   else
-    if(mFile.fileName().endsWith("mat"))
+    if(mFile.fileName().endsWith("mat") || mFile.fileName().endsWith("col"))
     {
       ModelicaMatReader reader;
       ModelicaMatVariable_t *var;
@@ -1270,7 +1270,7 @@ void PlotWindow::plotArrayParametric(double time, PlotCurve *pPlotCurve)
       omc_free_csv_reader(csvReader);
     }
     //PLOT MAT
-    else if(mFile.fileName().endsWith("mat"))
+    else if(mFile.fileName().endsWith("mat") || mFile.fileName().endsWith("col"))
     {
       //Declare variables
       ModelicaMatReader reader;
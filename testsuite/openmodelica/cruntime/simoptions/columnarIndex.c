@@ -0,0 +1,120 @@
+/* Prints which kinds of column chunks a columnar result file (outputFormat="col")
+ * contains, see SimulationRuntime/c/util/result_columnar.h. If variables are
+ * given, prints instead whether their values are stored only once, i.e. whether
+ * their columns are aliases or copies of a single stored column in every chunk.
+ *
+ * usage: columnarIndex <file> [variables]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONSTANT 0
+#define REFERENCE 0xFFFFFFFFu
+#define NEGATED (((uint64_t)1) << 63)
+
+static char* read_string(FILE *f)
+{
+  char buf[1024];
+  size_t len = 0;
+  int c;
+  while ((c = fgetc(f)) != EOF && c != 0) {
+    if (len < sizeof(buf) - 1) {
+      buf[len++] = (char) c;
+    }
+  }
+  buf[len] = 0;
+  return strdup(buf);
+}
+
+int main(int argc, char **argv)
+{
+  const char *names[4] = {"data", "constant", "copied", "negated copied"};
+  int kinds[4] = {0, 0, 0, 0};
+  char magic[8], **varNames;
+  int32_t *varInfo;
+  uint64_t offset, *chunk;
+  uint32_t header[5], *size, i, v;
+  int k, once = 1;
+  FILE *f;
+
+  if (argc < 2) {
+    printf("usage: %s file [variables]\n", argv[0]);
+    return 1;
+  }
+  f = fopen(argv[1], "rb");
+  if (!f) {
+    printf("cannot open %s\n", argv[1]);
+    return 1;
+  }
+  if (1 != fread(magic, 8, 1, f) || memcmp(magic, "OMCCOL01", 8) ||
+      fseek(f, -16, SEEK_END) || 1 != fread(&offset, 8, 1, f) || 1 != fread(magic, 8, 1, f) || memcmp(magic, "OMCCOLIX", 8) ||
+      fseek(f, (long) offset, SEEK_SET) || 1 != fread(header, sizeof(header), 1, f)) {
+    printf("not a columnar result file\n");
+    return 1;
+  }
+  /* nvar, nrows, nparam, nall, nchunks */
+  fseek(f, 8 * (long) header[2], SEEK_CUR);
+  varNames = (char**) malloc(header[3] * sizeof(char*));
+  varInfo = (int32_t*) malloc(2 * header[3] * sizeof(int32_t));
+  for (i = 0; i < header[3]; i++) {
+    if (1 != fread(&varInfo[2*i], 2 * sizeof(int32_t), 1, f)) {
+      printf("corrupt index\n");
+      return 1;
+    }
+    varNames[i] = read_string(f);
+    free(read_string(f));
+  }
+  chunk = (uint64_t*) malloc((size_t) header[4] * header[0] * sizeof(uint64_t));
+  size = (uint32_t*) malloc((size_t) header[4] * header[0] * sizeof(uint32_t));
+  for (i = 0; i < header[4]; i++) {
+    fseek(f, 4, SEEK_CUR);
+    for (v = 0; v < header[0]; v++) {
+      uint64_t *c = &chunk[(size_t) i * header[0] + v];
+      uint32_t *s = &size[(size_t) i * header[0] + v];
+      if (1 != fread(c, 8, 1, f) || 1 != fread(s, 4, 1, f)) {
+        printf("corrupt index\n");
+        return 1;
+      }
+      kinds[*s == CONSTANT ? 1 : *s != REFERENCE ? 0 : (*c & NEGATED) ? 3 : 2]++;
+    }
+  }
+  fclose(f);
+  if (argc == 2) {
+    for (i = 0; i < 4; i++) {
+      printf("%s chunks: %s\n", names[i], kinds[i] ? "yes" : "no");
+    }
+    return 0;
+  }
+
+  /* the stored column of every variable must be the same in each chunk */
+  for (i = 0; i < header[4]; i++) {
+    int64_t stored = -1;
+    for (k = 2; k < argc; k++) {
+      int64_t col = -1;
+      for (v = 0; v < header[3]; v++) {
+        if (!strcmp(varNames[v], argv[k]) && !varInfo[2*v]) {
+          col = abs(varInfo[2*v+1]) - 1;
+        }
+      }
+      if (col < 0) {
+        printf("%s is not a variable of the result\n", argv[k]);
+        return 1;
+      }
+      if (size[(size_t) i * header[0] + col] == REFERENCE) {
+        col = (int64_t) (chunk[(size_t) i * header[0] + col] & ~NEGATED);
+      }
+      if (stored >= 0 && stored != col) {
+        once = 0;
+      }
+      stored = col;
+    }
+  }
+  printf("values of");
+  for (k = 2; k < argc; k++) {
+    printf(" %s", argv[k]);
+  }
+  printf(" stored once: %s\n", once ? "yes" : "no");
+  return 0;
+}
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+#
+# Stand-in client for the result streaming of the interactive output format
+# (outputFormat="ia"), see SimulationRuntime/c/simulation/results/simulation_result_ia.cpp
+#
+# Usage: streamingClient.py [--decimation N] [--interval DT] [--signal NAME]... [--check EXPR]... -- EXECUTABLE [ARGS...]
+#
+# Listens on a local TCP port, starts the simulation executable with -port
+# (pass -portSubscribe to the executable to get all output steps),
+# subscribes to the given signals and prints the received rows. With --check
+# only a summary is printed instead: whether the rows are at least DT apart
+# and whether every Python expression EXPR, in terms of time and the signal
+# names, holds in every row.
+
+import argparse
+import socket
+import struct
+import subprocess
+import sys
+
+ID_NAMES = 2
+ID_VALUES = 4
+ID_DONE = 6
+ID_SUBSCRIBE = 8
+ID_BATCH = 10
+
+def recv_exactly(conn, size):
+  buf = b""
+  while len(buf) < size:
+    chunk = conn.recv(size - len(buf))
+    if not chunk:
+      raise EOFError("connection closed by the simulation")
+    buf += chunk
+  return buf
+
+def recv_msg(conn):
+  (msg_id, size) = struct.unpack("=BI", recv_exactly(conn, 5))
+  return (msg_id, recv_exactly(conn, size))
+
+def send_msg(conn, msg_id, data):
+  conn.sendall(struct.pack("=BI", msg_id, len(data)) + data)
+
+def parse_names(data):
+  counts = struct.unpack_from("=4I", data)
+  names = data[struct.calcsize("=4I"):].split(b"\0")
+  return ([n.decode() for n in names[:sum(counts)]], counts)
+
+def decode_batch(data, last):
+  (n, nrows) = struct.unpack_from("=II", data)
+  offset = 8
+  rows = []
+  for r in range(nrows):
+    (time,) = struct.unpack_from("=d", data, offset)
+    offset += 8
+    mask = data[offset:offset + (n + 7) // 8]
+    offset += len(mask)
+    for i in range(n):
+      if mask[i // 8] & (1 << (i % 8)):
+        (last[i],) = struct.unpack_from("=d", data, offset)
+        offset += 8
+    rows.append([time] + list(last))
+  return rows
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument("--decimation", type=int, default=1)
+  parser.add_argument("--interval", type=float, default=0.0)
+  parser.add_argument("--signal", action="append", default=[])
+  parser.add_argument("--check", action="append", default=[])
+  parser.add_argument("command", nargs=argparse.REMAINDER)
+  args = parser.parse_args()
+  command = args.command[1:] if args.command[:1] == ["--"] else args.command
+
+  server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+  server.bind(("127.0.0.1", 0))
+  server.listen(1)
+  port = server.getsockname()[1]
+  proc = subprocess.Popen(command + ["-port=%d" % port], stdout=subprocess.DEVNULL)
+  (conn, _) = server.accept()
+
+  last = [0.0] * len(args.signal)
+  rows = []
+  while True:
+    (msg_id, data) = recv_msg(conn)
+    if msg_id == ID_NAMES:
+      (names, counts) = parse_names(data)
+      indices = [names.index(s) for s in args.signal]
+      send_msg(conn, ID_SUBSCRIBE, struct.pack("=Id", args.decimation, args.interval) +
+               struct.pack("=I", len(indices)) + struct.pack("=%dI" % len(indices), *indices))
+    elif msg_id == ID_BATCH:
+      rows += decode_batch(data, last)
+    elif msg_id == ID_DONE:
+      break
+  conn.close()
+  proc.wait()
+
+  if args.check:
+    times = [row[0] for row in rows]
+    print("received rows: %s" % ("yes" if rows else "no"))
+    print("rows at least %g apart: %s" % (args.interval, "yes" if all(t1 - t0 >= args.interval - 1e-12 for (t0, t1) in zip(times, times[1:])) else "no"))
+    for check in args.check:
+      ok = all(eval(check, {}, dict(zip(["time"] + args.signal, row))) for row in rows)
+      print("%s in every row: %s" % (check, "yes" if ok else "no"))
+    return proc.returncode
+
+  print("received rows: %d" % len(rows))
+  print("time " + " ".join(args.signal))
+  for row in rows:
+    print(" ".join("%.6g" % v for v in row))
+  return proc.returncode
+
+if __name__ == "__main__":
+  sys.exit(main())
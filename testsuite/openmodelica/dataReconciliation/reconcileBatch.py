@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+#
+# Compares the batch output of DataReconciliation (-sxBatch) with the output
+# of a single reconciliation of the first set, and checks that the reconciled
+# flows of every set fulfill the mass balance Q1 = Q2 + Q3. Only these checks
+# are printed, not the reconciled values, which depend on the uncertainties
+# and the iteration.
+#
+# Usage: reconcileBatch.py OUTPUTS.csv BATCH_OUTPUTS.csv
+
+import csv
+import sys
+
+# the second set of Splitter1Batch.mos already fulfills the mass balance
+consistent = {"Q1": 2.0, "Q2": 1.0, "Q3": 1.0}
+
+def main():
+  with open(sys.argv[1]) as f:
+    rows = [[c.strip() for c in row] for row in csv.reader(f)][1:]
+  single = dict((row[0], float(row[2])) for row in rows if row and row[0])
+
+  with open(sys.argv[2]) as f:
+    rows = [[c.strip() for c in row] for row in csv.reader(f)]
+  names = rows[0][3:]
+  sets = [dict(zip(names, map(float, row[3:]))) for row in rows[1:] if row]
+
+  print("reconciled sets: %d" % len(sets))
+  print("first set equals the single reconciliation: %s" % ("yes" if all(abs(sets[0][n] - single[n]) < 1e-6 for n in names) else "no"))
+  print("consistent second set is unchanged: %s" % ("yes" if all(abs(sets[1][n] - consistent[n]) < 1e-4 for n in names) else "no"))
+  print("Q1 = Q2 + Q3 in every set: %s" % ("yes" if all(abs(s["Q1"] - s["Q2"] - s["Q3"]) < 1e-4 for s in sets) else "no"))
+  return 0
+
+if __name__ == "__main__":
+  sys.exit(main())
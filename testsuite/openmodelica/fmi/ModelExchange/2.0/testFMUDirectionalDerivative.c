@@ -0,0 +1,180 @@
+/* Calls fmi2GetDirectionalDerivative of testFMUDirectionalDerivative.mos repeatedly at the same
+ * point with different seeds and compares the results with the analytic Jacobian
+ *   d(der(x1), der(x2))/d(x1, x2) = {{x2, x1}, {1, -3}}
+ * The first calls evaluate one column in the direction of the seed, the following ones use the
+ * Jacobian cached at this point; both must give the same values for every seed.
+ *
+ * usage: testFMUDirectionalDerivative <binary> <modelDescription.xml>
+ */
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef void* fmi2Component;
+typedef int fmi2Status;
+typedef int fmi2Boolean;
+typedef double fmi2Real;
+typedef unsigned int fmi2ValueReference;
+
+typedef struct {
+  void (*logger)(void*, const char*, fmi2Status, const char*, const char*, ...);
+  void* (*allocateMemory)(size_t, size_t);
+  void (*freeMemory)(void*);
+  void (*stepFinished)(void*, fmi2Status);
+  void* componentEnvironment;
+} fmi2CallbackFunctions;
+
+typedef struct {
+  fmi2Boolean newDiscreteStatesNeeded;
+  fmi2Boolean terminateSimulation;
+  fmi2Boolean nominalsOfContinuousStatesChanged;
+  fmi2Boolean valuesOfContinuousStatesChanged;
+  fmi2Boolean nextEventTimeDefined;
+  fmi2Real nextEventTime;
+} fmi2EventInfo;
+
+#define NX 2
+#define NSEEDS 4
+#define ROUNDS 3
+
+static void logger(void *env, const char *instanceName, fmi2Status status, const char *category, const char *message, ...)
+{
+}
+
+static fmi2Component (*instantiate)(const char*, int, const char*, const char*, const fmi2CallbackFunctions*, fmi2Boolean, fmi2Boolean);
+static fmi2Status (*setupExperiment)(fmi2Component, fmi2Boolean, fmi2Real, fmi2Real, fmi2Boolean, fmi2Real);
+static fmi2Status (*enterInitializationMode)(fmi2Component);
+static fmi2Status (*exitInitializationMode)(fmi2Component);
+static fmi2Status (*newDiscreteStates)(fmi2Component, fmi2EventInfo*);
+static fmi2Status (*enterContinuousTimeMode)(fmi2Component);
+static fmi2Status (*setContinuousStates)(fmi2Component, const fmi2Real*, size_t);
+static fmi2Status (*getDirectionalDerivative)(fmi2Component, const fmi2ValueReference*, size_t, const fmi2ValueReference*, size_t, const fmi2Real*, fmi2Real*);
+static fmi2Status (*terminate)(fmi2Component);
+static void (*freeInstance)(fmi2Component);
+
+static void* load(void *lib, const char *name)
+{
+  void *sym = dlsym(lib, name);
+  if (!sym) {
+    printf("missing %s\n", name);
+    exit(1);
+  }
+  return sym;
+}
+
+#define CHECK(call) if ((call) != 0) { printf("%s failed\n", #call); exit(1); }
+
+/* value reference of the variable with the given name in modelDescription.xml */
+static fmi2ValueReference valueReference(const char *xml, const char *name)
+{
+  char pattern[256];
+  const char *var;
+  snprintf(pattern, sizeof(pattern), "name=\"%s\"", name);
+  var = strstr(xml, pattern);
+  if (!var || !(var = strstr(var, "valueReference=\""))) {
+    printf("missing variable %s\n", name);
+    exit(1);
+  }
+  return (fmi2ValueReference) strtoul(var + 16, NULL, 10);
+}
+
+/* directional derivative at x in the direction of seed, compared with the analytic Jacobian */
+static int directionalDerivativeOk(fmi2Component c, const fmi2ValueReference *vrX, const fmi2ValueReference *vrDer, const fmi2Real *x, const fmi2Real *seed)
+{
+  fmi2Real dv[NX], expected[NX];
+  expected[0] = x[1] * seed[0] + x[0] * seed[1];
+  expected[1] = seed[0] - 3 * seed[1];
+  CHECK(getDirectionalDerivative(c, vrDer, NX, vrX, NX, seed, dv));
+  return fabs(dv[0] - expected[0]) < 1e-12 && fabs(dv[1] - expected[1]) < 1e-12;
+}
+
+int main(int argc, char **argv)
+{
+  fmi2CallbackFunctions callbacks = {logger, calloc, free, NULL, NULL};
+  fmi2EventInfo eventInfo;
+  fmi2Component c;
+  fmi2Real x[NX] = {1, 2}, y[NX] = {-0.5, 4};
+  fmi2Real seeds[NSEEDS][NX] = {{1, 0}, {0, 1}, {1, 1}, {2, -1}};
+  fmi2ValueReference vrX[NX], vrDer[NX];
+  char guid[128] = "", xml[65536], *start, *end;
+  int i, round, ok;
+  void *lib;
+  FILE *f;
+
+  if (argc != 3) {
+    printf("usage: %s binary modelDescription.xml\n", argv[0]);
+    return 1;
+  }
+  f = fopen(argv[2], "r");
+  if (!f) {
+    printf("cannot open %s\n", argv[2]);
+    return 1;
+  }
+  xml[fread(xml, 1, sizeof(xml) - 1, f)] = 0;
+  fclose(f);
+  if ((start = strstr(xml, "guid=\"")) && (end = strchr(start + 6, '"')) && end - start - 6 < sizeof(guid)) {
+    memcpy(guid, start + 6, end - start - 6);
+    guid[end - start - 6] = 0;
+  }
+
+  lib = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+  if (!lib) {
+    printf("cannot load %s\n", argv[1]);
+    return 1;
+  }
+  instantiate = load(lib, "fmi2Instantiate");
+  setupExperiment = load(lib, "fmi2SetupExperiment");
+  enterInitializationMode = load(lib, "fmi2EnterInitializationMode");
+  exitInitializationMode = load(lib, "fmi2ExitInitializationMode");
+  newDiscreteStates = load(lib, "fmi2NewDiscreteStates");
+  enterContinuousTimeMode = load(lib, "fmi2EnterContinuousTimeMode");
+  setContinuousStates = load(lib, "fmi2SetContinuousStates");
+  getDirectionalDerivative = load(lib, "fmi2GetDirectionalDerivative");
+  terminate = load(lib, "fmi2Terminate");
+  freeInstance = load(lib, "fmi2FreeInstance");
+
+  c = instantiate("testFMUDirectionalDerivative", 0 /* fmi2ModelExchange */, guid, "", &callbacks, 0, 0);
+  if (!c) {
+    printf("fmi2Instantiate failed\n");
+    return 1;
+  }
+  vrX[0] = valueReference(xml, "x1");
+  vrX[1] = valueReference(xml, "x2");
+  vrDer[0] = valueReference(xml, "der(x1)");
+  vrDer[1] = valueReference(xml, "der(x2)");
+  CHECK(setupExperiment(c, 0, 0, 0, 0, 0));
+  CHECK(enterInitializationMode(c));
+  CHECK(exitInitializationMode(c));
+  do {
+    CHECK(newDiscreteStates(c, &eventInfo));
+  } while (eventInfo.newDiscreteStatesNeeded);
+  CHECK(enterContinuousTimeMode(c));
+
+  CHECK(setContinuousStates(c, x, NX));
+  for (i = 0; i < NSEEDS; i++) {
+    printf("seed {%g, %g}: %s\n", seeds[i][0], seeds[i][1], directionalDerivativeOk(c, vrX, vrDer, x, seeds[i]) ? "ok" : "wrong");
+  }
+  ok = 1;
+  for (round = 0; round < ROUNDS; round++) {
+    for (i = 0; i < NSEEDS; i++) {
+      ok = directionalDerivativeOk(c, vrX, vrDer, x, seeds[i]) && ok;
+    }
+  }
+  printf("repeated calls at the same point: %s\n", ok ? "ok" : "wrong");
+
+  /* the cached Jacobian must not be used at a new point */
+  CHECK(setContinuousStates(c, y, NX));
+  ok = 1;
+  for (round = 0; round < ROUNDS; round++) {
+    for (i = 0; i < NSEEDS; i++) {
+      ok = directionalDerivativeOk(c, vrX, vrDer, y, seeds[i]) && ok;
+    }
+  }
+  printf("repeated calls at a new point: %s\n", ok ? "ok" : "wrong");
+
+  CHECK(terminate(c));
+  freeInstance(c);
+  return 0;
+}
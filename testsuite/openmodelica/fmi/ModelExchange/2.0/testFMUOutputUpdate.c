@@ -0,0 +1,160 @@
+/* Counts the equation evaluations of fmi2GetReal for testFMUOutputUpdate.mos: the output y and
+ * the algebraic variable z are computed by calls of counted(), which increments
+ * testFMUOutputUpdate_calls[0] for y and testFMUOutputUpdate_calls[1] for z. Getting the output
+ * must only evaluate the equations y depends on, getting the derivatives must evaluate none of
+ * them and getting z must evaluate all of them.
+ *
+ * usage: testFMUOutputUpdate <binary> <modelDescription.xml>
+ */
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef void* fmi2Component;
+typedef int fmi2Status;
+typedef int fmi2Boolean;
+typedef double fmi2Real;
+typedef unsigned int fmi2ValueReference;
+
+typedef struct {
+  void (*logger)(void*, const char*, fmi2Status, const char*, const char*, ...);
+  void* (*allocateMemory)(size_t, size_t);
+  void (*freeMemory)(void*);
+  void (*stepFinished)(void*, fmi2Status);
+  void* componentEnvironment;
+} fmi2CallbackFunctions;
+
+typedef struct {
+  fmi2Boolean newDiscreteStatesNeeded;
+  fmi2Boolean terminateSimulation;
+  fmi2Boolean nominalsOfContinuousStatesChanged;
+  fmi2Boolean valuesOfContinuousStatesChanged;
+  fmi2Boolean nextEventTimeDefined;
+  fmi2Real nextEventTime;
+} fmi2EventInfo;
+
+static void logger(void *env, const char *instanceName, fmi2Status status, const char *category, const char *message, ...)
+{
+}
+
+static fmi2Component (*instantiate)(const char*, int, const char*, const char*, const fmi2CallbackFunctions*, fmi2Boolean, fmi2Boolean);
+static fmi2Status (*setupExperiment)(fmi2Component, fmi2Boolean, fmi2Real, fmi2Real, fmi2Boolean, fmi2Real);
+static fmi2Status (*enterInitializationMode)(fmi2Component);
+static fmi2Status (*exitInitializationMode)(fmi2Component);
+static fmi2Status (*newDiscreteStates)(fmi2Component, fmi2EventInfo*);
+static fmi2Status (*enterContinuousTimeMode)(fmi2Component);
+static fmi2Status (*setTime)(fmi2Component, fmi2Real);
+static fmi2Status (*setContinuousStates)(fmi2Component, const fmi2Real*, size_t);
+static fmi2Status (*getDerivatives)(fmi2Component, fmi2Real*, size_t);
+static fmi2Status (*getReal)(fmi2Component, const fmi2ValueReference*, size_t, fmi2Real*);
+static fmi2Status (*terminate)(fmi2Component);
+static void (*freeInstance)(fmi2Component);
+
+static void* load(void *lib, const char *name)
+{
+  void *sym = dlsym(lib, name);
+  if (!sym) {
+    printf("missing %s\n", name);
+    exit(1);
+  }
+  return sym;
+}
+
+#define CHECK(call) if ((call) != 0) { printf("%s failed\n", #call); exit(1); }
+
+/* value reference of the variable with the given name in modelDescription.xml */
+static fmi2ValueReference valueReference(const char *xml, const char *name)
+{
+  char pattern[256];
+  const char *var;
+  snprintf(pattern, sizeof(pattern), "name=\"%s\"", name);
+  var = strstr(xml, pattern);
+  if (!var || !(var = strstr(var, "valueReference=\""))) {
+    printf("missing variable %s\n", name);
+    exit(1);
+  }
+  return (fmi2ValueReference) strtoul(var + 16, NULL, 10);
+}
+
+int main(int argc, char **argv)
+{
+  fmi2CallbackFunctions callbacks = {logger, calloc, free, NULL, NULL};
+  fmi2EventInfo eventInfo;
+  fmi2Component c;
+  fmi2Real x = 0.5, dx, y, z;
+  fmi2ValueReference vrY, vrZ;
+  char guid[128] = "", xml[65536], *start, *end;
+  int *calls;
+  void *lib;
+  FILE *f;
+
+  if (argc != 3) {
+    printf("usage: %s binary modelDescription.xml\n", argv[0]);
+    return 1;
+  }
+  f = fopen(argv[2], "r");
+  if (!f) {
+    printf("cannot open %s\n", argv[2]);
+    return 1;
+  }
+  xml[fread(xml, 1, sizeof(xml) - 1, f)] = 0;
+  fclose(f);
+  if ((start = strstr(xml, "guid=\"")) && (end = strchr(start + 6, '"')) && end - start - 6 < sizeof(guid)) {
+    memcpy(guid, start + 6, end - start - 6);
+    guid[end - start - 6] = 0;
+  }
+
+  lib = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+  if (!lib) {
+    printf("cannot load %s\n", argv[1]);
+    return 1;
+  }
+  instantiate = load(lib, "fmi2Instantiate");
+  setupExperiment = load(lib, "fmi2SetupExperiment");
+  enterInitializationMode = load(lib, "fmi2EnterInitializationMode");
+  exitInitializationMode = load(lib, "fmi2ExitInitializationMode");
+  newDiscreteStates = load(lib, "fmi2NewDiscreteStates");
+  enterContinuousTimeMode = load(lib, "fmi2EnterContinuousTimeMode");
+  setTime = load(lib, "fmi2SetTime");
+  setContinuousStates = load(lib, "fmi2SetContinuousStates");
+  getDerivatives = load(lib, "fmi2GetDerivatives");
+  getReal = load(lib, "fmi2GetReal");
+  terminate = load(lib, "fmi2Terminate");
+  freeInstance = load(lib, "fmi2FreeInstance");
+  calls = load(lib, "testFMUOutputUpdate_calls");
+
+  c = instantiate("testFMUOutputUpdate", 0 /* fmi2ModelExchange */, guid, "", &callbacks, 0, 0);
+  if (!c) {
+    printf("fmi2Instantiate failed\n");
+    return 1;
+  }
+  vrY = valueReference(xml, "y");
+  vrZ = valueReference(xml, "z");
+  CHECK(setupExperiment(c, 0, 0, 0, 0, 0));
+  CHECK(enterInitializationMode(c));
+  CHECK(exitInitializationMode(c));
+  do {
+    CHECK(newDiscreteStates(c, &eventInfo));
+  } while (eventInfo.newDiscreteStatesNeeded);
+  CHECK(enterContinuousTimeMode(c));
+
+  calls[0] = calls[1] = 0;
+  CHECK(setTime(c, 0.1));
+  CHECK(setContinuousStates(c, &x, 1));
+  CHECK(getDerivatives(c, &dx, 1));
+  printf("derivatives: y %d, z %d, der(x) %s\n", calls[0], calls[1], dx == -x ? "ok" : "wrong");
+  CHECK(getReal(c, &vrY, 1, &y));
+  printf("output: y %d, z %d, y %s\n", calls[0], calls[1], y == 2 * x ? "ok" : "wrong");
+  CHECK(getReal(c, &vrY, 1, &y));
+  printf("output again: y %d, z %d\n", calls[0], calls[1]);
+  CHECK(getReal(c, &vrZ, 1, &z));
+  printf("algebraic variable: y %d, z %d, z %s\n", calls[0], calls[1], z == 3 * x ? "ok" : "wrong");
+  CHECK(getReal(c, &vrY, 1, &y));
+  printf("output after all: y %d, z %d\n", calls[0], calls[1]);
+
+  CHECK(terminate(c));
+  freeInstance(c);
+  return 0;
+}
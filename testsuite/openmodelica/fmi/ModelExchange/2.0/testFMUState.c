@@ -0,0 +1,238 @@
+/* Round trip of fmi2GetFMUstate/fmi2SetFMUstate and fmi2SerializeFMUstate/fmi2DeSerializeFMUstate
+ * for testFMUState.mos: the FMU is integrated to t=0.5, its state is saved, integrated to t=1,
+ * and then restored from the saved and from the deserialized state and integrated to t=1 again.
+ * The string parameter p is set before the initialization and must keep its value after the
+ * deserialized state is set and freed.
+ *
+ * usage: testFMUState <binary> <modelDescription.xml>
+ */
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef void* fmi2Component;
+typedef void* fmi2FMUstate;
+typedef int fmi2Status;
+typedef int fmi2Boolean;
+typedef double fmi2Real;
+typedef unsigned int fmi2ValueReference;
+typedef const char* fmi2String;
+
+typedef struct {
+  void (*logger)(void*, const char*, fmi2Status, const char*, const char*, ...);
+  void* (*allocateMemory)(size_t, size_t);
+  void (*freeMemory)(void*);
+  void (*stepFinished)(void*, fmi2Status);
+  void* componentEnvironment;
+} fmi2CallbackFunctions;
+
+typedef struct {
+  fmi2Boolean newDiscreteStatesNeeded;
+  fmi2Boolean terminateSimulation;
+  fmi2Boolean nominalsOfContinuousStatesChanged;
+  fmi2Boolean valuesOfContinuousStatesChanged;
+  fmi2Boolean nextEventTimeDefined;
+  fmi2Real nextEventTime;
+} fmi2EventInfo;
+
+#define NX 2
+#define STEPS 100
+#define STEP 0.005
+
+static void logger(void *env, const char *instanceName, fmi2Status status, const char *category, const char *message, ...)
+{
+}
+
+static fmi2Component (*instantiate)(const char*, int, const char*, const char*, const fmi2CallbackFunctions*, fmi2Boolean, fmi2Boolean);
+static fmi2Status (*setupExperiment)(fmi2Component, fmi2Boolean, fmi2Real, fmi2Real, fmi2Boolean, fmi2Real);
+static fmi2Status (*enterInitializationMode)(fmi2Component);
+static fmi2Status (*exitInitializationMode)(fmi2Component);
+static fmi2Status (*newDiscreteStates)(fmi2Component, fmi2EventInfo*);
+static fmi2Status (*enterContinuousTimeMode)(fmi2Component);
+static fmi2Status (*setTime)(fmi2Component, fmi2Real);
+static fmi2Status (*getContinuousStates)(fmi2Component, fmi2Real*, size_t);
+static fmi2Status (*setContinuousStates)(fmi2Component, const fmi2Real*, size_t);
+static fmi2Status (*getDerivatives)(fmi2Component, fmi2Real*, size_t);
+static fmi2Status (*completedIntegratorStep)(fmi2Component, fmi2Boolean, fmi2Boolean*, fmi2Boolean*);
+static fmi2Status (*getFMUstate)(fmi2Component, fmi2FMUstate*);
+static fmi2Status (*setFMUstate)(fmi2Component, fmi2FMUstate);
+static fmi2Status (*freeFMUstate)(fmi2Component, fmi2FMUstate*);
+static fmi2Status (*serializedFMUstateSize)(fmi2Component, fmi2FMUstate, size_t*);
+static fmi2Status (*serializeFMUstate)(fmi2Component, fmi2FMUstate, char*, size_t);
+static fmi2Status (*deSerializeFMUstate)(fmi2Component, const char*, size_t, fmi2FMUstate*);
+static fmi2Status (*getString)(fmi2Component, const fmi2ValueReference*, size_t, fmi2String*);
+static fmi2Status (*setString)(fmi2Component, const fmi2ValueReference*, size_t, const fmi2String*);
+static fmi2Status (*terminate)(fmi2Component);
+static void (*freeInstance)(fmi2Component);
+
+static void* load(void *lib, const char *name)
+{
+  void *sym = dlsym(lib, name);
+  if (!sym) {
+    printf("missing %s\n", name);
+    exit(1);
+  }
+  return sym;
+}
+
+#define CHECK(call) if ((call) != 0) { printf("%s failed\n", #call); exit(1); }
+
+/* explicit Euler from the current time for n steps */
+static void integrate(fmi2Component c, fmi2Real *t, int n)
+{
+  fmi2Real x[NX], dx[NX];
+  fmi2Boolean enterEventMode, terminateSimulation;
+  int i, j;
+  for (i = 0; i < n; i++) {
+    CHECK(getContinuousStates(c, x, NX));
+    CHECK(getDerivatives(c, dx, NX));
+    for (j = 0; j < NX; j++) {
+      x[j] += STEP * dx[j];
+    }
+    *t += STEP;
+    CHECK(setTime(c, *t));
+    CHECK(setContinuousStates(c, x, NX));
+    CHECK(completedIntegratorStep(c, 1, &enterEventMode, &terminateSimulation));
+  }
+}
+
+static int sameStates(fmi2Component c, const fmi2Real *expected)
+{
+  fmi2Real x[NX];
+  int j;
+  CHECK(getContinuousStates(c, x, NX));
+  for (j = 0; j < NX; j++) {
+    if (x[j] != expected[j]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* value reference of the variable with the given name in modelDescription.xml */
+static fmi2ValueReference valueReference(const char *xml, const char *name)
+{
+  char pattern[256];
+  const char *var;
+  snprintf(pattern, sizeof(pattern), "name=\"%s\"", name);
+  var = strstr(xml, pattern);
+  if (!var || !(var = strstr(var, "valueReference=\""))) {
+    printf("missing variable %s\n", name);
+    exit(1);
+  }
+  return (fmi2ValueReference) strtoul(var + 16, NULL, 10);
+}
+
+int main(int argc, char **argv)
+{
+  fmi2CallbackFunctions callbacks = {logger, calloc, free, NULL, NULL};
+  fmi2EventInfo eventInfo;
+  fmi2Component c;
+  fmi2FMUstate saved = NULL, deserialized = NULL;
+  fmi2Real t = 0, tSaved, xSaved[NX], xEnd[NX];
+  fmi2ValueReference vrP;
+  fmi2String p = "saved value";
+  char guid[128] = "", xml[65536], *start, *end;
+  size_t size;
+  char *buffer;
+  void *lib;
+  FILE *f;
+
+  if (argc != 3) {
+    printf("usage: %s binary modelDescription.xml\n", argv[0]);
+    return 1;
+  }
+  f = fopen(argv[2], "r");
+  if (!f) {
+    printf("cannot open %s\n", argv[2]);
+    return 1;
+  }
+  xml[fread(xml, 1, sizeof(xml) - 1, f)] = 0;
+  fclose(f);
+  if ((start = strstr(xml, "guid=\"")) && (end = strchr(start + 6, '"')) && end - start - 6 < sizeof(guid)) {
+    memcpy(guid, start + 6, end - start - 6);
+    guid[end - start - 6] = 0;
+  }
+
+  lib = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+  if (!lib) {
+    printf("cannot load %s\n", argv[1]);
+    return 1;
+  }
+  instantiate = load(lib, "fmi2Instantiate");
+  setupExperiment = load(lib, "fmi2SetupExperiment");
+  enterInitializationMode = load(lib, "fmi2EnterInitializationMode");
+  exitInitializationMode = load(lib, "fmi2ExitInitializationMode");
+  newDiscreteStates = load(lib, "fmi2NewDiscreteStates");
+  enterContinuousTimeMode = load(lib, "fmi2EnterContinuousTimeMode");
+  setTime = load(lib, "fmi2SetTime");
+  getContinuousStates = load(lib, "fmi2GetContinuousStates");
+  setContinuousStates = load(lib, "fmi2SetContinuousStates");
+  getDerivatives = load(lib, "fmi2GetDerivatives");
+  completedIntegratorStep = load(lib, "fmi2CompletedIntegratorStep");
+  getFMUstate = load(lib, "fmi2GetFMUstate");
+  setFMUstate = load(lib, "fmi2SetFMUstate");
+  freeFMUstate = load(lib, "fmi2FreeFMUstate");
+  serializedFMUstateSize = load(lib, "fmi2SerializedFMUstateSize");
+  serializeFMUstate = load(lib, "fmi2SerializeFMUstate");
+  deSerializeFMUstate = load(lib, "fmi2DeSerializeFMUstate");
+  getString = load(lib, "fmi2GetString");
+  setString = load(lib, "fmi2SetString");
+  terminate = load(lib, "fmi2Terminate");
+  freeInstance = load(lib, "fmi2FreeInstance");
+
+  c = instantiate("testFMUState", 0 /* fmi2ModelExchange */, guid, "", &callbacks, 0, 0);
+  if (!c) {
+    printf("fmi2Instantiate failed\n");
+    return 1;
+  }
+  vrP = valueReference(xml, "p");
+  CHECK(setString(c, &vrP, 1, &p));
+  CHECK(setupExperiment(c, 0, 0, 0, 0, 0));
+  CHECK(enterInitializationMode(c));
+  CHECK(exitInitializationMode(c));
+  do {
+    CHECK(newDiscreteStates(c, &eventInfo));
+  } while (eventInfo.newDiscreteStatesNeeded);
+  CHECK(enterContinuousTimeMode(c));
+
+  integrate(c, &t, STEPS);
+  tSaved = t;
+  CHECK(getContinuousStates(c, xSaved, NX));
+  CHECK(getFMUstate(c, &saved));
+  integrate(c, &t, STEPS);
+  CHECK(getContinuousStates(c, xEnd, NX));
+
+  /* restore the saved state */
+  CHECK(setFMUstate(c, saved));
+  printf("restored state: %s\n", sameStates(c, xSaved) ? "ok" : "wrong");
+  t = tSaved;
+  integrate(c, &t, STEPS);
+  printf("continued from restored state: %s\n", sameStates(c, xEnd) ? "ok" : "wrong");
+
+  /* the saved state must not change when it is set or when the FMU continues */
+  CHECK(serializedFMUstateSize(c, saved, &size));
+  buffer = malloc(size);
+  CHECK(serializeFMUstate(c, saved, buffer, size));
+  CHECK(deSerializeFMUstate(c, buffer, size, &deserialized));
+  printf("deserialized into a new state: %s\n", deserialized && deserialized != saved ? "ok" : "wrong");
+  CHECK(freeFMUstate(c, &saved));
+  free(buffer);
+
+  CHECK(setFMUstate(c, deserialized));
+  printf("restored deserialized state: %s\n", sameStates(c, xSaved) ? "ok" : "wrong");
+  t = tSaved;
+  integrate(c, &t, STEPS);
+  printf("continued from deserialized state: %s\n", sameStates(c, xEnd) ? "ok" : "wrong");
+  CHECK(freeFMUstate(c, &deserialized));
+  /* the strings of the deserialized state are gone, the instance has its own copies */
+  p = NULL;
+  CHECK(getString(c, &vrP, 1, &p));
+  printf("string parameter after freeing the deserialized state: %s\n", p && !strcmp(p, "saved value") ? "ok" : "wrong");
+
+  CHECK(terminate(c));
+  freeInstance(c);
+  return 0;
+}
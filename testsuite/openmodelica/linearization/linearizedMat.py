@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+#
+# Compares the matrices of a linearized model written with -l_sparse, i.e. a
+# MATLAB v4 file with the sparse matrices A, B, C and D and the full
+# matrices x0, u0 and time (see SimulationRuntime/c/linearization/linearize.cpp),
+# with the dense linearized model written without -l_sparse. Only the sizes,
+# the number of nonzeros and the result of the comparison are printed, so the
+# output does not depend on the order of the states.
+#
+# Usage: linearizedMat.py FILE.mat FILE.mo
+
+import re
+import struct
+import sys
+
+FULL = 0
+SPARSE = 2
+
+def readMat(fileName):
+  matrices = {}
+  with open(fileName, "rb") as f:
+    data = f.read()
+  offset = 0
+  while offset < len(data):
+    (mtype, mrows, ncols, imagf, namelen) = struct.unpack_from("=5I", data, offset)
+    offset += 20
+    name = data[offset:offset + namelen - 1].decode()
+    offset += namelen
+    values = struct.unpack_from("=%dd" % (mrows * ncols), data, offset)
+    offset += 8 * mrows * ncols
+    if mtype % 1000 == SPARSE:
+      # triplets (row, col, value) stored by column, the last one holds the dimensions
+      nnz = mrows - 1
+      rows = int(values[nnz])
+      cols = int(values[2 * nnz + 1])
+      dense = [[0.0] * cols for i in range(rows)]
+      for i in range(nnz):
+        dense[int(values[i]) - 1][int(values[nnz + 1 + i]) - 1] = values[2 * (nnz + 1) + i]
+      matrices[name] = (dense, nnz)
+    elif mtype % 1000 == FULL:
+      # column major
+      matrices[name] = ([[values[j * mrows + i] for j in range(ncols)] for i in range(mrows)], None)
+    else:
+      raise Exception("%s: unexpected type %d" % (name, mtype))
+  return matrices
+
+def readMo(fileName):
+  matrices = {}
+  with open(fileName) as f:
+    text = f.read()
+  for (name, values) in re.findall(r"Real (\w+)\[[^\]]*\] =\s*\[(.*?)\];", text, re.S):
+    matrices[name] = [[float(v) for v in row.split(",")] for row in values.split(";")]
+  for (name, values) in re.findall(r"Real (\w+)\[\w+\] = \{(.*?)\};", text, re.S):
+    matrices[name] = [[float(v)] for v in values.split(",")]
+  return matrices
+
+def equal(a, b):
+  return len(a) == len(b) and all(len(r) == len(s) and all(abs(x - y) <= 1e-12 * max(1.0, abs(y)) for (x, y) in zip(r, s)) for (r, s) in zip(a, b))
+
+def main():
+  sparse = readMat(sys.argv[1])
+  dense = readMo(sys.argv[2])
+  for name in ["A", "B", "C", "D", "x0", "u0"]:
+    (m, nnz) = sparse[name]
+    info = "%s: %d x %d" % (name, len(m), len(m[0]) if m else 0)
+    if nnz is not None:
+      info += ", %d nonzero" % nnz
+    print("%s, same as the dense linearization: %s" % (info, "yes" if name in dense and equal(m, dense[name]) else "no"))
+  print("time: %g" % sparse["time"][0][0][0])
+  return 0
+
+if __name__ == "__main__":
+  sys.exit(main())